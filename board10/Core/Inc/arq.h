@@ -0,0 +1,74 @@
+/*!
+ * \file      arq.h
+ *
+ * \brief     Selective-repeat ARQ for the downlink of the photo (or any block of
+ * 			  the flash). Packets are sent inside a sliding window of up to 64
+ * 			  sequence numbers and the ground station acknowledges them with a
+ * 			  SACK: the sequence number of its first missing packet and a 64-bit
+ * 			  bitmap of the packets received from there on. Only the missing
+ * 			  packets are sent again, interleaved with the new ones.
+ *
+ * 			  Packet: seq (2 bytes, MSB first) | ARQ_PAYLOAD_SIZE bytes of data
+ * 			  SACK:   base (2 bytes, MSB first) | bitmap (8 bytes, bit i = base + i received)
+ *
+ * 			  With Arq_Set_Fec, every ARQ_WINDOW_SIZE new packets are followed by
+ * 			  parity packets (fec.h) with seq = FEC_PARITY_SEQ(group, j). They are
+ * 			  not acknowledged nor retransmitted.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_ARQ_H_
+#define INC_ARQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fec.h"
+
+#define ARQ_WINDOW_SIZE			40		/*Packets in flight (<= 64, the bits of a SACK)*/
+#define ARQ_HEADER_SIZE			2
+#define ARQ_PACKET_SIZE			38		/*BUFFER_SIZE of comms.h*/
+#define ARQ_PAYLOAD_SIZE		(ARQ_PACKET_SIZE - ARQ_HEADER_SIZE)
+#define ARQ_SACK_SIZE			10
+
+typedef struct {
+	uint32_t DataAddress;	/*Memory-mapped flash address of the data*/
+	uint32_t Length;		/*Bytes to send*/
+	uint16_t Total;			/*Packets of the transfer*/
+	uint16_t Base;			/*First packet not acknowledged*/
+	uint16_t Next;			/*Next packet never sent*/
+	uint64_t Acked;			/*Bit i: packet Base + i acknowledged*/
+	uint64_t Retransmit;	/*Bit i: packet Base + i has to be sent again*/
+	bool LastWasRetransmit;	/*To alternate retransmissions and new packets*/
+	FecEncoder Fec;			/*Parity of the group being sent*/
+	uint8_t ParityPending;	/*Parity packets of the last complete group still to send*/
+	uint16_t ParityGroup;	/*Group of the pending parity packets*/
+	uint32_t Sent;			/*Packets sent (new + retransmitted)*/
+	uint32_t Retransmitted;	/*Packets sent again*/
+	uint32_t Sacks;			/*SACKs processed*/
+	uint32_t ParitySent;	/*Parity packets sent*/
+} ArqTx;
+
+/*Starts a transfer of Length bytes from DataAddress, resuming the window saved in the flash*/
+void Arq_Init(ArqTx *arq, uint32_t DataAddress, uint32_t Length);
+
+/*Starts the transfer from the first packet (new data) and saves the window*/
+void Arq_Reset(ArqTx *arq);
+
+/*Sends Parity packets every ARQ_WINDOW_SIZE new packets (0 turns the FEC off)*/
+void Arq_Set_Fec(ArqTx *arq, uint8_t Parity);
+
+/*Builds the next packet to send, returns false if the window is full or the transfer is done*/
+bool Arq_Next(ArqTx *arq, uint8_t *Packet);
+
+/*Processes a SACK received from the ground station and slides the window*/
+void Arq_Sack(ArqTx *arq, const uint8_t *Sack);
+
+/*No SACK arrived in time: every packet in flight that is not acknowledged is sent again*/
+void Arq_Timeout(ArqTx *arq);
+
+/*True once every packet has been acknowledged*/
+bool Arq_Done(const ArqTx *arq);
+
+#endif /* INC_ARQ_H_ */
@@ -0,0 +1,74 @@
+/*
+ * camera_uart.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Asynchronous UART transport of the VC0706 camera. Commands are sent as a
+ *  single frame by interrupt and the responses are stored in a ring buffer by
+ *  the reception-to-idle interrupt. Only CameraUart_ReadBlocking waits (asleep)
+ *  for them, for the commands run out of the scheduler: the photo is taken by
+ *  the camera task, woken by the events of the callback (photoStep of
+ *  payload_camera.h).
+ */
+
+#ifndef INC_CAMERA_UART_H_
+#define INC_CAMERA_UART_H_
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CAMERA_UART_RX_FIFO_SIZE	512		// Ring buffer for the responses (> 1 chunk + headers)
+#define CAMERA_UART_RX_BLOCK_SIZE	64		// Bytes received before the data is moved to the ring buffer
+#define CAMERA_UART_MAX_FRAME		32		// 0x56 0x00 command + arguments
+
+typedef enum
+{
+	CAMERA_UART_TX_DONE,		// The whole command frame has been sent
+	CAMERA_UART_RX_IDLE,		// The line went idle after receiving data (end of a response)
+	CAMERA_UART_RX_OVERFLOW,	// The ring buffer was full, bytes were dropped
+} CameraUartEvent;
+
+typedef void (*CameraUartCallback)(CameraUartEvent event);
+
+/**
+  * Starts the continuous reception of the camera UART
+  * callback (can be NULL) is called from the interrupt on every event
+  */
+void CameraUart_Init(UART_HandleTypeDef *huart, CameraUartCallback callback);
+
+/**
+  * Sends 0x56 0x00 command hexData with a single interrupt transfer
+  * The reception is started again first if it is not running, so the answer is not lost
+  * Returns false if the previous frame is still being sent
+  */
+bool CameraUart_Send(uint8_t command, const uint8_t *hexData, uint8_t dataArrayLength);
+
+/**
+  * True while a frame is being sent
+  */
+bool CameraUart_TxBusy(void);
+
+/**
+  * Moves up to length received bytes to buffer, returns how many were moved
+  */
+uint16_t CameraUart_Read(uint8_t *buffer, uint16_t length);
+
+/**
+  * Waits (up to timeout ms, sleeping between the interrupts) until length bytes are received
+  * and moves them to buffer
+  * Returns how many bytes were moved
+  */
+uint16_t CameraUart_ReadBlocking(uint8_t *buffer, uint16_t length, uint32_t timeout);
+
+/**
+  * Discards everything received
+  */
+void CameraUart_Flush(void);
+
+/**
+  * Number of bytes dropped because the ring buffer was full
+  */
+uint32_t CameraUart_Overflows(void);
+
+#endif /* INC_CAMERA_UART_H_ */
@@ -97,6 +97,8 @@ typedef enum
 
 
 
+/*Handlers of the radio (OnTxDone...), given to Radio.Init and to RadioIrq_Init*/
+extern RadioEvents_t RadioEvents;
 
 void configuration(void);
 
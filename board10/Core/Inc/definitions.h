@@ -57,6 +57,9 @@
 #define SET_SF				24
 #define SET_CRC				25
 #define SEND_CALIBRATION	26
+#define SEND_TRACE			27	/*Oldest records of the trace (trace.h), one packet each time*/
+#define SEND_HK_LOG			28	/*Housekeeping blocks (hk_log.h) of the last info hours, 0 = the open block*/
+#define SEND_HK_STATS		29	/*Summary frame (hk_stats.h) of the window info: 0 minute, 1 orbit, 2 day*/
 
 /*CAMARA*/
 #define TAKEPHOTO 			30	/*Might rotate the PQ into the right position +
@@ -85,7 +88,7 @@
 
 /* USER CODE BEGIN EFP */
 enum MachineState {INIT, IDLE, COMMS, PAYLOAD, CONTINGENCY, SUNSAFE, SURVIVAL};
-uint8_t currentState;
+extern uint8_t currentState; /*Defined in configuration.c*/
 
 
 
@@ -0,0 +1,53 @@
+/*!
+ * \file      fec.h
+ *
+ * \brief     Packet-level erasure code for the downlink. Every group of up to
+ * 			  FEC_MAX_GROUP data packets is followed by M parity packets computed
+ * 			  with a systematic Cauchy Reed-Solomon code over GF(2^8), so the
+ * 			  ground station can rebuild any M lost packets of the group without
+ * 			  asking for a retransmission.
+ *
+ * 			  Parity packet j of a group: byte b = sum over i of C(j, i) * data_i[b]
+ * 			  with C(j, i) = 1 / (x_j + y_i), x_j = FEC_MAX_GROUP + j, y_i = i
+ * 			  (GF(2^8) with polynomial 0x11D). Missing packets of the last group
+ * 			  are taken as zeros.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_FEC_H_
+#define INC_FEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FEC_MAX_GROUP			128		/*Data packets of a group (y_i < 128 <= x_j)*/
+#define FEC_MAX_PARITY			16		/*Parity packets of a group*/
+#define FEC_BLOCK_SIZE			36		/*Bytes protected of each packet (ARQ_PAYLOAD_SIZE)*/
+
+/*Sequence number of the parity packet j of a group, data packets are below 0x8000*/
+#define FEC_PARITY_FLAG			0x8000
+#define FEC_PARITY_SEQ(group, j)	(FEC_PARITY_FLAG | ((group) << 4) | (j))
+
+/*The parity is accumulated while the data packets are sent, only M blocks are kept in RAM*/
+typedef struct {
+	uint8_t K;									/*Data packets of a group*/
+	uint8_t M;									/*Parity packets of a group (0: FEC off)*/
+	uint8_t Count;								/*Data packets added to the current group*/
+	uint8_t Parity[FEC_MAX_PARITY][FEC_BLOCK_SIZE];
+} FecEncoder;
+
+/*Starts an encoder of M parity packets every K data packets*/
+void Fec_Init(FecEncoder *enc, uint8_t K, uint8_t M);
+
+/*Adds the next data packet of the group, returns true when the group is complete*/
+bool Fec_Add(FecEncoder *enc, const uint8_t *Data);
+
+/*Parity block j of the current group, valid after the last packet of the group*/
+const uint8_t *Fec_Parity(const FecEncoder *enc, uint8_t j);
+
+/*Clears the parity to start the next group*/
+void Fec_Restart(FecEncoder *enc);
+
+#endif /* INC_FEC_H_ */
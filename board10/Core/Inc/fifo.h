@@ -17,29 +17,24 @@ Maintainer: Miguel Luis and Gregory Cristian
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "ring.h"
 
 /*!
- * FIFO structure
+ * FIFO structure, kept as a shim of the lock-free ring (ring.h)
  */
-typedef struct Fifo_s
-{
-    uint16_t Begin;
-    uint16_t End;
-    uint8_t *Data;
-    uint16_t Size;
-}Fifo_t;
+typedef Ring_t Fifo_t;
 
 /*!
  * Initializes the FIFO structure
  *
  * \param [IN] fifo   Pointer to the FIFO object
  * \param [IN] buffer Buffer to be used as FIFO
- * \param [IN] size   Size of the buffer
+ * \param [IN] size   Size of the buffer (rounded down to a power of 2, at least 2)
  */
 void FifoInit( Fifo_t *fifo, uint8_t *buffer, uint16_t size );
 
 /*!
- * Pushes data to the FIFO
+ * Pushes data to the FIFO, it is dropped (and counted in Overflows) if the FIFO is full
  *
  * \param [IN] fifo Pointer to the FIFO object
  * \param [IN] data Data to be pushed into the FIFO
@@ -50,7 +45,7 @@ void FifoPush( Fifo_t *fifo, uint8_t data );
  * Pops data from the FIFO
  *
  * \param [IN] fifo Pointer to the FIFO object
- * \retval data     Data popped from the FIFO
+ * \retval data     Data popped from the FIFO (0 if it is empty)
  */
 uint8_t FifoPop( Fifo_t *fifo );
 
@@ -17,8 +17,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+//REDUNDANCY: the variables up to 0x0800BFFF have 2 more copies, each one 0x4000 positions after
+#define REDUNDANCY_OFFSET			0x4000
 
 #define PHOTO_ADDR 					0x08020000
+#define PHOTO_MAX_SIZE				0x20000		//Sector 5, the next one is used by flash_log.c
 #define PAYLOAD_STATE_ADDR 			0x08008000
 #define COMMS_STATE_ADDR 			0x08008001
 #define DEPLOYMENT_STATE_ADDR 		0x08008002
@@ -33,6 +38,8 @@
 #define PL_TIME_ADDR 				0x0800800B
 #define PREVIOUS_STATE_ADDR			0x0800800C
 #define EXIT_LOW_ADDR 				0x0800800D
+#define LINK_SF_ADDR 				0x0800800E	//SF and CR chosen by link_adapt.c, rewritten every few windows
+#define LINK_CR_ADDR 				0x0800800F
 
 //CONFIGURATION ADDRESSES
 #define CONFIG_ADDR 				0x08008010
@@ -64,14 +71,35 @@
 #define CURRENT_ADDR 				0x08008109
 #define BATT_LEVEL_ADDR 			0x0800810A
 
+/*Flash sector descriptor*/
+typedef struct {
+	uint32_t start;		/*First address*/
+	uint32_t size;		/*Size in bytes*/
+	uint32_t index;		/*FLASH_SECTOR_x*/
+} FlashSector;
+
+const FlashSector *Flash_Get_Sector(uint32_t Address);
+
+bool Flash_Plan_Erase(uint32_t Address, uint32_t numberofbytes, uint32_t *FirstSector, uint32_t *NbSectors);
+
+HAL_StatusTypeDef Flash_Erase_Sectors(uint32_t Address, uint32_t numberofbytes);
+
+uint32_t Flash_Erase(uint32_t Address, uint32_t numberofbytes);
+
+HAL_StatusTypeDef Flash_Program_Data(uint32_t Address, uint8_t *Data, uint32_t numberofbytes);
+
 uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t numberofbytes);
 
 void Write_Flash(uint32_t StartSectorAddress, uint8_t *Data, uint16_t numberofbytes);
 
+void Write_Flash_Direct(uint32_t StartSectorAddress, uint8_t *Data, uint16_t numberofbytes);
+
 void Flash_Read_Data (uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numberofbytes);
 
-void Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes);
+uint16_t Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes);
 
 void Read_Flash(uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numberofbytes);
 
+void Read_Flash_Direct(uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numberofbytes);
+
 #endif /* INC_FLASH_H_ */
@@ -0,0 +1,53 @@
+/*!
+ * \file      flash_cache.h
+ *
+ * \brief     RAM copy of the flash.h address map (PAYLOAD_STATE_ADDR ... BATT_LEVEL_ADDR).
+ * 			  Read_Flash/Write_Flash work on this copy and the changes are written
+ * 			  back to the flash in batches (periodically, on a state change or
+ * 			  before a reset).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_FLASH_CACHE_H_
+#define INC_FLASH_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASH_CACHE_START			0x08008000	//PAYLOAD_STATE_ADDR
+#define FLASH_CACHE_SIZE			0x110		//up to BATT_LEVEL_ADDR, rounded to 16 bytes
+
+#define FLASH_CACHE_FLUSH_PERIOD	60000		//ms between periodic write-backs
+
+/*Write-back counters*/
+typedef struct {
+	uint32_t reads;			/*Reads served from RAM*/
+	uint32_t writes;		/*Writes absorbed in RAM*/
+	uint32_t flushes;		/*Write-backs with at least one dirty region*/
+	uint32_t flash_writes;	/*Write_Flash_Direct calls done by the write-backs*/
+} FlashCacheStats;
+
+/*Loads the RAM copy from the flash (log + triple redundancy area)*/
+void Flash_Cache_Init(void);
+
+/*True if the whole range belongs to the cached address map*/
+bool Flash_Cache_Owns(uint32_t Address, uint16_t numberofbytes);
+
+/*Copies the cached value, no flash access*/
+void Flash_Cache_Read(uint32_t Address, uint8_t *RxBuf, uint16_t numberofbytes);
+
+/*Updates the cached value and marks it dirty if it changed*/
+void Flash_Cache_Write(uint32_t Address, uint8_t *Data, uint16_t numberofbytes);
+
+/*Writes back all the dirty regions*/
+void Flash_Cache_Flush(void);
+
+/*Writes back if FLASH_CACHE_FLUSH_PERIOD has elapsed since the last write-back*/
+void Flash_Cache_Poll(void);
+
+/*Returns the write-back counters*/
+const FlashCacheStats *Flash_Cache_Get_Stats(void);
+
+#endif /* INC_FLASH_CACHE_H_ */
@@ -0,0 +1,84 @@
+/*!
+ * \file      flash_log.h
+ *
+ * \brief     Append-only, wear-levelled key/value log for the variables of the
+ * 			  flash.h address map that are rewritten on every main loop iteration
+ * 			  (state flags and telemetry). Two sectors swap roles: one holds the
+ * 			  active log and the other one is kept erased for garbage collection.
+ *
+ * 			  The log also stores the blocks of the housekeeping series (hk_log.c)
+ * 			  as records of their own key. They are never overwritten: a garbage
+ * 			  collection carries the newest FLASH_LOG_SERIES_KEEP bytes of them to
+ * 			  the new sector and drops the older ones.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_FLASH_LOG_H_
+#define INC_FLASH_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//LOG SECTORS (sectors 6 and 7 of the STM32F411CE, 128KB each)
+#define FLASH_LOG_SECTOR_A_ADDR		0x08040000
+#define FLASH_LOG_SECTOR_B_ADDR		0x08060000
+#define FLASH_LOG_SECTOR_SIZE		0x20000
+
+/*
+ * Ranges of the address map that are served by the log. Everything else keeps
+ * being written through Flash_Write_Data (with triple redundancy if it applies).
+ * The configuration, TLE and calibration are written rarely, so they stay there.
+ */
+#define FLASH_LOG_STATE_START		0x08008000	//PAYLOAD_STATE_ADDR ... LINK_CR_ADDR
+#define FLASH_LOG_STATE_SIZE		0x10
+#define FLASH_LOG_TELEMETRY_START	0x08008100	//TEMP_ADDR ... BATT_LEVEL_ADDR
+#define FLASH_LOG_TELEMETRY_SIZE	0x10
+
+#define FLASH_LOG_SLOTS				(FLASH_LOG_STATE_SIZE + FLASH_LOG_TELEMETRY_SIZE)
+
+/*Sector header status, the values only clear bits so they can be programmed in sequence*/
+#define FLASH_LOG_SECTOR_ERASED		0xFFFFFFFF
+#define FLASH_LOG_SECTOR_RECEIVING	0xEEEEEEEE
+#define FLASH_LOG_SECTOR_VALID		0x00000000
+
+/*Key of the records of the housekeeping series, outside the ranges above*/
+#define FLASH_LOG_SERIES_KEY		0xFFF0
+#define FLASH_LOG_SERIES_KEEP		0x8000		//Bytes of series records kept by a garbage collection
+
+/*Last word of every record, programmed once the data is complete*/
+#define FLASH_LOG_COMMIT			0x5AA5C33C
+
+/*Counters to know how much the log is saving with respect to Flash_Write_Data*/
+typedef struct {
+	uint32_t appends;		/*Records appended*/
+	uint32_t erases;		/*Sector erases (garbage collections + formats)*/
+	uint32_t collections;	/*Garbage collections*/
+} FlashLogStats;
+
+/*Scans the active sector and rebuilds the RAM index, formats the log if needed*/
+void Flash_Log_Init(void);
+
+/*True if the whole range [Address, Address + numberofbytes) is served by the log*/
+bool Flash_Log_Owns(uint32_t Address, uint16_t numberofbytes);
+
+/*Appends a record with the new value, collects garbage if the sector is full*/
+uint32_t Flash_Log_Write(uint32_t Address, uint8_t *Data, uint16_t numberofbytes);
+
+/*Reads the latest value of every byte of the range from the log, nothing if it does not own it*/
+void Flash_Log_Read(uint32_t Address, uint8_t *RxBuf, uint16_t numberofbytes);
+
+/*Appends a block of the housekeeping series, collects garbage if the sector is full*/
+uint32_t Flash_Log_Append_Series(uint8_t *Block, uint16_t numberofbytes);
+
+/*Flash address of the series block after Block (0: the oldest one), 0 if there are no more*/
+uint32_t Flash_Log_Next_Series(uint32_t Block, uint16_t *numberofbytes);
+
+/*Changes on every garbage collection, when the series blocks move to the other sector*/
+uint32_t Flash_Log_Get_Generation(void);
+
+/*Returns the log counters*/
+const FlashLogStats *Flash_Log_Get_Stats(void);
+
+#endif /* INC_FLASH_LOG_H_ */
@@ -0,0 +1,39 @@
+/*!
+ * \file      flash_scrub.h
+ *
+ * \brief     Background scrubber of the triple redundancy area. A few words are
+ * 			  voted in every main loop iteration, and the copies that disagree are
+ * 			  repaired at the end of each pass, one copy (sector) per iteration.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_FLASH_SCRUB_H_
+#define INC_FLASH_SCRUB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*Protected region: CONFIG_ADDR ... end of the calibration (the rest of the map is in the log)*/
+#define FLASH_SCRUB_START			0x08008010
+#define FLASH_SCRUB_SIZE			0xF0
+
+/*Time budget of Flash_Scrub_Step: words voted per call (3 flash reads each)*/
+#define FLASH_SCRUB_WORDS_PER_STEP	4
+
+typedef struct {
+	uint32_t passes;			/*Complete passes over the region (repairs included)*/
+	uint32_t corrected;			/*Words where one copy disagreed*/
+	uint32_t uncorrectable;		/*Words where the three copies were different*/
+	uint32_t repairs_inplace;	/*Copies repaired by programming over them (only 1 -> 0 flips)*/
+	uint32_t repairs_erase;		/*Copies repaired by erasing and rewriting their sector*/
+} FlashScrubStats;
+
+/*Votes FLASH_SCRUB_WORDS_PER_STEP words or repairs one copy, never both*/
+void Flash_Scrub_Step(void);
+
+/*Returns the scrubber counters*/
+const FlashScrubStats *Flash_Scrub_Get_Stats(void);
+
+#endif /* INC_FLASH_SCRUB_H_ */
@@ -0,0 +1,43 @@
+/*!
+ * \file      fuel_gauge.h
+ *
+ * \brief     Battery fuel gauge (BATTSENSOR_ADDR). Its registers auto-increment,
+ * 			  so the level, current, temperature and voltage are read as one
+ * 			  contiguous block in a single transaction instead of a transmit and
+ * 			  a receive per register, and every field is decoded from that block.
+ *
+ * 			  The map and the units are the ones of the DS2782 (address 0x34): the
+ * 			  measurements are 16-bit registers, MSB first, with the temperature
+ * 			  and the voltage left aligned by 5 bits.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_FUEL_GAUGE_H_
+#define INC_FUEL_GAUGE_H_
+
+#include <stdint.h>
+
+/*Registers*/
+#define FUEL_GAUGE_REG_LEVEL		0x06	/*Remaining capacity (%), 1 byte*/
+#define FUEL_GAUGE_REG_CURRENT		0x08	/*Average current, 2 bytes*/
+#define FUEL_GAUGE_REG_TEMPERATURE	0x0A	/*2 bytes*/
+#define FUEL_GAUGE_REG_VOLTAGE		0x0C	/*2 bytes*/
+
+/*Block read in one transaction: from the first to the last register above*/
+#define FUEL_GAUGE_BLOCK_START		FUEL_GAUGE_REG_LEVEL
+#define FUEL_GAUGE_BLOCK_SIZE		(FUEL_GAUGE_REG_VOLTAGE + 2 - FUEL_GAUGE_BLOCK_START)
+
+/*Counts of one reading (sign extended, see sensor_conv.h for the units)*/
+typedef struct {
+	uint8_t level;
+	int16_t current;		/*1.5625 uV / Rsns*/
+	int16_t temperature;	/*0.125 degC*/
+	int16_t voltage;		/*4.88 mV*/
+} FuelGaugeRegisters;
+
+/*Decodes every register from a block read at FUEL_GAUGE_BLOCK_START*/
+void FuelGauge_Decode(const uint8_t block[FUEL_GAUGE_BLOCK_SIZE], FuelGaugeRegisters *registers);
+
+#endif /* INC_FUEL_GAUGE_H_ */
@@ -0,0 +1,89 @@
+/*!
+ * \file      hk_log.h
+ *
+ * \brief     Time series of the housekeeping sensors. The samples are encoded in
+ * 			  RAM into a block of at most HK_LOG_BLOCK_SIZE bytes; a full block
+ * 			  is appended to the flash log (flash_log.h) and indexed by its first
+ * 			  time, so a time range is found with a binary search. The blocks are
+ * 			  downlinked as they are, in fragments of a packet (HkLog_Read_Fragment),
+ * 			  and each one can be decoded alone, little-endian:
+ *
+ * 			    'H' 'K' version(1) channels(1) count(2) first(4) last(4)
+ * 			    channels x value(2)                    first sample
+ * 			    count-1 x { mask(varint) [step(varint)] [delta(varint)]... }
+ *
+ * 			  first and last are the times of the first and the last sample. Bit
+ * 			  0 of mask is set if the time step differs from the previous one (0
+ * 			  before the second sample), then the change of step follows; bit
+ * 			  1 + c is set if channel c changed, then its delta follows, in the
+ * 			  order of the channels. Steps and deltas are zig-zag encoded (0, -1,
+ * 			  1, -2... -> 0, 1, 2, 3...) LEB128 varints (as trace.h), so a sample
+ * 			  equal to the previous one, one period later, takes 1 byte.
+ *
+ * 			  The time counts seconds of the log: at start-up it goes on from the
+ * 			  last stored sample, so the time the OBC was off is not counted.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_HK_LOG_H_
+#define INC_HK_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HK_LOG_VERSION			1
+#define HK_LOG_BLOCK_SIZE		256		/*Bytes, a reset loses the samples of the open block*/
+#define HK_LOG_INDEX_SIZE		512		/*Blocks indexed, more than the log sector can hold*/
+
+/*Channels of a sample, the ones that change more often first so the mask fits in 1 byte*/
+typedef enum {
+	HK_LOG_CURRENT,			/*0.1 A*/
+	HK_LOG_VOLTAGE,			/*0.1 V*/
+	HK_LOG_BATT_LEVEL,		/*%*/
+	HK_LOG_TEMP_BATT,		/*degC*/
+	HK_LOG_TEMP1,			/*degC, TEMP1..TEMP6*/
+	HK_LOG_CHANNELS = HK_LOG_TEMP1 + 6,
+} HkLogChannel;
+
+#define HK_LOG_HEADER_SIZE		(14 + 2 * HK_LOG_CHANNELS)
+
+/*A block is downlinked in fragments: first(4) offset(2) and the bytes of the block from offset*/
+#define HK_LOG_FRAGMENT_HEADER	6
+#define HK_LOG_FRAGMENT_LAST	0x8000	/*In offset, set on the last fragment of the block*/
+
+typedef struct {
+	uint32_t samples;
+	uint32_t blocks;		/*Blocks stored*/
+	uint32_t bytes;			/*Bytes of the blocks stored*/
+	uint32_t errors;		/*Blocks lost because the flash failed*/
+} HkLogStats;
+
+/*Indexes the blocks of the flash log and continues its time, after Flash_Log_Init*/
+void HkLog_Init(void);
+
+/*Current time of the log (s)*/
+uint32_t HkLog_Time(void);
+
+/*Adds a sample (HK_LOG_CHANNELS values) at the current time, stores the block when it is full*/
+void HkLog_Append(const int16_t *values);
+
+/*Stores the open block even if it is not full*/
+void HkLog_Flush(void);
+
+/*Blocks that can be read, the open one (the newest) included*/
+uint16_t HkLog_Blocks(void);
+
+/*First block to read to get the samples from time on*/
+uint16_t HkLog_Find(uint32_t time);
+
+/*Copies a block to buffer, returns its size (0 if it does not exist or does not fit)*/
+uint16_t HkLog_Read_Block(uint16_t block, uint8_t *buffer, uint16_t size);
+
+/*Copies the fragment of a block that starts at offset to a packet of size bytes, returns its size (0 past the end)*/
+uint16_t HkLog_Read_Fragment(uint16_t block, uint16_t offset, uint8_t *buffer, uint16_t size);
+
+const HkLogStats *HkLog_Get_Stats(void);
+
+#endif /* INC_HK_LOG_H_ */
@@ -0,0 +1,84 @@
+/*!
+ * \file      hk_stats.h
+ *
+ * \brief     Summaries of the housekeeping channels (hk_log.h) over windows of
+ * 			  time: minimum, maximum, mean and standard deviation of every channel
+ * 			  over the last minute, orbit and day, so a short pass downlinks a few
+ * 			  bytes instead of the samples. Each window keeps one accumulator per
+ * 			  channel, whatever its length, and the summary of the last window
+ * 			  that ended. The windows are aligned to multiples of their period in
+ * 			  the time of the log.
+ *
+ * 			  A summary is sent in HK_STATS_FRAMES frames of up to
+ * 			  HK_STATS_FRAME_CHANNELS channels, so each fits in a packet,
+ * 			  little-endian:
+ *
+ * 			    'H' 'S' version(1) window(1) first(1) channels(1) start(4) count(4)
+ * 			    channels x { min(2) max(2) mean(2) stddev(2) }
+ *
+ * 			  first is the first channel of the frame and channels how many
+ * 			  follow. start is the log time (s) where the window began and count the
+ * 			  samples. min and max are in the unit of the channel, mean and stddev
+ * 			  in 1/16 of it, saturated (+-2047 units, more than the range of the
+ * 			  housekeeping channels); stddev is the population one (divided by
+ * 			  count).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_HK_STATS_H_
+#define INC_HK_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hk_log.h"
+
+#define HK_STATS_VERSION		2
+#define HK_STATS_FRAME_CHANNELS	3		/*Channels of a frame*/
+#define HK_STATS_FRAME_SIZE		(14 + 8 * HK_STATS_FRAME_CHANNELS)
+#define HK_STATS_FRAMES			((HK_LOG_CHANNELS + HK_STATS_FRAME_CHANNELS - 1) / HK_STATS_FRAME_CHANNELS)
+#define HK_STATS_FRACTION		4		/*Bits of the fraction of mean and stddev*/
+
+typedef enum {
+	HK_STATS_MINUTE,
+	HK_STATS_ORBIT,
+	HK_STATS_DAY,
+	HK_STATS_WINDOWS,
+} HkStatsWindow;
+
+/*Default periods (s), HkStats_Set_Period changes them*/
+#define HK_STATS_MINUTE_PERIOD	60
+#define HK_STATS_ORBIT_PERIOD	5700	/*About 95 min, a 550 km orbit*/
+#define HK_STATS_DAY_PERIOD		86400
+
+typedef struct {
+	int16_t min;
+	int16_t max;
+	int16_t mean;			/*1/16 of the unit*/
+	uint16_t stddev;		/*1/16 of the unit*/
+} HkStatsChannel;
+
+typedef struct {
+	uint32_t start;			/*Log time (s)*/
+	uint32_t count;			/*Samples, 0 while no window has ended*/
+	HkStatsChannel channels[HK_LOG_CHANNELS];
+} HkStatsSummary;
+
+/*Empties the accumulators and sets the default periods*/
+void HkStats_Init(void);
+
+/*Changes the period of a window (s), the current window starts again*/
+void HkStats_Set_Period(uint8_t window, uint32_t period);
+
+/*Adds a sample (HK_LOG_CHANNELS values) taken at time, ends the windows that are over*/
+void HkStats_Add(const int16_t *values, uint32_t time);
+
+/*Summary of the last window that ended*/
+const HkStatsSummary *HkStats_Get_Summary(uint8_t window);
+
+/*Writes frame part (0 .. HK_STATS_FRAMES - 1) of the summary of a window, returns its size
+  (0 if there is none or it does not fit)*/
+uint16_t HkStats_Frame(uint8_t window, uint8_t part, uint8_t *buffer, uint16_t size);
+
+#endif /* INC_HK_STATS_H_ */
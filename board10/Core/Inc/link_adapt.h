@@ -0,0 +1,72 @@
+/*!
+ * \file      link_adapt.h
+ *
+ * \brief     Closed-loop adaptation of the spreading factor and coding rate of
+ * 			  the downlink. The SNR of the received packets is filtered with an
+ * 			  EWMA and, at the end of every ARQ window, the SF is moved to the
+ * 			  fastest one whose demodulation limit still leaves the required
+ * 			  margin, and the CR follows the packet loss of the window. Faster
+ * 			  settings need a hysteresis and a few windows without changes, slower
+ * 			  ones are taken at once. The choice is kept in LINK_SF_ADDR and
+ * 			  LINK_CR_ADDR, served by the flash log (flash_log.h) because it
+ * 			  changes during the passes; SF_ADDR and CRC_ADDR keep the setting
+ * 			  of the ground (SET_SF, SET_CRC) that it starts from.
+ *
+ * 			  The radio is configured through the callback given to LinkAdapt_Init,
+ * 			  which comms is expected to implement with Radio.SetTxConfig.
+ *
+ * 			  LinkAdapt_Window belongs to the end of each window of the ARQ
+ * 			  downlink (arq.h). No downlink runs in the firmware while comms.c is
+ * 			  commented out, so for now the closed loop only runs in the host
+ * 			  tests; the firmware keeps the SF and CR of the ground and, with
+ * 			  OBC_RADIO (main.c), applies them at startup.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_LINK_ADAPT_H_
+#define INC_LINK_ADAPT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LINK_ADAPT_EWMA_N			8		/*Weight of a new sample: 1/8*/
+#define LINK_ADAPT_MARGIN			10		/*SNR margin kept over the demodulation limit (dB x 10), the ARQ resends the fades*/
+#define LINK_ADAPT_HYSTERESIS		20		/*Extra margin needed to go to a faster SF (dB x 10)*/
+#define LINK_ADAPT_HOLD				2		/*Windows without changes before going faster*/
+#define LINK_ADAPT_LOSS_HIGH		25		/*% of packets lost in a window to use a stronger CR (a step costs 17-25% of airtime)*/
+#define LINK_ADAPT_LOSS_LOW			2		/*% of packets lost in a window to use a weaker CR*/
+
+#define LINK_ADAPT_SF_DEFAULT		9		/*LORA_SPREADING_FACTOR of comms.h*/
+#define LINK_ADAPT_CR_MIN			1		/*LORA_CR_4_5*/
+#define LINK_ADAPT_CR_MAX			4		/*LORA_CR_4_8*/
+
+/*Called with the new SF (7..12) and CR (LORA_CR_4_5..LORA_CR_4_8) every time they change*/
+typedef void (*LinkAdaptApply)(uint8_t SpreadingFactor, uint8_t CodingRate);
+
+typedef struct {
+	int16_t Snr;			/*EWMA of the SNR (dB x 10)*/
+	int16_t Rssi;			/*EWMA of the RSSI (dBm)*/
+	uint8_t SpreadingFactor;
+	uint8_t CodingRate;
+	uint32_t Samples;		/*Packets received*/
+	uint32_t Changes;		/*Times the SF or the CR changed*/
+} LinkAdaptStats;
+
+/*Loads the last SF and CR chosen (the ones of the ground if none) and applies them*/
+void LinkAdapt_Init(LinkAdaptApply apply);
+
+/*Starts again from the SF and CR of the ground after a telecommand changed them*/
+void LinkAdapt_Load(void);
+
+/*Adds the RSSI (dBm) and SNR (dB) of a received packet to the averages*/
+void LinkAdapt_Rx(int16_t rssi, int8_t snr);
+
+/*End of a window of sent packets, lost of them not acknowledged. Returns true if the SF or CR changed*/
+bool LinkAdapt_Window(uint16_t sent, uint16_t lost);
+
+/*Averages and current setting*/
+const LinkAdaptStats *LinkAdapt_Get_Stats(void);
+
+#endif /* INC_LINK_ADAPT_H_ */
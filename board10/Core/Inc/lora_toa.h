@@ -0,0 +1,77 @@
+/*!
+ * \file      lora_toa.h
+ *
+ * \brief     Integer LoRa time-on-air and pass capacity. RadioTimeOnAir (radio.c)
+ * 			  computes in double, which the Cortex-M4F emulates in software;
+ * 			  here the symbol time is an exact number of microseconds (2^SF / BW)
+ * 			  so the result is the same without any floating point. The time of
+ * 			  every payload length of the current configuration is kept in a
+ * 			  table, so the comms planner can look it up per packet.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_LORA_TOA_H_
+#define INC_LORA_TOA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LORA_TOA_SF_MIN				7
+#define LORA_TOA_SF_MAX				12
+#define LORA_TOA_BW_MIN				4		/*LORA_BW_125*/
+#define LORA_TOA_BW_MAX				6		/*LORA_BW_500*/
+#define LORA_TOA_MAX_LENGTH			255
+#define LORA_TOA_LDRO_SYMBOL_US		16384	/*Symbol time from which the low data rate optimize is needed*/
+
+/*Same values as the SX126x driver: SF 7..12, BW LORA_BW_125/250/500 (4..6), CR LORA_CR_4_5..4_8 (1..4)*/
+typedef struct {
+	uint8_t SpreadingFactor;
+	uint8_t Bandwidth;
+	uint8_t CodingRate;
+	uint8_t LowDatarateOptimize;
+	uint16_t PreambleLength;
+	bool FixedLength;			/*Implicit header*/
+	bool Crc;
+} LoraToaParams;
+
+typedef struct {
+	LoraToaParams Params;
+	uint16_t Table[LORA_TOA_MAX_LENGTH + 1];	/*ms for every payload length*/
+} LoraToa;
+
+/*Symbol time in microseconds, 0 if the SF or the bandwidth is not supported*/
+uint32_t LoraToa_Symbol_Us(uint8_t SpreadingFactor, uint8_t Bandwidth);
+
+/*Time on air in microseconds, 0 if the configuration is not supported*/
+uint32_t LoraToa_Compute_Us(const LoraToaParams *params, uint8_t pktLen);
+
+/*Time on air in ms, rounded up like RadioTimeOnAir (0: not supported)*/
+uint32_t LoraToa_Compute(const LoraToaParams *params, uint8_t pktLen);
+
+/*Builds the table of the configuration, to be called when the modulation changes (all 0 if not supported)*/
+void LoraToa_Init(LoraToa *toa, const LoraToaParams *params);
+
+/*Time on air in ms of a packet of the configuration of the table*/
+uint16_t LoraToa_Get(const LoraToa *toa, uint8_t pktLen);
+
+/*Useful bytes per second sending packets of pktLen bytes back to back (0: not supported)*/
+uint32_t LoraToa_Throughput(const LoraToaParams *params, uint8_t pktLen, uint8_t payload);
+
+/*Useful bytes that fit in a pass of passMs ms, with gapMs ms between packets (0: not supported)*/
+uint32_t LoraToa_Pass_Capacity(const LoraToaParams *params, uint8_t pktLen, uint8_t payload,
+							   uint32_t passMs, uint32_t gapMs);
+
+/*Demodulation SNR limit (dB x 10) of a spreading factor*/
+int16_t LoraToa_Snr_Limit(uint8_t SpreadingFactor);
+
+/*
+ * Spreading factor that delivers the most bytes in the pass with the expected SNR
+ * (dB x 10) and margin (dB x 10). params->SpreadingFactor and LowDatarateOptimize
+ * are set to the choice, returns 0 if no spreading factor closes the link.
+ */
+uint8_t LoraToa_Best_SF(LoraToaParams *params, uint8_t pktLen, uint8_t payload, uint32_t passMs,
+						uint32_t gapMs, int16_t snr, int16_t margin);
+
+#endif /* INC_LORA_TOA_H_ */
@@ -37,6 +37,15 @@ extern "C" {
 #include "configuration.h"
 #include "sensorReadings.h"
 #include "definitions.h"
+#include "flash_log.h"
+#include "flash_cache.h"
+#include "hk_log.h"
+#include "hk_stats.h"
+#include "flash_scrub.h"
+#include "radio_irq.h"
+#include "link_adapt.h"
+#include "scheduler.h"
+#include "trace.h"
 /* USER CODE END Includes */
 
 /* Exported types ------------------------------------------------------------*/
@@ -9,6 +9,7 @@
 #define INC_PAYLOAD_CAMERA_H_
 
 #include "stm32f4xx_hal.h"
+#include "camera_uart.h"
 #include <string.h> // Usado para la funcion memcmp
 #include <stdio.h>
 #include <stdbool.h> //PARA EL BOOL
@@ -17,12 +18,51 @@
 
 
 
+#define CAMERA_CHUNK_MAX		256		// Biggest READ_FBUF (it must fit in CAMERA_UART_RX_FIFO_SIZE with its headers)
+#define CAMERA_CHUNK_MIN		32		// Smallest READ_FBUF after shrinking on errors (multiple of 8)
+#define CAMERA_CHUNK_TIMEOUT	100		// ms to receive a whole chunk
+#define CAMERA_CHUNK_RETRIES	3		// Consecutive retries of the same chunk before giving up
+#define CAMERA_CHUNK_GROW		8		// Good chunks in a row before doubling the chunk size again
+#define CAMERA_READ_DELAY_MIN	0x01	// READ_FBUF delay field (x 0.01 ms)
+#define CAMERA_READ_DELAY_MAX	0x0A
+#define CAMERA_RESYNC_DELAY		10		// ms waited before discarding a bad answer
+#define CAMERA_RESPONSE_TIMEOUT	100		// ms to send a command or receive its response
+
+/*Progress of the photo taken by photoStep*/
+typedef enum {
+	CAMERA_PHOTO_IDLE,
+	CAMERA_PHOTO_CAPTURE,	// FBUF_CTRL stop sent (captureImage), waiting for its answer
+	CAMERA_PHOTO_LENGTH,	// GET_FBUF_LEN sent (getFrameLength)
+	CAMERA_PHOTO_CHUNK,		// READ_FBUF of a chunk sent (retrieveImage)
+	CAMERA_PHOTO_RESYNC,	// Letting a bad answer end before asking the chunk again
+	CAMERA_PHOTO_STOP,		// FBUF_CTRL resume sent (stopCapture)
+	CAMERA_PHOTO_DONE,		// The photo is in the flash
+	CAMERA_PHOTO_FAILED,
+} CameraPhotoState;
+
+/*Result of the last retrieveImage*/
+typedef struct {
+	uint32_t time_ms;		/*Download time of the whole frame*/
+	uint32_t bytes;			/*Bytes programmed in the flash*/
+	uint16_t chunks;		/*READ_FBUF answered correctly*/
+	uint16_t retries;		/*READ_FBUF repeated after a timeout or a bad header*/
+	uint16_t chunk_size;	/*Chunk size tuned for the baud rate*/
+	bool ok;
+} CameraDownloadStats;
+
 /**
   * Waits for data to be received and stores the information to the global variable dataBuffer
+  * The bytes are taken from the camera_uart ring buffer, returns how many were received
   */
 uint8_t readResponse(UART_HandleTypeDef *huart, uint8_t expLength, uint8_t attempts);
 
 
+/**
+  * Sends the 0x56 0x00 header, the command and hexData
+  * The frame is sent by interrupt through camera_uart
+  */
+void sendCommand(UART_HandleTypeDef *huart, uint8_t command, uint8_t *hexData, uint8_t dataArrayLength);
+
 /**
   * Transmitts information using the USART protocol
   * reads the response using readResponse
@@ -42,11 +82,36 @@ bool captureImage(UART_HandleTypeDef *huart);
   */
 void getFrameLength(UART_HandleTypeDef *huart);
 
+/**
+  * Asks the camera for toRead bytes of the frame buffer starting at address
+  * delay (x 0.01 ms) is the time the camera waits before sending the data
+  */
+void requestChunk(UART_HandleTypeDef *huart, uint32_t address, uint16_t toRead, uint16_t delay);
+
+/**
+  * Checks both headers of the answer to requestChunk (length bytes, data + 10)
+  */
+bool checkChunk(const uint8_t *answer, uint16_t length);
+
+/**
+  * Chunk size that can be received in half of CAMERA_CHUNK_TIMEOUT at the baud rate of huart
+  */
+uint16_t tuneChunkSize(UART_HandleTypeDef *huart);
+
+/**
+  * Download time, chunks and retries of the last retrieveImage
+  */
+const CameraDownloadStats *getDownloadStats(void);
+
 /**
   * #4
   * Saves the image to the flash memory of the STM32
+  * Each chunk is programmed in the flash while the next one is being received.
+  * Chunks with a bad header or a timeout are requested again with a smaller size
+  * and a longer delay, the size grows back after CAMERA_CHUNK_GROW good chunks
+  * Sleeps (WFI) until the whole frame is in the flash, photoStep does the same without waiting
   */
-void retrieveImage(UART_HandleTypeDef *huart);
+bool retrieveImage(UART_HandleTypeDef *huart);
 
 /**
   * #5
@@ -73,11 +138,25 @@ void setResolution(UART_HandleTypeDef *huart, uint8_t resolution);
   * getFrameLength
   * retrieveImage
   * stopCapture
+  * Sleeps (WFI) until the photo ends: out of the scheduler only, the camera task uses startPhoto
   */
 bool takePhoto(UART_HandleTypeDef *huart);
 
+/**
+  * Starts takePhoto without waiting, photoStep goes on with it
+  * Returns false if a photo is already being taken or the first command cannot be sent
+  */
+bool startPhoto(UART_HandleTypeDef *huart);
+
+/**
+  * Goes on with the photo as far as the bytes received allow, never waits for the camera
+  * To be called on the events of camera_uart and periodically, for the timeouts
+  */
+CameraPhotoState photoStep(void);
+
 
 int min(int bSize, int frameLength);
+int max(int x, int y);
 
 
 #endif /* INC_PAYLOAD_CAMERA_H_ */
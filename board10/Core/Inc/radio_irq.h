@@ -0,0 +1,68 @@
+/*!
+ * \file      radio_irq.h
+ *
+ * \brief     Event-driven dispatch of the SX126x interrupts. The DIO1 interrupt
+ * 			  (and the radio timers) only post an event in a lock-free single
+ * 			  producer / single consumer queue; RadioIrq_Dispatch reads the IRQ
+ * 			  status once and calls the RadioEvents_t handlers in priority order
+ * 			  (TX done, RX done, CAD done, timeouts, errors). Every post
+ * 			  releases the radio task of the scheduler (SCHEDULER_EVENT_RADIO),
+ * 			  so the events are not handled only once per loop like RadioIrqProcess.
+ *
+ * 			  The SX126x is reached through RadioIrqOps, so the dispatcher does not
+ * 			  depend on which radio driver is compiled.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_RADIO_IRQ_H_
+#define INC_RADIO_IRQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <radio.h>
+
+#define RADIO_IRQ_QUEUE_SIZE		16		/*Power of 2*/
+#define RADIO_IRQ_PAYLOAD_SIZE		255
+
+/*Events in priority order (bit 0 is dispatched first)*/
+#define RADIO_EVENT_TX_DONE			(1 << 0)
+#define RADIO_EVENT_RX_DONE			(1 << 1)
+#define RADIO_EVENT_CAD_DONE		(1 << 2)
+#define RADIO_EVENT_TX_TIMEOUT		(1 << 3)
+#define RADIO_EVENT_RX_TIMEOUT		(1 << 4)
+#define RADIO_EVENT_RX_ERROR		(1 << 5)
+#define RADIO_EVENT_DIO1			(1 << 15)	/*IRQ status not read yet*/
+
+/*Access to the SX126x (SX126xGetIrqStatus, SX126xClearIrqStatus...)*/
+typedef struct {
+	uint16_t (*GetIrqStatus)(void);
+	void (*ClearIrqStatus)(uint16_t irq);
+	void (*GetPayload)(uint8_t *buffer, uint8_t *size, int16_t *rssi, int8_t *snr);
+	bool (*IsTransmitting)(void);	/*To tell a TX timeout from an RX timeout*/
+} RadioIrqOps;
+
+typedef struct {
+	uint32_t posted;		/*Events posted*/
+	uint32_t dropped;		/*Events lost because the queue was full*/
+	uint32_t dispatched;	/*Handlers called*/
+	uint32_t max_latency;	/*Longest time from post to handler (ms)*/
+} RadioIrqStats;
+
+/*Sets the radio access and the handlers (the same RadioEvents_t given to Radio.Init)*/
+void RadioIrq_Init(const RadioIrqOps *ops, RadioEvents_t *events);
+
+/*DIO1 interrupt: to be given to SX126xInit as the DioIrqHandler*/
+void RadioIrq_On_Dio1(void);
+
+/*Posts an event (RADIO_EVENT_...), from an interrupt or a timer callback*/
+bool RadioIrq_Post(uint16_t event);
+
+/*Runs the handlers of every pending event, returns how many were called*/
+uint8_t RadioIrq_Dispatch(void);
+
+/*Counters of the queue and the dispatcher*/
+const RadioIrqStats *RadioIrq_Get_Stats(void);
+
+#endif /* INC_RADIO_IRQ_H_ */
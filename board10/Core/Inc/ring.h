@@ -0,0 +1,85 @@
+/*!
+ * \file      ring.h
+ *
+ * \brief     Lock-free single producer / single consumer ring buffer. The size
+ * 			  is a power of 2 and Head / Tail run freely (indexes are masked),
+ * 			  so the whole buffer is usable and full / empty need no extra slot.
+ * 			  Head is only written by the producer and Tail by the consumer, with
+ * 			  release / acquire ordering, so one side can be an interrupt and the
+ * 			  other one the main loop. A push that does not fit is dropped and
+ * 			  counted instead of overwriting data.
+ *
+ * 			  The span functions give the contiguous part of the buffer that can be
+ * 			  written or read directly (for instance by a DMA transfer).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_RING_H_
+#define INC_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct Ring_s
+{
+	uint8_t *Data;
+	uint16_t Mask;				/*Size - 1*/
+	volatile uint16_t Head;		/*Producer: next byte to write*/
+	volatile uint16_t Tail;		/*Consumer: next byte to read*/
+	volatile uint32_t Overflows;	/*Bytes dropped because the ring was full*/
+} Ring_t;
+
+/*!
+ * Initializes the ring, size is rounded down to a power of 2 (2..32768)
+ * \retval ok   False, and the ring is left as it was, if size is below 2
+ */
+bool RingInit( Ring_t *ring, uint8_t *buffer, uint16_t size );
+
+/*!
+ * Bytes stored / free space
+ */
+uint16_t RingCount( Ring_t *ring );
+uint16_t RingSpace( Ring_t *ring );
+
+/*!
+ * Producer: pushes one byte, false (and an overflow) if the ring is full
+ */
+bool RingPush( Ring_t *ring, uint8_t data );
+
+/*!
+ * Producer: pushes up to length bytes, the ones that do not fit are counted as overflows
+ * \retval pushed   Bytes stored
+ */
+uint16_t RingPushN( Ring_t *ring, const uint8_t *data, uint16_t length );
+
+/*!
+ * Consumer: pops one byte, false if the ring is empty
+ */
+bool RingPop( Ring_t *ring, uint8_t *data );
+
+/*!
+ * Consumer: pops up to length bytes
+ * \retval popped   Bytes copied to data
+ */
+uint16_t RingPopN( Ring_t *ring, uint8_t *data, uint16_t length );
+
+/*!
+ * Consumer: discards everything stored
+ */
+void RingFlush( Ring_t *ring );
+
+/*!
+ * Producer: contiguous free space starting at *span, RingCommitWrite publishes what was written
+ */
+uint16_t RingWriteSpan( Ring_t *ring, uint8_t **span );
+void RingCommitWrite( Ring_t *ring, uint16_t length );
+
+/*!
+ * Consumer: contiguous stored bytes starting at *span, RingCommitRead releases what was used
+ */
+uint16_t RingReadSpan( Ring_t *ring, const uint8_t **span );
+void RingCommitRead( Ring_t *ring, uint16_t length );
+
+#endif /* INC_RING_H_ */
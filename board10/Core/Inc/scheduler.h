@@ -0,0 +1,76 @@
+/*!
+ * \file      scheduler.h
+ *
+ * \brief     Cooperative run-to-completion scheduler. A task is a function that
+ * 			  returns when its work is done; it is released periodically, by the
+ * 			  events it subscribes to (posted from interrupts or from other tasks),
+ * 			  or both. Among the ready tasks the one with the highest priority
+ * 			  runs first, and the ready set is evaluated again after every task, so
+ * 			  a posted event waits at most for the task that is running.
+ *
+ * 			  Every task is monitored: release jitter, execution time, deadline
+ * 			  misses and releases lost because the previous one had not run yet.
+ * 			  Times are measured in microseconds from the SysTick.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHEDULER_MAX_TASKS			8
+#define SCHEDULER_MAX_EVENTS		16
+
+/*Events (one bit each, SCHEDULER_MAX_EVENTS at most)*/
+#define SCHEDULER_EVENT_RADIO		(1 << 0)	/*Radio interrupt queued (radio_irq)*/
+#define SCHEDULER_EVENT_STATE		(1 << 1)	/*Transition of the state machine*/
+#define SCHEDULER_EVENT_SENSORS		(1 << 2)	/*End of an I2C epoch or transfer timeout (sensor_bus)*/
+#define SCHEDULER_EVENT_CAMERA		(1 << 3)	/*Frame sent or answer received by the camera UART (camera_uart)*/
+
+typedef struct {
+	const char *name;
+	void (*run)(void);
+	uint32_t period;		/*ms between releases, 0 for a task only released by events*/
+	uint32_t deadline;		/*ms from the release to the end, 0 = the period (none for events)*/
+	uint16_t events;		/*Events that release the task*/
+	uint8_t priority;		/*0 is the highest*/
+} SchedulerTask;
+
+typedef struct {
+	uint32_t runs;
+	uint32_t overruns;			/*Releases lost because the task was still ready*/
+	uint32_t deadline_misses;
+	uint32_t max_jitter;		/*Longest time from the release to the start (us)*/
+	uint32_t max_exec;			/*Longest execution (us)*/
+	uint64_t total_exec;		/*Sum of the executions (us)*/
+} SchedulerTaskStats;
+
+/*Removes every task and restarts the statistics*/
+void Scheduler_Init(void);
+
+/*Adds a task (the structure is copied), false if the table is full*/
+bool Scheduler_Add(const SchedulerTask *task);
+
+/*Posts events, from an interrupt or from a task*/
+void Scheduler_Post(uint16_t events);
+
+/*Runs the ready task with the highest priority, false if no task was ready*/
+bool Scheduler_Run_Once(void);
+
+/*Runs the tasks forever, sleeps (WFI) while none is ready*/
+void Scheduler_Run(void);
+
+/*Statistics of the i-th task in priority order, NULL if it does not exist*/
+const SchedulerTaskStats *Scheduler_Get_Stats(uint8_t index, const char **name);
+
+/*CPU used by the tasks since Scheduler_Reset_Load (or Scheduler_Init), in per mille*/
+uint16_t Scheduler_Get_Load(void);
+
+/*Starts a new window for Scheduler_Get_Load*/
+void Scheduler_Reset_Load(void);
+
+#endif /* INC_SCHEDULER_H_ */
@@ -17,16 +17,40 @@
 #include "definitions.h"
 #include "configuration.h"
 
+/*Bits of SensorSnapshot.valid: the reading of the last epoch succeeded*/
+#define SENSOR_VALID_TEMP1			(1 << 0)	/*temp1..temp6 are bits 0..5*/
+#define SENSOR_VALID_TEMP_BATT		(1 << 6)
+#define SENSOR_VALID_VOLTAGE		(1 << 7)
+#define SENSOR_VALID_CURRENT		(1 << 8)
+#define SENSOR_VALID_BATT_LEVEL		(1 << 9)
+
+/*Last values of every sensor, a failed reading keeps the previous value*/
+typedef struct {
+	Temperatures temperatures;	/*degC*/
+	uint8_t voltage;		/*0.1 V*/
+	int8_t current;			/*0.1 A, positive while charging*/
+	uint8_t battery_level;
+	uint16_t valid;			/*SENSOR_VALID_...*/
+	uint32_t tick;			/*HAL_GetTick() at the end of the epoch*/
+	uint32_t epoch;			/*Epochs published*/
+} SensorSnapshot;
+
+/*Builds the register reads of an epoch and sets the I2C*/
+void sensorReadingsInit(I2C_HandleTypeDef *hi2c);
+
 /*Overwrites into the Temperatures Union the temperature of the 8 sensors*/
-void acquireTemp(I2C_HandleTypeDef *hi2c);
+void acquireTemp(void);
 
 /*Overwrites into the Voltages Union the readings of the 12 voltages*/
-void acquireVoltage(I2C_HandleTypeDef *hi2c);
+void acquireVoltage(void);
 
 /*Overwrites into the Currents Union the readings of the 7 currents*/
-void acquireCurrents(I2C_HandleTypeDef *hi2c);
+void acquireCurrents(void);
 
-/*Includes the functions above*/
+/*Starts an epoch or, once it has ended, includes the functions above (never waits for the I2C)*/
 void sensorReadings(I2C_HandleTypeDef *hi2c);
 
+/*Readings of the last epoch*/
+const SensorSnapshot *getSensorSnapshot(void);
+
 #endif /* INC_SENSORREADINGS_H_ */
@@ -0,0 +1,76 @@
+/*!
+ * \file      sensor_bus.h
+ *
+ * \brief     Non-blocking I2C acquisition. All the register reads of one sampling
+ * 			  epoch are given as a list of transfers and run one after the other
+ * 			  by interrupt (HAL_I2C_Mem_Read_IT), each completion or error starts
+ * 			  the next one. The status of every transfer is kept, so one missing
+ * 			  sensor only marks its own reading as failed: a NACK ends its transfer
+ * 			  at once and a stuck transfer is aborted after SENSOR_BUS_TIMEOUT by
+ * 			  resetting the peripheral, after clocking SCL by hand to release a
+ * 			  device that holds SDA low.
+ *
+ * 			  The done callback is called from the interrupt (or the timer of the
+ * 			  timeout) when the epoch ends or a transfer has to be aborted; the
+ * 			  owner then calls SensorBus_Process from the main loop.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_SENSOR_BUS_H_
+#define INC_SENSOR_BUS_H_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_BUS_TIMEOUT		5		/*ms per transfer, a register read takes < 1 ms at 100 kHz*/
+
+/*I2C1 pins (stm32f4xx_hal_msp.c), driven as GPIO for the bus recovery*/
+#define SENSOR_BUS_GPIO			GPIOB
+#define SENSOR_BUS_SCL_PIN		GPIO_PIN_6
+#define SENSOR_BUS_SDA_PIN		GPIO_PIN_7
+#define SENSOR_BUS_CLOCKS		9		/*Enough for a device to finish its byte and its ACK*/
+#define SENSOR_BUS_HALF_US		5		/*Half a period of the recovery clock, 100 kHz*/
+
+typedef enum {
+	SENSOR_BUS_PENDING,
+	SENSOR_BUS_OK,
+	SENSOR_BUS_ERROR,		/*NACK, arbitration lost or bus error*/
+	SENSOR_BUS_TIMEOUT_ERROR,
+	SENSOR_BUS_ABSENT,		/*No address defined for the device*/
+} SensorBusStatus;
+
+typedef struct {
+	uint8_t device;			/*Address in the HAL format (7 bits << 1), 0 if not fitted*/
+	uint8_t reg;			/*First register*/
+	uint8_t length;
+	uint8_t *data;
+	volatile uint8_t status;	/*SensorBusStatus*/
+} SensorBusTransfer;
+
+typedef struct {
+	uint32_t epochs;
+	uint32_t errors;			/*Transfers ended with SENSOR_BUS_ERROR*/
+	uint32_t timeouts;			/*Transfers aborted*/
+	uint32_t recoveries;		/*Aborts that found SDA held low*/
+	uint32_t last_duration;		/*ms from SensorBus_Start to the end of the last epoch*/
+	uint32_t max_duration;
+} SensorBusStats;
+
+/*Sets the I2C and the callback of the end of an epoch (can be NULL)*/
+void SensorBus_Init(I2C_HandleTypeDef *hi2c, void (*done)(void));
+
+/*Starts an epoch with count transfers, false if the previous one has not ended*/
+bool SensorBus_Start(SensorBusTransfer *transfers, uint8_t count);
+
+/*Aborts the transfer that timed out, returns true once the epoch has ended*/
+bool SensorBus_Process(void);
+
+/*True while an epoch is running*/
+bool SensorBus_Busy(void);
+
+const SensorBusStats *SensorBus_Get_Stats(void);
+
+#endif /* INC_SENSOR_BUS_H_ */
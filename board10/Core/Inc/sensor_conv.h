@@ -0,0 +1,65 @@
+/*!
+ * \file      sensor_conv.h
+ *
+ * \brief     Fixed-point conversion of the housekeeping sensors. Every channel
+ * 			  has a calibration in Q24 (value = count * gain + offset, rounded to
+ * 			  the nearest unit and saturated to the storage range), so the
+ * 			  conversion only needs integer arithmetic: no libm, no soft-float, and
+ * 			  the same result on any compiler. The counts are the signed readings
+ * 			  of the sensors, already aligned (see fuel_gauge.h and
+ * 			  SensorConv_Tmp102_Count).
+ *
+ * 			  The default calibrations are the datasheet scales; a channel can be
+ * 			  corrected at run time with SensorConv_Set_Calibration.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_SENSOR_CONV_H_
+#define INC_SENSOR_CONV_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_CONV_Q				24
+#define SENSOR_CONV_ONE				(1L << SENSOR_CONV_Q)
+
+typedef enum {
+	SENSOR_CONV_TEMP1,			/*TMP102 1..6: 0.0625 degC/count -> degC*/
+	SENSOR_CONV_TEMP2,
+	SENSOR_CONV_TEMP3,
+	SENSOR_CONV_TEMP4,
+	SENSOR_CONV_TEMP5,
+	SENSOR_CONV_TEMP6,
+	SENSOR_CONV_TEMP_BATT,		/*Fuel gauge: 0.125 degC/count -> degC*/
+	SENSOR_CONV_VOLTAGE,		/*Fuel gauge: 4.88 mV/count -> 0.1 V*/
+	SENSOR_CONV_CURRENT,		/*Fuel gauge: 1.5625 uV / 15 mOhm per count -> 0.1 A*/
+	SENSOR_CONV_CHANNELS
+} SensorConvChannel;
+
+typedef struct {
+	int32_t gain;			/*Units per count, Q24*/
+	int32_t offset;			/*Units, Q24*/
+	int16_t min;			/*Storage range, the result is saturated*/
+	int16_t max;
+} SensorCalibration;
+
+/*Temperature count of a TMP102 (12 bits, left aligned in the 2 bytes of the register)*/
+int16_t SensorConv_Tmp102_Count(const uint8_t reg[2]);
+
+/*Converts one count of a channel*/
+int16_t SensorConv_Convert(SensorConvChannel channel, int16_t count);
+
+/*Converts the counts of the channels first .. first + n - 1*/
+void SensorConv_Convert_Batch(SensorConvChannel first, const int16_t *counts, int16_t *values, uint8_t n);
+
+/*Replaces the calibration of a channel, false if the channel or the range is not valid*/
+bool SensorConv_Set_Calibration(SensorConvChannel channel, const SensorCalibration *calibration);
+
+/*Restores the datasheet calibrations*/
+void SensorConv_Reset_Calibration(void);
+
+const SensorCalibration *SensorConv_Get_Calibration(SensorConvChannel channel);
+
+#endif /* INC_SENSOR_CONV_H_ */
@@ -10,9 +10,20 @@
 
 #include "definitions.h"
 #include "flash.h"
+#include "flash_cache.h"
+#include "link_adapt.h"
+#include "sensorReadings.h"
+#include "hk_log.h"
+#include "hk_stats.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "trace.h"
 
 #define CONFIG_SIZE		13
 
 void process_telecommand(uint8_t header, uint8_t info);
 
+/*Writes the telemetry frame of the current values, returns TELEMETRY_FRAME_SIZE*/
+uint8_t buildTelemetry(uint8_t *frame);
+
 #endif /* INC_TELECOMMANDS_H_ */
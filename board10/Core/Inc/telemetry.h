@@ -0,0 +1,83 @@
+/*!
+ * \file      telemetry.h
+ *
+ * \brief     Bit-packed telemetry frame. The fields are listed once, in
+ * 			  TELEMETRY_FIELDS, with their width in bits and their minimum value;
+ * 			  the enum of the fields, the schema table and the frame size are
+ * 			  generated from the list at compile time. A field is sent as
+ * 			  value - min in exactly its width (saturated), so a 0..100 %
+ * 			  takes 7 bits and a flag 1 bit instead of a byte each.
+ *
+ * 			  Frame: TELEMETRY_FRAME_ID(1), then the fields in the order of the
+ * 			  list as one stream of bits, little-endian: the low bit of a field
+ * 			  goes first and the stream fills every byte from its bit 0. The last
+ * 			  byte is padded with 0.
+ *
+ * 			  telemetry.c only needs the C library, so the ground station decodes
+ * 			  the frames by compiling it with this header (Telemetry_Unpack).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TELEMETRY_FRAME_ID		0xB2		/*Beacon, schema 2: change it with the list of fields*/
+#define TELEMETRY_MAX_SIZE		38			/*BUFFER_SIZE of comms.h*/
+
+/*FIELD(name, bits, min), the range sent is min .. min + 2^bits - 1.
+  TIME is the time of the log, which goes on from the first boot across the resets: 26 bits
+  would wrap after 2.1 years, inside the mission, and 27 bits last 4.2 years*/
+#define TELEMETRY_FIELDS(FIELD) \
+	FIELD(TIME,					27,	0)		/*s, time of the log (hk_log.h)*/ \
+	FIELD(STATE,				3,	0)		/*MachineState*/ \
+	FIELD(DEPLOYMENT,			1,	0) \
+	FIELD(DEPLOYMENT_RF,		1,	0) \
+	FIELD(DETUMBLE,				1,	0) \
+	FIELD(SENSORS_VALID,		10,	0)		/*SENSOR_VALID_... of the last epoch*/ \
+	FIELD(BATT_LEVEL,			7,	0)		/*%*/ \
+	FIELD(VOLTAGE,				7,	0)		/*0.1 V*/ \
+	FIELD(CURRENT,				7,	-64)	/*0.1 A*/ \
+	FIELD(TEMP_BATT,			7,	-40)	/*degC, TEMP_BATT..TEMP6*/ \
+	FIELD(TEMP1,				7,	-40) \
+	FIELD(TEMP2,				7,	-40) \
+	FIELD(TEMP3,				7,	-40) \
+	FIELD(TEMP4,				7,	-40) \
+	FIELD(TEMP5,				7,	-40) \
+	FIELD(TEMP6,				7,	-40) \
+	FIELD(ORBIT_VOLTAGE_MIN,	7,	0)		/*Last orbit (hk_stats.h)*/ \
+	FIELD(ORBIT_VOLTAGE_MAX,	7,	0) \
+	FIELD(ORBIT_CURRENT_MIN,	7,	-64) \
+	FIELD(ORBIT_CURRENT_MAX,	7,	-64) \
+	FIELD(ORBIT_TEMP_BATT_MIN,	7,	-40) \
+	FIELD(ORBIT_TEMP_BATT_MAX,	7,	-40) \
+	FIELD(SF,					3,	7) \
+	FIELD(CR,					2,	1)		/*LORA_CR_4_5..LORA_CR_4_8*/ \
+	FIELD(SNR,					9,	-256)	/*dB x 10*/ \
+	FIELD(RSSI,					7,	-150)	/*dBm*/ \
+	FIELD(LOAD,					7,	0)		/*CPU, %*/
+
+#define TELEMETRY_FIELD_ENUM(name, bits, min)	TELEMETRY_##name,
+#define TELEMETRY_FIELD_BITS(name, bits, min)	+ (bits)
+#define TELEMETRY_FIELD_BYTES(name, bits, min)	+ ((bits) + 7) / 8
+
+typedef enum {
+	TELEMETRY_FIELDS(TELEMETRY_FIELD_ENUM)
+	TELEMETRY_FIELD_COUNT
+} TelemetryField;
+
+#define TELEMETRY_BITS			(0 TELEMETRY_FIELDS(TELEMETRY_FIELD_BITS))
+#define TELEMETRY_FRAME_SIZE	(1 + (TELEMETRY_BITS + 7) / 8)
+#define TELEMETRY_ALIGNED_SIZE	(1 TELEMETRY_FIELDS(TELEMETRY_FIELD_BYTES))	/*Same frame with every field in whole bytes*/
+
+/*Packs the TELEMETRY_FIELD_COUNT values into frame, returns TELEMETRY_FRAME_SIZE*/
+uint8_t Telemetry_Pack(const int32_t *values, uint8_t *frame);
+
+/*Unpacks a frame into TELEMETRY_FIELD_COUNT values, false if it is not a frame of this schema*/
+bool Telemetry_Unpack(const uint8_t *frame, uint8_t length, int32_t *values);
+
+#endif /* INC_TELEMETRY_H_ */
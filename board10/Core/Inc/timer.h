@@ -18,17 +18,19 @@ Maintainer: Miguel Luis and Gregory Cristian
 #include <stdio.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /*!
  * \brief Timer object description
  */
 typedef struct TimerEvent_s
 {
-    uint32_t Timestamp;         //! Current timer value
+    uint32_t Timestamp;         //! Tick at which the timer expires
     uint32_t ReloadValue;       //! Timer delay value
     bool IsRunning;             //! Is the timer currently running
     void ( *Callback )( void ); //! Timer IRQ callback function
-    struct TimerEvent_s *Next;  //! Pointer to the next Timer object.
+    struct TimerEvent_s *Next;  //! Pointer to the next Timer object of the wheel slot.
+    struct TimerEvent_s **Prev; //! Pointer to the link that points to this object (O(1) removal)
 }TimerEvent_t;
 
 /*!
@@ -38,6 +40,8 @@ typedef struct TimerEvent_s
 typedef uint32_t TimerTime_t;
 #endif
 
+#define TIMER_NO_EVENT      0xFFFFFFFF
+
 //REVISAR AQUESTA FUNCIÓ!!! (TRETA DE LA MANGA)
 enum BoardPowerSources
 {
@@ -57,12 +61,13 @@ enum BoardPowerSources
 void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) );
 
 /*!
- * Timer IRQ event handler
+ * Timer IRQ event handler, called on every SysTick (1 ms). It also catches up
+ * the ticks missed while the tick was suspended
  */
 void TimerIrqHandler( void );
 
 /*!
- * \brief Starts and adds the timer object to the list of timer events
+ * \brief Starts and adds the timer object to the timing wheel
  *
  * \param [IN] obj Structure containing the timer object parameters
  */
@@ -113,6 +118,13 @@ TimerTime_t TimerGetElapsedTime( TimerTime_t savedTime );
  */
 TimerTime_t TimerGetFutureTime( TimerTime_t eventInFuture );
 
+/*!
+ * \brief Time until the next timer expires (tickless idle)
+ *
+ * \retval time             ms to the next expiry, TIMER_NO_EVENT if no timer runs
+ */
+TimerTime_t TimerGetTimeToNextEvent( void );
+
 /*!
  * \brief Manages the entry into ARM cortex deep-sleep mode
  */
@@ -0,0 +1,87 @@
+/*!
+ * \file      trace.h
+ *
+ * \brief     Enter / exit probes with the cycle counter of the DWT, stored in a
+ * 			  RAM ring (the newest TRACE_SIZE records are kept). The probes are
+ * 			  removed at compile time unless the build defines TRACE_ENABLED 1
+ * 			  (-DTRACE_ENABLED=1, as the host build does); enabled, a probe costs
+ * 			  a critical section and two stores.
+ *
+ * 			  Trace_Peek copies the oldest records to a buffer (a downlink packet,
+ * 			  telecommand SEND_TRACE, or a UART frame) and Trace_Commit removes
+ * 			  them once the piece is delivered, so the trace can be read in
+ * 			  several pieces and a lost packet is sent again. Every piece can be decoded alone, little-endian
+ * 			  (Host/Src/trace_decode.c turns them into a Chrome trace):
+ *
+ * 			    'T' 'R' version(1) count(2) lost(2) clock_hz(4)
+ * 			    count x { probe(2) cycles(varint) }
+ *
+ * 			  probe has TRACE_EXIT_FLAG set on the exits. cycles is the distance
+ * 			  to the previous record of the piece (the counter itself for the
+ * 			  first one) as a LEB128 varint: 7 bits per byte, low bits first, bit
+ * 			  7 set if more bytes follow. lost counts the records overwritten
+ * 			  before they were dumped. Each enter / exit pair of a probe is one
+ * 			  frame of a flame graph or a complete event of a Chrome trace.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED		0
+#endif
+
+#define TRACE_SIZE			256		/*Records, power of 2*/
+#define TRACE_VERSION		1
+#define TRACE_HEADER_SIZE	11
+#define TRACE_EXIT_FLAG		0x8000
+
+/*Timestamp of the probes, the DWT cycle counter unless a build defines another clock*/
+#ifndef TRACE_CLOCK
+#define TRACE_CLOCK()		(DWT->CYCCNT)
+#endif
+
+typedef enum {
+	TRACE_SYSTEM_STATE = 1,
+	TRACE_SENSOR_READINGS,
+	TRACE_I2C_EPOCH,			/*From SensorBus_Start to the end of its last transfer*/
+	TRACE_FLASH_WRITE,			/*Write_Flash_Direct*/
+	TRACE_FLASH_ERASE,			/*Flash_Erase*/
+	TRACE_FLASH_CACHE_FLUSH,
+	TRACE_CAMERA_STEP,			/*A step of the photo download (payload_camera.c)*/
+	TRACE_TASK = 0x40,			/*+ index of the scheduler task*/
+} TraceProbe;
+
+#if TRACE_ENABLED
+#define TRACE_ENTER(probe)		Trace_Record((uint16_t)(probe))
+#define TRACE_EXIT(probe)		Trace_Record((uint16_t)(probe) | TRACE_EXIT_FLAG)
+#else
+#define TRACE_ENTER(probe)		((void)0)
+#define TRACE_EXIT(probe)		((void)0)
+#endif
+
+/*Starts the cycle counter, empties the ring and enables the probes*/
+void Trace_Init(void);
+
+/*Enables or pauses the recording (the probes stay compiled)*/
+void Trace_Enable(bool enable);
+
+/*Stores a record, from the main loop or an interrupt*/
+void Trace_Record(uint16_t probe);
+
+/*Encodes the oldest records in buffer without removing them, returns the bytes written (0 if nothing fits)*/
+uint16_t Trace_Peek(uint8_t *buffer, uint16_t size);
+
+/*Removes the records of the last Trace_Peek, once its piece has been delivered*/
+void Trace_Commit(void);
+
+/*Trace_Peek then Trace_Commit: moves the oldest records to buffer*/
+uint16_t Trace_Dump(uint8_t *buffer, uint16_t size);
+
+#endif /* INC_TRACE_H_ */
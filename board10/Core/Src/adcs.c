@@ -26,7 +26,7 @@
  *                                                                                    *
  **************************************************************************************/
 void detumble(I2C_HandleTypeDef *hi2c) {
-
+	(void)hi2c;
 }
 
 /**************************************************************************************
@@ -68,5 +68,5 @@ void readPhotodiodes(ADC_HandleTypeDef *hadc) { // I think the four ADC should b
  *                                                                                    *
  **************************************************************************************/
 void singlePhotodiode(ADC_HandleTypeDef *hadc) {
-
+	(void)hadc;
 }
@@ -0,0 +1,279 @@
+/*!
+ * \file      arq.c
+ *
+ * \brief     Selective-repeat ARQ for the downlink (see arq.h).
+ *
+ * 			  The window is kept as two bitmaps relative to Base (acknowledged and
+ * 			  waiting for retransmission), so a SACK is merged with a shift and an
+ * 			  OR, and the next packet to resend is found with count-trailing-zeros.
+ * 			  The data is read straight from the memory-mapped flash when a packet
+ * 			  is built, so nothing has to be buffered in RAM for retransmissions.
+ *
+ * 			  Base is saved in COUNT_WINDOW_ADDR / COUNT_PACKET_ADDR every time the
+ * 			  window slides, so a reset resumes the transfer from the first packet
+ * 			  that was not acknowledged.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "arq.h"
+#include "flash.h"
+#include "string.h"
+
+_Static_assert(ARQ_WINDOW_SIZE <= 64, "The window has to fit in a SACK bitmap");
+_Static_assert(ARQ_PAYLOAD_SIZE == FEC_BLOCK_SIZE, "The FEC protects the whole payload");
+
+/*Mask with the n lowest bits set*/
+static uint64_t Arq_Mask(uint16_t n)
+{
+	return n >= 64 ? ~0ULL : (1ULL << n) - 1;
+}
+
+/*Packets sent and not acknowledged, relative to Base*/
+static uint64_t Arq_In_Flight(const ArqTx *arq)
+{
+	return Arq_Mask(arq->Next - arq->Base) & ~arq->Acked;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Arq_Save                                                                *
+ * --------------------                                                               *
+ * Saves Base as window number and packet inside the window, in the variables that   *
+ * the old stop-and-wait scheme used, and the retransmission counter                  *
+ *                                                                                    *
+ *  arq: transfer                                                                     *
+ *                                                                                    *
+ *  returns: nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void Arq_Save(const ArqTx *arq)
+{
+	uint8_t window = arq->Base / ARQ_WINDOW_SIZE;
+	uint8_t packet = arq->Base % ARQ_WINDOW_SIZE;
+	uint8_t rtx = arq->Retransmitted > 0xFF ? 0xFF : arq->Retransmitted;
+
+	Write_Flash(COUNT_WINDOW_ADDR, &window, 1);
+	Write_Flash(COUNT_PACKET_ADDR, &packet, 1);
+	Write_Flash(COUNT_RTX_ADDR, &rtx, 1);
+}
+
+static void Arq_Slide(ArqTx *arq, uint16_t n)
+{
+	if (n == 0) return;
+	if (n >= 64)
+	{
+		arq->Acked = 0;
+		arq->Retransmit = 0;
+	}
+	else
+	{
+		arq->Acked >>= n;
+		arq->Retransmit >>= n;
+	}
+	arq->Base += n;
+	Arq_Save(arq);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Arq_Build                                                               *
+ * --------------------                                                               *
+ * Writes the sequence number and the data of a packet, the last packet is padded     *
+ * with 0xFF                                                                          *
+ *                                                                                    *
+ *  arq: transfer                                                                     *
+ *  seq: sequence number of the packet                                                *
+ *  Packet: buffer of ARQ_PACKET_SIZE bytes                                           *
+ *                                                                                    *
+ *  returns: nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void Arq_Build(const ArqTx *arq, uint16_t seq, uint8_t *Packet)
+{
+	uint32_t offset = (uint32_t)seq * ARQ_PAYLOAD_SIZE;
+	uint32_t length = arq->Length - offset;
+
+	if (length > ARQ_PAYLOAD_SIZE) length = ARQ_PAYLOAD_SIZE;
+
+	Packet[0] = seq >> 8;
+	Packet[1] = seq & 0xFF;
+	memcpy(&Packet[ARQ_HEADER_SIZE], (const uint8_t *)(arq->DataAddress + offset), length);
+	memset(&Packet[ARQ_HEADER_SIZE + length], 0xFF, ARQ_PAYLOAD_SIZE - length);
+}
+
+void Arq_Init(ArqTx *arq, uint32_t DataAddress, uint32_t Length)
+{
+	uint8_t window, packet;
+
+	memset(arq, 0, sizeof(*arq));
+	arq->DataAddress = DataAddress;
+	arq->Length = Length;
+	arq->Total = (Length + ARQ_PAYLOAD_SIZE - 1) / ARQ_PAYLOAD_SIZE;
+
+	Read_Flash(COUNT_WINDOW_ADDR, &window, 1);
+	Read_Flash(COUNT_PACKET_ADDR, &packet, 1);
+	arq->Base = window * ARQ_WINDOW_SIZE + packet;
+
+	/*Erased flash (0xFF) or a window of another transfer*/
+	if (packet >= ARQ_WINDOW_SIZE || arq->Base > arq->Total)
+	{
+		Arq_Reset(arq);
+	}
+	arq->Next = arq->Base;
+}
+
+void Arq_Reset(ArqTx *arq)
+{
+	arq->Base = 0;
+	arq->Next = 0;
+	arq->Acked = 0;
+	arq->Retransmit = 0;
+	arq->Retransmitted = 0;
+	arq->LastWasRetransmit = false;
+	arq->ParityPending = 0;
+	Fec_Restart(&arq->Fec);
+	Arq_Save(arq);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Arq_Set_Fec                                                             *
+ * --------------------                                                               *
+ * Sets the redundancy of the groups. If the transfer resumes in the middle of a      *
+ * group, the packets of the group already sent are added again from the flash so     *
+ * the parity covers the whole group                                                  *
+ *                                                                                    *
+ *  arq: transfer                                                                     *
+ *  Parity: parity packets every ARQ_WINDOW_SIZE data packets (0: no FEC)             *
+ *                                                                                    *
+ *  returns: nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Arq_Set_Fec(ArqTx *arq, uint8_t Parity)
+{
+	uint8_t packet[ARQ_PACKET_SIZE];
+	uint16_t seq;
+
+	Fec_Init(&arq->Fec, ARQ_WINDOW_SIZE, Parity);
+	arq->ParityPending = 0;
+	if (Parity == 0) return;
+
+	for (seq = arq->Next - arq->Next % ARQ_WINDOW_SIZE; seq < arq->Next; seq++)
+	{
+		Arq_Build(arq, seq, packet);
+		Fec_Add(&arq->Fec, &packet[ARQ_HEADER_SIZE]);
+	}
+}
+
+bool Arq_Next(ArqTx *arq, uint8_t *Packet)
+{
+	bool canSendNew = arq->Next < arq->Total && arq->Next - arq->Base < ARQ_WINDOW_SIZE;
+	uint16_t seq;
+	uint8_t j;
+
+	/*The parity goes right after its group, while the window waits for the SACK*/
+	if (arq->ParityPending > 0)
+	{
+		j = arq->Fec.M - arq->ParityPending;
+		seq = FEC_PARITY_SEQ(arq->ParityGroup, j);
+		Packet[0] = seq >> 8;
+		Packet[1] = seq & 0xFF;
+		memcpy(&Packet[ARQ_HEADER_SIZE], Fec_Parity(&arq->Fec, j), ARQ_PAYLOAD_SIZE);
+		if (--arq->ParityPending == 0) Fec_Restart(&arq->Fec);
+		arq->ParitySent++;
+		arq->Sent++;
+		return true;
+	}
+
+	/*Retransmissions and new packets alternate, so the window keeps moving*/
+	if (arq->Retransmit != 0 && (!canSendNew || !arq->LastWasRetransmit))
+	{
+		seq = arq->Base + __builtin_ctzll(arq->Retransmit);
+		arq->Retransmit &= arq->Retransmit - 1;	/*Clears the lowest bit*/
+		arq->Retransmitted++;
+		arq->LastWasRetransmit = true;
+	}
+	else if (canSendNew)
+	{
+		seq = arq->Next++;
+		arq->LastWasRetransmit = false;
+		Arq_Build(arq, seq, Packet);
+		arq->Sent++;
+		/*The last group of the transfer can be shorter*/
+		if (Fec_Add(&arq->Fec, &Packet[ARQ_HEADER_SIZE]) || (arq->Fec.M > 0 && arq->Next == arq->Total))
+		{
+			arq->ParityPending = arq->Fec.M;
+			arq->ParityGroup = seq / ARQ_WINDOW_SIZE;
+		}
+		return true;
+	}
+	else return false;
+
+	Arq_Build(arq, seq, Packet);
+	arq->Sent++;
+	return true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Arq_Sack                                                                *
+ * --------------------                                                               *
+ * Everything before the base of the SACK has been received. The bitmap is aligned    *
+ * with Base and merged; the packets in flight below the highest one received are     *
+ * lost and are queued for retransmission. Then the window slides over the packets    *
+ * acknowledged in a row.                                                             *
+ *                                                                                    *
+ *  arq: transfer                                                                     *
+ *  Sack: ARQ_SACK_SIZE bytes received from the ground station                        *
+ *                                                                                    *
+ *  returns: nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Arq_Sack(ArqTx *arq, const uint8_t *Sack)
+{
+	uint16_t base = (Sack[0] << 8) | Sack[1];
+	uint64_t bitmap = 0;
+	uint64_t lost;
+	uint16_t n;
+	int i;
+
+	for (i = 0; i < 8; i++) bitmap = (bitmap << 8) | Sack[2 + i];
+	arq->Sacks++;
+
+	if (base > arq->Next) base = arq->Next;	/*Corrupted SACK, never go past what was sent*/
+	if (base > arq->Base)
+	{
+		Arq_Slide(arq, base - arq->Base);
+	}
+	else
+	{
+		/*Old SACK, drop the bits of the packets already out of the window*/
+		n = arq->Base - base;
+		bitmap = n >= 64 ? 0 : bitmap >> n;
+	}
+
+	bitmap &= Arq_Mask(arq->Next - arq->Base);
+	arq->Acked |= bitmap;
+	arq->Retransmit &= ~arq->Acked;
+
+	if (bitmap != 0)
+	{
+		lost = Arq_In_Flight(arq) & Arq_Mask(63 - __builtin_clzll(bitmap));
+		arq->Retransmit |= lost;
+	}
+
+	n = ~arq->Acked == 0 ? 64 : __builtin_ctzll(~arq->Acked);
+	Arq_Slide(arq, n);
+}
+
+void Arq_Timeout(ArqTx *arq)
+{
+	arq->Retransmit |= Arq_In_Flight(arq);
+}
+
+bool Arq_Done(const ArqTx *arq)
+{
+	return arq->Base >= arq->Total;
+}
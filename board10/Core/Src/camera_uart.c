@@ -0,0 +1,182 @@
+/*
+ * camera_uart.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Asynchronous UART transport of the VC0706 camera (see camera_uart.h)
+ */
+
+#include <camera_uart.h>
+#include <ring.h>
+#include <string.h>
+
+static UART_HandleTypeDef *cameraHuart = NULL;
+static CameraUartCallback cameraCallback = NULL;
+
+static uint8_t txFrame[CAMERA_UART_MAX_FRAME];
+static volatile bool txBusy = false;
+
+static uint8_t rxDiscard[CAMERA_UART_RX_BLOCK_SIZE];	// Receives when the ring is full
+static uint8_t rxStorage[CAMERA_UART_RX_FIFO_SIZE];
+static Ring_t rxRing;
+static bool rxIntoRing;
+static uint16_t rxRequested;
+static volatile bool rxArmed = false;	// A reception is running (the last start returned HAL_OK)
+
+static void notify(CameraUartEvent event)
+{
+	if (cameraCallback != NULL) cameraCallback(event);
+}
+
+static void startReception(void)
+{ // The UART writes straight into the free span of the ring, no copy is needed
+	uint8_t *span;
+	uint16_t length = RingWriteSpan(&rxRing, &span);
+
+	if (length > CAMERA_UART_RX_BLOCK_SIZE) length = CAMERA_UART_RX_BLOCK_SIZE;
+	rxIntoRing = length > 0;
+	if (!rxIntoRing)
+	{
+		span = rxDiscard;
+		length = sizeof(rxDiscard);
+	}
+	// Completes when the block is full or when the line goes idle (end of a response)
+	rxRequested = length;
+	rxArmed = HAL_UARTEx_ReceiveToIdle_IT(cameraHuart, span, length) == HAL_OK;
+}
+
+static void resumeIntoRing(void)
+{ // After an overflow the reception goes on into rxDiscard until the next event, come back as soon as there is room
+	uint32_t primask;
+
+	if (rxIntoRing || RingSpace(&rxRing) == 0) return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!rxIntoRing && rxArmed)
+	{
+		HAL_UART_AbortReceive(cameraHuart);
+		rxRing.Overflows += cameraHuart->RxXferSize - cameraHuart->RxXferCount;
+		startReception();
+	}
+	__set_PRIMASK(primask);
+}
+
+void CameraUart_Init(UART_HandleTypeDef *huart, CameraUartCallback callback)
+{
+	cameraHuart = huart;
+	cameraCallback = callback;
+	txBusy = false;
+	RingInit(&rxRing, rxStorage, sizeof(rxStorage));
+	startReception();
+}
+
+bool CameraUart_Send(uint8_t command, const uint8_t *hexData, uint8_t dataArrayLength)
+{
+	if (txBusy || dataArrayLength + 3 > CAMERA_UART_MAX_FRAME) return false;
+
+	txFrame[0] = 0x56;
+	txFrame[1] = 0x00;
+	txFrame[2] = command;
+	memcpy(&txFrame[3], hexData, dataArrayLength);
+
+	// The answer is lost if nothing is receiving when it arrives
+	if (!rxArmed)
+	{
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		startReception();
+		__set_PRIMASK(primask);
+	}
+
+	txBusy = true;
+	if (HAL_UART_Transmit_IT(cameraHuart, txFrame, dataArrayLength + 3) != HAL_OK)
+	{
+		txBusy = false;
+		return false;
+	}
+	return true;
+}
+
+bool CameraUart_TxBusy(void)
+{
+	return txBusy;
+}
+
+uint16_t CameraUart_Read(uint8_t *buffer, uint16_t length)
+{
+	uint16_t n = RingPopN(&rxRing, buffer, length);
+
+	if (n > 0) resumeIntoRing();
+	return n;
+}
+
+uint16_t CameraUart_ReadBlocking(uint8_t *buffer, uint16_t length, uint32_t timeout)
+{
+	uint32_t start = HAL_GetTick();
+	uint16_t n = 0;
+
+	while (n < length)
+	{
+		n += CameraUart_Read(&buffer[n], length - n);
+		if (n == length || HAL_GetTick() - start > timeout) break;
+		__WFI(); // Every byte and the SysTick wake it up
+	}
+	return n;
+}
+
+void CameraUart_Flush(void)
+{
+	RingFlush(&rxRing);
+	resumeIntoRing();
+}
+
+uint32_t CameraUart_Overflows(void)
+{
+	return rxRing.Overflows;
+}
+
+/*
+ * HAL callbacks (interrupt context)
+ */
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if (huart != cameraHuart) return;
+	txBusy = false;
+	notify(CAMERA_UART_TX_DONE);
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	bool overflow = !rxIntoRing;
+	bool idle = Size < rxRequested;
+
+	if (huart != cameraHuart) return;
+
+	if (rxIntoRing) RingCommitWrite(&rxRing, Size);
+	else rxRing.Overflows += Size;
+	// Restart before notifying, the next byte may already be arriving
+	startReception();
+
+	if (overflow) notify(CAMERA_UART_RX_OVERFLOW);
+	if (idle) notify(CAMERA_UART_RX_IDLE);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	uint16_t received;
+
+	if (huart != cameraHuart || huart->ErrorCode == HAL_UART_ERROR_NONE) return;
+	// Parity, noise and framing errors are only flagged, the reception goes on
+	if (huart->RxState != HAL_UART_STATE_READY) return;
+
+	// An overrun ended it: keep the bytes received before the error, then start again
+	if (rxArmed)
+	{
+		received = rxRequested - huart->RxXferCount;
+		if (rxIntoRing) RingCommitWrite(&rxRing, received);
+		else rxRing.Overflows += received;
+	}
+	startReception();
+}
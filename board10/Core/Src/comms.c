@@ -40,7 +40,7 @@
 //
 ////#include "sx126x-hal.h"
 //
-//static RadioEvents_t RadioEvents;	//SHOULD THIS BE IN MAIN??? IS TO HANDLE IRQ???
+//RadioEvents_t RadioEvents;	//Also given to RadioIrq_Init by main.c
 //
 //uint32_t air_time;
 //uint8_t Buffer[BUFFER_SIZE];
@@ -370,6 +370,7 @@
 //    memcpy( Buffer, payload, BufferSize );
 //    RssiValue = rssi;
 //    SnrValue = snr;
+//    LinkAdapt_Rx( rssi, snr );	//Signal of the ground station for the next SF and CR (link_adapt.h)
 //    PacketReceived = true;
 //    RssiMoy = (((RssiMoy * RxCorrectCnt) + RssiValue) / (RxCorrectCnt + 1));
 //    SnrMoy = (((SnrMoy * RxCorrectCnt) + SnrValue) / (RxCorrectCnt + 1));
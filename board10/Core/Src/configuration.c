@@ -12,29 +12,31 @@
  * \author    David Reiss
  */
 #include "configuration.h"
+#include "sensorReadings.h"
+#include "adcs.h"
+#include "trace.h"
+
+uint8_t currentState; /*State of the machine of main.c, INIT until init() ends*/
 
 /**************************************************************************************
  *                                                                                    *
  * Function:  checkbatteries                                                 		  *
  * --------------------                                                               *
- * Checks the current battery level	and stores it in the NVM						  *
+ * Checks the current battery level	and stores it in the NVM. The level is read in	  *
+ * every epoch of sensorReadings(), if the last reading failed the NVM keeps the	  *
+ * previous one																		  *
  *                                                                                    *
- *  hi2c: I2C to read battery capacity							    				  *
+ *  hi2c: I2C to read battery capacity (not used, the reading is asynchronous)		  *
  *															                          *
  *  returns: Nothing									                              *
  *                                                                                    *
  **************************************************************************************/
 void checkbatteries(I2C_HandleTypeDef *hi2c){
-	uint8_t percentage;
-	HAL_StatusTypeDef ret;
+	const SensorSnapshot *sensors = getSensorSnapshot();
+	uint8_t percentage = sensors->battery_level;
 
-	ret = HAL_I2C_Master_Transmit(hi2c, BATTSENSOR_ADDR, (uint8_t*)0x06, 1, 500); //we want to read from the register 0x06
-	if (ret != HAL_OK) {
-
-	} else {
-		HAL_I2C_Master_Receive(hi2c, BATTSENSOR_ADDR, &percentage, 1, 500);
-	}
-	Write_Flash(BATT_LEVEL_ADDR, &percentage, 1);
+	(void)hi2c;
+	if (sensors->valid & SENSOR_VALID_BATT_LEVEL) Write_Flash(BATT_LEVEL_ADDR, &percentage, 1);
 }
 
 /**************************************************************************************
@@ -52,12 +54,12 @@ void checkbatteries(I2C_HandleTypeDef *hi2c){
  **************************************************************************************/
 void deployment(I2C_HandleTypeDef *hi2c){
 	bool deployment = false;
-	while (system_state(&hi2c)){
+	while (system_state(hi2c)){
 		/*Give high voltage to the resistor to burn the wire, TBD TIME AND VOLTAGE*/
 	}
 	deployment = true;
 
-	Write_Flash(DEPLOYMENT_STATE_ADDR, &deployment, 1); /*Must be stored in FLASH memory in order to keep it if the system is rebooted*/
+	Write_Flash(DEPLOYMENT_STATE_ADDR, (uint8_t *)&deployment, 1); /*Must be stored in FLASH memory in order to keep it if the system is rebooted*/
 }
 
 /**************************************************************************************
@@ -74,7 +76,7 @@ void deployment(I2C_HandleTypeDef *hi2c){
  *                                                                                    *
  **************************************************************************************/
 void deploymentRF(I2C_HandleTypeDef *hi2c){
-
+	(void)hi2c;
 }
 
 /**************************************************************************************
@@ -107,15 +109,15 @@ void check_position() {
  **************************************************************************************/
 void init(I2C_HandleTypeDef *hi2c){
 	bool deployment_state, deploymentRF_state;
-	Read_Flash(DEPLOYMENT_STATE_ADDR, &deployment_state, 1); //read the indicator of the deployment of comms antenna
-	Read_Flash(DEPLOYMENTRF_STATE_ADDR, &deploymentRF_state, 1); //read the indicator of the deployment of PL2 antenna
+	Read_Flash(DEPLOYMENT_STATE_ADDR, (uint8_t *)&deployment_state, 1); //read the indicator of the deployment of comms antenna
+	Read_Flash(DEPLOYMENTRF_STATE_ADDR, (uint8_t *)&deploymentRF_state, 1); //read the indicator of the deployment of PL2 antenna
 
-	if(!system_state(&hi2c)) currentState = CONTINGENCY;
+	if(!system_state(hi2c)) currentState = CONTINGENCY;
 	else {
-		if(!deployment_state)	deployment(&hi2c);
+		if(!deployment_state)	deployment(hi2c);
 		//Just in the PocketQube with the RF antenna
-		if(!deploymentRF_state) deploymentRF(&hi2c);
-		detumble(&hi2c);
+		if(!deploymentRF_state) deploymentRF(hi2c);
+		detumble(hi2c);
 		currentState = IDLE;
 	}
 }
@@ -168,21 +170,24 @@ void initsensors(I2C_HandleTypeDef *hi2c) {
  **************************************************************************************/
 bool system_state(I2C_HandleTypeDef *hi2c){
 	uint8_t nominal, battery_capacity;
+	bool ok;
 
+	TRACE_ENTER(TRACE_SYSTEM_STATE);
 	/*If checktemperature returns false, there are different cases which must be distinguished:
 	 * 	- More than three temperature sensors are hot => start rotating the satellite
 	 * 	- Battery temperature is too hot => THIS CASE MUST BE STUDIED
 	 * 	- MCU temperature out of operating range => THIS CASE MUST BE STUDIED */
-	if (!checktemperature(hi2c)) /*rotate_satellite*/;
+	if (!checktemperature(hi2c)) { /*rotate_satellite*/ }
 
 	checkbatteries(hi2c);
 
 	/*Read from memory the threshold NOMINAL and the current BATTERY LEVEL*/
 	Read_Flash(BATT_LEVEL_ADDR, &battery_capacity, 1);
 	Read_Flash(NOMINAL_ADDR, &nominal, 1);
-	if(battery_capacity < nominal) return false;
+	ok = battery_capacity >= nominal;
 
-	return true;
+	TRACE_EXIT(TRACE_SYSTEM_STATE);
+	return ok;
 }
 
 /**************************************************************************************
@@ -200,7 +205,8 @@ bool system_state(I2C_HandleTypeDef *hi2c){
  **************************************************************************************/
 bool checktemperature(I2C_HandleTypeDef *hi2c){
 	Temperatures temp;
-	Flash_Read_Data(TEMP_ADDR, &temp.raw, sizeof(temp));
+	(void)hi2c; /*The temperatures of the last epoch are in memory*/
+	Read_Flash(TEMP_ADDR, (uint8_t *)temp.raw, sizeof(temp));
 	int i, cont = 0;
 	for (i=1; i<=7; i++){  //number of sensors not defined yet
 
@@ -238,14 +244,14 @@ bool checktemperature(I2C_HandleTypeDef *hi2c){
 		default: break;
 		//more cases should come as much as the final number of sensors
 		}
+	}
 
 	if (cont > 3) return false;
 	else return true;
-	}
 }
 
 void heater(int state){
-
+	(void)state;
 }
 
 
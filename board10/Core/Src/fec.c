@@ -0,0 +1,108 @@
+/*!
+ * \file      fec.c
+ *
+ * \brief     Cauchy Reed-Solomon erasure code for the downlink (see fec.h).
+ *
+ * 			  Multiplications use log/antilog tables (768 bytes of RAM, built on
+ * 			  the first Fec_Init). Each data packet is multiplied by one
+ * 			  coefficient per parity packet and added to the accumulators, so the
+ * 			  encoder never has to read the group again.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "fec.h"
+#include "string.h"
+
+#define FEC_POLYNOMIAL		0x11D
+
+static uint8_t GfExp[512];	/*Doubled so exp[log a + log b] needs no modulo*/
+static uint8_t GfLog[256];
+static bool GfReady = false;
+
+static void Gf_Init(void)
+{
+	uint16_t x = 1;
+	int i;
+
+	for (i = 0; i < 255; i++)
+	{
+		GfExp[i] = x;
+		GfExp[i + 255] = x;
+		GfLog[x] = i;
+		x <<= 1;
+		if (x & 0x100) x ^= FEC_POLYNOMIAL;
+	}
+	GfExp[510] = GfExp[0];
+	GfExp[511] = GfExp[1];
+	GfLog[0] = 0;	/*Never used, 0 is handled apart*/
+	GfReady = true;
+}
+
+/*Log of the Cauchy coefficient 1 / (x_j + y_i)*/
+static uint8_t Fec_Coefficient_Log(uint8_t j, uint8_t i)
+{
+	uint8_t sum = (FEC_MAX_GROUP + j) ^ i;	/*Never 0: x_j >= 128 > y_i*/
+
+	return (255 - GfLog[sum]) % 255;
+}
+
+void Fec_Init(FecEncoder *enc, uint8_t K, uint8_t M)
+{
+	if (!GfReady) Gf_Init();
+
+	enc->K = K > FEC_MAX_GROUP ? FEC_MAX_GROUP : K;
+	enc->M = M > FEC_MAX_PARITY ? FEC_MAX_PARITY : M;
+	Fec_Restart(enc);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Fec_Add                                                                 *
+ * --------------------                                                               *
+ * Adds C(j, i) * Data to every parity block, i being the position of the packet in   *
+ * the group                                                                          *
+ *                                                                                    *
+ *  enc: encoder                                                                      *
+ *  Data: FEC_BLOCK_SIZE bytes of the packet                                          *
+ *                                                                                    *
+ *  returns: true if it was the last packet of the group (the parity can be sent)     *
+ *                                                                                    *
+ **************************************************************************************/
+bool Fec_Add(FecEncoder *enc, const uint8_t *Data)
+{
+	uint8_t logData[FEC_BLOCK_SIZE];
+	uint8_t j, c;
+	int b;
+
+	if (enc->M == 0) return false;
+
+	/*The logs of the data are shared by all the parity blocks, 0 is marked with 0xFF*/
+	for (b = 0; b < FEC_BLOCK_SIZE; b++)
+	{
+		logData[b] = Data[b] ? GfLog[Data[b]] : 0xFF;
+	}
+
+	for (j = 0; j < enc->M; j++)
+	{
+		c = Fec_Coefficient_Log(j, enc->Count);
+		for (b = 0; b < FEC_BLOCK_SIZE; b++)
+		{
+			if (logData[b] != 0xFF) enc->Parity[j][b] ^= GfExp[logData[b] + c];
+		}
+	}
+
+	return ++enc->Count >= enc->K;
+}
+
+const uint8_t *Fec_Parity(const FecEncoder *enc, uint8_t j)
+{
+	return enc->Parity[j];
+}
+
+void Fec_Restart(FecEncoder *enc)
+{
+	enc->Count = 0;
+	memset(enc->Parity, 0, sizeof(enc->Parity));
+}
@@ -14,45 +14,35 @@ Maintainer: Miguel Luis and Gregory Cristian
 */
 #include "fifo.h"
 
-static uint16_t FifoNext( Fifo_t *fifo, uint16_t index )
-{
-    return ( index + 1 ) % fifo->Size;
-}
-
 void FifoInit( Fifo_t *fifo, uint8_t *buffer, uint16_t size )
 {
-    fifo->Begin = 0;
-    fifo->End = 0;
-    fifo->Data = buffer;
-    fifo->Size = size;
+    RingInit( fifo, buffer, size );
 }
 
 void FifoPush( Fifo_t *fifo, uint8_t data )
 {
-    fifo->End = FifoNext( fifo, fifo->End );
-    fifo->Data[fifo->End] = data;
+    RingPush( fifo, data );
 }
 
 uint8_t FifoPop( Fifo_t *fifo )
 {
-    uint8_t data = fifo->Data[FifoNext( fifo, fifo->Begin )];
+    uint8_t data = 0;
 
-    fifo->Begin = FifoNext( fifo, fifo->Begin );
+    RingPop( fifo, &data );
     return data;
 }
 
 void FifoFlush( Fifo_t *fifo )
 {
-    fifo->Begin = 0;
-    fifo->End = 0;
+    RingFlush( fifo );
 }
 
 bool IsFifoEmpty( Fifo_t *fifo )
 {
-    return ( fifo->Begin == fifo->End );
+    return RingCount( fifo ) == 0;
 }
 
 bool IsFifoFull( Fifo_t *fifo )
 {
-    return ( FifoNext( fifo, fifo->End ) == fifo->Begin );
+    return RingSpace( fifo ) == 0;
 }
@@ -13,127 +13,260 @@
 
 
 #include "flash.h"
+#include "flash_log.h"
+#include "flash_cache.h"
+#include "trace.h"
 #include "stm32f4xx_hal.h"
 #include "string.h"
 #include "stdio.h"
 
+/*Supply of the board (2.7V - 3.6V), sets the erase parallelism and the program width*/
+#define FLASH_PROGRAM_VOLTAGE_RANGE		FLASH_VOLTAGE_RANGE_3
+
+/*
+ * Sector map of the STM32F4 family, according to the reference manuals. Each bank
+ * has 4 sectors of 16KB, 1 of 64KB and up to 7 of 128KB. Only the first
+ * FLASH_SECTOR_TOTAL rows exist in the selected part:
+ *  STM32F411CE: sectors 0 to 7 (512KB)
+ *  STM32F40x/41x: sectors 0 to 11 (1MB)
+ *  STM32F413/423: sectors 12 to 15 continue with 128KB (1.5MB)
+ *  STM32F42x/43x/469/479: sectors 12 to 23 are bank 2, same layout as bank 1 (2MB)
+ */
+#define SECTOR_ROW(index, start, size)	{ (start), (size), (index) }
+
+static const FlashSector FlashSectors[] = {
+	SECTOR_ROW(0,  0x08000000, 0x04000),
+	SECTOR_ROW(1,  0x08004000, 0x04000),
+	SECTOR_ROW(2,  0x08008000, 0x04000),
+	SECTOR_ROW(3,  0x0800C000, 0x04000),
+	SECTOR_ROW(4,  0x08010000, 0x10000),
+	SECTOR_ROW(5,  0x08020000, 0x20000),
+	SECTOR_ROW(6,  0x08040000, 0x20000),
+	SECTOR_ROW(7,  0x08060000, 0x20000),
+	SECTOR_ROW(8,  0x08080000, 0x20000),
+	SECTOR_ROW(9,  0x080A0000, 0x20000),
+	SECTOR_ROW(10, 0x080C0000, 0x20000),
+	SECTOR_ROW(11, 0x080E0000, 0x20000),
+#if FLASH_SECTOR_TOTAL == 24U
+	SECTOR_ROW(12, 0x08100000, 0x04000),
+	SECTOR_ROW(13, 0x08104000, 0x04000),
+	SECTOR_ROW(14, 0x08108000, 0x04000),
+	SECTOR_ROW(15, 0x0810C000, 0x04000),
+	SECTOR_ROW(16, 0x08110000, 0x10000),
+	SECTOR_ROW(17, 0x08120000, 0x20000),
+	SECTOR_ROW(18, 0x08140000, 0x20000),
+	SECTOR_ROW(19, 0x08160000, 0x20000),
+	SECTOR_ROW(20, 0x08180000, 0x20000),
+	SECTOR_ROW(21, 0x081A0000, 0x20000),
+	SECTOR_ROW(22, 0x081C0000, 0x20000),
+	SECTOR_ROW(23, 0x081E0000, 0x20000),
+#elif FLASH_SECTOR_TOTAL == 16U
+	SECTOR_ROW(12, 0x08100000, 0x20000),
+	SECTOR_ROW(13, 0x08120000, 0x20000),
+	SECTOR_ROW(14, 0x08140000, 0x20000),
+	SECTOR_ROW(15, 0x08160000, 0x20000),
+#endif
+};
+
+_Static_assert(FLASH_SECTOR_TOTAL <= sizeof(FlashSectors) / sizeof(FlashSectors[0]),
+			   "FlashSectors does not describe all the sectors of this part");
+
 /**************************************************************************************
  *                                                                                    *
- * Function:  GetSector                                                     		  *
+ * Function:  Flash_Get_Sector                                                        *
  * --------------------                                                               *
- * defines the SECTORS according to the reference manual					          *
- * STM32F411CE has:																	  *
- *  Sector 0 to Sector 3 each 16KB													  *
- *  Sector 4 as 64KB																  *
- *  Sector 5 to Sector 7 each 128KB													  *
+ * Binary search of the sector that contains an address (at most 5 comparisons	  *
+ * for the 24 sectors of the largest parts)											  *
  *                                                                                    *
  *  Address: Specific address of a read/write function                                *
  *                                                                                    *
- *  returns: sector in which the address is contained		                          *
+ *  returns: descriptor of the sector or NULL if the address is not in the flash	  *
  *                                                                                    *
  **************************************************************************************/
+const FlashSector *Flash_Get_Sector(uint32_t Address)
+{
+	uint32_t low = 0, high = FLASH_SECTOR_TOTAL, mid;
 
-static uint32_t GetSector(uint32_t Address)
+	if (Address < FlashSectors[0].start) return NULL;
+
+	while (high - low > 1) {
+		mid = (low + high) / 2;
+		if (Address >= FlashSectors[mid].start) low = mid;
+		else high = mid;
+	}
+	if (Address - FlashSectors[low].start >= FlashSectors[low].size) return NULL;
+	return &FlashSectors[low];
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Plan_Erase                                                        *
+ * --------------------                                                               *
+ * Computes which sectors have to be erased to write a range of addresses			  *
+ *                                                                                    *
+ *  Address: first address to be written		                                      *
+ *	numberofbytes: Data size in Bytes					    						  *
+ *	FirstSector: first sector to erase (FLASH_SECTOR_x)								  *
+ *	NbSectors: number of sectors to erase											  *
+ *                                                                                    *
+ *  returns: False if the range is empty or not completely inside the flash		  *
+ *                                                                                    *
+ **************************************************************************************/
+bool Flash_Plan_Erase(uint32_t Address, uint32_t numberofbytes, uint32_t *FirstSector, uint32_t *NbSectors)
 {
-  uint32_t sector = 0;
-
-  if((Address < 0x08003FFF) && (Address >= 0x08000000))
-  {
-    sector = FLASH_SECTOR_0;
-  }
-  else if((Address < 0x08007FFF) && (Address >= 0x08004000))
-  {
-    sector = FLASH_SECTOR_1;
-  }
-  else if((Address < 0x0800BFFF) && (Address >= 0x08008000))
-  {
-    sector = FLASH_SECTOR_2;
-  }
-  else if((Address < 0x0800FFFF) && (Address >= 0x0800C000))
-  {
-    sector = FLASH_SECTOR_3;
-  }
-  else if((Address < 0x0801FFFF) && (Address >= 0x08010000))
-  {
-    sector = FLASH_SECTOR_4;
-  }
-  else if((Address < 0x0803FFFF) && (Address >= 0x08020000))
-  {
-    sector = FLASH_SECTOR_5;
-  }
-  else if((Address < 0x0805FFFF) && (Address >= 0x08040000))
-  {
-    sector = FLASH_SECTOR_6;
-  }
-  else if((Address < 0x0807FFFF) && (Address >= 0x08060000))
-  {
-    sector = FLASH_SECTOR_7;
-  }
-/*  else if((Address < 0x0809FFFF) && (Address >= 0x08080000))
-  {
-    sector = FLASH_SECTOR_8;
-  }
-  else if((Address < 0x080BFFFF) && (Address >= 0x080A0000))
-  {
-    sector = FLASH_SECTOR_9;
-  }
-  else if((Address < 0x080DFFFF) && (Address >= 0x080C0000))
-  {
-    sector = FLASH_SECTOR_10;
-  }
-  else if((Address < 0x080FFFFF) && (Address >= 0x080E0000))
-  {
-    sector = FLASH_SECTOR_11;
-  }
-  else if((Address < 0x08103FFF) && (Address >= 0x08100000))
-  {
-    sector = FLASH_SECTOR_12;
-  }
-  else if((Address < 0x08107FFF) && (Address >= 0x08104000))
-  {
-    sector = FLASH_SECTOR_13;
-  }
-  else if((Address < 0x0810BFFF) && (Address >= 0x08108000))
-  {
-    sector = FLASH_SECTOR_14;
-  }
-  else if((Address < 0x0810FFFF) && (Address >= 0x0810C000))
-  {
-    sector = FLASH_SECTOR_15;
-  }
-  else if((Address < 0x0811FFFF) && (Address >= 0x08110000))
-  {
-    sector = FLASH_SECTOR_16;
-  }
-  else if((Address < 0x0813FFFF) && (Address >= 0x08120000))
-  {
-    sector = FLASH_SECTOR_17;
-  }
-  else if((Address < 0x0815FFFF) && (Address >= 0x08140000))
-  {
-    sector = FLASH_SECTOR_18;
-  }
-  else if((Address < 0x0817FFFF) && (Address >= 0x08160000))
-  {
-    sector = FLASH_SECTOR_19;
-  }
-  else if((Address < 0x0819FFFF) && (Address >= 0x08180000))
-  {
-    sector = FLASH_SECTOR_20;
-  }
-  else if((Address < 0x081BFFFF) && (Address >= 0x081A0000))
-  {
-    sector = FLASH_SECTOR_21;
-  }
-  else if((Address < 0x081DFFFF) && (Address >= 0x081C0000))
-  {
-    sector = FLASH_SECTOR_22;
-  }
-  else if (Address < 0x081FFFFF) && (Address >= 0x081E0000)
-  {
-    sector = FLASH_SECTOR_23;
-  }*/
-  return sector;
+	const FlashSector *first, *last;
+
+	if (numberofbytes == 0) return false;
+	first = Flash_Get_Sector(Address);
+	last = Flash_Get_Sector(Address + numberofbytes - 1);	/*last byte, not the next one*/
+	if (first == NULL || last == NULL) return false;
+
+	*FirstSector = first->index;
+	*NbSectors = last->index - first->index + 1;
+	return true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Erase_Sectors                                             		  *
+ * --------------------                                                               *
+ * Erases all the sectors that contain a range of addresses, with the parallelism	  *
+ * of the voltage range. The flash must be unlocked									  *
+ *                                                                                    *
+ *  Address: first address of the range		                                      *
+ *	numberofbytes: Size of the range in Bytes					    				  *
+ *															                          *
+ *  returns: HAL_OK or the HAL error					                              *
+ *                                                                                    *
+ **************************************************************************************/
+HAL_StatusTypeDef Flash_Erase_Sectors(uint32_t Address, uint32_t numberofbytes)
+{
+	FLASH_EraseInitTypeDef EraseInitStruct;
+	uint32_t SECTORError;
+	HAL_StatusTypeDef status;
+
+	if (!Flash_Plan_Erase(Address, numberofbytes, &EraseInitStruct.Sector, &EraseInitStruct.NbSectors))
+		return HAL_ERROR;
+
+	EraseInitStruct.TypeErase     = FLASH_TYPEERASE_SECTORS;
+	EraseInitStruct.VoltageRange  = FLASH_PROGRAM_VOLTAGE_RANGE;
+
+	TRACE_ENTER(TRACE_FLASH_ERASE);
+	status = HAL_FLASHEx_Erase(&EraseInitStruct, &SECTORError);
+	TRACE_EXIT(TRACE_FLASH_ERASE);
+	return status;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Erase                                                      		  *
+ * --------------------                                                               *
+ * Erases all the sectors that contain a range of addresses, so that it can be		  *
+ * programmed afterwards piece by piece with Flash_Program_Data						  *
+ *                                                                                    *
+ *  Address: first address of the range		                                      *
+ *	numberofbytes: Size of the range in Bytes					    				  *
+ *															                          *
+ *  returns: 0 or error in case it fails				                              *
+ *                                                                                    *
+ **************************************************************************************/
+uint32_t Flash_Erase(uint32_t Address, uint32_t numberofbytes)
+{
+	uint32_t FirstSector, NbSectors;
+	uint32_t error = 0;
+
+	if (!Flash_Plan_Erase(Address, numberofbytes, &FirstSector, &NbSectors))
+		return HAL_FLASH_ERROR_OPERATION;
+
+	HAL_FLASH_Unlock();
+	if (Flash_Erase_Sectors(Address, numberofbytes) != HAL_OK)
+	{
+		error = HAL_FLASH_GetError ();
+	}
+	HAL_FLASH_Lock();
+	return error;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Program_Data                                              		  *
+ * --------------------                                                               *
+ * Programs already erased flash. The unaligned head and tail are written byte by	  *
+ * byte and the aligned body with the widest access allowed by the voltage range	  *
+ * (x8 range 1, x16 range 2, x32 range 3, x64 range 4 with external Vpp).			  *
+ * A 20KB photo needs 5000 program operations instead of 20000						  *
+ * The flash must be unlocked														  *
+ *                                                                                    *
+ *  Address: first address to be programmed		                                      *
+ *	Data: information to be stored in the FLASH/EEPROM memory						  *
+ *	numberofbytes: Data size in Bytes					    						  *
+ *															                          *
+ *  returns: HAL_OK or the HAL error					                              *
+ *                                                                                    *
+ **************************************************************************************/
+HAL_StatusTypeDef Flash_Program_Data(uint32_t Address, uint8_t *Data, uint32_t numberofbytes)
+{
+	uint32_t TypeProgram, unit;
+	uint32_t word;
+	uint16_t halfword;
+	uint64_t doubleword;
+
+	switch (FLASH_PROGRAM_VOLTAGE_RANGE) {
+	case FLASH_VOLTAGE_RANGE_4:
+		TypeProgram = FLASH_TYPEPROGRAM_DOUBLEWORD;
+		unit = 8;
+		break;
+	case FLASH_VOLTAGE_RANGE_3:
+		TypeProgram = FLASH_TYPEPROGRAM_WORD;
+		unit = 4;
+		break;
+	case FLASH_VOLTAGE_RANGE_2:
+		TypeProgram = FLASH_TYPEPROGRAM_HALFWORD;
+		unit = 2;
+		break;
+	default:
+		TypeProgram = FLASH_TYPEPROGRAM_BYTE;
+		unit = 1;
+		break;
+	}
+
+	/*Head: up to the first aligned address*/
+	while (numberofbytes > 0 && (Address & (unit - 1)) != 0) {
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, Address, *Data) != HAL_OK) return HAL_ERROR;
+		Address++;
+		Data++;
+		numberofbytes--;
+	}
+
+	/*Body: Data may be unaligned, so it is copied before programming*/
+	while (unit > 1 && numberofbytes >= unit) {
+		HAL_StatusTypeDef status;
+		if (unit == 8) {
+			memcpy(&doubleword, Data, 8);
+			status = HAL_FLASH_Program(TypeProgram, Address, doubleword);
+		}
+		else if (unit == 4) {
+			memcpy(&word, Data, 4);
+			status = HAL_FLASH_Program(TypeProgram, Address, word);
+		}
+		else {
+			memcpy(&halfword, Data, 2);
+			status = HAL_FLASH_Program(TypeProgram, Address, halfword);
+		}
+		if (status != HAL_OK) return HAL_ERROR;
+		Address += unit;
+		Data += unit;
+		numberofbytes -= unit;
+	}
+
+	/*Tail*/
+	while (numberofbytes > 0) {
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, Address, *Data) != HAL_OK) return HAL_ERROR;
+		Address++;
+		Data++;
+		numberofbytes--;
+	}
+	return HAL_OK;
 }
 
 /**************************************************************************************
@@ -154,7 +287,6 @@ uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t
 
 	static FLASH_EraseInitTypeDef EraseInitStruct;
 	uint32_t SECTORError;
-	int sofar=0;
 
 	//int numberofwords = (strlen(Data)/4) + ((strlen(Data)%4) != 0);
 
@@ -164,17 +296,19 @@ uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t
 
 	  /* Erase the user Flash area */
 
-	  /* Get the number of sector to erase from 1st sector */
-
-	  uint32_t StartSector = GetSector(StartSectorAddress);
-	  uint32_t EndSectorAddress = StartSectorAddress + numberofbytes;
-	  uint32_t EndSector = GetSector(EndSectorAddress);
+	  /* Get the sectors to erase */
+	  uint32_t StartSector, NbSectors;
+	  if (!Flash_Plan_Erase(StartSectorAddress, numberofbytes, &StartSector, &NbSectors))
+	  {
+		  HAL_FLASH_Lock();
+		  return HAL_FLASH_ERROR_OPERATION;
+	  }
 
 	  /* Fill EraseInit structure*/
 	  EraseInitStruct.TypeErase     = FLASH_TYPEERASE_SECTORS;
-	  EraseInitStruct.VoltageRange  = FLASH_VOLTAGE_RANGE_3;
+	  EraseInitStruct.VoltageRange  = FLASH_PROGRAM_VOLTAGE_RANGE;
 	  EraseInitStruct.Sector        = StartSector;
-	  EraseInitStruct.NbSectors     = (EndSector - StartSector) + 1;
+	  EraseInitStruct.NbSectors     = NbSectors;
 
 	  /* Note: If an erase operation in Flash memory also concerns data in the data or instruction cache,
 	     you have to make sure that these data are rewritten before they are accessed during code
@@ -182,26 +316,18 @@ uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t
 	     DCRST and ICRST bits in the FLASH_CR register. */
 	  if (HAL_FLASHEx_Erase(&EraseInitStruct, &SECTORError) != HAL_OK)
 	  {
+		  HAL_FLASH_Lock();
 		  return HAL_FLASH_GetError ();
 
 	  }
 
-	  /* Program the user Flash area word by word
-	    (area defined by FLASH_USER_START_ADDR and FLASH_USER_END_ADDR) ***********/
-
-	   while (sofar<numberofbytes)
-	   {
-	     if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, StartSectorAddress, Data[sofar]) == HAL_OK)
-	     {
-	    	 StartSectorAddress += 1;  // use StartPageAddress += 2 for half word and 8 for double word
-	    	 sofar++;
-	     }
-	     else
-	     {
-	       /* Error occurred while writing data in Flash memory*/
-	    	 return HAL_FLASH_GetError ();
-	     }
-	   }
+	  /* Program the user Flash area, word by word in the aligned part */
+	  if (Flash_Program_Data(StartSectorAddress, Data, numberofbytes) != HAL_OK)
+	  {
+		  /* Error occurred while writing data in Flash memory*/
+		  HAL_FLASH_Lock();
+		  return HAL_FLASH_GetError ();
+	  }
 
 	  /* Lock the Flash to disable the flash control register access (recommended
 	     to protect the FLASH memory against possible unwanted operation) *********/
@@ -215,7 +341,8 @@ uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t
  * Function:  Write_Flash                                                		 	  *
  * --------------------                                                               *
  * It's the function that must be called when writing in the Flash memory.			  *
- * Depending on the address, it writes 1 time or 3 times (Redundancy)				  *
+ * The variables of the flash.h address map are only updated in the RAM copy		  *
+ * (flash_cache.c), which writes them back later. The rest goes to the flash		  *
  *                                                                                    *
  *  StartSectorAddress: first address to be written		                              *
  *	Data: information to be stored in the FLASH/EEPROM memory						  *
@@ -225,15 +352,44 @@ uint32_t Flash_Write_Data (uint32_t StartSectorAddress, uint8_t *Data, uint16_t
  *                                                                                    *
  **************************************************************************************/
 void Write_Flash(uint32_t StartSectorAddress, uint8_t *Data, uint16_t numberofbytes) {
-	if (StartSectorAddress >= 0x08000000 && StartSectorAddress <= 0x0800BFFF) { //addresses with redundancy
-		// The addresses are separated 0x4000 positions
+	if (Flash_Cache_Owns(StartSectorAddress, numberofbytes)) {
+		Flash_Cache_Write(StartSectorAddress, Data, numberofbytes);
+	}
+	else {
+		Write_Flash_Direct(StartSectorAddress, Data, numberofbytes);
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Write_Flash_Direct                                           		 	  *
+ * --------------------                                                               *
+ * Writes in the Flash memory bypassing the RAM copy (used by its write-back).		  *
+ * The state and telemetry variables are appended to the log (flash_log.c), the	  *
+ * rest depending on the address, it writes 1 time or 3 times (Redundancy)		  *
+ *                                                                                    *
+ *  StartSectorAddress: first address to be written		                              *
+ *	Data: information to be stored in the FLASH/EEPROM memory						  *
+ *	numberofbytes: Data size in Bytes					    						  *
+ *															                          *
+ *  returns: Nothing									                              *
+ *                                                                                    *
+ **************************************************************************************/
+void Write_Flash_Direct(uint32_t StartSectorAddress, uint8_t *Data, uint16_t numberofbytes) {
+	TRACE_ENTER(TRACE_FLASH_WRITE);
+	if (Flash_Log_Owns(StartSectorAddress, numberofbytes)) { //variables rewritten every loop, no erase
+		Flash_Log_Write(StartSectorAddress, Data, numberofbytes);
+	}
+	else if (StartSectorAddress >= 0x08000000 && StartSectorAddress <= 0x0800BFFF) { //addresses with redundancy
+		// The addresses are separated REDUNDANCY_OFFSET (0x4000) positions
 		Flash_Write_Data(StartSectorAddress, Data, numberofbytes);
-		Flash_Write_Data(StartSectorAddress + 0x4000, Data, numberofbytes);
-		Flash_Write_Data(StartSectorAddress + 0x8000, Data, numberofbytes);
+		Flash_Write_Data(StartSectorAddress + REDUNDANCY_OFFSET, Data, numberofbytes);
+		Flash_Write_Data(StartSectorAddress + 2 * REDUNDANCY_OFFSET, Data, numberofbytes);
 	}
 	else {
 		Flash_Write_Data(StartSectorAddress, Data, numberofbytes);
 	}
+	TRACE_EXIT(TRACE_FLASH_WRITE);
 }
 
 /**************************************************************************************
@@ -266,40 +422,60 @@ void Flash_Read_Data (uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numb
  *                                                                                    *
  * Function:  Check_Redundancy                                                 		  *
  * --------------------                                                               *
- * Reads the data from the 3 addresses where it is stored and chooses the value		  *
- * that coincides at least in 2 of the 3 addresses (in case one gets corrupted)		  *
+ * Reads the data from the 3 addresses where it is stored and keeps, bit by bit,	  *
+ * the value that coincides at least in 2 of the 3 copies: (a&b)|(a&c)|(b&c)		  *
+ * The copies are voted in a single pass, 32 bits at a time (the unaligned head	  *
+ * and tail byte by byte), so no stack buffers depending on the size are needed	  *
  * All the addresses of variables with Redundancy follow the same pattern: each		  *
- * address is separated 0x4000 positions in memory									  *
+ * address is separated REDUNDANCY_OFFSET positions in memory						  *
  *                                                                                    *
  *  Address: first address to be read		                              			  *
  *	RxDef: Buffer to store the lecture that coincides at least 2 times				  *
  *	numberofbytes: Data size in bytes												  *
  *															                          *
- *  returns: Nothing									                              *
+ *  returns: Number of words (or unaligned bytes) where the copies did not match,	  *
+ *  		 0 if the 3 copies are identical and nothing has to be repaired			  *
  *                                                                                    *
  **************************************************************************************/
-void Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes){
-	uint8_t lect1[numberofbytes], lect2[numberofbytes], lect3[numberofbytes];
-	Flash_Read_Data(Address, lect1, numberofbytes);
-	Flash_Read_Data(Address + 0x4000, lect2, numberofbytes);
-	Flash_Read_Data(Address + 0x8000, lect3, numberofbytes);
-
-	bool coincidence12 = true, coincidence13 = true, coincidence23 = true;
-	for (int i = 0; i < numberofbytes; i++) {
-		if (lect1[i] != lect2[i]) coincidence12 = false;
-		if (lect1[i] != lect3[i]) coincidence13 = false;
-		if (lect2[i] != lect3[i]) coincidence23 = false;
-	}
-	if(coincidence12 || coincidence13) {
-		Flash_Read_Data(Address, RxDef, numberofbytes);
+uint16_t Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes){
+	uint32_t a, b, c, vote;
+	uint16_t corrected = 0;
+
+	/*Head: bytes up to the first word aligned address*/
+	while (numberofbytes > 0 && (Address & 3) != 0) {
+		a = *(__IO uint8_t *)Address;
+		b = *(__IO uint8_t *)(Address + REDUNDANCY_OFFSET);
+		c = *(__IO uint8_t *)(Address + 2 * REDUNDANCY_OFFSET);
+		*RxDef++ = (a & b) | (a & c) | (b & c);
+		if (a != b || a != c) corrected++;
+		Address++;
+		numberofbytes--;
 	}
-	else if(coincidence23) {
-		Flash_Read_Data(Address + 0x4000, RxDef, numberofbytes);
+
+	/*Body: a whole word is voted at once*/
+	while (numberofbytes >= 4) {
+		a = *(__IO uint32_t *)Address;
+		b = *(__IO uint32_t *)(Address + REDUNDANCY_OFFSET);
+		c = *(__IO uint32_t *)(Address + 2 * REDUNDANCY_OFFSET);
+		vote = (a & b) | (a & c) | (b & c);
+		memcpy(RxDef, &vote, 4);	/*RxDef may be unaligned*/
+		if (a != b || a != c) corrected++;
+		RxDef += 4;
+		Address += 4;
+		numberofbytes -= 4;
 	}
 
-	else {
-		*RxDef = lect1; /*PREGUNTAR QUÈ FER QUAN NO COINCIDEIX CAP LECTURA (POC PROBABLE)*/
+	/*Tail*/
+	while (numberofbytes > 0) {
+		a = *(__IO uint8_t *)Address;
+		b = *(__IO uint8_t *)(Address + REDUNDANCY_OFFSET);
+		c = *(__IO uint8_t *)(Address + 2 * REDUNDANCY_OFFSET);
+		*RxDef++ = (a & b) | (a & c) | (b & c);
+		if (a != b || a != c) corrected++;
+		Address++;
+		numberofbytes--;
 	}
+	return corrected;
 }
 
 
@@ -308,7 +484,8 @@ void Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes){
  * Function:  Read_Flash	                                                 		  *
  * --------------------                                                               *
  * It's the function that must be called when reading from the Flash memory.		  *
- * Depending on the address, it reads from 1 or 3 addresses (Redundancy)			  *
+ * The variables of the flash.h address map are read from the RAM copy				  *
+ * (flash_cache.c), the rest from the flash											  *
  *                                                                                    *
  *  StartSectorAddress: starting address to read		                              *
  *	RxBuf: Where the data read from memory will be stored							  *
@@ -318,7 +495,34 @@ void Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes){
  *                                                                                    *
  **************************************************************************************/
 void Read_Flash(uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numberofbytes) {
-	if (StartSectorAddress >= 0x08000000 && StartSectorAddress <= 0x0800BFFF) { //addresses with redundancy
+	if (Flash_Cache_Owns(StartSectorAddress, numberofbytes)) {
+		Flash_Cache_Read(StartSectorAddress, RxBuf, numberofbytes);
+	}
+	else {
+		Read_Flash_Direct(StartSectorAddress, RxBuf, numberofbytes);
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Read_Flash_Direct                                             		  *
+ * --------------------                                                               *
+ * Reads from the Flash memory bypassing the RAM copy (used to load it).			  *
+ * The state and telemetry variables are read from the log (flash_log.c), the rest	  *
+ * depending on the address, it reads from 1 or 3 addresses (Redundancy)			  *
+ *                                                                                    *
+ *  StartSectorAddress: starting address to read		                              *
+ *	RxBuf: Where the data read from memory will be stored							  *
+ *	numberofbytes: Reading data size in Bytes					    				  *
+ *															                          *
+ *  returns: Nothing									                              *
+ *                                                                                    *
+ **************************************************************************************/
+void Read_Flash_Direct(uint32_t StartSectorAddress, uint8_t *RxBuf, uint16_t numberofbytes) {
+	if (Flash_Log_Owns(StartSectorAddress, numberofbytes)) {
+		Flash_Log_Read(StartSectorAddress, RxBuf, numberofbytes);
+	}
+	else if (StartSectorAddress >= 0x08000000 && StartSectorAddress <= 0x0800BFFF) { //addresses with redundancy
 		Check_Redundancy(StartSectorAddress, RxBuf, numberofbytes);
 	}
 	else {
@@ -0,0 +1,188 @@
+/*!
+ * \file      flash_cache.c
+ *
+ * \brief     RAM copy of the flash.h address map with dirty tracking. The map is
+ * 			  split in the same regions the flash uses to store it, so a write-back
+ * 			  rewrites each dirty region with a single Write_Flash_Direct call:
+ * 			    state flags     -> log (flash_log.c)
+ * 			    config/TLE/cal. -> triple redundancy area
+ * 			    telemetry       -> log (flash_log.c)
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "flash_cache.h"
+#include "flash.h"
+#include "trace.h"
+#include "stm32f4xx_hal.h"
+#include "string.h"
+
+typedef struct {
+	uint32_t offset;
+	uint32_t size;
+} CacheRegion;
+
+static const CacheRegion CacheRegions[] = {
+	{ 0x000, 0x010 },	/*PAYLOAD_STATE_ADDR ... LINK_CR_ADDR*/
+	{ 0x010, 0x0F0 },	/*CONFIG_ADDR ... CALIBRATION_ADDR*/
+	{ 0x100, 0x010 },	/*TEMP_ADDR ... BATT_LEVEL_ADDR*/
+};
+
+#define CACHE_REGIONS	(sizeof(CacheRegions) / sizeof(CacheRegions[0]))
+
+static uint8_t Shadow[FLASH_CACHE_SIZE];
+static uint32_t DirtyMask = 0;		/*bit i set => CacheRegions[i] must be written back*/
+static uint32_t LastFlush = 0;
+static bool CacheReady = false;
+static FlashCacheStats CacheStats;
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Init                                                        *
+ * --------------------                                                               *
+ * Reads every region from the flash (with the redundancy vote where it applies)     *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Cache_Init(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < CACHE_REGIONS; i++) {
+		Read_Flash_Direct(FLASH_CACHE_START + CacheRegions[i].offset,
+						  &Shadow[CacheRegions[i].offset], CacheRegions[i].size);
+	}
+	DirtyMask = 0;
+	LastFlush = HAL_GetTick();
+	CacheReady = true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Owns                                                        *
+ * --------------------                                                               *
+ * Checks if a variable belongs to the cached address map                             *
+ *                                                                                    *
+ *  Address: first address of the variable                                           *
+ *  numberofbytes: Data size in bytes                                                 *
+ *                                                                                    *
+ *  returns: True if all the bytes are cached                                         *
+ *                                                                                    *
+ **************************************************************************************/
+bool Flash_Cache_Owns(uint32_t Address, uint16_t numberofbytes)
+{
+	return numberofbytes > 0 && Address >= FLASH_CACHE_START &&
+		   Address + numberofbytes <= FLASH_CACHE_START + FLASH_CACHE_SIZE;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Read                                                        *
+ * --------------------                                                               *
+ * Reads a variable from the RAM copy                                                 *
+ *                                                                                    *
+ *  Address: first address of the variable in the flash.h address map                 *
+ *  RxBuf: Where the data will be stored                                              *
+ *  numberofbytes: Reading data size in Bytes                                         *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Cache_Read(uint32_t Address, uint8_t *RxBuf, uint16_t numberofbytes)
+{
+	if (!CacheReady) Flash_Cache_Init();
+	memcpy(RxBuf, &Shadow[Address - FLASH_CACHE_START], numberofbytes);
+	CacheStats.reads++;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Write                                                       *
+ * --------------------                                                               *
+ * Updates a variable in the RAM copy. Only the regions whose content changes are     *
+ * marked to be written back                                                          *
+ *                                                                                    *
+ *  Address: first address of the variable in the flash.h address map                 *
+ *  Data: new value                                                                   *
+ *  numberofbytes: Data size in Bytes                                                 *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Cache_Write(uint32_t Address, uint8_t *Data, uint16_t numberofbytes)
+{
+	uint32_t first = Address - FLASH_CACHE_START;
+	uint32_t last = first + numberofbytes;	/*not included*/
+	uint32_t i;
+
+	if (!CacheReady) Flash_Cache_Init();
+	CacheStats.writes++;
+	if (memcmp(&Shadow[first], Data, numberofbytes) == 0) return;
+
+	memcpy(&Shadow[first], Data, numberofbytes);
+	for (i = 0; i < CACHE_REGIONS; i++) {
+		if (first < CacheRegions[i].offset + CacheRegions[i].size && last > CacheRegions[i].offset) {
+			DirtyMask |= 1u << i;
+		}
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Flush                                                       *
+ * --------------------                                                               *
+ * Writes back every dirty region. Must be called before a reset or a state change    *
+ * so that nothing stored in RAM is lost                                              *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Cache_Flush(void)
+{
+	uint32_t i;
+
+	LastFlush = HAL_GetTick();
+	if (DirtyMask == 0) return;
+
+	TRACE_ENTER(TRACE_FLASH_CACHE_FLUSH);
+	for (i = 0; i < CACHE_REGIONS; i++) {
+		if (DirtyMask & (1u << i)) {
+			Write_Flash_Direct(FLASH_CACHE_START + CacheRegions[i].offset,
+							   &Shadow[CacheRegions[i].offset], CacheRegions[i].size);
+			CacheStats.flash_writes++;
+		}
+	}
+	DirtyMask = 0;
+	CacheStats.flushes++;
+	TRACE_EXIT(TRACE_FLASH_CACHE_FLUSH);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Poll                                                        *
+ * --------------------                                                               *
+ * Periodic write-back policy, to be called once per main loop iteration             *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Cache_Poll(void)
+{
+	if (HAL_GetTick() - LastFlush >= FLASH_CACHE_FLUSH_PERIOD) Flash_Cache_Flush();
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Cache_Get_Stats                                                   *
+ * --------------------                                                               *
+ * Gives access to the write-back counters                                            *
+ *                                                                                    *
+ *  returns: Pointer to the counters                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+const FlashCacheStats *Flash_Cache_Get_Stats(void)
+{
+	return &CacheStats;
+}
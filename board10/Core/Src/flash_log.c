@@ -0,0 +1,546 @@
+/*!
+ * \file      flash_log.c
+ *
+ * \brief     Append-only, wear-levelled key/value log for the variables of the
+ * 			  flash.h address map that are rewritten on every main loop iteration.
+ *
+ * 			  Sector layout:
+ * 			    word 0: status (ERASED -> RECEIVING -> VALID)
+ * 			    word 1: generation, increased on every garbage collection
+ * 			    records, one after the other, word aligned:
+ * 			      header: key (offset from PAYLOAD_STATE_ADDR) | length << 16
+ * 			      data:   length bytes, padded with 0xFF up to a word
+ * 			      commit: FLASH_LOG_COMMIT, written last, a record without it is ignored
+ *
+ * 			  The RAM index keeps the flash address of the latest copy of every byte,
+ * 			  so reads never have to scan the log. The records with the key
+ * 			  FLASH_LOG_SERIES_KEY are blocks of the housekeeping series: they are
+ * 			  not in the index and a garbage collection copies the newest ones,
+ * 			  in order, between the live values and the record that did not fit.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "flash_log.h"
+#include "flash.h"
+#include "stm32f4xx_hal.h"
+#include "string.h"
+
+#define FLASH_LOG_HEADER_SIZE		8
+#define FLASH_LOG_KEY_BASE			PAYLOAD_STATE_ADDR
+#define FLASH_LOG_SERIES_ADDR		(FLASH_LOG_KEY_BASE + FLASH_LOG_SERIES_KEY)
+
+static uint32_t ActiveSector;
+static uint32_t WriteAddress;
+static uint32_t Generation;
+static uint32_t LogIndex[FLASH_LOG_SLOTS];	/*Flash address of the latest value of each byte (0 if none)*/
+static bool LogReady = false;
+static FlashLogStats LogStats;
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Slot                                                                *
+ * --------------------                                                               *
+ * Maps an address of the flash.h address map to its position in the RAM index       *
+ *                                                                                    *
+ *  Address: address of the variable                                                  *
+ *                                                                                    *
+ *  returns: slot of the index or -1 if the address is not served by the log          *
+ *                                                                                    *
+ **************************************************************************************/
+static int Log_Slot(uint32_t Address)
+{
+	if (Address >= FLASH_LOG_STATE_START && Address < FLASH_LOG_STATE_START + FLASH_LOG_STATE_SIZE)
+		return Address - FLASH_LOG_STATE_START;
+	if (Address >= FLASH_LOG_TELEMETRY_START && Address < FLASH_LOG_TELEMETRY_START + FLASH_LOG_TELEMETRY_SIZE)
+		return FLASH_LOG_STATE_SIZE + (Address - FLASH_LOG_TELEMETRY_START);
+	return -1;
+}
+
+static uint32_t Log_Record_Size(uint16_t numberofbytes)
+{
+	return 4 + ((numberofbytes + 3) & ~3u) + 4;
+}
+
+static uint32_t Log_Other_Sector(uint32_t Sector)
+{
+	return (Sector == FLASH_LOG_SECTOR_A_ADDR) ? FLASH_LOG_SECTOR_B_ADDR : FLASH_LOG_SECTOR_A_ADDR;
+}
+
+static uint32_t Log_Read_Word(uint32_t Address)
+{
+	return *(__IO uint32_t *)Address;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Erase                                                               *
+ * --------------------                                                               *
+ * Erases one of the two log sectors. The flash must be unlocked                      *
+ *                                                                                    *
+ *  Sector: FLASH_LOG_SECTOR_A_ADDR or FLASH_LOG_SECTOR_B_ADDR                        *
+ *                                                                                    *
+ *  returns: HAL_OK or the HAL error                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static HAL_StatusTypeDef Log_Erase(uint32_t Sector)
+{
+	LogStats.erases++;
+	return Flash_Erase_Sectors(Sector, FLASH_LOG_SECTOR_SIZE);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Append                                                              *
+ * --------------------                                                               *
+ * Programs a record at WriteAddress and points the index to it. The caller must      *
+ * have checked that the record fits in the active sector and unlocked the flash      *
+ *                                                                                    *
+ *  Address: address of the variable in the flash.h address map                       *
+ *  Data: new value                                                                   *
+ *  numberofbytes: Data size in bytes                                                 *
+ *                                                                                    *
+ *  returns: HAL_OK or the HAL error                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static HAL_StatusTypeDef Log_Append(uint32_t Address, const uint8_t *Data, uint16_t numberofbytes)
+{
+	uint32_t record = WriteAddress;
+	uint32_t at = record;
+	uint32_t word;
+	int slot = Log_Slot(Address);
+	int i, j;
+
+	word = (Address - FLASH_LOG_KEY_BASE) | ((uint32_t)numberofbytes << 16);
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, at, word) != HAL_OK) {
+		/*The header may be half programmed, the next write has to collect*/
+		WriteAddress = ActiveSector + FLASH_LOG_SECTOR_SIZE;
+		return HAL_ERROR;
+	}
+	/*From here on a failed record is skipped by the commit word, never overwritten*/
+	WriteAddress = record + Log_Record_Size(numberofbytes);
+	at += 4;
+
+	for (i = 0; i < numberofbytes; i += 4) {
+		word = 0xFFFFFFFF;
+		for (j = 0; j < 4 && i + j < numberofbytes; j++) {
+			word &= ~(0xFFu << (8 * j));
+			word |= (uint32_t)Data[i + j] << (8 * j);
+		}
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, at, word) != HAL_OK) return HAL_ERROR;
+		at += 4;
+	}
+
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, at, FLASH_LOG_COMMIT) != HAL_OK) return HAL_ERROR;
+
+	for (i = 0; slot >= 0 && i < numberofbytes; i++) {
+		LogIndex[slot + i] = record + 4 + i;
+	}
+	LogStats.appends++;
+	return HAL_OK;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Scan                                                                *
+ * --------------------                                                               *
+ * Walks the records of the active sector, rebuilds the index and finds the first    *
+ * free address. A record without commit word (power loss) is skipped                 *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void Log_Scan(void)
+{
+	uint32_t end = ActiveSector + FLASH_LOG_SECTOR_SIZE;
+	uint32_t p = ActiveSector + FLASH_LOG_HEADER_SIZE;
+	uint32_t header, size, key;
+	uint16_t len;
+	int slot, i;
+
+	memset(LogIndex, 0, sizeof(LogIndex));
+
+	while (p + 4 <= end) {
+		header = Log_Read_Word(p);
+		if (header == 0xFFFFFFFF) break;	/*End of the log*/
+
+		key = FLASH_LOG_KEY_BASE + (header & 0xFFFF);
+		len = header >> 16;
+		size = Log_Record_Size(len);
+		if (len == 0 || p + size > end) {
+			/*Corrupted header: nothing can be appended after it, next write collects*/
+			p = end;
+			break;
+		}
+		if (Log_Read_Word(p + size - 4) == FLASH_LOG_COMMIT && Flash_Log_Owns(key, len)) {
+			slot = Log_Slot(key);
+			for (i = 0; i < len; i++) LogIndex[slot + i] = p + 4 + i;
+		}
+		p += size;
+	}
+	WriteAddress = p;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Next_Series                                                         *
+ * --------------------                                                               *
+ * Walks the records of a sector up to the next committed block of the series         *
+ *                                                                                    *
+ *  Sector: FLASH_LOG_SECTOR_A_ADDR or FLASH_LOG_SECTOR_B_ADDR                        *
+ *  End: first free address of the sector                                             *
+ *  Block: data address of the previous block, 0 to start from the first record       *
+ *  numberofbytes: size of the block found                                            *
+ *                                                                                    *
+ *  returns: data address of the block, 0 if there are no more                        *
+ *                                                                                    *
+ **************************************************************************************/
+static uint32_t Log_Next_Series(uint32_t Sector, uint32_t End, uint32_t Block, uint16_t *numberofbytes)
+{
+	uint32_t p = Sector + FLASH_LOG_HEADER_SIZE;
+	uint32_t header, size;
+	uint16_t len;
+
+	if (Block != 0) p = Block - 4 + Log_Record_Size(Log_Read_Word(Block - 4) >> 16);
+
+	while (p + 4 <= End) {
+		header = Log_Read_Word(p);
+		if (header == 0xFFFFFFFF) break;
+
+		len = header >> 16;
+		size = Log_Record_Size(len);
+		if (len == 0 || p + size > End) break;
+		if ((header & 0xFFFF) == FLASH_LOG_SERIES_KEY && Log_Read_Word(p + size - 4) == FLASH_LOG_COMMIT) {
+			*numberofbytes = len;
+			return p + 4;
+		}
+		p += size;
+	}
+	return 0;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Carry_Series                                                        *
+ * --------------------                                                               *
+ * Copies the newest blocks of the series of the old sector (up to                    *
+ * FLASH_LOG_SERIES_KEEP bytes of records) to the end of the active one               *
+ *                                                                                    *
+ *  Sector: sector being collected                                                    *
+ *  End: first free address of that sector                                            *
+ *                                                                                    *
+ *  returns: HAL_OK or the HAL error                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static HAL_StatusTypeDef Log_Carry_Series(uint32_t Sector, uint32_t End)
+{
+	uint32_t block, total = 0;
+	uint16_t len;
+
+	for (block = Log_Next_Series(Sector, End, 0, &len); block != 0; block = Log_Next_Series(Sector, End, block, &len)) {
+		total += Log_Record_Size(len);
+	}
+
+	for (block = Log_Next_Series(Sector, End, 0, &len); block != 0; block = Log_Next_Series(Sector, End, block, &len)) {
+		if (total > FLASH_LOG_SERIES_KEEP) {
+			total -= Log_Record_Size(len);	/*Oldest blocks, dropped*/
+			continue;
+		}
+		if (Log_Append(FLASH_LOG_SERIES_ADDR, (const uint8_t *)block, len) != HAL_OK) return HAL_ERROR;
+	}
+	return HAL_OK;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Format                                                              *
+ * --------------------                                                               *
+ * Erases both sectors and starts a new log in sector A. The current values are       *
+ * imported from the triple redundancy area, so nothing is lost the first time        *
+ *                                                                                    *
+ *  returns: HAL_OK or the HAL error, sector A is only valid after HAL_OK             *
+ *                                                                                    *
+ **************************************************************************************/
+static HAL_StatusTypeDef Log_Format(void)
+{
+	uint8_t state[FLASH_LOG_STATE_SIZE], telemetry[FLASH_LOG_TELEMETRY_SIZE];
+
+	Check_Redundancy(FLASH_LOG_STATE_START, state, sizeof(state));
+	Check_Redundancy(FLASH_LOG_TELEMETRY_START, telemetry, sizeof(telemetry));
+
+	if (Log_Read_Word(FLASH_LOG_SECTOR_A_ADDR) != FLASH_LOG_SECTOR_ERASED) {
+		if (Log_Erase(FLASH_LOG_SECTOR_A_ADDR) != HAL_OK) return HAL_ERROR;
+	}
+	if (Log_Read_Word(FLASH_LOG_SECTOR_B_ADDR) != FLASH_LOG_SECTOR_ERASED) {
+		if (Log_Erase(FLASH_LOG_SECTOR_B_ADDR) != HAL_OK) return HAL_ERROR;
+	}
+
+	ActiveSector = FLASH_LOG_SECTOR_A_ADDR;
+	Generation = 0;
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, ActiveSector, FLASH_LOG_SECTOR_RECEIVING) != HAL_OK) return HAL_ERROR;
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, ActiveSector + 4, Generation) != HAL_OK) return HAL_ERROR;
+
+	WriteAddress = ActiveSector + FLASH_LOG_HEADER_SIZE;
+	if (Log_Append(FLASH_LOG_STATE_START, state, sizeof(state)) != HAL_OK) return HAL_ERROR;
+	if (Log_Append(FLASH_LOG_TELEMETRY_START, telemetry, sizeof(telemetry)) != HAL_OK) return HAL_ERROR;
+
+	/*Only now the sector is valid: a power loss before this point formats again*/
+	return HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, ActiveSector, FLASH_LOG_SECTOR_VALID);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Log_Collect                                                             *
+ * --------------------                                                               *
+ * Garbage collection: copies the latest value of every byte and the newest blocks    *
+ * of the series to the erased sector, appends the new record there, validates it     *
+ * and erases the old one. The old sector stays the active one until the new one is   *
+ * valid: if the copy fails, the index is rebuilt from it and the next write retries  *
+ *                                                                                    *
+ *  Address: address of the variable that did not fit                                 *
+ *  Data: new value                                                                   *
+ *  numberofbytes: Data size in bytes                                                 *
+ *                                                                                    *
+ *  returns: HAL_OK or the HAL error                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static HAL_StatusTypeDef Log_Collect(uint32_t Address, const uint8_t *Data, uint16_t numberofbytes)
+{
+	uint8_t state[FLASH_LOG_STATE_SIZE], telemetry[FLASH_LOG_TELEMETRY_SIZE];
+	uint32_t old = ActiveSector;
+	uint32_t oldEnd = WriteAddress;
+	uint32_t next = Log_Other_Sector(old);
+
+	/*Take the live values before the index starts pointing to the new sector*/
+	Flash_Log_Read(FLASH_LOG_STATE_START, state, sizeof(state));
+	Flash_Log_Read(FLASH_LOG_TELEMETRY_START, telemetry, sizeof(telemetry));
+
+	if (Log_Read_Word(next) != FLASH_LOG_SECTOR_ERASED) {
+		if (Log_Erase(next) != HAL_OK) return HAL_ERROR;
+	}
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, next, FLASH_LOG_SECTOR_RECEIVING) != HAL_OK) return HAL_ERROR;
+	if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, next + 4, Generation + 1) != HAL_OK) return HAL_ERROR;
+
+	WriteAddress = next + FLASH_LOG_HEADER_SIZE;
+	if (Log_Append(FLASH_LOG_STATE_START, state, sizeof(state)) != HAL_OK
+			|| Log_Append(FLASH_LOG_TELEMETRY_START, telemetry, sizeof(telemetry)) != HAL_OK
+			|| Log_Carry_Series(old, oldEnd) != HAL_OK
+			|| Log_Append(Address, Data, numberofbytes) != HAL_OK
+			|| HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, next, FLASH_LOG_SECTOR_VALID) != HAL_OK) {
+		/*The RECEIVING sector is erased again by the next collection or Flash_Log_Init*/
+		Log_Scan();
+		return HAL_ERROR;
+	}
+
+	ActiveSector = next;
+	Generation++;
+	LogStats.collections++;
+
+	/*If the reset comes before this erase, Flash_Log_Init keeps the higher generation*/
+	return Log_Erase(old);
+}
+
+/*Appends a record to the active sector or, if it does not fit, collects garbage*/
+static uint32_t Log_Write(uint32_t Address, uint8_t *Data, uint16_t numberofbytes)
+{
+	HAL_StatusTypeDef status;
+
+	HAL_FLASH_Unlock();
+	if (WriteAddress + Log_Record_Size(numberofbytes) > ActiveSector + FLASH_LOG_SECTOR_SIZE) {
+		status = Log_Collect(Address, Data, numberofbytes);
+	}
+	else {
+		status = Log_Append(Address, Data, numberofbytes);
+	}
+	HAL_FLASH_Lock();
+
+	return (status == HAL_OK) ? 0 : HAL_FLASH_GetError();
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Init                                                          *
+ * --------------------                                                               *
+ * Finds the active sector, finishes an interrupted garbage collection if needed,     *
+ * and rebuilds the RAM index                                                         *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Log_Init(void)
+{
+	uint32_t a = Log_Read_Word(FLASH_LOG_SECTOR_A_ADDR);
+	uint32_t b = Log_Read_Word(FLASH_LOG_SECTOR_B_ADDR);
+	uint32_t genA = Log_Read_Word(FLASH_LOG_SECTOR_A_ADDR + 4);
+	uint32_t genB = Log_Read_Word(FLASH_LOG_SECTOR_B_ADDR + 4);
+
+	HAL_FLASH_Unlock();
+
+	if (a == FLASH_LOG_SECTOR_VALID && b == FLASH_LOG_SECTOR_VALID) {
+		/*Reset between validating the new sector and erasing the old one*/
+		ActiveSector = (genB > genA) ? FLASH_LOG_SECTOR_B_ADDR : FLASH_LOG_SECTOR_A_ADDR;
+		Log_Erase(Log_Other_Sector(ActiveSector));
+	}
+	else if (a == FLASH_LOG_SECTOR_VALID || b == FLASH_LOG_SECTOR_VALID) {
+		ActiveSector = (a == FLASH_LOG_SECTOR_VALID) ? FLASH_LOG_SECTOR_A_ADDR : FLASH_LOG_SECTOR_B_ADDR;
+		/*A RECEIVING sector here is an interrupted garbage collection, the valid one is intact*/
+		if (Log_Read_Word(Log_Other_Sector(ActiveSector)) != FLASH_LOG_SECTOR_ERASED) {
+			Log_Erase(Log_Other_Sector(ActiveSector));
+		}
+	}
+	else if (Log_Format() != HAL_OK) {
+		/*Not ready: the next access formats again*/
+		HAL_FLASH_Lock();
+		LogReady = false;
+		return;
+	}
+	Generation = Log_Read_Word(ActiveSector + 4);
+	Log_Scan();
+
+	HAL_FLASH_Lock();
+	LogReady = true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Owns                                                          *
+ * --------------------                                                               *
+ * Checks if a variable of the address map is stored in the log                       *
+ *                                                                                    *
+ *  Address: first address of the variable                                            *
+ *  numberofbytes: Data size in bytes                                                 *
+ *                                                                                    *
+ *  returns: True if all the bytes belong to the same range of the log                *
+ *                                                                                    *
+ **************************************************************************************/
+bool Flash_Log_Owns(uint32_t Address, uint16_t numberofbytes)
+{
+	int first = Log_Slot(Address);
+	int last = Log_Slot(Address + numberofbytes - 1);
+
+	if (numberofbytes == 0 || first < 0 || last < 0) return false;
+	return (last - first) == (numberofbytes - 1);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Write                                                         *
+ * --------------------                                                               *
+ * Stores a new value by appending a record, without erasing. Writing the value that  *
+ * is already stored does nothing                                                     *
+ *                                                                                    *
+ *  Address: first address of the variable in the flash.h address map                 *
+ *  Data: information to be stored                                                    *
+ *  numberofbytes: Data size in Bytes                                                 *
+ *                                                                                    *
+ *  returns: 0 or error in case it fails                                              *
+ *                                                                                    *
+ **************************************************************************************/
+uint32_t Flash_Log_Write(uint32_t Address, uint8_t *Data, uint16_t numberofbytes)
+{
+	uint8_t current[FLASH_LOG_SLOTS];
+
+	if (!LogReady) {
+		Flash_Log_Init();
+		if (!LogReady) return HAL_FLASH_ERROR_OPERATION;
+	}
+	if (!Flash_Log_Owns(Address, numberofbytes)) return HAL_FLASH_ERROR_OPERATION;
+
+	Flash_Log_Read(Address, current, numberofbytes);
+	if (memcmp(current, Data, numberofbytes) == 0) return 0;
+
+	return Log_Write(Address, Data, numberofbytes);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Append_Series                                                 *
+ * --------------------                                                               *
+ * Appends a block of the housekeeping series after the last record                   *
+ *                                                                                    *
+ *  Block: encoded block (hk_log.h)                                                   *
+ *  numberofbytes: Block size in Bytes                                                *
+ *                                                                                    *
+ *  returns: 0 or error in case it fails                                              *
+ *                                                                                    *
+ **************************************************************************************/
+uint32_t Flash_Log_Append_Series(uint8_t *Block, uint16_t numberofbytes)
+{
+	if (!LogReady) {
+		Flash_Log_Init();
+		if (!LogReady) return HAL_FLASH_ERROR_OPERATION;
+	}
+	if (numberofbytes == 0 || Log_Record_Size(numberofbytes) > FLASH_LOG_SERIES_KEEP) return HAL_FLASH_ERROR_OPERATION;
+
+	return Log_Write(FLASH_LOG_SERIES_ADDR, Block, numberofbytes);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Next_Series                                                   *
+ * --------------------                                                               *
+ * Iterates over the blocks of the series in the active sector, oldest first. The    *
+ * addresses are valid until the next garbage collection (Flash_Log_Get_Generation)   *
+ *                                                                                    *
+ *  Block: address returned by the previous call, 0 for the first block               *
+ *  numberofbytes: size of the block found                                            *
+ *                                                                                    *
+ *  returns: flash address of the block, 0 if there are no more                       *
+ *                                                                                    *
+ **************************************************************************************/
+uint32_t Flash_Log_Next_Series(uint32_t Block, uint16_t *numberofbytes)
+{
+	if (!LogReady) {
+		Flash_Log_Init();
+		if (!LogReady) return 0;
+	}
+	return Log_Next_Series(ActiveSector, WriteAddress, Block, numberofbytes);
+}
+
+uint32_t Flash_Log_Get_Generation(void)
+{
+	return Generation;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Read                                                          *
+ * --------------------                                                               *
+ * Reads the latest value of a variable using the RAM index. A range that is not     *
+ * served by the log (see Flash_Log_Owns) is not read and RxBuf is left as it is      *
+ *                                                                                    *
+ *  Address: first address of the variable in the flash.h address map                 *
+ *  RxBuf: Where the data read from memory will be stored                             *
+ *  numberofbytes: Reading data size in Bytes                                         *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Log_Read(uint32_t Address, uint8_t *RxBuf, uint16_t numberofbytes)
+{
+	int slot = Log_Slot(Address);
+	int i;
+
+	if (!Flash_Log_Owns(Address, numberofbytes)) return;
+	if (!LogReady) Flash_Log_Init();
+
+	for (i = 0; i < numberofbytes; i++) {
+		if (LogIndex[slot + i] != 0) RxBuf[i] = *(__IO uint8_t *)LogIndex[slot + i];
+		else RxBuf[i] = *(__IO uint8_t *)(Address + i);
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Log_Get_Stats                                                     *
+ * --------------------                                                               *
+ * Gives access to the append/erase counters (they can be sent with the telemetry)    *
+ *                                                                                    *
+ *  returns: Pointer to the counters                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+const FlashLogStats *Flash_Log_Get_Stats(void)
+{
+	return &LogStats;
+}
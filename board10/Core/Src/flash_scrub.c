@@ -0,0 +1,143 @@
+/*!
+ * \file      flash_scrub.c
+ *
+ * \brief     Background scrubber of the triple redundancy area. Check_Redundancy
+ * 			  only votes on read, so without it single-event upsets accumulate
+ * 			  until two copies are wrong.
+ *
+ * 			  Each call of Flash_Scrub_Step does a bounded amount of work: either it
+ * 			  votes FLASH_SCRUB_WORDS_PER_STEP words, remembering which copies have
+ * 			  to be fixed, or (at the end of a pass) it repairs one copy. A copy
+ * 			  whose wrong bits are all 1 instead of 0 is programmed over without
+ * 			  erasing, otherwise its sector is rewritten once with all the fixes.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "flash_scrub.h"
+#include "flash.h"
+#include "stm32f4xx_hal.h"
+
+#define SCRUB_WORDS		(FLASH_SCRUB_SIZE / 4)
+
+static uint32_t ScrubCursor = 0;	/*Next word to vote*/
+static uint64_t BadWords[3];		/*Per copy, bit i set => word i must be repaired*/
+static bool RepairPending = false;
+static FlashScrubStats ScrubStats;
+
+static uint32_t Scrub_Read(int copy, uint32_t word)
+{
+	return *(__IO uint32_t *)(FLASH_SCRUB_START + copy * REDUNDANCY_OFFSET + 4 * word);
+}
+
+static uint32_t Scrub_Vote(uint32_t word)
+{
+	uint32_t a = Scrub_Read(0, word), b = Scrub_Read(1, word), c = Scrub_Read(2, word);
+	return (a & b) | (a & c) | (b & c);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Scrub_Repair                                                            *
+ * --------------------                                                               *
+ * Repairs all the wrong words of one copy with a single operation                    *
+ *                                                                                    *
+ *  copy: 0, 1 or 2 (base address + copy * REDUNDANCY_OFFSET)                         *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void Scrub_Repair(int copy)
+{
+	static uint8_t image[FLASH_SCRUB_SIZE];
+	uint32_t base = FLASH_SCRUB_START + copy * REDUNDANCY_OFFSET;
+	bool inplace = true;
+	uint32_t i, vote;
+
+	for (i = 0; i < SCRUB_WORDS; i++) {
+		if (!(BadWords[copy] & ((uint64_t)1 << i))) continue;
+		vote = Scrub_Vote(i);
+		/*Programming can only turn 1s into 0s*/
+		if ((Scrub_Read(copy, i) & vote) != vote) inplace = false;
+	}
+
+	if (inplace) {
+		HAL_FLASH_Unlock();
+		for (i = 0; i < SCRUB_WORDS; i++) {
+			if (BadWords[copy] & ((uint64_t)1 << i)) {
+				HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, base + 4 * i, Scrub_Vote(i));
+			}
+		}
+		HAL_FLASH_Lock();
+		ScrubStats.repairs_inplace++;
+	}
+	else {
+		/*One erase for all the wrong words of this copy*/
+		Check_Redundancy(FLASH_SCRUB_START, image, FLASH_SCRUB_SIZE);
+		Flash_Write_Data(base, image, FLASH_SCRUB_SIZE);
+		ScrubStats.repairs_erase++;
+	}
+	BadWords[copy] = 0;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Scrub_Step                                                        *
+ * --------------------                                                               *
+ * Incremental scrubbing, to be called once per main loop iteration                   *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Flash_Scrub_Step(void)
+{
+	uint32_t a, b, c, vote;
+	int n, copy;
+
+	if (RepairPending) {
+		for (copy = 0; copy < 3; copy++) {
+			if (BadWords[copy] != 0) {
+				Scrub_Repair(copy);
+				return;
+			}
+		}
+		RepairPending = false;
+		ScrubStats.passes++;
+		return;
+	}
+
+	for (n = 0; n < FLASH_SCRUB_WORDS_PER_STEP; n++) {
+		a = Scrub_Read(0, ScrubCursor);
+		b = Scrub_Read(1, ScrubCursor);
+		c = Scrub_Read(2, ScrubCursor);
+		if (a != b || a != c) {
+			vote = (a & b) | (a & c) | (b & c);
+			if (a != vote) BadWords[0] |= (uint64_t)1 << ScrubCursor;
+			if (b != vote) BadWords[1] |= (uint64_t)1 << ScrubCursor;
+			if (c != vote) BadWords[2] |= (uint64_t)1 << ScrubCursor;
+			if (a != b && a != c && b != c) ScrubStats.uncorrectable++;
+			else ScrubStats.corrected++;
+		}
+
+		if (++ScrubCursor == SCRUB_WORDS) {
+			ScrubCursor = 0;
+			RepairPending = true;
+			return;
+		}
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Flash_Scrub_Get_Stats                                                   *
+ * --------------------                                                               *
+ * Gives access to the scrubber counters (they can be sent with the telemetry)        *
+ *                                                                                    *
+ *  returns: Pointer to the counters                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+const FlashScrubStats *Flash_Scrub_Get_Stats(void)
+{
+	return &ScrubStats;
+}
@@ -0,0 +1,26 @@
+/*!
+ * \file      fuel_gauge.c
+ *
+ * \brief     Battery fuel gauge block decoding (see fuel_gauge.h).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "fuel_gauge.h"
+
+#define FUEL_GAUGE_OFFSET(reg)		((reg) - FUEL_GAUGE_BLOCK_START)
+
+/*16-bit register, MSB first*/
+static int16_t FuelGauge_Word(const uint8_t *block, uint8_t reg)
+{
+	return (int16_t)(((uint16_t)block[FUEL_GAUGE_OFFSET(reg)] << 8) | block[FUEL_GAUGE_OFFSET(reg) + 1]);
+}
+
+void FuelGauge_Decode(const uint8_t block[FUEL_GAUGE_BLOCK_SIZE], FuelGaugeRegisters *registers)
+{
+	registers->level = block[FUEL_GAUGE_OFFSET(FUEL_GAUGE_REG_LEVEL)];
+	registers->current = FuelGauge_Word(block, FUEL_GAUGE_REG_CURRENT);
+	registers->temperature = FuelGauge_Word(block, FUEL_GAUGE_REG_TEMPERATURE) >> 5;
+	registers->voltage = FuelGauge_Word(block, FUEL_GAUGE_REG_VOLTAGE) >> 5;
+}
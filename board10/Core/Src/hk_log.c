@@ -0,0 +1,364 @@
+/*!
+ * \file      hk_log.c
+ *
+ * \brief     Time series of the housekeeping sensors (see hk_log.h).
+ *
+ * 			  The header of the open block is kept up to date on every sample, so
+ * 			  it can be downlinked before it is full. The index keeps the first
+ * 			  time and the flash address of every stored block; the addresses
+ * 			  change when the flash log collects garbage, then the index is
+ * 			  rebuilt from the blocks that were carried to the new sector.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hk_log.h"
+#include "flash_log.h"
+#include "stm32f4xx_hal.h"
+#include "string.h"
+
+/*Mask, change of step and the delta of every channel*/
+#define HK_LOG_SAMPLE_MAX		(2 + 5 + 3 * HK_LOG_CHANNELS)
+
+#define HK_LOG_COUNT_OFFSET		4
+#define HK_LOG_FIRST_OFFSET		6
+#define HK_LOG_LAST_OFFSET		10
+#define HK_LOG_VALUES_OFFSET	14
+
+/*Open block*/
+static uint8_t Block[HK_LOG_BLOCK_SIZE];
+static uint16_t Length = 0;			/*0 if there is no open block*/
+static uint16_t Count;
+static int16_t Previous[HK_LOG_CHANNELS];
+static uint32_t PreviousTime;
+static uint32_t PreviousStep;
+
+/*Time of the log: whole seconds, and the tick they were counted up to*/
+static uint32_t Seconds;
+static uint32_t SecondsTick;
+
+/*Stored blocks, oldest first*/
+static uint32_t Times[HK_LOG_INDEX_SIZE];
+static uint32_t Addresses[HK_LOG_INDEX_SIZE];
+static uint16_t Lengths[HK_LOG_INDEX_SIZE];
+static uint16_t Blocks = 0;
+static uint32_t Generation;
+
+static HkLogStats Stats;
+
+static void HkLog_Put16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+}
+
+static void HkLog_Put32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t HkLog_Get32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*Little-endian LEB128, returns the bytes written (at most 5)*/
+static uint8_t HkLog_Varint(uint8_t *buffer, uint32_t value)
+{
+	uint8_t n = 0;
+
+	while (value >= 0x80)
+	{
+		buffer[n++] = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	buffer[n++] = (uint8_t)value;
+	return n;
+}
+
+/*Small magnitudes to small codes, whatever the sign*/
+static uint32_t HkLog_Zigzag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/*Adds a block of the flash log to the index, the oldest one is forgotten if it is full*/
+static void HkLog_Index_Add(uint32_t address, uint16_t length)
+{
+	const uint8_t *block = (const uint8_t *)address;
+
+	if (length < HK_LOG_HEADER_SIZE || block[0] != 'H' || block[1] != 'K' ||
+		block[2] != HK_LOG_VERSION || block[3] != HK_LOG_CHANNELS) return;
+
+	if (Blocks == HK_LOG_INDEX_SIZE)
+	{
+		memmove(&Times[0], &Times[1], (HK_LOG_INDEX_SIZE - 1) * sizeof(Times[0]));
+		memmove(&Addresses[0], &Addresses[1], (HK_LOG_INDEX_SIZE - 1) * sizeof(Addresses[0]));
+		memmove(&Lengths[0], &Lengths[1], (HK_LOG_INDEX_SIZE - 1) * sizeof(Lengths[0]));
+		Blocks--;
+	}
+	Times[Blocks] = HkLog_Get32(&block[HK_LOG_FIRST_OFFSET]);
+	Addresses[Blocks] = address;
+	Lengths[Blocks] = length;
+	Blocks++;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkLog_Index                                                             *
+ * --------------------                                                               *
+ * Brings the index up to date: after a garbage collection it is built again, else    *
+ * only the blocks after the last indexed one are read                                *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void HkLog_Index(void)
+{
+	uint32_t address;
+	uint16_t length;
+
+	if (Generation != Flash_Log_Get_Generation())
+	{
+		Generation = Flash_Log_Get_Generation();
+		Blocks = 0;
+	}
+
+	address = Blocks ? Addresses[Blocks - 1] : 0;
+	while ((address = Flash_Log_Next_Series(address, &length)) != 0)
+	{
+		HkLog_Index_Add(address, length);
+	}
+}
+
+void HkLog_Init(void)
+{
+	Generation = Flash_Log_Get_Generation();
+	Blocks = 0;
+	Length = 0;
+	HkLog_Index();
+
+	/*The time goes on from the last stored sample*/
+	Seconds = Blocks ? HkLog_Get32((const uint8_t *)Addresses[Blocks - 1] + HK_LOG_LAST_OFFSET) + 1 : 0;
+	SecondsTick = HAL_GetTick();
+}
+
+/*Counted from the ticks since the previous call, the ms short of a second are kept
+ *for the next one: the time goes on when the 32-bit tick wraps (49.7 days)*/
+uint32_t HkLog_Time(void)
+{
+	uint32_t seconds = (HAL_GetTick() - SecondsTick) / 1000;
+
+	Seconds += seconds;
+	SecondsTick += seconds * 1000;
+	return Seconds;
+}
+
+/*Opens a block with an absolute sample*/
+static void HkLog_Start(uint32_t time, const int16_t *values)
+{
+	int c;
+
+	Block[0] = 'H';
+	Block[1] = 'K';
+	Block[2] = HK_LOG_VERSION;
+	Block[3] = HK_LOG_CHANNELS;
+	HkLog_Put32(&Block[HK_LOG_FIRST_OFFSET], time);
+	for (c = 0; c < HK_LOG_CHANNELS; c++)
+	{
+		HkLog_Put16(&Block[HK_LOG_VALUES_OFFSET + 2 * c], (uint16_t)values[c]);
+	}
+	Length = HK_LOG_HEADER_SIZE;
+	Count = 0;
+	PreviousStep = 0;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkLog_Encode                                                            *
+ * --------------------                                                               *
+ * Appends a sample to the open block as the changes from the previous one            *
+ *                                                                                    *
+ *  time: time of the sample (s)                                                      *
+ *  values: HK_LOG_CHANNELS values                                                    *
+ *                                                                                    *
+ *  returns: false if it does not fit, the block is not modified                      *
+ *                                                                                    *
+ **************************************************************************************/
+static bool HkLog_Encode(uint32_t time, const int16_t *values)
+{
+	uint8_t sample[HK_LOG_SAMPLE_MAX];
+	uint32_t step = time - PreviousTime;
+	uint32_t mask = 0;
+	uint8_t n;
+	int c;
+
+	if (step != PreviousStep) mask |= 1;
+	for (c = 0; c < HK_LOG_CHANNELS; c++)
+	{
+		if (values[c] != Previous[c]) mask |= 2u << c;
+	}
+
+	n = HkLog_Varint(sample, mask);
+	if (mask & 1) n += HkLog_Varint(&sample[n], HkLog_Zigzag((int32_t)(step - PreviousStep)));
+	for (c = 0; c < HK_LOG_CHANNELS; c++)
+	{
+		if (mask & (2u << c)) n += HkLog_Varint(&sample[n], HkLog_Zigzag((int32_t)values[c] - Previous[c]));
+	}
+
+	if (Length + n > HK_LOG_BLOCK_SIZE) return false;
+	memcpy(&Block[Length], sample, n);
+	Length += n;
+	PreviousStep = step;
+	return true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkLog_Append                                                            *
+ * --------------------                                                               *
+ * Adds a sample at the current time. If it does not fit in the open block, the       *
+ * block is stored and the sample opens the next one                                  *
+ *                                                                                    *
+ *  values: HK_LOG_CHANNELS values, in the order of HkLogChannel                      *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void HkLog_Append(const int16_t *values)
+{
+	uint32_t time = HkLog_Time();
+
+	if (Length != 0 && !HkLog_Encode(time, values)) HkLog_Flush();
+	if (Length == 0) HkLog_Start(time, values);
+
+	Count++;
+	HkLog_Put16(&Block[HK_LOG_COUNT_OFFSET], Count);
+	HkLog_Put32(&Block[HK_LOG_LAST_OFFSET], time);
+	memcpy(Previous, values, sizeof(Previous));
+	PreviousTime = time;
+	Stats.samples++;
+}
+
+void HkLog_Flush(void)
+{
+	if (Length == 0) return;
+
+	if (Flash_Log_Append_Series(Block, Length) == 0)
+	{
+		Stats.blocks++;
+		Stats.bytes += Length;
+	}
+	else
+	{
+		Stats.errors++;
+	}
+	Length = 0;
+	HkLog_Index();
+}
+
+uint16_t HkLog_Blocks(void)
+{
+	HkLog_Index();
+	return Blocks + (Length != 0);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkLog_Find                                                              *
+ * --------------------                                                               *
+ * Binary search of the last block that starts at or before time                      *
+ *                                                                                    *
+ *  time: first time of the range (s)                                                 *
+ *                                                                                    *
+ *  returns: block to start reading from, 0 if time is older than the log             *
+ *                                                                                    *
+ **************************************************************************************/
+uint16_t HkLog_Find(uint32_t time)
+{
+	uint16_t low = 0, high, middle;
+
+	HkLog_Index();
+	if (Length != 0 && HkLog_Get32(&Block[HK_LOG_FIRST_OFFSET]) <= time) return Blocks;
+
+	/*Times[low - 1] <= time < Times[high]*/
+	high = Blocks;
+	while (low < high)
+	{
+		middle = (low + high) / 2;
+		if (Times[middle] <= time) low = middle + 1;
+		else high = middle;
+	}
+	return low ? low - 1 : 0;
+}
+
+/*Data and length of a block, the open one included, NULL if it does not exist*/
+static const uint8_t *HkLog_Block(uint16_t block, uint16_t *length)
+{
+	HkLog_Index();
+	if (block < Blocks)
+	{
+		*length = Lengths[block];
+		return (const uint8_t *)Addresses[block];
+	}
+	if (block == Blocks && Length != 0)
+	{
+		*length = Length;
+		return Block;
+	}
+	return NULL;
+}
+
+uint16_t HkLog_Read_Block(uint16_t block, uint8_t *buffer, uint16_t size)
+{
+	const uint8_t *data;
+	uint16_t length;
+
+	data = HkLog_Block(block, &length);
+	if (data == NULL || length > size) return 0;
+	memcpy(buffer, data, length);
+	return length;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkLog_Read_Fragment                                                     *
+ * --------------------                                                               *
+ * Copies the part of a block that starts at offset and fits in a packet, after the   *
+ * fragment header: first(4) offset(2), bit 15 of offset set on the last fragment.    *
+ * first is the time of the first sample of the block, so the ground joins the        *
+ * fragments of each block even if some of them are lost                              *
+ *                                                                                    *
+ *  block: block number, as HkLog_Read_Block                                          *
+ *  offset: first byte of the block to copy                                           *
+ *  buffer: packet                                                                    *
+ *  size: bytes of the packet                                                         *
+ *                                                                                    *
+ *  returns: bytes written, 0 if the block does not exist or offset is past its end   *
+ *                                                                                    *
+ **************************************************************************************/
+uint16_t HkLog_Read_Fragment(uint16_t block, uint16_t offset, uint8_t *buffer, uint16_t size)
+{
+	const uint8_t *data;
+	uint16_t length, part;
+
+	data = HkLog_Block(block, &length);
+	if (data == NULL || offset >= length || size <= HK_LOG_FRAGMENT_HEADER) return 0;
+
+	part = length - offset;
+	if (part > size - HK_LOG_FRAGMENT_HEADER) part = size - HK_LOG_FRAGMENT_HEADER;
+
+	memcpy(buffer, &data[HK_LOG_FIRST_OFFSET], 4);
+	HkLog_Put16(&buffer[4], offset | (offset + part == length ? HK_LOG_FRAGMENT_LAST : 0));
+	memcpy(&buffer[HK_LOG_FRAGMENT_HEADER], &data[offset], part);
+	return HK_LOG_FRAGMENT_HEADER + part;
+}
+
+const HkLogStats *HkLog_Get_Stats(void)
+{
+	return &Stats;
+}
@@ -0,0 +1,249 @@
+/*!
+ * \file      hk_stats.c
+ *
+ * \brief     Summaries of the housekeeping channels over windows (see hk_stats.h).
+ *
+ * 			  The accumulators keep, for every channel, the sum and the sum of
+ * 			  squares of the differences to the first sample of the window. The
+ * 			  samples are integers, so the sums are exact and the update is two
+ * 			  additions and a 32-bit multiplication; subtracting the first sample
+ * 			  keeps the sums small and avoids the cancellation of the textbook
+ * 			  formula, which is what Welford's running mean is used for with
+ * 			  floating point. The mean and the deviation are only computed when
+ * 			  the window ends.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hk_stats.h"
+#include "telemetry.h"
+#include "string.h"
+
+_Static_assert(HK_STATS_FRAME_SIZE <= TELEMETRY_MAX_SIZE, "A summary frame does not fit in a packet");
+
+typedef struct {
+	int16_t first;			/*Differences are taken to this value*/
+	int16_t min;
+	int16_t max;
+	int64_t sum;			/*Sum of (x - first)*/
+	uint64_t squares;		/*Sum of (x - first)^2*/
+} HkStatsAccumulator;
+
+typedef struct {
+	uint32_t period;
+	uint32_t start;
+	uint32_t count;
+	HkStatsAccumulator channels[HK_LOG_CHANNELS];
+	HkStatsSummary last;
+} HkStatsWindowState;
+
+static HkStatsWindowState Windows[HK_STATS_WINDOWS];
+
+static const uint32_t DefaultPeriods[HK_STATS_WINDOWS] = {
+	HK_STATS_MINUTE_PERIOD, HK_STATS_ORBIT_PERIOD, HK_STATS_DAY_PERIOD,
+};
+
+static void HkStats_Put16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+}
+
+static void HkStats_Put32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+/*Integer square root, rounded down*/
+static uint32_t HkStats_Sqrt(uint64_t value)
+{
+	uint64_t root = 0, bit = (uint64_t)1 << 62;
+
+	while (bit > value) bit >>= 2;
+	while (bit != 0)
+	{
+		if (value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else root >>= 1;
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+/*a / n rounded to the nearest, half away from zero*/
+static int64_t HkStats_Divide(int64_t a, uint32_t n)
+{
+	return (a >= 0) ? (a + n / 2) / n : (a - (int64_t)(n / 2)) / n;
+}
+
+static int16_t HkStats_Saturate(int64_t value)
+{
+	if (value > INT16_MAX) return INT16_MAX;
+	if (value < INT16_MIN) return INT16_MIN;
+	return (int16_t)value;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkStats_Summarize                                                       *
+ * --------------------                                                               *
+ * Computes the summary of one channel from its accumulator. With m = sum / n and     *
+ * r = sum % n, the sum of squares to the mean is squares - m (2 sum - n m) - r^2/n,  *
+ * which never needs more than the range of squares                                   *
+ *                                                                                    *
+ *  acc: accumulator of the channel                                                   *
+ *  n: samples of the window, > 0                                                     *
+ *  summary: where the result is written                                              *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+static void HkStats_Summarize(const HkStatsAccumulator *acc, uint32_t n, HkStatsChannel *summary)
+{
+	int64_t m = acc->sum / (int64_t)n;
+	int64_t r = acc->sum - m * (int64_t)n;
+	uint64_t deviation, variance;
+	uint32_t stddev;
+
+	deviation = acc->squares - (uint64_t)(m * (2 * acc->sum - (int64_t)n * m));
+	deviation -= (uint64_t)(r * r) / n;
+
+	/*variance in 1/256, so its root is in 1/16*/
+	variance = (deviation / n << (2 * HK_STATS_FRACTION)) + ((deviation % n) << (2 * HK_STATS_FRACTION)) / n;
+	stddev = HkStats_Sqrt(variance);
+
+	summary->min = acc->min;
+	summary->max = acc->max;
+	summary->mean = HkStats_Saturate((int64_t)acc->first * (1 << HK_STATS_FRACTION) +
+									 HkStats_Divide(acc->sum * (1 << HK_STATS_FRACTION), n));
+	summary->stddev = (stddev > UINT16_MAX) ? UINT16_MAX : (uint16_t)stddev;
+}
+
+/*Ends a window: keeps its summary and empties the accumulators*/
+static void HkStats_End(HkStatsWindowState *window)
+{
+	int c;
+
+	if (window->count == 0) return;
+	window->last.start = window->start;
+	window->last.count = window->count;
+	for (c = 0; c < HK_LOG_CHANNELS; c++)
+	{
+		HkStats_Summarize(&window->channels[c], window->count, &window->last.channels[c]);
+	}
+	window->count = 0;
+}
+
+void HkStats_Init(void)
+{
+	uint8_t w;
+
+	memset(Windows, 0, sizeof(Windows));
+	for (w = 0; w < HK_STATS_WINDOWS; w++) Windows[w].period = DefaultPeriods[w];
+}
+
+void HkStats_Set_Period(uint8_t window, uint32_t period)
+{
+	if (window >= HK_STATS_WINDOWS || period == 0) return;
+	Windows[window].period = period;
+	Windows[window].count = 0;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  HkStats_Add                                                             *
+ * --------------------                                                               *
+ * Adds a sample to the accumulators of every window. A window whose period is over   *
+ * is summarized first, and the sample opens the next one                             *
+ *                                                                                    *
+ *  values: HK_LOG_CHANNELS values, in the order of HkLogChannel                      *
+ *  time: log time of the sample (s)                                                  *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void HkStats_Add(const int16_t *values, uint32_t time)
+{
+	HkStatsWindowState *window;
+	HkStatsAccumulator *acc;
+	int32_t d;
+	uint8_t w;
+	int c;
+
+	for (w = 0; w < HK_STATS_WINDOWS; w++)
+	{
+		window = &Windows[w];
+		if (window->count != 0 && time - window->start >= window->period) HkStats_End(window);
+
+		if (window->count == 0)
+		{
+			window->start = time - time % window->period;
+			for (c = 0; c < HK_LOG_CHANNELS; c++)
+			{
+				acc = &window->channels[c];
+				acc->first = values[c];
+				acc->min = values[c];
+				acc->max = values[c];
+				acc->sum = 0;
+				acc->squares = 0;
+			}
+		}
+		else
+		{
+			for (c = 0; c < HK_LOG_CHANNELS; c++)
+			{
+				acc = &window->channels[c];
+				d = (int32_t)values[c] - acc->first;
+				acc->sum += d;
+				acc->squares += (uint32_t)d * (uint32_t)d;	/*|d| < 2^16, the square fits*/
+				if (values[c] < acc->min) acc->min = values[c];
+				if (values[c] > acc->max) acc->max = values[c];
+			}
+		}
+		window->count++;
+	}
+}
+
+const HkStatsSummary *HkStats_Get_Summary(uint8_t window)
+{
+	if (window >= HK_STATS_WINDOWS) return NULL;
+	return &Windows[window].last;
+}
+
+uint16_t HkStats_Frame(uint8_t window, uint8_t part, uint8_t *buffer, uint16_t size)
+{
+	const HkStatsSummary *summary = HkStats_Get_Summary(window);
+	uint8_t *p = buffer;
+	uint8_t first = part * HK_STATS_FRAME_CHANNELS, channels;
+	int c;
+
+	if (summary == NULL || summary->count == 0 || part >= HK_STATS_FRAMES) return 0;
+	channels = HK_LOG_CHANNELS - first < HK_STATS_FRAME_CHANNELS ? HK_LOG_CHANNELS - first : HK_STATS_FRAME_CHANNELS;
+	if (size < 14 + 8 * channels) return 0;
+
+	*p++ = 'H';
+	*p++ = 'S';
+	*p++ = HK_STATS_VERSION;
+	*p++ = window;
+	*p++ = first;
+	*p++ = channels;
+	HkStats_Put32(p, summary->start);
+	HkStats_Put32(p + 4, summary->count);
+	p += 8;
+	for (c = first; c < first + channels; c++)
+	{
+		HkStats_Put16(p, (uint16_t)summary->channels[c].min);
+		HkStats_Put16(p + 2, (uint16_t)summary->channels[c].max);
+		HkStats_Put16(p + 4, (uint16_t)summary->channels[c].mean);
+		HkStats_Put16(p + 6, summary->channels[c].stddev);
+		p += 8;
+	}
+	return p - buffer;
+}
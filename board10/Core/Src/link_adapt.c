@@ -0,0 +1,161 @@
+/*!
+ * \file      link_adapt.c
+ *
+ * \brief     Closed-loop SF / CR adaptation of the downlink (see link_adapt.h).
+ *
+ * 			  The averages are kept with 4 fractional bits, so a 1/8 EWMA does not
+ * 			  lose the small variations that the integer running means of the old
+ * 			  OnRxDone did.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "link_adapt.h"
+#include "lora_toa.h"
+#include "flash.h"
+
+#define LINK_ADAPT_FRACTION		16
+
+static LinkAdaptApply Apply = 0;
+static LinkAdaptStats Stats;
+static int32_t SnrAcc;		/*dB x 10 x LINK_ADAPT_FRACTION*/
+static int32_t RssiAcc;		/*dBm x LINK_ADAPT_FRACTION*/
+static uint8_t Hold;		/*Windows since the last change*/
+
+/*LINK_SF_ADDR keeps 7..12, LINK_CR_ADDR keeps 0..3 for 4/5..4/8 like CRC_ADDR*/
+static void LinkAdapt_Save(void)
+{
+	uint8_t cr = Stats.CodingRate - LINK_ADAPT_CR_MIN;
+
+	Write_Flash(LINK_SF_ADDR, &Stats.SpreadingFactor, 1);
+	Write_Flash(LINK_CR_ADDR, &cr, 1);
+}
+
+/*Takes and applies sf and cr (0..3), erased or corrupted values fall back to the comms.h defaults*/
+static void LinkAdapt_Set(uint8_t sf, uint8_t cr)
+{
+	if (sf < LORA_TOA_SF_MIN || sf > LORA_TOA_SF_MAX) sf = LINK_ADAPT_SF_DEFAULT;
+	if (cr > LINK_ADAPT_CR_MAX - LINK_ADAPT_CR_MIN) cr = 0;
+
+	Stats.SpreadingFactor = sf;
+	Stats.CodingRate = cr + LINK_ADAPT_CR_MIN;
+	Hold = 0;
+	if (Apply) Apply(Stats.SpreadingFactor, Stats.CodingRate);
+}
+
+void LinkAdapt_Init(LinkAdaptApply apply)
+{
+	uint8_t sf, cr;
+
+	Apply = apply;
+	Stats.Samples = 0;
+	Stats.Changes = 0;
+
+	Read_Flash(LINK_SF_ADDR, &sf, 1);
+	Read_Flash(LINK_CR_ADDR, &cr, 1);
+	if (sf < LORA_TOA_SF_MIN || sf > LORA_TOA_SF_MAX)
+	{
+		LinkAdapt_Load();	/*Nothing chosen yet*/
+		return;
+	}
+	LinkAdapt_Set(sf, cr);
+}
+
+void LinkAdapt_Load(void)
+{
+	uint8_t sf, cr;
+
+	Read_Flash(SF_ADDR, &sf, 1);
+	Read_Flash(CRC_ADDR, &cr, 1);
+	LinkAdapt_Set(sf, cr);
+	LinkAdapt_Save();
+}
+
+void LinkAdapt_Rx(int16_t rssi, int8_t snr)
+{
+	int32_t snrSample = snr * 10 * LINK_ADAPT_FRACTION;
+	int32_t rssiSample = rssi * LINK_ADAPT_FRACTION;
+
+	if (Stats.Samples == 0)
+	{
+		SnrAcc = snrSample;
+		RssiAcc = rssiSample;
+	}
+	else
+	{
+		SnrAcc += (snrSample - SnrAcc) / LINK_ADAPT_EWMA_N;
+		RssiAcc += (rssiSample - RssiAcc) / LINK_ADAPT_EWMA_N;
+	}
+	Stats.Samples++;
+	Stats.Snr = SnrAcc / LINK_ADAPT_FRACTION;
+	Stats.Rssi = RssiAcc / LINK_ADAPT_FRACTION;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  LinkAdapt_Window                                                        *
+ * --------------------                                                               *
+ * Decides the setting of the next window. The SF goes slower (as many steps as      *
+ * needed) as soon as the SNR falls below limit(SF) + margin, and one step faster     *
+ * only if the SNR is over limit(SF - 1) + margin + hysteresis and nothing changed    *
+ * in the last windows.                                                               *
+ * The CR follows the same rule with the packet loss of the window.                   *
+ *                                                                                    *
+ *  sent: new packets sent in the window                                              *
+ *  lost: packets of the window that were not acknowledged                            *
+ *                                                                                    *
+ *  returns: true if the SF or the CR changed (already applied and saved)             *
+ *                                                                                    *
+ **************************************************************************************/
+bool LinkAdapt_Window(uint16_t sent, uint16_t lost)
+{
+	uint8_t sf = Stats.SpreadingFactor;
+	uint8_t cr = Stats.CodingRate;
+	uint32_t loss = sent ? (uint32_t)lost * 100 / sent : 0;
+	bool settled;
+
+	if (Hold < 0xFF) Hold++;
+	settled = Hold > LINK_ADAPT_HOLD;
+
+	if (Stats.Samples > 0)
+	{
+		if (Stats.Snr < LoraToa_Snr_Limit(sf) + LINK_ADAPT_MARGIN)
+		{
+			/*As many steps as needed, the link is being lost*/
+			while (sf < LORA_TOA_SF_MAX && Stats.Snr < LoraToa_Snr_Limit(sf) + LINK_ADAPT_MARGIN) sf++;
+		}
+		else if (settled && sf > LORA_TOA_SF_MIN &&
+				 Stats.Snr >= LoraToa_Snr_Limit(sf - 1) + LINK_ADAPT_MARGIN + LINK_ADAPT_HYSTERESIS)
+		{
+			sf--;
+		}
+	}
+
+	if (sent > 0)
+	{
+		if (loss > LINK_ADAPT_LOSS_HIGH)
+		{
+			if (cr < LINK_ADAPT_CR_MAX) cr++;
+		}
+		else if (settled && loss < LINK_ADAPT_LOSS_LOW && cr > LINK_ADAPT_CR_MIN)
+		{
+			cr--;
+		}
+	}
+
+	if (sf == Stats.SpreadingFactor && cr == Stats.CodingRate) return false;
+
+	Stats.SpreadingFactor = sf;
+	Stats.CodingRate = cr;
+	Stats.Changes++;
+	Hold = 0;
+	LinkAdapt_Save();
+	if (Apply) Apply(sf, cr);
+	return true;
+}
+
+const LinkAdaptStats *LinkAdapt_Get_Stats(void)
+{
+	return &Stats;
+}
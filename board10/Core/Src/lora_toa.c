@@ -0,0 +1,141 @@
+/*!
+ * \file      lora_toa.c
+ *
+ * \brief     Integer LoRa time-on-air and pass capacity (see lora_toa.h).
+ *
+ * 			  Ts = 2^SF / BW is 8, 4 or 2 us times 2^SF for 125, 250 and 500 kHz,
+ * 			  and the preamble adds 4.25 symbols, so every term of the SX126x
+ * 			  formula is an exact number of microseconds:
+ * 			    T = (Npreamble + 4.25) Ts + (8 + max(ceil(num / den) CRn, 0)) Ts
+ * 			    num = 8 PL - 4 SF + 28 + 16 CRC - 20 IH,  den = 4 (SF - 2 DE)
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "lora_toa.h"
+
+/*Demodulation SNR limit (dB x 10) of SF7..SF12 (SX1261/2 datasheet)*/
+static const int16_t SnrLimit[LORA_TOA_SF_MAX - LORA_TOA_SF_MIN + 1] = {
+	-75, -100, -125, -150, -175, -200
+};
+
+uint32_t LoraToa_Symbol_Us(uint8_t SpreadingFactor, uint8_t Bandwidth)
+{
+	if (SpreadingFactor < LORA_TOA_SF_MIN || SpreadingFactor > LORA_TOA_SF_MAX) return 0;
+	if (Bandwidth < LORA_TOA_BW_MIN || Bandwidth > LORA_TOA_BW_MAX) return 0;
+
+	/*LORA_BW_125 = 4 -> 8 us, LORA_BW_250 = 5 -> 4 us, LORA_BW_500 = 6 -> 2 us*/
+	return (1UL << SpreadingFactor) << (7 - Bandwidth);
+}
+
+uint32_t LoraToa_Compute_Us(const LoraToaParams *params, uint8_t pktLen)
+{
+	uint32_t ts = LoraToa_Symbol_Us(params->SpreadingFactor, params->Bandwidth);
+	int32_t num = 8 * pktLen - 4 * params->SpreadingFactor + 28 + (params->Crc ? 16 : 0) -
+				  (params->FixedLength ? 20 : 0);
+	int32_t den = 4 * (params->SpreadingFactor - (params->LowDatarateOptimize ? 2 : 0));
+	uint32_t symbols = 8;
+
+	if (ts == 0 || params->CodingRate < 1 || params->CodingRate > 4) return 0;
+
+	if (num > 0)
+	{
+		symbols += (num + den - 1) / den * (params->CodingRate + 4);
+	}
+	/*(Npreamble + 4.25) Ts, Ts is a multiple of 4 us*/
+	return (4 * params->PreambleLength + 17) * (ts / 4) + symbols * ts;
+}
+
+uint32_t LoraToa_Compute(const LoraToaParams *params, uint8_t pktLen)
+{
+	return (LoraToa_Compute_Us(params, pktLen) + 999) / 1000;
+}
+
+void LoraToa_Init(LoraToa *toa, const LoraToaParams *params)
+{
+	int len;
+
+	toa->Params = *params;
+	for (len = 0; len <= LORA_TOA_MAX_LENGTH; len++)
+	{
+		toa->Table[len] = LoraToa_Compute(params, len);
+	}
+}
+
+uint16_t LoraToa_Get(const LoraToa *toa, uint8_t pktLen)
+{
+	return toa->Table[pktLen];
+}
+
+uint32_t LoraToa_Throughput(const LoraToaParams *params, uint8_t pktLen, uint8_t payload)
+{
+	uint32_t us = LoraToa_Compute_Us(params, pktLen);
+
+	if (us == 0) return 0;
+	return (uint64_t)payload * 1000000 / us;
+}
+
+uint32_t LoraToa_Pass_Capacity(const LoraToaParams *params, uint8_t pktLen, uint8_t payload,
+							   uint32_t passMs, uint32_t gapMs)
+{
+	uint32_t toa = LoraToa_Compute(params, pktLen);
+
+	if (toa == 0) return 0;
+	return passMs / (toa + gapMs) * payload;
+}
+
+int16_t LoraToa_Snr_Limit(uint8_t SpreadingFactor)
+{
+	if (SpreadingFactor < LORA_TOA_SF_MIN) SpreadingFactor = LORA_TOA_SF_MIN;
+	if (SpreadingFactor > LORA_TOA_SF_MAX) SpreadingFactor = LORA_TOA_SF_MAX;
+	return SnrLimit[SpreadingFactor - LORA_TOA_SF_MIN];
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  LoraToa_Best_SF                                                         *
+ * --------------------                                                               *
+ * Goes through SF7..SF12 and keeps the one with the highest pass capacity among the  *
+ * ones whose demodulation limit plus margin is below the expected SNR. The low data  *
+ * rate optimize is set as the radio driver does (symbols of 16.384 ms or longer)     *
+ *                                                                                    *
+ *  params: bandwidth, coding rate and packet parameters, the SF is written back      *
+ *  pktLen: bytes of every packet                                                     *
+ *  payload: useful bytes of every packet                                             *
+ *  passMs: duration of the pass                                                      *
+ *  gapMs: time between packets (turnaround, ACKs)                                    *
+ *  snr: expected SNR (dB x 10)                                                       *
+ *  margin: link margin required (dB x 10)                                            *
+ *                                                                                    *
+ *  returns: best spreading factor or 0 if the link does not close                    *
+ *                                                                                    *
+ **************************************************************************************/
+uint8_t LoraToa_Best_SF(LoraToaParams *params, uint8_t pktLen, uint8_t payload, uint32_t passMs,
+						uint32_t gapMs, int16_t snr, int16_t margin)
+{
+	LoraToaParams candidate = *params;
+	uint32_t capacity, best = 0;
+	uint8_t sf, bestSF = 0;
+
+	for (sf = LORA_TOA_SF_MIN; sf <= LORA_TOA_SF_MAX; sf++)
+	{
+		if (snr < LoraToa_Snr_Limit(sf) + margin) continue;
+
+		candidate.SpreadingFactor = sf;
+		candidate.LowDatarateOptimize = LoraToa_Symbol_Us(sf, candidate.Bandwidth) >= LORA_TOA_LDRO_SYMBOL_US;
+		capacity = LoraToa_Pass_Capacity(&candidate, pktLen, payload, passMs, gapMs);
+		if (capacity > best)
+		{
+			best = capacity;
+			bestSF = sf;
+		}
+	}
+
+	if (bestSF != 0)
+	{
+		params->SpreadingFactor = bestSF;
+		params->LowDatarateOptimize = LoraToa_Symbol_Us(bestSF, params->Bandwidth) >= LORA_TOA_LDRO_SYMBOL_US;
+	}
+	return bestSF;
+}
@@ -68,6 +68,196 @@ static void MX_USB_OTG_FS_HCD_Init(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+static bool systemOk = true; /*Result of the last system_state(), updated by the health task*/
+static uint8_t lastState; /*State of the previous run, the flash variables are written back when it changes*/
+
+/*Batteries and temperatures, once per period instead of twice per loop iteration*/
+static void Health_Task(void)
+{
+	systemOk = system_state(&hi2c1);
+	if (!systemOk && (currentState == IDLE || currentState == COMMS || currentState == PAYLOAD))
+	{
+		currentState = CONTINGENCY;
+		Scheduler_Post(SCHEDULER_EVENT_STATE);
+	}
+}
+
+/*One step of the state machine, periodically or when a transition is posted*/
+static void State_Task(void)
+{
+	bool payload_state; //bool which indicates when do we need to go to PAYLOAD state
+	bool comms_state; //bool which indicates if we are in region of contact with GS, then go to COMMS state
+
+	switch (currentState)
+	{
+
+	case IDLE:
+		/* State that periodically checks the satellite general state (batteries,
+		 * temperatures, voltages...
+		 * From this state the satellite can go to PAYLOAD when a telecommand to
+		 * take data is received, to COMMS when we are in range of contact with GS
+		 * or to contingency if systemstate() returns false */
+		if(!systemOk) currentState = CONTINGENCY;
+		else {
+			check_position();
+			Read_Flash(PAYLOAD_STATE_ADDR, &payload_state, 1);
+			Read_Flash(COMMS_STATE_ADDR, &comms_state, 1);
+			if(comms_state)	currentState = COMMS;	/*comms becomes true when we are in range of contact with GS*/
+			else if(payload_state) currentState = PAYLOAD; /*payload becomes true if a telecommand to acquire data is received*/
+			Write_Flash(PREVIOUS_STATE_ADDR, IDLE, 1);
+		}
+		break;
+	case COMMS:	// This might refer ONLY refer to TX!!!
+		//configuration();
+		/* check if the picture or spectrogram has to be sent and send it if needed */
+		if(!systemOk) currentState = CONTINGENCY;
+		//else if(comms_state) telecommand(); 	        /* function that receives orders from "COMMS" */
+		//else if(comms_timer_state) sendtelemetry(); /* loop that sends the telemetry data to "COMMS" */
+		else currentState = IDLE;
+		Write_Flash(PREVIOUS_STATE_ADDR, COMMS, 1);
+		break;
+	case PAYLOAD:
+		/* The idea of this state is to modify the coils' current in each iteration
+		 * (when payload_state is true), and once the PQ reaches the final position
+		 * in which the photo will be taken, try to maintain the position until it
+		 * is the correct moment to take the photo
+		 * The code is commented because most variables were not defined and gave
+		 * errors, do not think it's a wrong code! */
+//		Read_Flash(PL_TIME_ADDR, &payload_time, 4); //Read from memory the time to use the payload
+//		if(payload_time - /*¿¿*/RCC/*??*/ < threshold) {
+//			rotatePhoto();
+//			if(payload_time - /*¿¿*/RCC/*??*/ < small_threshold) {
+//				startPhoto(&huart1); //Taken by the camera task
+//				resetCommsParams();
+//				Write_Flash(PAYLOAD_STATE_ADDR, FALSE, 1);
+//			}
+//		}
+
+		/*If that checks if the clock's time has passed the Payload time*/
+//		if(/*¿¿*/RCC/*??*/ > payload_time) {
+//			Write_Flash(PAYLOAD_STATE_ADDR, FALSE, 1);
+//		}
+
+		currentState = IDLE;
+		if(!systemOk) currentState = CONTINGENCY;
+		Write_Flash(PREVIOUS_STATE_ADDR, PAYLOAD, 1);
+		break;
+
+	case CONTINGENCY:
+		/*Turn STM32 to Stop Mode or Standby Mode
+		 *Loop to check at what batterylevel are we
+		 *Out of CONTINGENCY State when batterylevel is NOMINAL
+		 *while(checkbatteries() /= NOMINAL){
+		 *}
+		 *Return to Run Mode*/
+		 currentState = IDLE;
+		 Write_Flash(PREVIOUS_STATE_ADDR, CONTINGENCY, 1);
+		 //Una opció és fer reset total del satelit quan surti de contingency
+		break;
+
+	case SUNSAFE:
+		Write_Flash(PREVIOUS_STATE_ADDR, SUNSAFE, 1);
+		break;
+
+	case SURVIVAL:
+		Write_Flash(PREVIOUS_STATE_ADDR, SURVIVAL, 1);
+		break;
+
+	case INIT:
+		init(&hi2c1);
+		Write_Flash(PREVIOUS_STATE_ADDR, INIT, 1);
+		break;
+	/*If we reach this state something has gone wrong*/
+	default:
+		/*REBOOT THE SYSTEM*/
+		break;
+	}
+
+	/*Write back the RAM copy of the flash variables on a state change. The new state
+	 *runs right away, except IDLE that waits for its period (COMMS always returns to it)*/
+	if (currentState != lastState)
+	{
+		Flash_Cache_Flush();
+		if (currentState != IDLE) Scheduler_Post(SCHEDULER_EVENT_STATE);
+	}
+	lastState = currentState;
+}
+
+/*Temperatures, voltages and currents: starts an I2C epoch, publishes it when it ends*/
+static void Sensors_Task(void)
+{
+	sensorReadings(&hi2c1);
+}
+
+/*Periodic write-back of the flash variables and scrubbing of the redundant copies*/
+static void Flash_Task(void)
+{
+	Flash_Cache_Poll();
+	Flash_Scrub_Step(); /*Votes a few redundant words or repairs one copy*/
+}
+
+/*The SX126x driver (radio.c, sx126x.c) and comms.c are commented out: the radio is only
+ *started when OBC_RADIO is defined, once they are built again. comms.c owns the handlers
+ *of the events (RadioEvents), the radio task dispatches them*/
+#ifdef OBC_RADIO
+/*Modulation chosen by link_adapt.c, the rest of the TX configuration as configuration() of comms.c*/
+static void Radio_Apply_Link(uint8_t SpreadingFactor, uint8_t CodingRate)
+{
+	Radio.SetTxConfig(MODEM_LORA, TX_OUTPUT_POWER, 0, LORA_BANDWIDTH,
+					  SpreadingFactor, CodingRate,
+					  LORA_PREAMBLE_LENGTH, LORA_FIX_LENGTH_PAYLOAD_ON,
+					  true, 0, 0, LORA_IQ_INVERSION_ON, TX_TIMEOUT_VALUE);
+}
+
+/*Payload and signal of the packet received, for RxDone*/
+static void Radio_Get_Payload(uint8_t *buffer, uint8_t *size, int16_t *rssi, int8_t *snr)
+{
+	PacketStatus_t status;
+
+	SX126xGetPayload(buffer, size, RADIO_IRQ_PAYLOAD_SIZE);
+	SX126xGetPacketStatus(&status);
+	*rssi = status.Params.LoRa.SignalRssiPkt;
+	*snr = status.Params.LoRa.SnrPkt;
+}
+
+/*An RX_TX_TIMEOUT is a TX timeout while transmitting*/
+static bool Radio_Is_Transmitting(void)
+{
+	return SX126xGetOperatingMode() == MODE_TX;
+}
+
+static const RadioIrqOps radioOps = {
+	SX126xGetIrqStatus, SX126xClearIrqStatus, Radio_Get_Payload, Radio_Is_Transmitting
+};
+#endif
+
+/*Events of the camera UART, from the interrupt*/
+static void Camera_Event(CameraUartEvent event)
+{
+	(void)event;
+	Scheduler_Post(SCHEDULER_EVENT_CAMERA);
+}
+
+/*Photo started by startPhoto: goes on on every answer of the camera, the period checks the timeouts*/
+static void Camera_Task(void)
+{
+	photoStep();
+}
+
+static void Radio_Task(void)
+{
+	RadioIrq_Dispatch();
+}
+
+/*Tasks of the scheduler: name, function, period (ms), deadline (ms), events, priority*/
+static const SchedulerTask tasks[] = {
+	{ "radio",	Radio_Task,		0,		5,	SCHEDULER_EVENT_RADIO,	0 },
+	{ "health",	Health_Task,	1000,	0,	0,						1 },
+	{ "sensors",Sensors_Task,	1000,	0,	SCHEDULER_EVENT_SENSORS,2 },
+	{ "state",	State_Task,		1000,	0,	SCHEDULER_EVENT_STATE,	3 },
+	{ "flash",	Flash_Task,		10,		0,	0,						4 },
+	{ "camera",	Camera_Task,	10,		0,	SCHEDULER_EVENT_CAMERA,	5 },
+};
 
 /* USER CODE END 0 */
 
@@ -88,10 +278,6 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-  pthread_t thread_comms;
-  uint8_t payload_time[4];
-  bool payload_state; //bool which indicates when do we need to go to PAYLOAD state
-  bool comms_state; //bool which indicates if we are in region of contact with GS, then go to COMMS state
 
   /* USER CODE END Init */
 
@@ -110,116 +296,32 @@ int main(void)
   MX_I2C1_Init();
   MX_USB_OTG_FS_HCD_Init();
   /* USER CODE BEGIN 2 */
-
+  Flash_Log_Init(); /*Rebuilds the RAM index of the state/telemetry log*/
+  Flash_Cache_Init(); /*Loads the RAM copy of the flash.h address map*/
+  HkLog_Init(); /*Indexes the blocks of the housekeeping series and continues its time*/
+  HkStats_Init(); /*Minute, orbit and day summaries of the housekeeping*/
+  CameraUart_Init(&huart1, Camera_Event); /*Starts the interrupt reception of the camera, its events release the camera task*/
+  sensorReadingsInit(&hi2c1); /*Register reads of the sensors, by interrupt*/
+#ifdef OBC_RADIO
+  configuration(); /*comms.c: Radio.Init with RadioEvents, SX126x in standby, DIO1 posted to radio_irq.c*/
+  RadioIrq_Init(&radioOps, &RadioEvents); /*The radio task calls the handlers of the events*/
+  LinkAdapt_Init(Radio_Apply_Link); /*Last SF and CR of the downlink (flash log), applied to the radio*/
+#else
+  LinkAdapt_Init(NULL); /*Last SF and CR of the downlink, for the telemetry only*/
+#endif
+  lastState = currentState;
+
+  Trace_Init(); /*Cycle counter and ring of the probes (trace.h)*/
+  Scheduler_Init();
+  for (uint8_t i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++) Scheduler_Add(&tasks[i]);
+  Scheduler_Post(SCHEDULER_EVENT_STATE); /*First step of the state machine (INIT) without waiting*/
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-		system_state(&hi2c1);
-		switch (currentState)
-		{
-
-		case IDLE:
-			/* State that periodically checks the satellite general state (batteries,
-			 * temperatures, voltages...
-			 * From this state the satellite can go to PAYLOAD when a telecommand to
-			 * take data is received, to COMMS when we are in range of contact with GS
-			 * or to contingency if systemstate() returns false */
-			if(!system_state(&hi2c1)) currentState = CONTINGENCY;
-			else {
-				check_position();
-				Read_Flash(PAYLOAD_STATE_ADDR, &payload_state, 1);
-				Read_Flash(COMMS_STATE_ADDR, &comms_state, 1);
-				if(comms_state)	currentState = COMMS;	/*comms becomes true when we are in range of contact with GS*/
-				else if(payload_state) currentState = PAYLOAD; /*payload becomes true if a telecommand to acquire data is received*/
-				sensorReadings(&hi2c1); /*Updates the values of temperatures, voltages and currents*/
-				Write_Flash(PREVIOUS_STATE_ADDR, IDLE, 1);
-			}
-			break;
-		case COMMS:	// This might refer ONLY refer to TX!!!
-			//configuration();
-			//pthread_create(&thread_comms, NULL, stateMachine(), NULL);
-
-
-
-
-
-			/* check if the picture or spectrogram has to be sent and send it if needed */
-			if(!system_state(&hi2c1)) currentState = CONTINGENCY;
-			else if(comms_state); //telecommand(); 	        /* function that receives orders from "COMMS" */
-			//else if(comms_timer_state) sendtelemetry(); /* loop that sends the telemetry data to "COMMS" */
-			//comms_state = false;
-			currentState = IDLE;
-			Write_Flash(PREVIOUS_STATE_ADDR, COMMS, 1);
-			break;
-		case PAYLOAD:
-			/* The idea of this state is to modify the coils' current in each iteration
-			 * (when payload_state is true), and once the PQ reaches the final position
-			 * in which the photo will be taken, try to maintain the position until it
-			 * is the correct moment to take the photo
-			 * The code is commented because most variables were not defined and gave
-			 * errors, do not think it's a wrong code! */
-//			Read_Flash(PL_TIME_ADDR, &payload_time, 4); //Read from memory the time to use the payload
-//			if(payload_time - /*¿¿*/RCC/*??*/ < threshold) {
-//				rotatePhoto();
-//				if(payload_time - /*¿¿*/RCC/*??*/ < small_threshold) {
-//					takePhoto();
-//					resetCommsParams();
-//					Write_Flash(PAYLOAD_STATE_ADDR, FALSE, 1);
-//				}
-//			}
-
-			/*If that checks if the clock's time has passed the Payload time*/
-//			if(/*¿¿*/RCC/*??*/ > payload_time) {
-//				Write_Flash(PAYLOAD_STATE_ADDR, FALSE, 1);
-//			}
-
-			currentState = IDLE;
-			if(!system_state(&hi2c1)) currentState = CONTINGENCY;
-			Write_Flash(PREVIOUS_STATE_ADDR, PAYLOAD, 1);
-			break;
-
-		case CONTINGENCY:
-			/*Turn STM32 to Stop Mode or Standby Mode
-			 *Loop to check at what batterylevel are we
-			 *Out of CONTINGENCY State when batterylevel is NOMINAL
-			 //while(checkbatteries() /= NOMINAL){
-			 //}
-			 /*Return to Run Mode*/
-			 currentState = IDLE;
-			 Write_Flash(PREVIOUS_STATE_ADDR, CONTINGENCY, 1);
-			 //Una opció és fer reset total del satelit quan surti de contingency
-			break;
-
-		case SUNSAFE:
-			Write_Flash(PREVIOUS_STATE_ADDR, SUNSAFE, 1);
-			break;
-
-		case SURVIVAL:
-			Write_Flash(PREVIOUS_STATE_ADDR, SURVIVAL, 1);
-			break;
-
-		case INIT:
-			init(&hi2c1);
-			Write_Flash(PREVIOUS_STATE_ADDR, INIT, 1);
-			break;
-		/*If we reach this state something has gone wrong*/
-		default:
-			/*REBOOT THE SYSTEM*/
-			break;
-		}
-
-
-		/*Start a TIMER*/
-
-//	    return 0;
-
-		//todo variable que conti ticks rellotge per fer reset
-
-
-
+		Scheduler_Run(); /*Runs the tasks, never returns*/
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -7,43 +7,66 @@
 
 #include <payload_camera.h>
 #include <flash.h>
+#include "trace.h"
 
 //VARIABLES
 uint8_t dataBuffer[201], bufferLength;
 uint32_t frameLength;
-uint16_t framePointer;
+uint32_t framePointer;
 
 uint8_t commInit[2] = {0x56, 0x00};
 uint8_t commCapture = 0x36;
-uint32_t bSize = 128;
+uint32_t bSize = CAMERA_CHUNK_MAX;
+CameraDownloadStats downloadStats;
 
 //COMANDOS
 uint8_t captureImageCmd[] = {0x01, 0x00};
 uint8_t stopCaptureCmd[] = {0x01, 0x03};
 uint8_t setCompressibilityCmd[] = {0x05, 0x01, 0x01, 0x12, 0x04, 0x00};
 uint8_t setResolutionCmd[] = {0x05, 0x04, 0x01, 0x00, 0x19, 0x00};
+uint8_t getFrameLengthCmd[] = {0x01, 0x00};
+
+//PHOTO TAKEN BY photoStep
+static UART_HandleTypeDef *photoHuart;
+static CameraPhotoState photoState = CAMERA_PHOTO_IDLE;
+static bool photoOk;
+static uint32_t waitStart, waitTimeout;	// The answer is late waitTimeout ms after waitStart
+static uint8_t answerLength, answerReceived;
+
+//DOWNLOAD OF THE FRAME (retrieveImage, photoStep)
+static uint8_t chunk[CAMERA_CHUNK_MAX + 10];
+static uint32_t chunkAddress, downloadTick;
+static uint16_t chunkReceived, toRead, maxSize, readDelay, good;
+static uint8_t retries;
 
-//NOT FINISHED
 uint8_t readResponse(UART_HandleTypeDef *huart, uint8_t expLength, uint8_t attempts){
-//  int i = 0;
-//  bufferLength = 0;
-//  while (attempts != i && bufferLength != expLength)//si attemps == i o si bufferLenght == expLength sale del while
-//  {
-////    if ()//mirar si tenemos algo que leer
-////    { // Is there any data?
-////      delay(1);
-////      i++;
-////      continue;
-////    }
-//    i = 0;
-//    bufferLength++;
-//    //dataBuffer[bufferLength++] = swsInstance.read(); // And we fill it with data
-//	//for(int i = 0; i<)
-//    HAL_UART_Receive(huart, dataBuffer, expLength, 100);
-//  }
-  HAL_UART_Receive(huart, dataBuffer, expLength, 100);
-
-  return expLength;
+  (void)huart; // The transport (camera_uart) owns the UART and the timeout replaces the attempts
+  (void)attempts;
+  // The response is received by interrupt in the camera_uart ring buffer, wait until it is complete
+  bufferLength = CameraUart_ReadBlocking(dataBuffer, expLength, CAMERA_RESPONSE_TIMEOUT);
+
+  return bufferLength;
+}
+
+void sendCommand(UART_HandleTypeDef *huart, uint8_t command, uint8_t *hexData, uint8_t dataArrayLength)
+{ // Sends the 0x56 0x00 header, the command and hexData as a single interrupt transfer
+  uint32_t start = HAL_GetTick();
+
+  (void)huart; // Sent on the UART given to CameraUart_Init
+
+  while (!CameraUart_Send(command, hexData, dataArrayLength))
+  {
+	  if (HAL_GetTick() - start > CAMERA_RESPONSE_TIMEOUT) return;
+	  __WFI(); // Until the previous frame has been sent
+  }
+}
+
+static bool checkAnswer(uint8_t command)
+{ // Data should always be 76, 00, command, 00
+  return dataBuffer[0] == 0x76 &&
+	  dataBuffer[1] == 0x0 &&
+	  dataBuffer[2] == command &&
+	  dataBuffer[3] == 0x0;
 }
 
 bool runCommand(UART_HandleTypeDef *huart, uint8_t command, uint8_t *hexData, uint8_t dataArrayLength, uint8_t expLength, bool doFlush)
@@ -52,17 +75,11 @@ bool runCommand(UART_HandleTypeDef *huart, uint8_t command, uint8_t *hexData, ui
 // Flush the reciever buffer
   if (doFlush)
   {
-    readResponse(huart, 100, 10);
+    CameraUart_Flush();
   }
 
   // Send the data
-  HAL_UART_Transmit(huart, commInit, 2, HAL_MAX_DELAY);
-  HAL_UART_Transmit(huart, &command, 1, HAL_MAX_DELAY);
-
-  for (int i = 0; i < dataArrayLength; i++)
-  {
-	  HAL_UART_Transmit(huart, &hexData[i], 1, HAL_MAX_DELAY);
-  }
+  sendCommand(huart, command, hexData, dataArrayLength);
 
   // Check the data
   if (readResponse(huart, expLength, 100) != expLength)
@@ -70,11 +87,7 @@ bool runCommand(UART_HandleTypeDef *huart, uint8_t command, uint8_t *hexData, ui
     return false;
   }
 
-  // Data should always be 76, 00, command, 00
-  return dataBuffer[0] == 0x76 &&
-	  dataBuffer[1] == 0x0 &&
-	  dataBuffer[2] == command &&
-	  dataBuffer[3] == 0x0;
+  return checkAnswer(command);
 }
 
 bool captureImage(UART_HandleTypeDef *huart){
@@ -101,82 +114,259 @@ void setResolution(UART_HandleTypeDef *huart, uint8_t resolution){
 	runCommand(huart, 0x31, setResolutionCmd, sizeof(setResolutionCmd), 5, true);
 }
 
+static uint32_t answerFrameLength(void)
+{ //Recreating split hex numbers from 4 bytes
+  return (uint32_t)dataBuffer[5] << 24 | (uint32_t)dataBuffer[6] << 16 | dataBuffer[7] << 8 | dataBuffer[8];
+}
+
 void getFrameLength(UART_HandleTypeDef *huart)
 { // ~ Get frame length
-  uint8_t hexData[] = {0x01, 0x00};
-  if (!runCommand(huart, 0x34, hexData, sizeof(hexData), 9, true))
+  if (!runCommand(huart, 0x34, getFrameLengthCmd, sizeof(getFrameLengthCmd), 9, true))
   {
     while (1);
   }
-  frameLength = dataBuffer[5]; //Recreating split hex numbers from 4 bytes
-  frameLength <<= 8;
-  frameLength |= dataBuffer[6];
-  frameLength <<= 8;
-  frameLength |= dataBuffer[7];
-  frameLength <<= 8;
-  frameLength |= dataBuffer[8];
+  frameLength = answerFrameLength();
 }
 
-void retrieveImage(UART_HandleTypeDef *huart)
-{ // * Retrieve photo data
+void requestChunk(UART_HandleTypeDef *huart, uint32_t address, uint16_t toRead, uint16_t delay)
+{ // READ_FBUF of toRead bytes from address, the camera answers header + data + header
+  // delay is the time (x 0.01 ms) the camera waits before sending the data
+	uint8_t hexData[] = {0x0C, 0x0, 0x0A, address >> 24, (address >> 16) & 0xFF,
+						 (address >> 8) & 0xFF, address & 0xFF, 0x0, 0x0,
+						 toRead >> 8, toRead & 0xFF, delay >> 8, delay & 0xFF
+						};
+	sendCommand(huart, 0x32, hexData, sizeof(hexData));
+}
 
-	uint8_t dataVect[frameLength];
+bool checkChunk(const uint8_t *answer, uint16_t length)
+{ // Both headers of the answer to requestChunk
+	const uint8_t *tail = &answer[length - 5];
 
-	//todo errase this bucle. Use the memset function (search this function on the internet)
-	for(int i = 0; i < frameLength; i++){
-	  dataVect[i] = 0;
-	}
+	return answer[0] == 0x76 && answer[1] == 0x0 && answer[2] == 0x32 && answer[3] == 0x0 &&
+		   tail[0] == 0x76 && tail[1] == 0x0 && tail[2] == 0x32 && tail[3] == 0x0;
+}
 
-	while (frameLength > 0)
-	{
-		HAL_Delay(100);
+uint16_t tuneChunkSize(UART_HandleTypeDef *huart)
+{ // Biggest chunk that the UART can move in half of CAMERA_CHUNK_TIMEOUT (10 bits per byte)
+	uint32_t size = huart->Init.BaudRate / 10 * CAMERA_CHUNK_TIMEOUT / 2000 - 10;
 
-		int toRead = min(bSize, frameLength); // Bytes read each loop
-		uint8_t hexData[] = {0x0C, 0x0, 0x0A, 0x0, 0x0,
-							 framePointer >> 8, framePointer & 0xFF, 0x0, 0x0,
-							 0x0, toRead, 0x0, 0x0A
-							};
+	if (size > CAMERA_CHUNK_MAX) size = CAMERA_CHUNK_MAX;
+	if (size < CAMERA_CHUNK_MIN) size = CAMERA_CHUNK_MIN;
+	return size & ~0x7; // The camera reads the frame buffer in multiples of 8 bytes
+}
 
-		if (!runCommand(huart, 0x32, hexData, sizeof(hexData), 5, false))
-		{
-			HAL_Delay(1);
-		}
-		if (readResponse(huart, toRead + 5, 0xff) == 0) // +5 for verification header
-		{
-			HAL_Delay(1);
-		}
+const CameraDownloadStats *getDownloadStats(void)
+{
+	return &downloadStats;
+}
 
-		for(int i = 0; i < toRead; i++){
-		  dataVect[framePointer+i] = dataBuffer[i];
-		}
+static void waitFor(uint32_t timeout)
+{ // Starts the wait of an answer, checked by waitOver without blocking
+	waitStart = HAL_GetTick();
+	waitTimeout = timeout;
+}
 
-		framePointer += toRead;
-		frameLength -= toRead;
-	}
+static bool waitOver(void)
+{
+	return HAL_GetTick() - waitStart > waitTimeout;
+}
 
-	Write_Flash(PHOTO_ADDR, dataVect, sizeof(dataVect));
+static bool startCommand(uint8_t command, uint8_t *hexData, uint8_t dataArrayLength, uint8_t expLength)
+{ // As runCommand, the answer is collected by answerStep
+	CameraUart_Flush();
+	if (!CameraUart_Send(command, hexData, dataArrayLength)) return false;
+	answerLength = expLength;
+	answerReceived = 0;
+	waitFor(CAMERA_RESPONSE_TIMEOUT);
+	return true;
 }
 
-bool takePhoto(UART_HandleTypeDef *huart){
-	//takePhoto
-	if(!captureImage(huart)){
-		//todo create a protocol in order to handle errors in the communication
-		return false;
+static int8_t answerStep(uint8_t command)
+{ // 1 once the answer is complete and right, 0 while it is arriving, -1 if it is late or wrong
+	answerReceived += CameraUart_Read(&dataBuffer[answerReceived], answerLength - answerReceived);
+	bufferLength = answerReceived;
+	if (answerReceived < answerLength) return waitOver() ? -1 : 0;
+	return checkAnswer(command) ? 1 : -1;
+}
+
+static void requestNext(void)
+{ // READ_FBUF of the next chunk, toRead is 0 at the end of the frame
+	toRead = min(bSize, frameLength);
+	chunkReceived = 0;
+	if (toRead > 0) requestChunk(photoHuart, framePointer, toRead, readDelay);
+	waitFor(CAMERA_CHUNK_TIMEOUT);
+}
+
+static bool beginDownload(UART_HandleTypeDef *huart)
+{ // Erases the photo area and asks for the first chunk, downloadStep does the rest
+	if (frameLength > PHOTO_MAX_SIZE) frameLength = PHOTO_MAX_SIZE;
+	photoHuart = huart;
+	chunkAddress = PHOTO_ADDR;
+	framePointer = 0;
+	maxSize = tuneChunkSize(huart);
+	bSize = maxSize;
+	readDelay = CAMERA_READ_DELAY_MIN;
+	good = 0;
+	retries = 0;
+	downloadTick = HAL_GetTick();
+	memset(&downloadStats, 0, sizeof(downloadStats));
+	downloadStats.chunk_size = bSize;
+
+	// The whole photo area is erased once, then every chunk is only programmed. It is one sector,
+	// its erase stalls the CPU (it runs from the same flash bank) however it is started
+	if (Flash_Erase(PHOTO_ADDR, frameLength) != 0) return false;
+	CameraUart_Flush();
+	photoState = CAMERA_PHOTO_CHUNK;
+	requestNext();
+	return true;
+}
+
+static bool endDownload(bool ok)
+{
+	downloadStats.time_ms = HAL_GetTick() - downloadTick;
+	downloadStats.ok = ok;
+	return false;
+}
+
+static bool downloadChunk(void)
+{ /* Takes the chunk received, if it is complete, and returns false once the download has ended.
+   * The next READ_FBUF is sent as soon as a chunk is verified, so the camera streams it into
+   * the camera_uart ring buffer while this one is programmed in the flash */
+	uint16_t received = toRead;
+	HAL_StatusTypeDef status;
+
+	if (photoState == CAMERA_PHOTO_RESYNC)
+	{ // The rest of the bad answer has arrived, discard it and ask again
+		if (!waitOver()) return true;
+		CameraUart_Flush();
+		photoState = CAMERA_PHOTO_CHUNK;
+		requestNext();
+		return true;
+	}
+
+	chunkReceived += CameraUart_Read(&chunk[chunkReceived], toRead + 10 - chunkReceived);
+	if (chunkReceived < toRead + 10 && !waitOver()) return true;
+	if (chunkReceived < toRead + 10 || !checkChunk(chunk, toRead + 10))
+	{
+		if (++retries > CAMERA_CHUNK_RETRIES) return endDownload(false);
+		downloadStats.retries++;
+		// Smaller chunks and a longer delay give the link more margin
+		bSize = max(CAMERA_CHUNK_MIN, bSize / 2) & ~0x7; // Multiples of 8 bytes, as tuneChunkSize
+		readDelay = min(CAMERA_READ_DELAY_MAX, readDelay * 2);
+		good = 0;
+		// Let the rest of the bad answer arrive before discarding it
+		photoState = CAMERA_PHOTO_RESYNC;
+		waitFor(CAMERA_RESYNC_DELAY);
+		return true;
+	}
+	retries = 0;
+	framePointer += received;
+	frameLength -= received;
+	downloadStats.chunks++;
+	downloadStats.bytes += received;
+
+	// Recover the tuned size after a run of good chunks
+	if (++good >= CAMERA_CHUNK_GROW && bSize < maxSize)
+	{
+		bSize = min(maxSize, bSize * 2) & ~0x7;
+		good = 0;
 	}
 
-	//actualize frameLength
-	getFrameLength(huart);
+	requestNext();
+	HAL_FLASH_Unlock();
+	status = Flash_Program_Data(chunkAddress, &chunk[5], received);
+	HAL_FLASH_Lock();
+	if (status != HAL_OK) return endDownload(false);
+	chunkAddress += received;
+	waitFor(CAMERA_CHUNK_TIMEOUT); // The next chunk has the whole timeout after the programming
+	if (toRead == 0) return endDownload(true);
+	return true;
+}
+
+static bool downloadStep(void)
+{
+	bool running;
+
+	TRACE_ENTER(TRACE_CAMERA_STEP);
+	running = downloadChunk();
+	TRACE_EXIT(TRACE_CAMERA_STEP);
+	return running;
+}
 
-	//saves the image to the flash mem
-	retrieveImage(huart);
+bool retrieveImage(UART_HandleTypeDef *huart)
+{ // * Retrieve photo data, sleeping until each chunk arrives
+	if (!beginDownload(huart)) return false;
+	while (downloadStep()) __WFI();
+	photoState = CAMERA_PHOTO_IDLE;
+	return downloadStats.ok;
+}
 
-	//stops capture
-	stopCapture(huart);
+static void stopPhoto(bool ok)
+{ // FBUF_CTRL resume, as stopCapture: the photo ends when it is answered, whatever the answer
+	photoOk = ok;
+	if (startCommand(0x36, stopCaptureCmd, sizeof(stopCaptureCmd), 5)) photoState = CAMERA_PHOTO_STOP;
+	else photoState = ok ? CAMERA_PHOTO_DONE : CAMERA_PHOTO_FAILED;
+}
 
+bool startPhoto(UART_HandleTypeDef *huart)
+{
+	if (photoState >= CAMERA_PHOTO_CAPTURE && photoState <= CAMERA_PHOTO_STOP) return false;
+	photoHuart = huart;
+	if (!startCommand(0x36, captureImageCmd, sizeof(captureImageCmd), 5)) return false;
+	photoState = CAMERA_PHOTO_CAPTURE;
 	return true;
 }
 
+CameraPhotoState photoStep(void)
+{ // captureImage, getFrameLength, retrieveImage and stopCapture, each one as far as the bytes received allow
+	int8_t answer;
+
+	switch (photoState)
+	{
+	case CAMERA_PHOTO_CAPTURE:
+		answer = answerStep(0x36);
+		if (answer < 0) photoState = CAMERA_PHOTO_FAILED; //todo create a protocol in order to handle errors in the communication
+		else if (answer > 0)
+		{
+			if (startCommand(0x34, getFrameLengthCmd, sizeof(getFrameLengthCmd), 9)) photoState = CAMERA_PHOTO_LENGTH;
+			else stopPhoto(false);
+		}
+		break;
+	case CAMERA_PHOTO_LENGTH:
+		answer = answerStep(0x34);
+		if (answer == 0) break;
+		if (answer > 0) frameLength = answerFrameLength();
+		if (answer < 0 || !beginDownload(photoHuart)) stopPhoto(false);
+		break;
+	case CAMERA_PHOTO_CHUNK:
+	case CAMERA_PHOTO_RESYNC:
+		if (!downloadStep()) stopPhoto(downloadStats.ok);
+		break;
+	case CAMERA_PHOTO_STOP:
+		if (answerStep(0x36) != 0) photoState = photoOk ? CAMERA_PHOTO_DONE : CAMERA_PHOTO_FAILED;
+		break;
+	default:
+		break;
+	}
+	return photoState;
+}
+
+bool takePhoto(UART_HandleTypeDef *huart){
+	// The steps of photoStep, sleeping until the camera answers
+	CameraPhotoState state;
+
+	if (!startPhoto(huart)) return false;
+	while ((state = photoStep()) != CAMERA_PHOTO_DONE && state != CAMERA_PHOTO_FAILED) __WFI();
+
+	return state == CAMERA_PHOTO_DONE;
+}
+
 int min(int x, int y)
 {
   return (x < y) ? x : y;
 }
+
+int max(int x, int y)
+{
+  return (x > y) ? x : y;
+}
@@ -29,6 +29,7 @@
 //#include <stdint.h>
 //#include <inttypes.h>
 //#include <timer.h>
+//#include "radio_irq.h"
 ////#include "sx126x-board.h"
 //
 ///*!
@@ -499,7 +500,7 @@
 //{
 //    RadioEvents = events;
 //
-//    SX126xInit( RadioOnDioIrq );
+//    SX126xInit( RadioIrq_On_Dio1 );     // DIO1 posted to the dispatcher (radio_irq.h), not RadioIrqProcess
 //    SX126xSetStandby( STDBY_RC );
 //    SX126xSetRegulatorMode( USE_DCDC );
 //
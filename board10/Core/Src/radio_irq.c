@@ -0,0 +1,189 @@
+/*!
+ * \file      radio_irq.c
+ *
+ * \brief     Event-driven dispatch of the SX126x interrupts (see radio_irq.h).
+ *
+ * 			  Queue: Head is only written by the producer (interrupts) and Tail
+ * 			  only by the consumer (main loop), so no interrupt has to be masked.
+ * 			  Every producer has to run at the same interrupt priority, otherwise
+ * 			  two of them could write the same entry.
+ *
+ * 			  All the queued events are merged in one mask, DIO1 is replaced by the
+ * 			  events of the IRQ status, and the mask is dispatched lowest bit first.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "radio_irq.h"
+#include "scheduler.h"
+#include <sx126x.h>
+#include "stm32f4xx_hal.h"
+
+#define RADIO_IRQ_QUEUE_MASK	(RADIO_IRQ_QUEUE_SIZE - 1)
+
+_Static_assert((RADIO_IRQ_QUEUE_SIZE & RADIO_IRQ_QUEUE_MASK) == 0 && RADIO_IRQ_QUEUE_SIZE <= 128,
+			   "The queue size has to be a power of 2 that fits the 8-bit indexes");
+
+typedef struct {
+	uint16_t event;
+	uint32_t tick;
+} RadioIrqEntry;
+
+/*SX126x IRQ flags and the event they produce, RX_TX_TIMEOUT is resolved apart*/
+static const struct {
+	uint16_t irq;
+	uint16_t event;
+} IrqMap[] = {
+	{ IRQ_TX_DONE,		RADIO_EVENT_TX_DONE },
+	{ IRQ_RX_DONE,		RADIO_EVENT_RX_DONE },
+	{ IRQ_CAD_DONE,		RADIO_EVENT_CAD_DONE },
+	{ IRQ_HEADER_ERROR,	RADIO_EVENT_RX_TIMEOUT },	/*As RadioIrqProcess did*/
+	{ IRQ_CRC_ERROR,	RADIO_EVENT_RX_ERROR },
+};
+
+static RadioIrqEntry Queue[RADIO_IRQ_QUEUE_SIZE];
+static volatile uint8_t Head = 0;
+static volatile uint8_t Tail = 0;
+
+static const RadioIrqOps *Ops = NULL;
+static RadioEvents_t *Events = NULL;
+static bool CadActivity;
+static uint8_t Payload[RADIO_IRQ_PAYLOAD_SIZE];
+static RadioIrqStats Stats;
+
+void RadioIrq_Init(const RadioIrqOps *ops, RadioEvents_t *events)
+{
+	Ops = ops;
+	Events = events;
+	Tail = Head;
+}
+
+bool RadioIrq_Post(uint16_t event)
+{
+	uint8_t head = Head;
+
+	if ((uint8_t)(head - Tail) >= RADIO_IRQ_QUEUE_SIZE)
+	{
+		Stats.dropped++;
+		return false;
+	}
+	Queue[head & RADIO_IRQ_QUEUE_MASK].event = event;
+	Queue[head & RADIO_IRQ_QUEUE_MASK].tick = HAL_GetTick();
+	__DMB();	/*The entry is complete before the consumer can see it*/
+	Head = head + 1;
+	Stats.posted++;
+	Scheduler_Post(SCHEDULER_EVENT_RADIO);	/*Releases the radio task*/
+	return true;
+}
+
+void RadioIrq_On_Dio1(void)
+{
+	RadioIrq_Post(RADIO_EVENT_DIO1);
+}
+
+/*Reads and clears the IRQ status of the SX126x and returns its events*/
+static uint16_t RadioIrq_Decode(void)
+{
+	uint16_t irq, events = 0;
+	uint8_t i;
+
+	if (Ops == NULL || Ops->GetIrqStatus == NULL) return 0;
+
+	irq = Ops->GetIrqStatus();
+	Ops->ClearIrqStatus(IRQ_RADIO_ALL);
+
+	for (i = 0; i < sizeof(IrqMap) / sizeof(IrqMap[0]); i++)
+	{
+		if (irq & IrqMap[i].irq) events |= IrqMap[i].event;
+	}
+	if (irq & IRQ_RX_TX_TIMEOUT)
+	{
+		events |= Ops->IsTransmitting() ? RADIO_EVENT_TX_TIMEOUT : RADIO_EVENT_RX_TIMEOUT;
+	}
+	CadActivity = (irq & IRQ_CAD_ACTIVITY_DETECTED) != 0;
+	return events;
+}
+
+static void RadioIrq_Call(uint16_t event)
+{
+	uint8_t size = 0;
+	int16_t rssi = 0;
+	int8_t snr = 0;
+
+	switch (event)
+	{
+	case RADIO_EVENT_TX_DONE:
+		if (Events->TxDone) Events->TxDone();
+		break;
+	case RADIO_EVENT_RX_DONE:
+		if (Ops && Ops->GetPayload) Ops->GetPayload(Payload, &size, &rssi, &snr);
+		if (Events->RxDone) Events->RxDone(Payload, size, rssi, snr);
+		break;
+	case RADIO_EVENT_CAD_DONE:
+		if (Events->CadDone) Events->CadDone(CadActivity);
+		break;
+	case RADIO_EVENT_TX_TIMEOUT:
+		if (Events->TxTimeout) Events->TxTimeout();
+		break;
+	case RADIO_EVENT_RX_TIMEOUT:
+		if (Events->RxTimeout) Events->RxTimeout();
+		break;
+	case RADIO_EVENT_RX_ERROR:
+		if (Events->RxError) Events->RxError();
+		break;
+	default:
+		break;
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  RadioIrq_Dispatch                                                       *
+ * --------------------                                                               *
+ * Empties the queue, reads the IRQ status once if DIO1 fired and calls the handler   *
+ * of every pending event, higher priority first                                      *
+ *                                                                                    *
+ *  returns: number of handlers called                                                *
+ *                                                                                    *
+ **************************************************************************************/
+uint8_t RadioIrq_Dispatch(void)
+{
+	uint16_t pending = 0;
+	uint32_t oldest = 0;
+	uint32_t latency;
+	uint8_t called = 0;
+	uint16_t event;
+
+	while (Tail != Head)
+	{
+		__DMB();	/*Head is read before the entry*/
+		if (pending == 0) oldest = Queue[Tail & RADIO_IRQ_QUEUE_MASK].tick;
+		pending |= Queue[Tail & RADIO_IRQ_QUEUE_MASK].event;
+		Tail = Tail + 1;
+	}
+	if (pending == 0 || Events == NULL) return 0;
+
+	if (pending & RADIO_EVENT_DIO1)
+	{
+		pending = (pending & ~RADIO_EVENT_DIO1) | RadioIrq_Decode();
+	}
+
+	latency = HAL_GetTick() - oldest;
+	if (latency > Stats.max_latency) Stats.max_latency = latency;
+
+	while (pending)
+	{
+		event = pending & -pending;	/*Lowest bit = highest priority*/
+		pending &= pending - 1;
+		RadioIrq_Call(event);
+		called++;
+	}
+	Stats.dispatched += called;
+	return called;
+}
+
+const RadioIrqStats *RadioIrq_Get_Stats(void)
+{
+	return &Stats;
+}
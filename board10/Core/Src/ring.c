@@ -0,0 +1,143 @@
+/*!
+ * \file      ring.c
+ *
+ * \brief     Lock-free single producer / single consumer ring buffer (see ring.h).
+ *
+ * 			  Each side reads the index of the other one with acquire (the data it
+ * 			  published is visible) and stores its own with release (its data is
+ * 			  written before the index moves); on the Cortex-M4 this is a DMB.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "ring.h"
+#include "string.h"
+
+#define RING_LOAD(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define RING_STORE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+bool RingInit( Ring_t *ring, uint8_t *buffer, uint16_t size )
+{
+	uint16_t pow2 = 2;
+
+	if( size < 2 ) return false;	/*The smallest ring holds 2 bytes*/
+	while( pow2 <= size / 2 && pow2 < 0x8000 ) pow2 <<= 1;
+
+	ring->Data = buffer;
+	ring->Mask = pow2 - 1;
+	ring->Head = 0;
+	ring->Tail = 0;
+	ring->Overflows = 0;
+	return true;
+}
+
+uint16_t RingCount( Ring_t *ring )
+{
+	return ( uint16_t )( RING_LOAD( ring->Head ) - RING_LOAD( ring->Tail ) );
+}
+
+uint16_t RingSpace( Ring_t *ring )
+{
+	return ring->Mask + 1 - RingCount( ring );
+}
+
+bool RingPush( Ring_t *ring, uint8_t data )
+{
+	uint16_t head = ring->Head;
+
+	if( ( uint16_t )( head - RING_LOAD( ring->Tail ) ) > ring->Mask )
+	{
+		ring->Overflows++;
+		return false;
+	}
+	ring->Data[head & ring->Mask] = data;
+	RING_STORE( ring->Head, head + 1 );
+	return true;
+}
+
+uint16_t RingPushN( Ring_t *ring, const uint8_t *data, uint16_t length )
+{
+	uint16_t head = ring->Head;
+	uint16_t space = ring->Mask + 1 - ( uint16_t )( head - RING_LOAD( ring->Tail ) );
+	uint16_t index = head & ring->Mask;
+	uint16_t first;
+
+	if( length > space )
+	{
+		ring->Overflows += length - space;
+		length = space;
+	}
+	/*Up to the end of the buffer, then from the beginning*/
+	first = ring->Mask + 1 - index;
+	if( first > length ) first = length;
+	memcpy( &ring->Data[index], data, first );
+	memcpy( ring->Data, &data[first], length - first );
+
+	RING_STORE( ring->Head, head + length );
+	return length;
+}
+
+bool RingPop( Ring_t *ring, uint8_t *data )
+{
+	uint16_t tail = ring->Tail;
+
+	if( tail == RING_LOAD( ring->Head ) ) return false;
+
+	*data = ring->Data[tail & ring->Mask];
+	RING_STORE( ring->Tail, tail + 1 );
+	return true;
+}
+
+uint16_t RingPopN( Ring_t *ring, uint8_t *data, uint16_t length )
+{
+	uint16_t tail = ring->Tail;
+	uint16_t count = RING_LOAD( ring->Head ) - tail;
+	uint16_t index = tail & ring->Mask;
+	uint16_t first;
+
+	if( length > count ) length = count;
+
+	first = ring->Mask + 1 - index;
+	if( first > length ) first = length;
+	memcpy( data, &ring->Data[index], first );
+	memcpy( &data[first], ring->Data, length - first );
+
+	RING_STORE( ring->Tail, tail + length );
+	return length;
+}
+
+void RingFlush( Ring_t *ring )
+{
+	RING_STORE( ring->Tail, RING_LOAD( ring->Head ) );
+}
+
+uint16_t RingWriteSpan( Ring_t *ring, uint8_t **span )
+{
+	uint16_t head = ring->Head;
+	uint16_t space = ring->Mask + 1 - ( uint16_t )( head - RING_LOAD( ring->Tail ) );
+	uint16_t toEnd = ring->Mask + 1 - ( head & ring->Mask );
+
+	*span = &ring->Data[head & ring->Mask];
+	return space < toEnd ? space : toEnd;
+}
+
+void RingCommitWrite( Ring_t *ring, uint16_t length )
+{
+	RING_STORE( ring->Head, ring->Head + length );
+}
+
+uint16_t RingReadSpan( Ring_t *ring, const uint8_t **span )
+{
+	uint16_t tail = ring->Tail;
+	uint16_t count = RING_LOAD( ring->Head ) - tail;
+	uint16_t toEnd = ring->Mask + 1 - ( tail & ring->Mask );
+
+	*span = &ring->Data[tail & ring->Mask];
+	return count < toEnd ? count : toEnd;
+}
+
+void RingCommitRead( Ring_t *ring, uint16_t length )
+{
+	RING_STORE( ring->Tail, ring->Tail + length );
+}
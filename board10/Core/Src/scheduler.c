@@ -0,0 +1,242 @@
+/*!
+ * \file      scheduler.c
+ *
+ * \brief     Cooperative run-to-completion scheduler (see scheduler.h).
+ *
+ * 			  The tasks are kept sorted by priority, so the ready set is a bitmap
+ * 			  and the next task is its lowest bit. Periodic releases are computed
+ * 			  from the previous nominal release (no drift); a task that is late by
+ * 			  more than one period skips the releases it lost. The events are
+ * 			  posted in a mask with the time of their first post, so the jitter of
+ * 			  an event task is measured from the interrupt that released it.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "scheduler.h"
+#include "trace.h"
+#include "stm32f4xx_hal.h"
+#include "string.h"
+
+typedef struct {
+	SchedulerTask task;
+	SchedulerTaskStats stats;
+	uint32_t next;			/*Next periodic release (us)*/
+	uint32_t release;		/*Release that made the task ready (us)*/
+} SchedulerEntry;
+
+static SchedulerEntry Tasks[SCHEDULER_MAX_TASKS];
+static uint8_t TaskCount = 0;
+static uint32_t Ready = 0;
+
+static volatile uint16_t Pending = 0;
+static uint32_t EventTime[SCHEDULER_MAX_EVENTS];
+
+static uint32_t StartTick;	/*Start of the load window: ms of the HAL tick and us into it*/
+static uint32_t StartUs;
+static uint64_t Busy;
+
+/*HAL tick and microseconds into it from the SysTick counter*/
+static void Scheduler_Clock(uint32_t *ms, uint32_t *us)
+{
+	uint32_t tick, val;
+	bool pending;
+
+	/*Read again if the tick moved or the counter reloaded (it counts down) in between*/
+	do {
+		tick = HAL_GetTick();
+		val = SysTick->VAL;
+		pending = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+	} while (SysTick->VAL > val || tick != HAL_GetTick());
+
+	/*Interrupts masked (critical section, Scheduler_Post from an ISR): the counter
+	 *has reloaded but HAL_IncTick has not run yet, its ms is not in the tick*/
+	if (pending) tick++;
+
+	*ms = tick;
+	*us = (uint32_t)(((uint64_t)(SysTick->LOAD - val) * 1000) / (SysTick->LOAD + 1));
+}
+
+/*Microseconds, wraps every 71 minutes*/
+static uint32_t Scheduler_Now(void)
+{
+	uint32_t ms, us;
+
+	Scheduler_Clock(&ms, &us);
+	return ms * 1000 + us;
+}
+
+void Scheduler_Init(void)
+{
+	TaskCount = 0;
+	Ready = 0;
+	Pending = 0;
+	Scheduler_Reset_Load();
+}
+
+bool Scheduler_Add(const SchedulerTask *task)
+{
+	uint8_t i;
+
+	if (TaskCount >= SCHEDULER_MAX_TASKS || task->run == NULL) return false;
+
+	/*Insertion in priority order, same priority after the ones already added*/
+	for (i = TaskCount; i > 0 && Tasks[i - 1].task.priority > task->priority; i--)
+	{
+		Tasks[i] = Tasks[i - 1];
+	}
+	Tasks[i].task = *task;
+	memset(&Tasks[i].stats, 0, sizeof(Tasks[i].stats));
+	Tasks[i].next = Scheduler_Now() + task->period * 1000;
+	Tasks[i].release = 0;
+	TaskCount++;
+	Ready = 0;	/*The bits moved with the tasks, they are released again*/
+	return true;
+}
+
+void Scheduler_Post(uint16_t events)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t now = Scheduler_Now();
+	uint16_t first;
+	uint8_t bit;
+
+	__disable_irq();
+	first = events & ~Pending;
+	while (first)
+	{
+		bit = __builtin_ctz(first);
+		first &= first - 1;
+		EventTime[bit] = now;
+	}
+	Pending |= events;
+	__set_PRIMASK(primask);
+}
+
+/*Marks ready the tasks released since the previous call*/
+static void Scheduler_Release(uint32_t now)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t release;
+	uint16_t events, matched;
+	uint8_t i;
+
+	__disable_irq();
+	events = Pending;
+	Pending = 0;
+	__set_PRIMASK(primask);
+
+	for (i = 0; i < TaskCount; i++)
+	{
+		SchedulerEntry *entry = &Tasks[i];
+		bool released = false;
+
+		matched = events & entry->task.events;
+		if (matched)
+		{
+			release = EventTime[__builtin_ctz(matched)];
+			released = true;
+		}
+		if (entry->task.period && (int32_t)(now - entry->next) >= 0)
+		{
+			release = entry->next;
+			released = true;
+			entry->next += entry->task.period * 1000;
+			if ((int32_t)(now - entry->next) >= 0) entry->next = now + entry->task.period * 1000;
+		}
+		if (!released) continue;
+
+		if (Ready & (1UL << i)) entry->stats.overruns++;
+		else
+		{
+			entry->release = release;
+			Ready |= 1UL << i;
+		}
+	}
+}
+
+/*Runs a task and updates its statistics*/
+static void Scheduler_Execute(SchedulerEntry *entry)
+{
+	uint32_t start, end, exec, jitter, deadline;
+
+	start = Scheduler_Now();
+	TRACE_ENTER(TRACE_TASK + (entry - Tasks));
+	entry->task.run();
+	TRACE_EXIT(TRACE_TASK + (entry - Tasks));
+	end = Scheduler_Now();
+
+	exec = end - start;
+	jitter = start - entry->release;
+	deadline = entry->task.deadline ? entry->task.deadline : entry->task.period;
+
+	entry->stats.runs++;
+	entry->stats.total_exec += exec;
+	Busy += exec;
+	if (exec > entry->stats.max_exec) entry->stats.max_exec = exec;
+	if (jitter > entry->stats.max_jitter) entry->stats.max_jitter = jitter;
+	if (deadline && end - entry->release > deadline * 1000) entry->stats.deadline_misses++;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Scheduler_Run_Once                                                      *
+ * --------------------                                                               *
+ * Releases the periodic tasks that are due and the ones of the posted events, then   *
+ * runs the ready task with the highest priority until it returns                     *
+ *                                                                                    *
+ *  returns: false if no task was ready                                               *
+ *                                                                                    *
+ **************************************************************************************/
+bool Scheduler_Run_Once(void)
+{
+	uint8_t i;
+
+	Scheduler_Release(Scheduler_Now());
+	if (Ready == 0) return false;
+
+	i = __builtin_ctz(Ready);	/*Lowest bit = highest priority*/
+	Ready &= ~(1UL << i);
+	Scheduler_Execute(&Tasks[i]);
+	return true;
+}
+
+void Scheduler_Run(void)
+{
+	while (1)
+	{
+		if (Scheduler_Run_Once()) continue;
+
+		/*An event posted after the check still ends the WFI: the interrupt is pending*/
+		__disable_irq();
+		if (Pending == 0) __WFI();
+		__enable_irq();
+	}
+}
+
+const SchedulerTaskStats *Scheduler_Get_Stats(uint8_t index, const char **name)
+{
+	if (index >= TaskCount) return NULL;
+	if (name) *name = Tasks[index].task.name;
+	return &Tasks[index].stats;
+}
+
+uint16_t Scheduler_Get_Load(void)
+{
+	uint32_t ms, us;
+	uint64_t elapsed;
+
+	/*In ms of the tick, so the window can be longer than the 71 minutes of Scheduler_Now*/
+	Scheduler_Clock(&ms, &us);
+	elapsed = (uint64_t)(ms - StartTick) * 1000 + us - StartUs;
+
+	if ((int64_t)elapsed <= 0) return 0;
+	return Busy >= elapsed ? 1000 : (uint16_t)(Busy * 1000 / elapsed);
+}
+
+void Scheduler_Reset_Load(void)
+{
+	Scheduler_Clock(&StartTick, &StartUs);
+	Busy = 0;
+}
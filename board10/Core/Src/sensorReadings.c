@@ -12,116 +12,150 @@
  */
 
 #include "sensorReadings.h"
+#include "sensor_bus.h"
+#include "fuel_gauge.h"
+#include "sensor_conv.h"
+#include "hk_log.h"
+#include "hk_stats.h"
+#include "scheduler.h"
+#include "trace.h"
+
+#define TEMP_SENSORS		6
+#define FUEL_GAUGE_READ		TEMP_SENSORS	/*Index of the block read of the fuel gauge*/
+
+/*TMP102 addresses in the HAL format, 0 while they are not defined (the reading is marked as absent)*/
+static const uint8_t TEMP_SENSOR_ADDR[TEMP_SENSORS] = {/*Adreça 1, Adreça 2, etc*/};
+static const uint8_t REG_TEMP = 0x00;
+
+/*Raw registers of one epoch*/
+static uint8_t tempRaw[TEMP_SENSORS][2];
+static uint8_t fuelGaugeRaw[FUEL_GAUGE_BLOCK_SIZE];
+static FuelGaugeRegisters fuelGauge;
+
+/*Every channel of the last epoch converted to its storage unit (sensor_conv.h)*/
+static int16_t values[SENSOR_CONV_CHANNELS];
+
+/*Every register read of an epoch, in the order they are read*/
+static SensorBusTransfer epoch[TEMP_SENSORS + 1];
+static uint8_t epochLength = 0;
+static bool epochRunning = false;
+
+static SensorSnapshot snapshot;
+
+/*End of an epoch or timeout of a transfer (interrupt): the sensors task finishes the work*/
+static void sensorBusDone(void)
+{
+	Scheduler_Post(SCHEDULER_EVENT_SENSORS);
+}
+
+static void addTransfer(uint8_t device, uint8_t reg, uint8_t *data, uint8_t length)
+{
+	epoch[epochLength].device = device;
+	epoch[epochLength].reg = reg;
+	epoch[epochLength].data = data;
+	epoch[epochLength].length = length;
+	epoch[epochLength].status = SENSOR_BUS_ABSENT;
+	epochLength++;
+}
+
+/*True if the transfer of the reading ended well*/
+static bool readOk(uint8_t index)
+{
+	return epoch[index].status == SENSOR_BUS_OK;
+}
 
 /**************************************************************************************
  *                                                                                    *
- * Function:  acquireTemp	                                             	  		  *
+ * Function:  sensorReadingsInit                                         	  		  *
  * --------------------                                                               *
- * Reads temperatures from all the sensors, and stores the struct in memory			  *
+ * Builds the list of register reads of an epoch: the temperature of the 6 TMP102	  *
+ * and one block read of all the registers of the fuel gauge						  *
  *																					  *
- *  hi2c: I2C to read from the temperature sensors				    				  *
+ *  hi2c: I2C of the sensors									    				  *
  *															                          *
  *  returns: Nothing									                              *
  *  		 																		  *
  **************************************************************************************/
-void acquireTemp(I2C_HandleTypeDef *hi2c){
-	Temperatures temperatures_local;
+void sensorReadingsInit(I2C_HandleTypeDef *hi2c){
 	int i;
-	HAL_StatusTypeDef ret;
-	uint8_t buf[6];
-	int16_t val;
-	uint8_t REG_TEMP = 0x00;
-	float temp_c; //defineixo float però no sé si es pot guardar al tipus Temperatures.raw
-	uint8_t ADDR[6] = {/*Adreça 1, Adreça 2, etc*/};//adreces deks diferents sensors de temperatura
-	for(i=0; i < 6; i++){
-		// Tell TMP102 that we want to read from the temperature register
-		buf[0] = REG_TEMP;
-		ret = HAL_I2C_Master_Transmit(&hi2c, ADDR[i], buf, 1, 1000);
-		if ( ret != HAL_OK ) {
-			//strcpy((char*)buf, "Error Tx\r\n");
-		} else {
-			  // Read 2 bytes from the temperature register
-			  ret = HAL_I2C_Master_Receive(&hi2c, ADDR[i], buf, 2, 1000);
-			  if ( ret != HAL_OK ) {
-				  //strcpy((char*)buf, "Error Rx\r\n");
-			  } else {
-				  //Combine the bytes
-				  val = ((int16_t)buf[0] << 4) | (buf[1] >> 4);
-
-				  // Convert to 2's complement, since temperature can be negative
-				  if ( val > 0x7FF ) {
-					  val |= 0xF000;
-				  }
-				  // Convert to float temperature value (Celsius)
-				  temp_c = val * 0.0625;
-				  switch(i) {
-				  case 0:
-					  temperatures_local.fields.temp1 = temp_c;
-					  break;
-				  case 1:
-					  temperatures_local.fields.temp2 = temp_c;
-					  break;
-				  case 2:
-					  temperatures_local.fields.temp3 = temp_c;
-					  break;
-				  case 3:
-					  temperatures_local.fields.temp4 = temp_c;
-					  break;
-				  case 4:
-					  temperatures_local.fields.temp5 = temp_c;
-					  break;
-				  case 5:
-					  temperatures_local.fields.temp6 = temp_c;
-					  break;
-				  default:
-					  break;
-				  }
-			  }
-		}
+
+	epochLength = 0;
+	for(i=0; i < TEMP_SENSORS; i++){
+		addTransfer(TEMP_SENSOR_ADDR[i], REG_TEMP, tempRaw[i], 2);
+	}
+	addTransfer(BATTSENSOR_ADDR, FUEL_GAUGE_BLOCK_START, fuelGaugeRaw, FUEL_GAUGE_BLOCK_SIZE);
+
+	SensorBus_Init(hi2c, sensorBusDone);
+}
+
+/*Converts the counts of every channel at once, the failed readings are converted too but not used*/
+static void convertAll(void){
+	int16_t counts[SENSOR_CONV_CHANNELS];
+	int i;
+
+	for(i=0; i < TEMP_SENSORS; i++){
+		counts[SENSOR_CONV_TEMP1 + i] = SensorConv_Tmp102_Count(tempRaw[i]);
 	}
-	ret = HAL_I2C_Master_Transmit(hi2c, BATTSENSOR_ADDR, (uint8_t*)0x0A, 1, 500); //we want to read from the register 0x0A
-	if (ret != HAL_OK) {
-
-	} else {
-		HAL_I2C_Master_Receive(hi2c, BATTSENSOR_ADDR, &buf, 1, 500);
-		val = ((int16_t)buf[0] << 4);
-		  // Convert to 2's complement, since temperature can be negative
-		if ( val > 0x7FF ) {
-			val |= 0xF000;
+	counts[SENSOR_CONV_TEMP_BATT] = fuelGauge.temperature;
+	counts[SENSOR_CONV_VOLTAGE] = fuelGauge.voltage;
+	counts[SENSOR_CONV_CURRENT] = fuelGauge.current;
+
+	SensorConv_Convert_Batch(SENSOR_CONV_TEMP1, counts, values, SENSOR_CONV_CHANNELS);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  acquireTemp	                                             	  		  *
+ * --------------------                                                               *
+ * Stores the temperatures of the last epoch (degC), and the struct in memory		  *
+ * A sensor that did not answer keeps its previous value and loses its valid bit	  *
+ *																					  *
+ *  No input													    				  *
+ *															                          *
+ *  returns: Nothing									                              *
+ *  		 																		  *
+ **************************************************************************************/
+void acquireTemp(void){
+	int i;
+	int8_t *fields[TEMP_SENSORS + 1] = {
+		&snapshot.temperatures.fields.temp1, &snapshot.temperatures.fields.temp2,
+		&snapshot.temperatures.fields.temp3, &snapshot.temperatures.fields.temp4,
+		&snapshot.temperatures.fields.temp5, &snapshot.temperatures.fields.temp6,
+		&snapshot.temperatures.fields.tempbatt,
+	};
+
+	/*The battery temperature comes from the fuel gauge, the last one of the list*/
+	for(i=0; i <= TEMP_SENSORS; i++){
+		if (!readOk(i)) {
+			snapshot.valid &= ~(SENSOR_VALID_TEMP1 << i);
+			continue;
 		}
-		// Convert to float temperature value (Celsius)
-		temp_c = (val/32)*(125/100);
-		temperatures_local.fields.tempbatt = temp_c;
+		*fields[i] = values[SENSOR_CONV_TEMP1 + i];
+		snapshot.valid |= SENSOR_VALID_TEMP1 << i;
 	}
-	Write_Flash(TEMP_ADDR, &temperatures_local.raw, sizeof(temperatures_local));
+
+	Write_Flash(TEMP_ADDR, (uint8_t *)snapshot.temperatures.raw, sizeof(snapshot.temperatures));
 }
 
 /**************************************************************************************
  *                                                                                    *
  * Function:  acquireVoltage                                             	  		  *
  * --------------------                                                               *
- * Reads Voltages from all the sensors, and stores the struct in memory				  *
+ * Stores the battery voltage of the last epoch (0.1 V) in memory					  *
  *																					  *
- *  hi2c: I2C to read from the sensors							    				  *
+ *  No input													    				  *
  *															                          *
  *  returns: Nothing									                              *
  *  		 																		  *
  **************************************************************************************/
-void acquireVoltage(I2C_HandleTypeDef *hi2c){
-	uint8_t buf, value_to_store;
-	HAL_StatusTypeDef ret;
-	float volt_mV;
-	ret = HAL_I2C_Master_Transmit(hi2c, BATTSENSOR_ADDR, (uint8_t*)0x0C, 1, 500); //we want to read from the register 0x0C
-	if (ret != HAL_OK) {
-
-	} else {
-		HAL_I2C_Master_Receive(hi2c, BATTSENSOR_ADDR, &buf, 1, 500);
+void acquireVoltage(void){
+	if (!readOk(FUEL_GAUGE_READ)) {
+		snapshot.valid &= ~SENSOR_VALID_VOLTAGE;
+		return;
 	}
-	//To obtain the value in mV
-	volt_mV = (buf/32)*4.88;
-	//We want 1 decimal
-	value_to_store = volt_mV/100;
-	Write_Flash(VOLTAGE_ADDR, &value_to_store, 1);
+	snapshot.voltage = values[SENSOR_CONV_VOLTAGE];
+	snapshot.valid |= SENSOR_VALID_VOLTAGE;
+	Write_Flash(VOLTAGE_ADDR, &snapshot.voltage, 1);
 }
 
 
@@ -129,43 +163,88 @@ void acquireVoltage(I2C_HandleTypeDef *hi2c){
  *                                                                                    *
  * Function:  acquireCurrents                                            	  		  *
  * --------------------                                                               *
- * Reads currents from all the sensors, and stores the struct in memory				  *
+ * Stores the battery current of the last epoch (0.1 A, signed) in memory			  *
  *																					  *
- *  hi2c: I2C to read from the sensors							    				  *
+ *  No input													    				  *
  *															                          *
  *  returns: Nothing									                              *
  *  		 																		  *
  **************************************************************************************/
-void acquireCurrents(I2C_HandleTypeDef *hi2c){
-	uint8_t buf[1], value_to_store;
-	HAL_StatusTypeDef ret;
-	float current;
-	ret = HAL_I2C_Master_Transmit(hi2c, BATTSENSOR_ADDR, (uint8_t*)0x08, 1, 500); //we want to read from the register 0x08
-	if (ret != HAL_OK) {
-
-	} else {
-		HAL_I2C_Master_Receive(hi2c, BATTSENSOR_ADDR, &buf, 1, 500);
+void acquireCurrents(void){
+	if (!readOk(FUEL_GAUGE_READ)) {
+		snapshot.valid &= ~SENSOR_VALID_CURRENT;
+		return;
 	}
-	//To obtain the value in mV
-	current = buf[0]*1.0416*pow(10,-4);
-	//We want 1 decimal
-	value_to_store = current;
-	Write_Flash(CURRENT_ADDR, &value_to_store, 1);
+	snapshot.current = values[SENSOR_CONV_CURRENT];
+	snapshot.valid |= SENSOR_VALID_CURRENT;
+	Write_Flash(CURRENT_ADDR, (uint8_t *)&snapshot.current, 1);
+}
+
+/*The level is only published in the snapshot, checkbatteries() stores it*/
+static void acquireBatteryLevel(void){
+	if (!readOk(FUEL_GAUGE_READ)) {
+		snapshot.valid &= ~SENSOR_VALID_BATT_LEVEL;
+		return;
+	}
+	snapshot.battery_level = fuelGauge.level;
+	snapshot.valid |= SENSOR_VALID_BATT_LEVEL;
+}
+
+/*Adds the readings of the epoch to the time series and the summaries, a failed reading repeats its previous value*/
+static void logSample(void){
+	int16_t sample[HK_LOG_CHANNELS];
+
+	sample[HK_LOG_CURRENT] = snapshot.current;
+	sample[HK_LOG_VOLTAGE] = snapshot.voltage;
+	sample[HK_LOG_BATT_LEVEL] = snapshot.battery_level;
+	sample[HK_LOG_TEMP_BATT] = snapshot.temperatures.fields.tempbatt;
+	sample[HK_LOG_TEMP1] = snapshot.temperatures.fields.temp1;
+	sample[HK_LOG_TEMP1 + 1] = snapshot.temperatures.fields.temp2;
+	sample[HK_LOG_TEMP1 + 2] = snapshot.temperatures.fields.temp3;
+	sample[HK_LOG_TEMP1 + 3] = snapshot.temperatures.fields.temp4;
+	sample[HK_LOG_TEMP1 + 4] = snapshot.temperatures.fields.temp5;
+	sample[HK_LOG_TEMP1 + 5] = snapshot.temperatures.fields.temp6;
+	HkLog_Append(sample);
+	HkStats_Add(sample, HkLog_Time());
 }
 
 /**************************************************************************************
  *                                                                                    *
  * Function:  SensorReadings                                             	  		  *
  * --------------------                                                               *
- * Updates all the readings (temp, voltages, currents)								  *
+ * Advances the acquisition without waiting for the I2C: starts an epoch (all the	  *
+ * register reads by interrupt), aborts a transfer that timed out or, once the		  *
+ * epoch has ended, updates all the readings (temp, voltages, currents)				  *
+ * To be called periodically and on SCHEDULER_EVENT_SENSORS							  *
  *																					  *
- *  hi2c: I2C to read from the sensors							    				  *
+ *  hi2c: I2C to read from the sensors (given to sensorReadingsInit)				  *
  *															                          *
  *  returns: Nothing									                              *
  *  		 																		  *
  **************************************************************************************/
 void sensorReadings(I2C_HandleTypeDef *hi2c){
-	acquireTemp(hi2c);
-	acquireVoltage(hi2c);
-	acquireCurrents(hi2c);
+	(void)hi2c;
+	TRACE_ENTER(TRACE_SENSOR_READINGS);
+	if (epochRunning) {
+		if (SensorBus_Process()) {
+			if (readOk(FUEL_GAUGE_READ)) FuelGauge_Decode(fuelGaugeRaw, &fuelGauge);
+			convertAll();
+			acquireTemp();
+			acquireVoltage();
+			acquireCurrents();
+			acquireBatteryLevel();
+			logSample();
+			snapshot.tick = HAL_GetTick();
+			snapshot.epoch++;
+			epochRunning = false;
+		}
+	}
+	else {
+		epochRunning = SensorBus_Start(epoch, epochLength);
+	}
+	TRACE_EXIT(TRACE_SENSOR_READINGS);
+}
+
+const SensorSnapshot *getSensorSnapshot(void){
+	return &snapshot;
 }
@@ -0,0 +1,230 @@
+/*!
+ * \file      sensor_bus.c
+ *
+ * \brief     Non-blocking I2C acquisition (see sensor_bus.h).
+ *
+ * 			  The transfers are chained from the I2C interrupt. A transfer that
+ * 			  does not end within SENSOR_BUS_TIMEOUT (the HAL has no timeout for
+ * 			  the interrupt transfers) is detected by a timer, which wakes up the
+ * 			  owner. SensorBus_Process ends the transfer and stops the peripheral
+ * 			  with the interrupts masked, so the I2C interrupt cannot end it too;
+ * 			  the bus recovery (about 100 us), the new initialisation and the next
+ * 			  transfer run with them enabled.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "sensor_bus.h"
+#include "timer.h"
+#include "trace.h"
+
+static I2C_HandleTypeDef *Bus = NULL;
+static void (*Done)(void) = NULL;
+
+static SensorBusTransfer *List;
+static uint8_t Count;
+static volatile uint8_t Current;
+static volatile bool Running = false;
+static uint32_t EpochStart;
+static volatile uint32_t TransferStart;
+
+static TimerEvent_t Timeout;
+static SensorBusStats Stats;
+
+static void SensorBus_On_Timeout(void)
+{
+	if (Done) Done();
+}
+
+void SensorBus_Init(I2C_HandleTypeDef *hi2c, void (*done)(void))
+{
+	Bus = hi2c;
+	Done = done;
+	TimerInit(&Timeout, SensorBus_On_Timeout);
+	TimerSetValue(&Timeout, SENSOR_BUS_TIMEOUT + 1);
+}
+
+/*Starts the next transfer with a device, or ends the epoch*/
+static void SensorBus_Next(void)
+{
+	SensorBusTransfer *transfer;
+
+	while (Current < Count)
+	{
+		transfer = &List[Current];
+		if (transfer->device == 0)
+		{
+			transfer->status = SENSOR_BUS_ABSENT;
+			Current++;
+			continue;
+		}
+		transfer->status = SENSOR_BUS_PENDING;
+		TransferStart = HAL_GetTick();
+		if (HAL_I2C_Mem_Read_IT(Bus, transfer->device, transfer->reg, I2C_MEMADD_SIZE_8BIT,
+								transfer->data, transfer->length) == HAL_OK)
+		{
+			TimerStart(&Timeout);
+			return;
+		}
+		transfer->status = SENSOR_BUS_ERROR;
+		Stats.errors++;
+		Current++;
+	}
+
+	TimerStop(&Timeout);
+	Stats.epochs++;
+	Stats.last_duration = HAL_GetTick() - EpochStart;
+	if (Stats.last_duration > Stats.max_duration) Stats.max_duration = Stats.last_duration;
+	Running = false;
+	TRACE_EXIT(TRACE_I2C_EPOCH);
+	if (Done) Done();
+}
+
+/*Ends the current transfer with status and goes on with the next one*/
+static void SensorBus_End(uint8_t status)
+{
+	List[Current].status = status;
+	Current++;
+	SensorBus_Next();
+}
+
+/*Busy wait on the SysTick counter, which counts down from LOAD every ms (HAL_Delay has a 1 ms step)*/
+static void SensorBus_Delay_Us(uint32_t us)
+{
+	uint32_t load = SysTick->LOAD + 1;
+	uint32_t ticks = us * (load / 1000);
+	uint32_t last = SysTick->VAL, now, elapsed = 0;
+
+	while (elapsed < ticks)
+	{
+		now = SysTick->VAL;
+		elapsed += (last >= now) ? last - now : last + load - now;
+		last = now;
+	}
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  SensorBus_Recover                                                       *
+ * --------------------                                                               *
+ * Releases a device stuck in the middle of a read (it holds SDA low while it waits   *
+ * for the clock of its next bit): SCL is clocked by hand until the device has sent   *
+ * its byte and sees the NACK, then a STOP leaves the bus free. The peripheral has    *
+ * to be stopped, HAL_I2C_Init gives the pins back to it                              *
+ *                                                                                    *
+ *  returns: true if SDA was held low                                                 *
+ *                                                                                    *
+ **************************************************************************************/
+static bool SensorBus_Recover(void)
+{
+	GPIO_InitTypeDef gpio = {0};
+	bool stuck;
+	uint8_t i;
+
+	HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SCL_PIN | SENSOR_BUS_SDA_PIN, GPIO_PIN_SET);
+	gpio.Pin = SENSOR_BUS_SCL_PIN | SENSOR_BUS_SDA_PIN;
+	gpio.Mode = GPIO_MODE_OUTPUT_OD;
+	gpio.Pull = GPIO_NOPULL;
+	gpio.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(SENSOR_BUS_GPIO, &gpio);
+
+	stuck = HAL_GPIO_ReadPin(SENSOR_BUS_GPIO, SENSOR_BUS_SDA_PIN) == GPIO_PIN_RESET;
+	for (i = 0; i < SENSOR_BUS_CLOCKS; i++)
+	{
+		HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SCL_PIN, GPIO_PIN_RESET);
+		SensorBus_Delay_Us(SENSOR_BUS_HALF_US);
+		HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SCL_PIN, GPIO_PIN_SET);
+		SensorBus_Delay_Us(SENSOR_BUS_HALF_US);
+	}
+
+	/*STOP: SDA rises while SCL is high*/
+	HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SCL_PIN, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SDA_PIN, GPIO_PIN_RESET);
+	SensorBus_Delay_Us(SENSOR_BUS_HALF_US);
+	HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SCL_PIN, GPIO_PIN_SET);
+	SensorBus_Delay_Us(SENSOR_BUS_HALF_US);
+	HAL_GPIO_WritePin(SENSOR_BUS_GPIO, SENSOR_BUS_SDA_PIN, GPIO_PIN_SET);
+	SensorBus_Delay_Us(SENSOR_BUS_HALF_US);
+
+	return stuck;
+}
+
+bool SensorBus_Start(SensorBusTransfer *transfers, uint8_t count)
+{
+	if (Running || Bus == NULL) return false;
+
+	TRACE_ENTER(TRACE_I2C_EPOCH);
+	List = transfers;
+	Count = count;
+	Current = 0;
+	EpochStart = HAL_GetTick();
+	Running = true;
+	SensorBus_Next();
+	return true;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  SensorBus_Process                                                       *
+ * --------------------                                                               *
+ * Aborts the current transfer if it has run for SENSOR_BUS_TIMEOUT: the peripheral   *
+ * is stopped, the bus recovered (a device may hold SDA low) and the peripheral       *
+ * initialised again, then the epoch goes on with the next transfer                   *
+ *                                                                                    *
+ *  returns: true if no epoch is running                                              *
+ *                                                                                    *
+ **************************************************************************************/
+bool SensorBus_Process(void)
+{
+	uint32_t primask;
+	bool abort;
+
+	if (!Running) return true;
+	if (HAL_GetTick() - TransferStart < SENSOR_BUS_TIMEOUT) return false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	/*The transfer may have ended since the check, once stopped its interrupts cannot end it*/
+	abort = Running && HAL_GetTick() - TransferStart >= SENSOR_BUS_TIMEOUT;
+	if (abort)
+	{
+		HAL_I2C_DeInit(Bus);
+		List[Current].status = SENSOR_BUS_TIMEOUT_ERROR;
+		Current++;
+	}
+	__set_PRIMASK(primask);
+
+	if (abort)
+	{
+		Stats.timeouts++;
+		if (SensorBus_Recover()) Stats.recoveries++;
+		HAL_I2C_Init(Bus);
+		SensorBus_Next();
+	}
+
+	return !Running;
+}
+
+bool SensorBus_Busy(void)
+{
+	return Running;
+}
+
+const SensorBusStats *SensorBus_Get_Stats(void)
+{
+	return &Stats;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c != Bus || !Running) return;
+	SensorBus_End(SENSOR_BUS_OK);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c != Bus || !Running) return;
+	Stats.errors++;
+	SensorBus_End(SENSOR_BUS_ERROR);
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file      sensor_conv.c
+ *
+ * \brief     Fixed-point conversion of the housekeeping sensors (see sensor_conv.h).
+ *
+ * 			  count * gain is computed in 64 bits (one SMLAL on the Cortex-M4)
+ * 			  and rounded half up with an arithmetic shift, so a 16-bit count
+ * 			  never overflows whatever the gain.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "sensor_conv.h"
+#include "string.h"
+
+/*Datasheet scales in Q24, computed by the compiler*/
+#define Q24(x)		((int32_t)((x) * SENSOR_CONV_ONE + 0.5))
+
+#define SENSOR_CONV_DEFAULTS { \
+	[SENSOR_CONV_TEMP1]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP2]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP3]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP4]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP5]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP6]		= { Q24(0.0625),	0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_TEMP_BATT]	= { Q24(0.125),		0, INT8_MIN, INT8_MAX }, \
+	[SENSOR_CONV_VOLTAGE]	= { Q24(4.88 / 100),	0, 0, UINT8_MAX }, \
+	[SENSOR_CONV_CURRENT]	= { Q24(1.5625e-6 / 0.015 * 10), 0, INT8_MIN, INT8_MAX }, \
+}
+
+static const SensorCalibration Defaults[SENSOR_CONV_CHANNELS] = SENSOR_CONV_DEFAULTS;
+static SensorCalibration Calibration[SENSOR_CONV_CHANNELS] = SENSOR_CONV_DEFAULTS;
+
+static inline int16_t SensorConv_Apply(const SensorCalibration *calibration, int16_t count)
+{
+	int64_t value = (int64_t)count * calibration->gain + calibration->offset;
+
+	value = (value + (SENSOR_CONV_ONE / 2)) >> SENSOR_CONV_Q;
+	if (value < calibration->min) return calibration->min;
+	if (value > calibration->max) return calibration->max;
+	return (int16_t)value;
+}
+
+int16_t SensorConv_Tmp102_Count(const uint8_t reg[2])
+{
+	return (int16_t)(((uint16_t)reg[0] << 8) | reg[1]) >> 4;
+}
+
+int16_t SensorConv_Convert(SensorConvChannel channel, int16_t count)
+{
+	if (channel >= SENSOR_CONV_CHANNELS) return 0;
+	return SensorConv_Apply(&Calibration[channel], count);
+}
+
+void SensorConv_Convert_Batch(SensorConvChannel first, const int16_t *counts, int16_t *values, uint8_t n)
+{
+	const SensorCalibration *calibration;
+	uint8_t i;
+
+	if (first >= SENSOR_CONV_CHANNELS) return;
+	if (first + n > SENSOR_CONV_CHANNELS) n = SENSOR_CONV_CHANNELS - first;
+	calibration = &Calibration[first];
+	for (i = 0; i < n; i++)
+	{
+		values[i] = SensorConv_Apply(&calibration[i], counts[i]);
+	}
+}
+
+bool SensorConv_Set_Calibration(SensorConvChannel channel, const SensorCalibration *calibration)
+{
+	if (channel >= SENSOR_CONV_CHANNELS || calibration->min > calibration->max) return false;
+	Calibration[channel] = *calibration;
+	return true;
+}
+
+void SensorConv_Reset_Calibration(void)
+{
+	memcpy(Calibration, Defaults, sizeof(Calibration));
+}
+
+const SensorCalibration *SensorConv_Get_Calibration(SensorConvChannel channel)
+{
+	if (channel >= SENSOR_CONV_CHANNELS) return NULL;
+	return &Calibration[channel];
+}
@@ -7,6 +7,65 @@
 
 #include "telecommands.h"
 
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  buildTelemetry                                                          *
+ * --------------------                                                               *
+ * Takes the current value of every field of the telemetry frame (telemetry.h), packs *
+ * them and starts a new window of the CPU load, so the next frame has the load since *
+ * this one                                                                           *
+ *                                                                                    *
+ *  frame: where the frame is written, TELEMETRY_FRAME_SIZE bytes                     *
+ *                                                                                    *
+ *  returns: size of the frame                                                        *
+ *                                                                                    *
+ **************************************************************************************/
+uint8_t buildTelemetry(uint8_t *frame) {
+	int32_t values[TELEMETRY_FIELD_COUNT];
+	const SensorSnapshot *snapshot = getSensorSnapshot();
+	const HkStatsSummary *orbit = HkStats_Get_Summary(HK_STATS_ORBIT);
+	const LinkAdaptStats *link = LinkAdapt_Get_Stats();
+	const Temperatures *temperatures = &snapshot->temperatures;
+	uint8_t flag;
+
+	values[TELEMETRY_TIME] = HkLog_Time();
+	values[TELEMETRY_STATE] = currentState;
+	Read_Flash(DEPLOYMENT_STATE_ADDR, &flag, 1);
+	values[TELEMETRY_DEPLOYMENT] = flag != 0;
+	Read_Flash(DEPLOYMENTRF_STATE_ADDR, &flag, 1);
+	values[TELEMETRY_DEPLOYMENT_RF] = flag != 0;
+	Read_Flash(DETUMBLE_STATE_ADDR, &flag, 1);
+	values[TELEMETRY_DETUMBLE] = flag != 0;
+
+	values[TELEMETRY_SENSORS_VALID] = snapshot->valid;
+	values[TELEMETRY_BATT_LEVEL] = snapshot->battery_level;
+	values[TELEMETRY_VOLTAGE] = snapshot->voltage;
+	values[TELEMETRY_CURRENT] = snapshot->current;
+	values[TELEMETRY_TEMP_BATT] = temperatures->fields.tempbatt;
+	values[TELEMETRY_TEMP1] = temperatures->fields.temp1;
+	values[TELEMETRY_TEMP2] = temperatures->fields.temp2;
+	values[TELEMETRY_TEMP3] = temperatures->fields.temp3;
+	values[TELEMETRY_TEMP4] = temperatures->fields.temp4;
+	values[TELEMETRY_TEMP5] = temperatures->fields.temp5;
+	values[TELEMETRY_TEMP6] = temperatures->fields.temp6;
+
+	/*All 0 until the first orbit has ended*/
+	values[TELEMETRY_ORBIT_VOLTAGE_MIN] = orbit->channels[HK_LOG_VOLTAGE].min;
+	values[TELEMETRY_ORBIT_VOLTAGE_MAX] = orbit->channels[HK_LOG_VOLTAGE].max;
+	values[TELEMETRY_ORBIT_CURRENT_MIN] = orbit->channels[HK_LOG_CURRENT].min;
+	values[TELEMETRY_ORBIT_CURRENT_MAX] = orbit->channels[HK_LOG_CURRENT].max;
+	values[TELEMETRY_ORBIT_TEMP_BATT_MIN] = orbit->channels[HK_LOG_TEMP_BATT].min;
+	values[TELEMETRY_ORBIT_TEMP_BATT_MAX] = orbit->channels[HK_LOG_TEMP_BATT].max;
+
+	values[TELEMETRY_SF] = link->SpreadingFactor;
+	values[TELEMETRY_CR] = link->CodingRate;
+	values[TELEMETRY_SNR] = link->Snr;
+	values[TELEMETRY_RSSI] = link->Rssi;
+	values[TELEMETRY_LOAD] = (Scheduler_Get_Load() + 5) / 10;
+	Scheduler_Reset_Load();
+	return Telemetry_Pack(values, frame);
+}
+
 
 /**************************************************************************************
  *                                                                                    *
@@ -26,6 +85,7 @@ void process_telecommand(uint8_t header, uint8_t info) {
 	case RESET2:
 		/*Segons el drive s'ha de fer el reset si val 1 el bit, així que potser
 		 * s'hauria de posar un if*/
+		Flash_Cache_Flush(); /*Nothing pending in RAM can be lost*/
 		HAL_NVIC_SystemReset();
 		break;
 	case NOMINAL:
@@ -61,7 +121,7 @@ void process_telecommand(uint8_t header, uint8_t info) {
 
 		break;
 	case SENDTELEMETRY:
-
+		/*The frame of buildTelemetry() is sent by comms.c, nothing to do until the comms exist*/
 		break;
 	case STOPSENDINGDATA:
 
@@ -70,25 +130,56 @@ void process_telecommand(uint8_t header, uint8_t info) {
 
 		break;
 	case SET_SF: ; //semicolon added in order to be able to declare SF here
-		uint8_t SF;
-		if (info == 0) SF = 7;
-		else if (info == 1) {uint8_t SF = 8;}
-		else if (info == 2) {uint8_t SF = 9;}
-		else if (info == 3) {uint8_t SF = 10;}
-		else if (info == 4) {uint8_t SF = 11;}
-		else if (info == 5) {uint8_t SF = 12;}
+		/*0..5 => SF7..SF12*/
+		uint8_t SF = 7 + info;
+		if (info > 5) break;
 		Write_Flash(SF_ADDR, &SF, 1);
+		LinkAdapt_Load(); /*The link adaptation starts again from the new SF*/
 		break;
 	case SET_CRC:
 		/*4 cases (4/5, 4/6, 4/7,1/2), so we will receive and store 0, 1, 2 or 3*/
+		if (info > 3) break;
 		Write_Flash(CRC_ADDR, &info, 1);
+		LinkAdapt_Load();
 		break;
 	case SEND_CALIBRATION:
 
 		break;
-	case TAKEPHOTO:
+	case SEND_TRACE: ; //semicolon added in order to be able to declare the piece here
+		/*Empty (0 bytes) when everything was sent or the probes are not compiled*/
+		uint8_t trace[TELEMETRY_MAX_SIZE];
+		uint16_t traceLength = Trace_Peek(trace, sizeof(trace));
+		(void)traceLength;
+		//Send(), and Trace_Commit() once it is acknowledged
+		break;
+	case SEND_HK_LOG: ; //semicolon added in order to be able to declare the block here
+		/*From the block holding the time info hours ago to the open one, each block as it is, in packets*/
+		uint8_t hkFragment[TELEMETRY_MAX_SIZE];
+		uint32_t hkNow = HkLog_Time();
+		uint32_t hkFrom = (uint32_t)info * 3600 < hkNow ? hkNow - (uint32_t)info * 3600 : 0;
+		uint16_t hkLast = HkLog_Blocks();
+		uint16_t hk, hkOffset, hkLength;
+		for (hk = HkLog_Find(hkFrom); hk < hkLast; hk++) {
+			hkOffset = 0;
+			while ((hkLength = HkLog_Read_Fragment(hk, hkOffset, hkFragment, sizeof(hkFragment))) != 0) {
+				//Send()
+				hkOffset += hkLength - HK_LOG_FRAGMENT_HEADER;
+			}
+		}
+		break;
+	case SEND_HK_STATS: ; //semicolon added in order to be able to declare the frame here
+		/*Nothing to send until the first window has ended, then a packet per frame*/
+		uint8_t hkStats[HK_STATS_FRAME_SIZE];
+		uint8_t hkPart;
+		for (hkPart = 0; hkPart < HK_STATS_FRAMES; hkPart++) {
+			if (HkStats_Frame(info, hkPart, hkStats, sizeof(hkStats)) == 0) break;
+			//Send()
+		}
+		break;
+	case TAKEPHOTO: ; //semicolon added in order to be able to declare the state here
 		/*GUARDAR TEMPS FOTO?*/
-		Write_Flash(PAYLOAD_STATE_ADDR, TRUE, 1);
+		uint8_t photoState = TRUE;
+		Write_Flash(PAYLOAD_STATE_ADDR, &photoState, 1);
 		Write_Flash(PL_TIME_ADDR, &info, 4);
 		break;
 	case SET_PHOTO_RESOL:
@@ -97,8 +188,9 @@ void process_telecommand(uint8_t header, uint8_t info) {
 	case PHOTO_COMPRESSION:
 		Write_Flash(PHOTO_COMPRESSION_ADDR, &info, 1);
 		break;
-	case TAKERF:
-		Write_Flash(PAYLOAD_STATE_ADDR, TRUE, 1);
+	case TAKERF: ; //semicolon added in order to be able to declare the state here
+		uint8_t rfState = TRUE;
+		Write_Flash(PAYLOAD_STATE_ADDR, &rfState, 1);
 		Write_Flash(PL_TIME_ADDR, &info, 4);
 		break;
 	case F_MIN:
@@ -115,7 +207,7 @@ void process_telecommand(uint8_t header, uint8_t info) {
 		break;
 	case SEND_CONFIG: ; //semicolon added in order to be able to declare SF here
 		uint8_t config[CONFIG_SIZE];
-		Read_Flash(CONFIG_ADDR, &config, CONFIG_SIZE);
+		Read_Flash(CONFIG_ADDR, config, CONFIG_SIZE);
 		//Send()
 		break;
 	}
@@ -0,0 +1,114 @@
+/*!
+ * \file      telemetry.c
+ *
+ * \brief     Bit-packed telemetry frame (see telemetry.h).
+ *
+ * 			  The fields go through a 64-bit accumulator: a field (up to 32 bits)
+ * 			  is added above the bits already there and every complete byte is
+ * 			  moved out, so a frame is one pass over the schema without reading
+ * 			  the frame back.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "telemetry.h"
+
+typedef struct {
+	uint8_t bits;
+	int32_t min;
+} TelemetryFieldSchema;
+
+#define TELEMETRY_FIELD_SCHEMA(name, bits, min)	{ (bits), (min) },
+#define TELEMETRY_FIELD_CHECK(name, bits, min) \
+	_Static_assert((bits) >= 1 && (bits) <= 32, "The width of " #name " has to be 1..32 bits");
+
+static const TelemetryFieldSchema Schema[TELEMETRY_FIELD_COUNT] = {
+	TELEMETRY_FIELDS(TELEMETRY_FIELD_SCHEMA)
+};
+
+TELEMETRY_FIELDS(TELEMETRY_FIELD_CHECK)
+_Static_assert(TELEMETRY_FRAME_SIZE <= TELEMETRY_MAX_SIZE, "The telemetry frame does not fit in a packet");
+
+static uint32_t Telemetry_Mask(uint8_t bits)
+{
+	return (uint32_t)(((uint64_t)1 << bits) - 1);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Telemetry_Pack                                                          *
+ * --------------------                                                               *
+ * Writes the frame id and every field with its width. A value out of the range of    *
+ * its field is saturated                                                             *
+ *                                                                                    *
+ *  values: TELEMETRY_FIELD_COUNT values, indexed by TelemetryField                   *
+ *  frame: where the frame is written, TELEMETRY_FRAME_SIZE bytes                     *
+ *                                                                                    *
+ *  returns: bytes written                                                            *
+ *                                                                                    *
+ **************************************************************************************/
+uint8_t Telemetry_Pack(const int32_t *values, uint8_t *frame)
+{
+	uint64_t bits = 0;
+	uint8_t count = 0;
+	uint8_t *p = frame;
+	int64_t value;
+	uint8_t f;
+
+	*p++ = TELEMETRY_FRAME_ID;
+	for (f = 0; f < TELEMETRY_FIELD_COUNT; f++)
+	{
+		value = (int64_t)values[f] - Schema[f].min;
+		if (value < 0) value = 0;
+		if (value > Telemetry_Mask(Schema[f].bits)) value = Telemetry_Mask(Schema[f].bits);
+
+		bits |= (uint64_t)value << count;
+		count += Schema[f].bits;
+		while (count >= 8)
+		{
+			*p++ = (uint8_t)bits;
+			bits >>= 8;
+			count -= 8;
+		}
+	}
+	if (count != 0) *p++ = (uint8_t)bits;
+
+	return (uint8_t)(p - frame);
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Telemetry_Unpack                                                        *
+ * --------------------                                                               *
+ * Reads every field of a frame (on the ground, or to check a frame on board)         *
+ *                                                                                    *
+ *  frame: frame received                                                             *
+ *  length: bytes received                                                            *
+ *  values: TELEMETRY_FIELD_COUNT values, indexed by TelemetryField                   *
+ *                                                                                    *
+ *  returns: false if the id or the length do not match this schema                   *
+ *                                                                                    *
+ **************************************************************************************/
+bool Telemetry_Unpack(const uint8_t *frame, uint8_t length, int32_t *values)
+{
+	uint64_t bits = 0;
+	uint8_t count = 0;
+	const uint8_t *p = frame + 1;
+	uint8_t f;
+
+	if (length < TELEMETRY_FRAME_SIZE || frame[0] != TELEMETRY_FRAME_ID) return false;
+
+	for (f = 0; f < TELEMETRY_FIELD_COUNT; f++)
+	{
+		while (count < Schema[f].bits)
+		{
+			bits |= (uint64_t)*p++ << count;
+			count += 8;
+		}
+		values[f] = (int32_t)((int64_t)(bits & Telemetry_Mask(Schema[f].bits)) + Schema[f].min);
+		bits >>= Schema[f].bits;
+		count -= Schema[f].bits;
+	}
+	return true;
+}
@@ -1,407 +1,324 @@
-///*
-// / _____)             _              | |
-//( (____  _____ ____ _| |_ _____  ____| |__
-// \____ \| ___ |    (_   _) ___ |/ ___)  _ \
-// _____) ) ____| | | || |_| ____( (___| | | |
-//(______/|_____)_|_|_| \__)_____)\____)_| |_|
-//    (C)2013 Semtech
-//
-//Description: Timer objects and scheduling management
-//
-//License: Revised BSD License, see LICENSE.TXT file include in the project
-//
-//Maintainer: Miguel Luis and Gregory Cristian
-//*/
-////#include "board.h"
-////#include "rtc-board.h"
-//
-//#include "timer.h"
-//
-//
-///*!
-// * This flag is used to loop through the main several times in order to be sure
-// * that all pending events have been processed.
-// */
-//volatile uint8_t HasLoopedThroughMain = 0;
-//
-///*!
-// * Timers list head pointer
-// */
-//static TimerEvent_t *TimerListHead = NULL;
-//
-///*!
-// * \brief Adds or replace the head timer of the list.
-// *
-// * \remark The list is automatically sorted. The list head always contains the
-// *         next timer to expire.
-// *
-// * \param [IN]  obj Timer object to be become the new head
-// * \param [IN]  remainingTime Remaining time of the previous head to be replaced
-// */
-//static void TimerInsertNewHeadTimer( TimerEvent_t *obj, uint32_t remainingTime );
-//
-///*!
-// * \brief Adds a timer to the list.
-// *
-// * \remark The list is automatically sorted. The list head always contains the
-// *         next timer to expire.
-// *
-// * \param [IN]  obj Timer object to be added to the list
-// * \param [IN]  remainingTime Remaining time of the running head after which the object may be added
-// */
-//static void TimerInsertTimer( TimerEvent_t *obj, uint32_t remainingTime );
-//
-///*!
-// * \brief Sets a timeout with the duration "timestamp"
-// *
-// * \param [IN] timestamp Delay duration
-// */
-//static void TimerSetTimeout( TimerEvent_t *obj );
-//
-///*!
-// * \brief Check if the Object to be added is not already in the list
-// *
-// * \param [IN] timestamp Delay duration
-// * \retval true (the object is already in the list) or false
-// */
-//static bool TimerExists( TimerEvent_t *obj );
-//
-///*!
-// * \brief Read the timer value of the currently running timer
-// *
-// * \retval value current timer value
-// */
-//TimerTime_t TimerGetValue( void );
-//
-//void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) )
-//{
-//    obj->Timestamp = 0;
-//    obj->ReloadValue = 0;
-//    obj->IsRunning = false;
-//    obj->Callback = callback;
-//    obj->Next = NULL;
-//}
-//
-//void TimerStart( TimerEvent_t *obj )
-//{
-//    uint32_t elapsedTime = 0;
-//    uint32_t remainingTime = 0;
-//
-//    BoardDisableIrq( );
-//
-//    if( ( obj == NULL ) || ( TimerExists( obj ) == true ) )
-//    {
-//        BoardEnableIrq( );
-//        return;
-//    }
-//
-//    obj->Timestamp = obj->ReloadValue;
-//    obj->IsRunning = false;
-//
-//    if( TimerListHead == NULL )
-//    {
-//        TimerInsertNewHeadTimer( obj, obj->Timestamp );
-//    }
-//    else
-//    {
-//        if( TimerListHead->IsRunning == true )
-//        {
-//            elapsedTime = TimerGetValue( );
-//            if( elapsedTime > TimerListHead->Timestamp )
-//            {
-//                elapsedTime = TimerListHead->Timestamp; // security but should never occur
-//            }
-//            remainingTime = TimerListHead->Timestamp - elapsedTime;
-//        }
-//        else
-//        {
-//            remainingTime = TimerListHead->Timestamp;
-//        }
-//
-//        if( obj->Timestamp < remainingTime )
-//        {
-//            TimerInsertNewHeadTimer( obj, remainingTime );
-//        }
-//        else
-//        {
-//             TimerInsertTimer( obj, remainingTime );
-//        }
-//    }
-//    BoardEnableIrq( );
-//}
-//
-//static void TimerInsertTimer( TimerEvent_t *obj, uint32_t remainingTime )
-//{
-//    uint32_t aggregatedTimestamp = 0;      // hold the sum of timestamps
-//    uint32_t aggregatedTimestampNext = 0;  // hold the sum of timestamps up to the next event
-//
-//    TimerEvent_t* prev = TimerListHead;
-//    TimerEvent_t* cur = TimerListHead->Next;
-//
-//    if( cur == NULL )
-//    { // obj comes just after the head
-//        obj->Timestamp -= remainingTime;
-//        prev->Next = obj;
-//        obj->Next = NULL;
-//    }
-//    else
-//    {
-//        aggregatedTimestamp = remainingTime;
-//        aggregatedTimestampNext = remainingTime + cur->Timestamp;
-//
-//        while( prev != NULL )
-//        {
-//            if( aggregatedTimestampNext > obj->Timestamp )
-//            {
-//                obj->Timestamp -= aggregatedTimestamp;
-//                if( cur != NULL )
-//                {
-//                    cur->Timestamp -= obj->Timestamp;
-//                }
-//                prev->Next = obj;
-//                obj->Next = cur;
-//                break;
-//            }
-//            else
-//            {
-//                prev = cur;
-//                cur = cur->Next;
-//                if( cur == NULL )
-//                { // obj comes at the end of the list
-//                    aggregatedTimestamp = aggregatedTimestampNext;
-//                    obj->Timestamp -= aggregatedTimestamp;
-//                    prev->Next = obj;
-//                    obj->Next = NULL;
-//                    break;
-//                }
-//                else
-//                {
-//                    aggregatedTimestamp = aggregatedTimestampNext;
-//                    aggregatedTimestampNext = aggregatedTimestampNext + cur->Timestamp;
-//                }
-//            }
-//        }
-//    }
-//}
-//
-//static void TimerInsertNewHeadTimer( TimerEvent_t *obj, uint32_t remainingTime )
-//{
-//    TimerEvent_t* cur = TimerListHead;
-//
-//    if( cur != NULL )
-//    {
-//        cur->Timestamp = remainingTime - obj->Timestamp;
-//        cur->IsRunning = false;
-//    }
-//
-//    obj->Next = cur;
-//    obj->IsRunning = true;
-//    TimerListHead = obj;
-//    TimerSetTimeout( TimerListHead );
-//}
-//
-//void TimerIrqHandler( void )
-//{
-//    uint32_t elapsedTime = 0;
-//
-//    // Early out when TimerListHead is null to prevent null pointer
-//    if ( TimerListHead == NULL )
-//    {
-//        return;
-//    }
-//
-//    elapsedTime = TimerGetValue( );
-//
-//    if( elapsedTime >= TimerListHead->Timestamp )
-//    {
-//        TimerListHead->Timestamp = 0;
-//    }
-//    else
-//    {
-//        TimerListHead->Timestamp -= elapsedTime;
-//    }
-//
-//    TimerListHead->IsRunning = false;
-//
-//    while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp == 0 ) )
-//    {
-//        TimerEvent_t* elapsedTimer = TimerListHead;
-//        TimerListHead = TimerListHead->Next;
-//
-//        if( elapsedTimer->Callback != NULL )
-//        {
-//            elapsedTimer->Callback( );
-//        }
-//    }
-//
-//    // start the next TimerListHead if it exists
-//    if( TimerListHead != NULL )
-//    {
-//        if( TimerListHead->IsRunning != true )
-//        {
-//            TimerListHead->IsRunning = true;
-//            TimerSetTimeout( TimerListHead );
-//        }
-//    }
-//}
-//
-//void TimerStop( TimerEvent_t *obj )
-//{
-//    BoardDisableIrq( );
-//
-//    uint32_t elapsedTime = 0;
-//    uint32_t remainingTime = 0;
-//
-//    TimerEvent_t* prev = TimerListHead;
-//    TimerEvent_t* cur = TimerListHead;
-//
-//    // List is empty or the Obj to stop does not exist
-//    if( ( TimerListHead == NULL ) || ( obj == NULL ) )
-//    {
-//        BoardEnableIrq( );
-//        return;
-//    }
-//
-//    if( TimerListHead == obj ) // Stop the Head
-//    {
-//        if( TimerListHead->IsRunning == true ) // The head is already running
-//        {
-//            elapsedTime = TimerGetValue( );
-//            if( elapsedTime > obj->Timestamp )
-//            {
-//                elapsedTime = obj->Timestamp;
-//            }
-//
-//            remainingTime = obj->Timestamp - elapsedTime;
-//
-//            if( TimerListHead->Next != NULL )
-//            {
-//                TimerListHead->IsRunning = false;
-//                TimerListHead = TimerListHead->Next;
-//                TimerListHead->Timestamp += remainingTime;
-//                TimerListHead->IsRunning = true;
-//                TimerSetTimeout( TimerListHead );
-//            }
-//            else
-//            {
-//                TimerListHead = NULL;
-//            }
-//        }
-//        else // Stop the head before it is started
-//        {
-//            if( TimerListHead->Next != NULL )
-//            {
-//                remainingTime = obj->Timestamp;
-//                TimerListHead = TimerListHead->Next;
-//                TimerListHead->Timestamp += remainingTime;
-//            }
-//            else
-//            {
-//                TimerListHead = NULL;
-//            }
-//        }
-//    }
-//    else // Stop an object within the list
-//    {
-//        remainingTime = obj->Timestamp;
-//
-//        while( cur != NULL )
-//        {
-//            if( cur == obj )
-//            {
-//                if( cur->Next != NULL )
-//                {
-//                    cur = cur->Next;
-//                    prev->Next = cur;
-//                    cur->Timestamp += remainingTime;
-//                }
-//                else
-//                {
-//                    cur = NULL;
-//                    prev->Next = cur;
-//                }
-//                break;
-//            }
-//            else
-//            {
-//                prev = cur;
-//                cur = cur->Next;
-//            }
-//        }
-//    }
-//    BoardEnableIrq( );
-//}
-//
-//static bool TimerExists( TimerEvent_t *obj )
-//{
-//    TimerEvent_t* cur = TimerListHead;
-//
-//    while( cur != NULL )
-//    {
-//        if( cur == obj )
-//        {
-//            return true;
-//        }
-//        cur = cur->Next;
-//    }
-//    return false;
-//}
-//
-//void TimerReset( TimerEvent_t *obj )
-//{
-//    TimerStop( obj );
-//    TimerStart( obj );
-//}
-//
-//void TimerSetValue( TimerEvent_t *obj, uint32_t value )
-//{
-//    TimerStop( obj );
-//    obj->Timestamp = value;
-//    obj->ReloadValue = value;
-//}
-//
-//TimerTime_t TimerGetValue( void )
-//{
-//    return RtcGetElapsedAlarmTime( );
-//}
-//
-//TimerTime_t TimerGetCurrentTime( void )
-//{
-//    return RtcGetTimerValue( );
-//}
-//
-//TimerTime_t TimerGetElapsedTime( TimerTime_t savedTime )
-//{
-//    return RtcComputeElapsedTime( savedTime );
-//}
-//
-//TimerTime_t TimerGetFutureTime( TimerTime_t eventInFuture )
-//{
-//    return RtcComputeFutureEventTime( eventInFuture );
-//}
-//
-//static void TimerSetTimeout( TimerEvent_t *obj )
-//{
-//    HasLoopedThroughMain = 0;
-//    obj->Timestamp = RtcGetAdjustedTimeoutValue( obj->Timestamp );
-//    RtcSetTimeout( obj->Timestamp );
-//}
-//
-//void TimerLowPowerHandler( void )
-//{
-//    if( ( TimerListHead != NULL ) && ( TimerListHead->IsRunning == true ) )
-//    {
-//        if( HasLoopedThroughMain < 5 )
-//        {
-//            HasLoopedThroughMain++;
-//        }
-//        else
-//        {
-//            HasLoopedThroughMain = 0;
-//            if( GetBoardPowerSource( ) == BATTERY_POWER )
-//            {
-//                RtcEnterLowPowerStopMode( );
-//            }
-//        }
-//    }
-//}
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013 Semtech
+
+Description: Timer objects and scheduling management
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis and Gregory Cristian
+*/
+/*
+ * The sorted delta list of the original driver (O(n) insertion and a full scan
+ * in TimerExists on every start) is replaced by a hierarchical timing wheel
+ * driven by the 1 ms SysTick:
+ *
+ *   level 0: 64 slots of 1 tick, level 1: 64 slots of 64 ticks, ... 4 levels
+ *   (2^24 ms, longer timers are parked in the last slot and inserted again)
+ *
+ * Start, stop and reset are O(1): a timer is put in the slot of its expiry
+ * tick at the level that covers its remaining time, and every slot is a list
+ * with a pointer to the previous link so a timer can be removed without
+ * searching. When the lower levels wrap, the slot of the next level is spread
+ * again. A bitmap of the occupied slots of every level gives the next expiry
+ * for tickless idle without scanning.
+ */
+#include "timer.h"
+#include "stm32f4xx_hal.h"
+
+#define TIMER_WHEEL_LEVELS      4
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       ( 1 << TIMER_WHEEL_BITS )
+#define TIMER_WHEEL_MASK        ( TIMER_WHEEL_SLOTS - 1 )
+#define TIMER_WHEEL_SPAN        ( 1UL << ( TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS ) )
+
+/*!
+ * Slots of the wheel and bitmap of the slots that are not empty
+ */
+static TimerEvent_t *Wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint64_t Occupied[TIMER_WHEEL_LEVELS];
+
+/*!
+ * Last tick processed by the wheel
+ */
+static volatile uint32_t WheelTime = 0;
+static bool WheelReady = false;
+
+static uint32_t TimerEnterCritical( void )
+{
+    uint32_t primask = __get_PRIMASK( );
+
+    __disable_irq( );
+    return primask;
+}
+
+static void TimerExitCritical( uint32_t primask )
+{
+    __set_PRIMASK( primask );
+}
+
+/*!
+ * \brief Links the timer in the slot of its expiry tick
+ */
+static void TimerWheelInsert( TimerEvent_t *obj )
+{
+    uint32_t delta = obj->Timestamp - WheelTime;
+    uint32_t expiry = obj->Timestamp;
+    uint8_t level;
+    uint8_t slot;
+
+    if( delta >= TIMER_WHEEL_SPAN )
+    {
+        // Parked in the farthest slot, it is inserted again when this slot is spread
+        delta = TIMER_WHEEL_SPAN - 1;
+        expiry = WheelTime + delta;
+    }
+    for( level = 0; level < TIMER_WHEEL_LEVELS - 1; level++ )
+    {
+        if( delta < ( 1UL << ( TIMER_WHEEL_BITS * ( level + 1 ) ) ) )
+        {
+            break;
+        }
+    }
+    slot = ( expiry >> ( TIMER_WHEEL_BITS * level ) ) & TIMER_WHEEL_MASK;
+
+    obj->Next = Wheel[level][slot];
+    if( obj->Next != NULL )
+    {
+        obj->Next->Prev = &obj->Next;
+    }
+    obj->Prev = &Wheel[level][slot];
+    Wheel[level][slot] = obj;
+    Occupied[level] |= 1ULL << slot;
+}
+
+/*!
+ * \brief Unlinks the timer from its slot
+ */
+static void TimerWheelRemove( TimerEvent_t *obj )
+{
+    uint32_t index;
+
+    *obj->Prev = obj->Next;
+    if( obj->Next != NULL )
+    {
+        obj->Next->Prev = obj->Prev;
+    }
+    // If it was the last one of the slot, the slot is not occupied anymore
+    if( obj->Prev >= &Wheel[0][0] && obj->Prev < &Wheel[0][0] + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS &&
+        *obj->Prev == NULL )
+    {
+        index = obj->Prev - &Wheel[0][0];
+        Occupied[index / TIMER_WHEEL_SLOTS] &= ~( 1ULL << ( index % TIMER_WHEEL_SLOTS ) );
+    }
+    obj->Next = NULL;
+    obj->Prev = NULL;
+}
+
+/*!
+ * \brief Moves the timers of a slot of an upper level to the lower levels
+ */
+static void TimerWheelCascade( uint8_t level, uint8_t slot )
+{
+    TimerEvent_t *obj;
+
+    while( ( obj = Wheel[level][slot] ) != NULL )
+    {
+        TimerWheelRemove( obj );
+        TimerWheelInsert( obj );
+    }
+}
+
+/*!
+ * \brief Advances the wheel one tick and runs the timers that expire
+ */
+static void TimerWheelStep( void )
+{
+    TimerEvent_t *obj;
+    uint32_t primask;
+    uint8_t level;
+    uint8_t slot;
+
+    primask = TimerEnterCritical( );
+    WheelTime++;
+    for( level = 1; level < TIMER_WHEEL_LEVELS; level++ )
+    {
+        if( ( WheelTime & ( ( 1UL << ( TIMER_WHEEL_BITS * level ) ) - 1 ) ) != 0 )
+        {
+            break;
+        }
+        TimerWheelCascade( level, ( WheelTime >> ( TIMER_WHEEL_BITS * level ) ) & TIMER_WHEEL_MASK );
+    }
+
+    // A callback can start or stop timers, so the slot is emptied one timer at a time
+    slot = WheelTime & TIMER_WHEEL_MASK;
+    while( ( obj = Wheel[0][slot] ) != NULL )
+    {
+        TimerWheelRemove( obj );
+        if( obj->Timestamp != WheelTime )
+        {
+            TimerWheelInsert( obj );
+            continue;
+        }
+        obj->IsRunning = false;
+        TimerExitCritical( primask );
+        if( obj->Callback != NULL )
+        {
+            obj->Callback( );
+        }
+        primask = TimerEnterCritical( );
+    }
+    TimerExitCritical( primask );
+}
+
+void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) )
+{
+    obj->Timestamp = 0;
+    obj->ReloadValue = 0;
+    obj->IsRunning = false;
+    obj->Callback = callback;
+    obj->Next = NULL;
+    obj->Prev = NULL;
+}
+
+void TimerStart( TimerEvent_t *obj )
+{
+    uint32_t primask = TimerEnterCritical( );
+
+    if( !WheelReady )
+    {
+        WheelTime = HAL_GetTick( );
+        WheelReady = true;
+    }
+    if( obj->IsRunning )
+    {
+        TimerWheelRemove( obj );
+    }
+    // A zero delay expires on the next tick, the current one may already be processed
+    obj->Timestamp = WheelTime + ( obj->ReloadValue > 0 ? obj->ReloadValue : 1 );
+    obj->IsRunning = true;
+    TimerWheelInsert( obj );
+
+    TimerExitCritical( primask );
+}
+
+void TimerIrqHandler( void )
+{
+    uint32_t now = HAL_GetTick( );
+    uint32_t primask;
+    TimerTime_t ahead;
+
+    if( !WheelReady )
+    {
+        return;
+    }
+    // Catches up the ticks missed (tickless idle): the ticks without an expiry or a
+    // cascade are skipped, so a long sleep costs one step per event, not per tick
+    while( WheelTime != now )
+    {
+        primask = TimerEnterCritical( );
+        ahead = TimerGetTimeToNextEvent( );
+        if( ahead > now - WheelTime )
+        {
+            ahead = now - WheelTime;
+        }
+        WheelTime += ahead - 1;
+        TimerExitCritical( primask );
+        TimerWheelStep( );
+    }
+}
+
+void TimerStop( TimerEvent_t *obj )
+{
+    uint32_t primask = TimerEnterCritical( );
+
+    if( obj->IsRunning )
+    {
+        TimerWheelRemove( obj );
+        obj->IsRunning = false;
+    }
+
+    TimerExitCritical( primask );
+}
+
+void TimerReset( TimerEvent_t *obj )
+{
+    TimerStop( obj );
+    TimerStart( obj );
+}
+
+void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+{
+    TimerStop( obj );
+    obj->Timestamp = value;
+    obj->ReloadValue = value;
+}
+
+TimerTime_t TimerGetCurrentTime( void )
+{
+    return HAL_GetTick( );
+}
+
+TimerTime_t TimerGetElapsedTime( TimerTime_t savedTime )
+{
+    return TimerGetCurrentTime( ) - savedTime;
+}
+
+TimerTime_t TimerGetFutureTime( TimerTime_t eventInFuture )
+{
+    return eventInFuture - TimerGetCurrentTime( );
+}
+
+/*!
+ * For every level, the first occupied slot after the current position gives the
+ * next expiry (level 0) or the next cascade (upper levels). A timer of an upper
+ * level can be due before the ones of a lower level inserted later, so the
+ * earliest of all the levels is taken; it is never later than the first expiry
+ */
+TimerTime_t TimerGetTimeToNextEvent( void )
+{
+    uint32_t primask = TimerEnterCritical( );
+    TimerTime_t next = TIMER_NO_EVENT;
+    TimerTime_t ticks;
+    uint32_t position;
+    uint64_t ahead;
+    uint8_t level;
+    uint8_t shift;
+    uint8_t slots;
+
+    for( level = 0; level < TIMER_WHEEL_LEVELS; level++ )
+    {
+        if( Occupied[level] == 0 )
+        {
+            continue;
+        }
+        shift = TIMER_WHEEL_BITS * level;
+        position = ( WheelTime >> shift ) & TIMER_WHEEL_MASK;
+        // Rotate so bit 0 is the slot after the current one
+        ahead = ( Occupied[level] >> ( ( position + 1 ) & TIMER_WHEEL_MASK ) ) |
+                ( Occupied[level] << ( ( TIMER_WHEEL_SLOTS - position - 1 ) & TIMER_WHEEL_MASK ) );
+        slots = __builtin_ctzll( ahead ) + 1;
+        // Ticks until that slot starts
+        ticks = ( ( ( WheelTime >> shift ) + slots ) << shift ) - WheelTime;
+        if( ticks < next )
+        {
+            next = ticks;
+        }
+    }
+
+    TimerExitCritical( primask );
+    return next;
+}
+
+void TimerLowPowerHandler( void )
+{
+    // Nothing expires before the next tick: sleep until the next interrupt
+    if( TimerGetTimeToNextEvent( ) > 1 )
+    {
+        __WFI( );
+    }
+}
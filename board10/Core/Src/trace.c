@@ -0,0 +1,197 @@
+/*!
+ * \file      trace.c
+ *
+ * \brief     Enter / exit probes with cycle timestamps (see trace.h).
+ *
+ * 			  The records are stored as two arrays (timestamps and probes), 6
+ * 			  bytes each without padding. A full ring drops its oldest record,
+ * 			  the last moments before a problem are the useful ones. Writer and
+ * 			  reader share Tail, so both run with the interrupts masked; a record
+ * 			  only holds them for a few cycles.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "trace.h"
+#include "stm32f4xx_hal.h"
+#include "string.h"
+
+#define TRACE_MASK		(TRACE_SIZE - 1)
+
+_Static_assert((TRACE_SIZE & TRACE_MASK) == 0 && TRACE_SIZE <= 0x8000,
+			   "The trace size has to be a power of 2 that fits the 16-bit indexes");
+
+static uint32_t Cycles[TRACE_SIZE];
+static uint16_t Probes[TRACE_SIZE];
+static uint16_t Head = 0;
+static uint16_t Tail = 0;
+static uint16_t Lost = 0;
+static volatile bool Enabled = false;
+
+/*Piece encoded by the last Trace_Peek, removed by Trace_Commit*/
+static uint16_t PeekTail;
+static uint16_t PeekCount = 0;
+static uint16_t PeekLost = 0;
+
+void Trace_Init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	Head = 0;
+	Tail = 0;
+	Lost = 0;
+	PeekCount = 0;
+	PeekLost = 0;
+	Enabled = true;
+}
+
+void Trace_Enable(bool enable)
+{
+	Enabled = enable;
+}
+
+void Trace_Record(uint16_t probe)
+{
+	uint32_t primask;
+
+	if (!Enabled) return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if ((uint16_t)(Head - Tail) == TRACE_SIZE)
+	{
+		Tail++;		/*Overwrites the oldest record*/
+		if (Lost < 0xFFFF) Lost++;
+	}
+	Cycles[Head & TRACE_MASK] = TRACE_CLOCK();
+	Probes[Head & TRACE_MASK] = probe;
+	Head++;
+	__set_PRIMASK(primask);
+}
+
+/*Little-endian LEB128, returns the bytes written (at most 5)*/
+static uint8_t Trace_Varint(uint8_t *buffer, uint32_t value)
+{
+	uint8_t n = 0;
+
+	while (value >= 0x80)
+	{
+		buffer[n++] = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	buffer[n++] = (uint8_t)value;
+	return n;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Trace_Peek                                                              *
+ * --------------------                                                               *
+ * Encodes the oldest records (header, then probe and cycles since the previous one)  *
+ * until the buffer is full. They stay in the ring until Trace_Commit                 *
+ *                                                                                    *
+ *  buffer: where the piece of trace is written                                       *
+ *  size: bytes available                                                             *
+ *                                                                                    *
+ *  returns: bytes written, 0 if there are no records or the buffer is too small      *
+ *                                                                                    *
+ **************************************************************************************/
+uint16_t Trace_Peek(uint8_t *buffer, uint16_t size)
+{
+	uint8_t encoded[7];
+	uint32_t primask, previous = 0, cycles;
+	uint16_t length = TRACE_HEADER_SIZE, count = 0, lost, probe, tail;
+	uint8_t n;
+
+	PeekCount = 0;
+	PeekLost = 0;
+	if (size < TRACE_HEADER_SIZE) return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	lost = Lost;
+	tail = Tail;
+	__set_PRIMASK(primask);
+
+	while (1)
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		/*Overwritten meanwhile: the piece ends at the gap, the next one reports it*/
+		if ((uint16_t)(tail + count - Tail) >= (uint16_t)(Head - Tail))
+		{
+			__set_PRIMASK(primask);
+			break;
+		}
+		cycles = Cycles[(tail + count) & TRACE_MASK];
+		probe = Probes[(tail + count) & TRACE_MASK];
+		__set_PRIMASK(primask);
+
+		encoded[0] = (uint8_t)probe;
+		encoded[1] = (uint8_t)(probe >> 8);
+		n = 2 + Trace_Varint(&encoded[2], count ? cycles - previous : cycles);
+		if (length + n > size) break;
+
+		memcpy(&buffer[length], encoded, n);
+		length += n;
+		previous = cycles;
+		count++;
+	}
+
+	if (count == 0 && lost == 0) return 0;
+
+	PeekTail = tail;
+	PeekCount = count;
+	PeekLost = lost;
+
+	buffer[0] = 'T';
+	buffer[1] = 'R';
+	buffer[2] = TRACE_VERSION;
+	buffer[3] = (uint8_t)count;
+	buffer[4] = (uint8_t)(count >> 8);
+	buffer[5] = (uint8_t)lost;
+	buffer[6] = (uint8_t)(lost >> 8);
+	buffer[7] = (uint8_t)SystemCoreClock;
+	buffer[8] = (uint8_t)(SystemCoreClock >> 8);
+	buffer[9] = (uint8_t)(SystemCoreClock >> 16);
+	buffer[10] = (uint8_t)(SystemCoreClock >> 24);
+	return length;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  Trace_Commit                                                            *
+ * --------------------                                                               *
+ * Removes the records of the last Trace_Peek, once its piece has been delivered.     *
+ * Those overwritten since the peek were delivered too, so they are not counted as    *
+ * lost                                                                               *
+ *                                                                                    *
+ *  returns: Nothing                                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+void Trace_Commit(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint16_t overwritten, sent;
+
+	__disable_irq();
+	overwritten = Tail - PeekTail;
+	sent = PeekLost + (overwritten < PeekCount ? overwritten : PeekCount);
+	if (overwritten < PeekCount) Tail = PeekTail + PeekCount;
+	Lost = Lost > sent ? Lost - sent : 0;
+	PeekCount = 0;
+	PeekLost = 0;
+	__set_PRIMASK(primask);
+}
+
+/*Trace_Peek and Trace_Commit, for a link that cannot lose the piece*/
+uint16_t Trace_Dump(uint8_t *buffer, uint16_t size)
+{
+	uint16_t length = Trace_Peek(buffer, size);
+
+	Trace_Commit();
+	return length;
+}
@@ -0,0 +1,111 @@
+/*!
+ * \file      hal_sim.h
+ *
+ * \brief     Control of the host HAL simulation (hal_sim.c) from the tests and
+ * 			  the benchmarks: simulated time, the flash of the STM32F411 mapped
+ * 			  at its real address, the I2C1 devices, the USART1 peer and the
+ * 			  counters of every one of them.
+ *
+ * 			  Timing model: flash sector erase and word program with the typical
+ * 			  x32 times of the STM32F411 datasheet, I2C at the ClockSpeed of the
+ * 			  handle (9 bit times per byte, plus start, restart and stop) and
+ * 			  the UART at its baud rate (10 bit times per byte).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_HAL_SIM_H_
+#define HOST_HAL_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+#define HALSIM_FLASH_SIZE			0x80000		/*512 KB at FLASH_BASE*/
+#define HALSIM_CPU_HZ				16000000	/*HSI, the SYSCLK of SystemClock_Config*/
+#define HALSIM_POLL_NS				250			/*Cost of a HAL_GetTick (call and return)*/
+#define HALSIM_PROGRAM_NS			16000		/*Byte to word program, x32*/
+#define HALSIM_ERASE_16K_NS			400000000ULL
+#define HALSIM_ERASE_64K_NS			1100000000ULL
+#define HALSIM_ERASE_128K_NS		2000000000ULL
+#define HALSIM_I2C_DEVICES			16
+#define HALSIM_UART_QUEUE			8192		/*Bytes on their way to the MCU*/
+
+typedef struct {
+	uint32_t programs;			/*HAL_FLASH_Program operations*/
+	uint32_t program_bytes;
+	uint32_t erases;			/*Sectors erased*/
+	uint32_t erase_bytes;
+	uint32_t errors;			/*Operations refused: locked, misaligned or outside the flash*/
+	uint32_t conflicts;			/*Programs over bits that were not erased*/
+	uint64_t busy_ns;
+} HalSimFlashStats;
+
+typedef enum {
+	HALSIM_I2C_OK,
+	HALSIM_I2C_NACK,			/*The address is not acknowledged*/
+	HALSIM_I2C_STUCK,			/*Holds SDA low in the middle of a transfer until 9 SCL clocks*/
+} HalSimI2cFault;
+
+typedef struct {
+	uint32_t transfers;
+	uint32_t bytes;				/*Bytes on the bus, addresses and registers included*/
+	uint32_t nacks;
+	uint32_t stuck;				/*Transfers that never ended*/
+	uint32_t recoveries;		/*Stuck devices released by clocking SCL*/
+	uint64_t busy_ns;
+} HalSimI2cStats;
+
+typedef struct {
+	uint32_t tx_bytes;
+	uint32_t rx_bytes;			/*Bytes stored by a reception*/
+	uint32_t lost;				/*Bytes that arrived with no reception armed*/
+} HalSimUartStats;
+
+/*Bytes sent by the MCU, the peer answers with HalSim_Uart_Send*/
+typedef void (*HalSimUartPeer)(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t length);
+
+/*Erased flash, clock at 0, no devices and no peer, counters cleared*/
+void HalSim_Reset(void);
+
+/*Simulated time since the reset*/
+uint64_t HalSim_Now_Ns(void);
+
+/*The CPU works for ns: the interrupts due meanwhile are delivered (unless masked)*/
+void HalSim_Advance_Ns(uint64_t ns);
+void HalSim_Advance_Us(uint32_t us);
+
+/*Called every ms after the HAL tick, as the SysTick_Handler of stm32f4xx_it.c*/
+void HalSim_Set_Tick_Handler(void (*handler)(void));
+
+/*Sets the HAL tick, to reach its wrap without simulating 49.7 days*/
+void HalSim_Set_Tick(uint32_t tick);
+
+/*HAL_NVIC_SystemReset calls since HalSim_Reset*/
+uint32_t HalSim_System_Resets(void);
+
+/*External interrupt line (the DIO1 of the SX126x): handler called at time (ns), one edge pending at most*/
+void HalSim_Exti_At(uint64_t time, void (*handler)(void));
+
+/*Flash*/
+const HalSimFlashStats *HalSim_Flash_Get_Stats(void);
+void HalSim_Flash_Clear_Stats(void);
+void HalSim_Flash_Flip(uint32_t address, uint8_t bit);	/*Single event upset*/
+void HalSim_Flash_Fail(uint32_t programs);	/*The programs-th HAL_FLASH_Program from now fails, 0 cancels*/
+
+/*I2C1: address in the HAL format (7 bits << 1), 256 registers that auto-increment*/
+bool HalSim_I2c_Add(uint8_t address, uint8_t *registers, uint32_t latency_us);
+void HalSim_I2c_Set_Fault(uint8_t address, HalSimI2cFault fault);
+const HalSimI2cStats *HalSim_I2c_Get_Stats(void);
+
+/*USART1: the peer gets every frame sent, HalSim_Uart_Send queues its answer*/
+void HalSim_Uart_Attach(UART_HandleTypeDef *huart, HalSimUartPeer peer);
+void HalSim_Uart_Send(const uint8_t *data, uint16_t length, uint32_t delay_us);
+const HalSimUartStats *HalSim_Uart_Get_Stats(void);
+
+/*Line error (HAL_UART_ERROR_...) as HAL_UART_IRQHandler reports it: an overrun ends the
+  reception before HAL_UART_ErrorCallback, parity, noise and framing errors leave it running*/
+void HalSim_Uart_Error(uint32_t error);
+
+#endif /* HOST_HAL_SIM_H_ */
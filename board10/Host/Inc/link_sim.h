@@ -0,0 +1,71 @@
+/*!
+ * \file      link_sim.h
+ *
+ * \brief     Downlink of a transfer (arq.c) over a simulated LoRa channel, for
+ * 			  the ARQ and FEC benchmarks. The satellite sends packets until
+ * 			  Arq_Next has nothing more to send, then waits for the SACK of the
+ * 			  ground station, which may be lost too (Arq_Timeout).
+ *
+ * 			  Losses: independent (Bernoulli) or in bursts (Gilbert-Elliott, a
+ * 			  good and a bad state with their own loss rate). The ground station
+ * 			  checks every data packet against the original data and rebuilds a
+ * 			  group as soon as it has as many packets, data or parity, as data
+ * 			  packets in the group (the Cauchy code of fec.c is MDS).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_LINK_SIM_H_
+#define HOST_LINK_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arq.h"
+#include "lora_toa.h"
+
+#define LINKSIM_MAX_PACKETS		2048
+#define LINKSIM_TURNAROUND_MS	20		/*Default: TX/RX switch at both ends*/
+#define LINKSIM_SACK_TIMEOUT_MS	500		/*Wait for a SACK that does not arrive*/
+#define LINKSIM_MAX_ROUNDS		100000
+
+typedef struct {
+	uint32_t LossGood;			/*Loss rate in the good state, ppm*/
+	uint32_t LossBad;			/*Loss rate in the bad state, ppm*/
+	uint32_t GoodToBad;			/*Probability per packet of entering a burst, ppm (0: Bernoulli)*/
+	uint32_t BadToGood;			/*Probability per packet of leaving it, ppm*/
+	uint32_t TurnaroundMs;		/*At each end, between the last packet and the SACK*/
+	uint32_t Seed;
+	bool Bad;
+} LinkSimChannel;
+
+typedef struct {
+	uint64_t TimeUs;			/*Until every packet is acknowledged*/
+	uint32_t Sent;
+	uint32_t Retransmitted;
+	uint32_t Parity;
+	uint32_t Sacks;				/*SACKs received by the satellite*/
+	uint32_t Timeouts;			/*Arq_Timeout calls: SACK lost or nothing left to send*/
+	uint32_t Rebuilt;			/*Data packets rebuilt from the parity*/
+	uint32_t Corrupted;			/*Data packets with a wrong payload (must be 0)*/
+	bool Done;
+} LinkSimResult;
+
+/*Independent losses*/
+void LinkSim_Bernoulli(LinkSimChannel *channel, uint32_t lossPpm, uint32_t seed);
+
+/*Bursts of average length 1e6 / BadToGood packets, lossBad inside them*/
+void LinkSim_Gilbert(LinkSimChannel *channel, uint32_t lossGood, uint32_t lossBad,
+					 uint32_t goodToBad, uint32_t badToGood, uint32_t seed);
+
+/*Draws the fate of the next packet, true if it is lost*/
+bool LinkSim_Lost(LinkSimChannel *channel);
+
+/*SX126x LoRa parameters of the downlink: BW 125 kHz, CR 4/5, 8 symbols of preamble, CRC*/
+void LinkSim_Params(LoraToaParams *params, uint8_t SpreadingFactor);
+
+/*Sends Length bytes from DataAddress (simulated flash) with Parity packets per window, not Done if the modulation is not supported*/
+LinkSimResult LinkSim_Run(uint32_t DataAddress, uint32_t Length, uint8_t Parity,
+						  const LoraToaParams *params, LinkSimChannel *channel);
+
+#endif /* HOST_LINK_SIM_H_ */
@@ -0,0 +1,333 @@
+/*!
+ * \file      stm32f4xx_hal.h
+ *
+ * \brief     Host stand-in of the STM32F4 HAL: only the types, constants and
+ * 			  functions that the modules of Core/Src built on the host use. It
+ * 			  is found before the HAL of Drivers/ by the host build, so the
+ * 			  modules are compiled without changes; the functions are the
+ * 			  simulation of hal_sim.c (flash, I2C, UART, GPIO, clock and
+ * 			  interrupt mask), which the tests drive through hal_sim.h.
+ *
+ * 			  The clock is simulated: it only moves when the code waits (flash
+ * 			  operations, HAL_Delay, bus transfers) or polls the time (every
+ * 			  HAL_GetTick, SysTick or DWT read costs a few cycles), and the
+ * 			  interrupts (SysTick, transfer completions) are delivered while it
+ * 			  moves, unless PRIMASK is set.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_STM32F4XX_HAL_H_
+#define HOST_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __IO		volatile
+#define __weak		__attribute__((weak))
+
+typedef enum {
+	HAL_OK		= 0x00U,
+	HAL_ERROR	= 0x01U,
+	HAL_BUSY	= 0x02U,
+	HAL_TIMEOUT	= 0x03U,
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY		0xFFFFFFFFU
+
+/*
+ * Core
+ */
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t LOAD;
+	__IO uint32_t VAL;
+	__IO uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	__IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	__IO uint32_t ICSR;			/*Only PENDSTSET: a SysTick is due but masked*/
+} SCB_Type;
+
+/*Every access brings the counters up to the simulated time*/
+SysTick_Type *HalSim_SysTick(void);
+DWT_Type *HalSim_DWT(void);
+CoreDebug_Type *HalSim_CoreDebug(void);
+SCB_Type *HalSim_SCB(void);
+
+#define SysTick						(HalSim_SysTick())
+#define DWT							(HalSim_DWT())
+#define CoreDebug					(HalSim_CoreDebug())
+#define SCB							(HalSim_SCB())
+#define SCB_ICSR_PENDSTSET_Msk		(1UL << 26)
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0)
+
+extern uint32_t SystemCoreClock;
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+#define __DMB()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void HAL_NVIC_SystemReset(void);	/*Only counted (hal_sim.h), the code goes on*/
+
+/*
+ * Flash (STM32F411xE: 512 KB in sectors 0..7)
+ */
+
+#define FLASH_TYPEERASE_SECTORS			0x00U
+#define FLASH_TYPEERASE_MASSERASE		0x01U
+
+#define FLASH_TYPEPROGRAM_BYTE			0x00U
+#define FLASH_TYPEPROGRAM_HALFWORD		0x01U
+#define FLASH_TYPEPROGRAM_WORD			0x02U
+#define FLASH_TYPEPROGRAM_DOUBLEWORD	0x03U
+
+#define FLASH_VOLTAGE_RANGE_1			0x00U	/*1.8 V to 2.1 V, x8*/
+#define FLASH_VOLTAGE_RANGE_2			0x01U	/*2.1 V to 2.7 V, x16*/
+#define FLASH_VOLTAGE_RANGE_3			0x02U	/*2.7 V to 3.6 V, x32*/
+#define FLASH_VOLTAGE_RANGE_4			0x03U	/*2.7 V to 3.6 V + VPP, x64*/
+
+#define FLASH_BANK_1					1U
+
+#define FLASH_SECTOR_0					0U
+#define FLASH_SECTOR_1					1U
+#define FLASH_SECTOR_2					2U
+#define FLASH_SECTOR_3					3U
+#define FLASH_SECTOR_4					4U
+#define FLASH_SECTOR_5					5U
+#define FLASH_SECTOR_6					6U
+#define FLASH_SECTOR_7					7U
+#ifndef FLASH_SECTOR_TOTAL	/*Larger F4 parts for the sector table test, the simulated flash is always 512KB*/
+#define FLASH_SECTOR_TOTAL				8U
+#endif
+
+#define FLASH_BASE						0x08000000UL
+#define FLASH_END						0x0807FFFFUL
+
+#define HAL_FLASH_ERROR_NONE			0x00000000U
+#define HAL_FLASH_ERROR_RD				0x00000001U
+#define HAL_FLASH_ERROR_PGS				0x00000002U
+#define HAL_FLASH_ERROR_PGP				0x00000004U
+#define HAL_FLASH_ERROR_PGA				0x00000008U
+#define HAL_FLASH_ERROR_WRP				0x00000010U
+#define HAL_FLASH_ERROR_OPERATION		0x00000020U
+
+typedef struct {
+	uint32_t TypeErase;
+	uint32_t Banks;
+	uint32_t Sector;
+	uint32_t NbSectors;
+	uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError);
+uint32_t HAL_FLASH_GetError(void);
+
+/*
+ * GPIO
+ */
+
+typedef struct {
+	uint8_t port;
+} GPIO_TypeDef;
+
+typedef enum {
+	GPIO_PIN_RESET = 0,
+	GPIO_PIN_SET,
+} GPIO_PinState;
+
+typedef struct {
+	uint32_t Pin;
+	uint32_t Mode;
+	uint32_t Pull;
+	uint32_t Speed;
+	uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef HalSim_GPIOA, HalSim_GPIOB, HalSim_GPIOC;
+#define GPIOA						(&HalSim_GPIOA)
+#define GPIOB						(&HalSim_GPIOB)
+#define GPIOC						(&HalSim_GPIOC)
+
+#define GPIO_PIN_0					((uint16_t)0x0001)
+#define GPIO_PIN_1					((uint16_t)0x0002)
+#define GPIO_PIN_2					((uint16_t)0x0004)
+#define GPIO_PIN_3					((uint16_t)0x0008)
+#define GPIO_PIN_4					((uint16_t)0x0010)
+#define GPIO_PIN_5					((uint16_t)0x0020)
+#define GPIO_PIN_6					((uint16_t)0x0040)
+#define GPIO_PIN_7					((uint16_t)0x0080)
+#define GPIO_PIN_8					((uint16_t)0x0100)
+#define GPIO_PIN_9					((uint16_t)0x0200)
+#define GPIO_PIN_10					((uint16_t)0x0400)
+#define GPIO_PIN_11					((uint16_t)0x0800)
+#define GPIO_PIN_12					((uint16_t)0x1000)
+
+#define GPIO_MODE_INPUT				0x00000000U
+#define GPIO_MODE_OUTPUT_PP			0x00000001U
+#define GPIO_MODE_OUTPUT_OD			0x00000011U
+#define GPIO_MODE_AF_PP				0x00000002U
+#define GPIO_MODE_AF_OD				0x00000012U
+#define GPIO_NOPULL					0x00000000U
+#define GPIO_PULLUP					0x00000001U
+#define GPIO_SPEED_FREQ_LOW			0x00000000U
+#define GPIO_SPEED_FREQ_VERY_HIGH	0x00000003U
+#define GPIO_AF4_I2C1				((uint8_t)0x04)
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+/*
+ * I2C
+ */
+
+typedef struct {
+	uint8_t bus;
+} I2C_TypeDef;
+
+typedef struct {
+	uint32_t ClockSpeed;
+	uint32_t DutyCycle;
+	uint32_t OwnAddress1;
+	uint32_t AddressingMode;
+	uint32_t DualAddressMode;
+	uint32_t OwnAddress2;
+	uint32_t GeneralCallMode;
+	uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef enum {
+	HAL_I2C_STATE_RESET		= 0x00U,
+	HAL_I2C_STATE_READY		= 0x20U,
+	HAL_I2C_STATE_BUSY_RX	= 0x22U,
+} HAL_I2C_StateTypeDef;
+
+typedef struct {
+	I2C_TypeDef *Instance;
+	I2C_InitTypeDef Init;
+	__IO HAL_I2C_StateTypeDef State;
+	__IO uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+extern I2C_TypeDef HalSim_I2C1;
+#define I2C1						(&HalSim_I2C1)
+
+#define I2C_MEMADD_SIZE_8BIT		0x00000001U
+#define HAL_I2C_ERROR_NONE			0x00000000U
+#define HAL_I2C_ERROR_AF			0x00000004U
+#define HAL_I2C_ERROR_TIMEOUT		0x00000020U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+										  uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+										 uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									  uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+/*
+ * UART
+ */
+
+typedef struct {
+	uint8_t port;
+} USART_TypeDef;
+
+typedef struct {
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+	uint32_t Mode;
+	uint32_t HwFlowCtl;
+	uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef enum {
+	HAL_UART_STATE_RESET	= 0x00U,
+	HAL_UART_STATE_READY	= 0x20U,
+	HAL_UART_STATE_BUSY_TX	= 0x21U,
+	HAL_UART_STATE_BUSY_RX	= 0x22U,
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+	USART_TypeDef *Instance;
+	UART_InitTypeDef Init;
+	uint8_t *pTxBuffPtr;
+	uint16_t TxXferSize;
+	uint8_t *pRxBuffPtr;
+	uint16_t RxXferSize;
+	__IO uint16_t RxXferCount;
+	__IO uint32_t ReceptionType;
+	__IO HAL_UART_StateTypeDef gState;
+	__IO HAL_UART_StateTypeDef RxState;
+	__IO uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+extern USART_TypeDef HalSim_USART1;
+#define USART1						(&HalSim_USART1)
+
+#define HAL_UART_RECEPTION_STANDARD	0x00U
+#define HAL_UART_RECEPTION_TOIDLE	0x01U
+
+#define HAL_UART_ERROR_NONE			0x00U
+#define HAL_UART_ERROR_PE			0x01U
+#define HAL_UART_ERROR_NE			0x02U
+#define HAL_UART_ERROR_FE			0x04U
+#define HAL_UART_ERROR_ORE			0x08U
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/*
+ * SPI (only the handle, the SX126x is simulated behind RadioIrqOps)
+ */
+
+typedef struct {
+	void *Instance;
+} SPI_HandleTypeDef;
+
+/*
+ * ADC (only the handle, the photodiodes of adcs.c are not simulated)
+ */
+
+typedef struct {
+	void *Instance;
+} ADC_HandleTypeDef;
+
+#endif /* HOST_STM32F4XX_HAL_H_ */
@@ -0,0 +1,64 @@
+/*!
+ * \file      trace_decode.h
+ *
+ * \brief     Ground side of trace.h: decodes the pieces of Trace_Dump (in any
+ * 			  number, in the order they were dumped) to 64-bit timestamps and
+ * 			  writes them as a Chrome trace (chrome://tracing, Perfetto), one
+ * 			  complete event per enter / exit pair of a probe.
+ *
+ * 			  The 32-bit cycle counter wraps every 268 s at 16 MHz: it is
+ * 			  unwrapped on the way, so two records in a row (across pieces too)
+ * 			  have to be closer than that.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_TRACE_DECODE_H_
+#define HOST_TRACE_DECODE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "trace.h"
+
+#define TRACE_DECODE_MAX_RECORDS	65536
+#define TRACE_DECODE_PROBES			128		/*Probe numbers kept apart, the others share the last one*/
+#define TRACE_DECODE_DEPTH			8		/*Nested enters of the same probe*/
+
+typedef struct {
+	uint64_t Cycles;
+	uint16_t Probe;				/*With TRACE_EXIT_FLAG on the exits*/
+} TraceDecodeRecord;
+
+/*Enter / exit pairs of a probe, filled by TraceDecode_Chrome*/
+typedef struct {
+	uint32_t Count;
+	uint64_t TotalCycles;
+	uint64_t MaxCycles;
+} TraceDecodeProbe;
+
+typedef struct {
+	TraceDecodeRecord Records[TRACE_DECODE_MAX_RECORDS];
+	uint32_t Count;
+	uint32_t Lost;				/*Overwritten on board, from the headers*/
+	uint32_t Dropped;			/*Not kept here, Records was full*/
+	uint32_t Rejected;			/*Pieces with a wrong header or cut short*/
+	uint32_t ClockHz;
+	uint64_t Last;
+	TraceDecodeProbe Probes[TRACE_DECODE_PROBES];
+	uint32_t Unpaired;			/*Exits without an enter and enters without an exit*/
+} TraceDecoder;
+
+void TraceDecode_Init(TraceDecoder *decoder);
+
+/*Appends the records of a piece, false if it is not a valid one*/
+bool TraceDecode_Piece(TraceDecoder *decoder, const uint8_t *piece, uint16_t length);
+
+/*Name of a probe, tasks[] (may be NULL) for the scheduler tasks*/
+const char *TraceDecode_Name(uint16_t probe, const char *const *tasks, uint8_t taskCount);
+
+/*Writes the Chrome trace (JSON) and fills Probes, returns the complete events*/
+uint32_t TraceDecode_Chrome(TraceDecoder *decoder, FILE *out, const char *const *tasks, uint8_t taskCount);
+
+#endif /* HOST_TRACE_DECODE_H_ */
@@ -0,0 +1,48 @@
+/*!
+ * \file      vc0706_sim.h
+ *
+ * \brief     VC0706 camera on the simulated USART1 (hal_sim.c), for the tests of
+ * 			  payload_camera.c and camera_uart.c. It answers FBUF_CTRL (0x36),
+ * 			  GET_FBUF_LEN (0x34), WRITE_DATA (0x31) and READ_FBUF (0x32) from a
+ * 			  frame buffer given by the test, usually a JPEG file.
+ *
+ * 			  Like the camera, READ_FBUF only accepts lengths that are multiples
+ * 			  of 8 bytes (except the last chunk of the frame) and waits the delay
+ * 			  field (x 0.01 ms) between the header and the data. The processing
+ * 			  latency and the rate of corrupted answers can be configured.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_VC0706_SIM_H_
+#define HOST_VC0706_SIM_H_
+
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+#define VC0706SIM_MAX_FRAME			0x20000		/*Frame buffer of the camera*/
+
+typedef struct {
+	uint32_t commands;			/*Frames received*/
+	uint32_t reads;				/*READ_FBUF answered*/
+	uint32_t read_bytes;		/*Bytes of the frame buffer sent*/
+	uint32_t refused;			/*READ_FBUF with a length that is not a multiple of 8*/
+	uint32_t corrupted;			/*Answers damaged on purpose*/
+} VC0706SimStats;
+
+/*Attaches the camera to huart (it must be the one of HAL_UART_Init) with a frame of length bytes*/
+void VC0706Sim_Init(UART_HandleTypeDef *huart, const uint8_t *frame, uint32_t length);
+
+/*Time from the end of a command to the first byte of its answer*/
+void VC0706Sim_Set_Latency(uint32_t latency_us);
+
+/*Answers to READ_FBUF damaged (bad header, missing bytes), in parts per million*/
+void VC0706Sim_Set_Error_Rate(uint32_t ppm, uint32_t seed);
+
+const VC0706SimStats *VC0706Sim_Get_Stats(void);
+
+/*A JPEG of length bytes: SOI, JFIF header, entropy-coded filler and EOI*/
+void VC0706Sim_Make_Jpeg(uint8_t *jpeg, uint32_t length, uint32_t seed);
+
+#endif /* HOST_VC0706_SIM_H_ */
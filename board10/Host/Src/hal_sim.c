@@ -0,0 +1,953 @@
+/*!
+ * \file      hal_sim.c
+ *
+ * \brief     Host simulation of the HAL functions declared in the host
+ * 			  stm32f4xx_hal.h (see hal_sim.h).
+ *
+ * 			  The flash is a private anonymous mapping at FLASH_BASE, so the
+ * 			  modules read it through the addresses of flash.h as on the target.
+ * 			  The interrupts are events with a due time (SysTick, end of an I2C
+ * 			  transfer, end of a UART transmission, arrival of a UART byte, idle
+ * 			  line and the external line); they are delivered in time order whenever the clock
+ * 			  moves, and the ones that are due while PRIMASK is set wait until it
+ * 			  is cleared. A pending SysTick is delivered once, so the HAL tick
+ * 			  falls behind when the interrupts are masked for more than a
+ * 			  millisecond, as on the target.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define HALSIM_MS_NS			1000000ULL
+#define HALSIM_CYCLE_NS			(1000000000ULL / HALSIM_CPU_HZ)
+#define HALSIM_GPIO_NS			125				/*HAL_GPIO_WritePin / ReadPin*/
+#define HALSIM_I2C_BUSY_NS		(25 * HALSIM_MS_NS)	/*I2C_TIMEOUT_BUSY_FLAG of the HAL*/
+#define HALSIM_NEVER			UINT64_MAX
+
+#define HALSIM_SCL_PIN			GPIO_PIN_6		/*I2C1 on PB6 / PB7 (stm32f4xx_hal_msp.c)*/
+#define HALSIM_SDA_PIN			GPIO_PIN_7
+
+uint32_t SystemCoreClock = HALSIM_CPU_HZ;
+
+GPIO_TypeDef HalSim_GPIOA = { 0 };
+GPIO_TypeDef HalSim_GPIOB = { 1 };
+GPIO_TypeDef HalSim_GPIOC = { 2 };
+I2C_TypeDef HalSim_I2C1 = { 1 };
+USART_TypeDef HalSim_USART1 = { 1 };
+
+/*Clock and interrupts*/
+static uint64_t Now;
+static uint64_t NextTick;
+static uint32_t Tick;
+static uint32_t Primask;
+static bool InInterrupt;
+static void (*TickHandler)(void);
+
+static SysTick_Type SysTickRegs;
+static DWT_Type DwtRegs;
+static uint64_t DwtTime;
+static CoreDebug_Type CoreDebugRegs;
+static SCB_Type ScbRegs;
+static uint32_t SystemResets;
+
+/*External line (DIO1 of the SX126x)*/
+static uint64_t ExtiTime;
+static void (*ExtiHandler)(void);
+
+/*Flash*/
+static uint8_t *Flash;
+static bool FlashLocked = true;
+static uint32_t FlashError;
+static HalSimFlashStats FlashStats;
+static uint32_t FlashFailIn;			/*Programs left before an injected failure, 0 if none*/
+
+/*GPIO: output latch and output mode of every pin*/
+static uint16_t Latch[3];
+static uint16_t Output[3];
+
+/*I2C1*/
+typedef struct {
+	uint8_t address;
+	uint8_t *registers;
+	uint8_t pointer;
+	uint32_t latency_ns;
+	HalSimI2cFault fault;
+} HalSimI2cDevice;
+
+static HalSimI2cDevice Devices[HALSIM_I2C_DEVICES];
+static uint8_t DeviceCount;
+static struct {
+	I2C_HandleTypeDef *handle;
+	HalSimI2cDevice *device;
+	uint8_t *data;
+	uint16_t length;
+	bool error;
+	uint64_t end;
+} I2cTransfer;
+static HalSimI2cDevice *Stuck;		/*Device holding SDA low*/
+static uint8_t SclClocks;
+static HalSimI2cStats I2cStats;
+
+/*USART1*/
+static struct {
+	UART_HandleTypeDef *handle;
+	HalSimUartPeer peer;
+	const uint8_t *tx_data;
+	uint16_t tx_length;
+	uint64_t tx_end;
+	uint8_t queue[HALSIM_UART_QUEUE];
+	uint64_t arrival[HALSIM_UART_QUEUE];
+	uint16_t head;
+	uint16_t tail;
+	uint16_t count;
+	uint64_t last;				/*Arrival of the last byte queued*/
+	uint64_t idle;				/*Idle line event, HALSIM_NEVER if none*/
+} Uart;
+static HalSimUartStats UartStats;
+
+__attribute__((constructor)) static void HalSim_Map(void)
+{
+	void *flash = mmap((void *)FLASH_BASE, HALSIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if (flash != (void *)FLASH_BASE)
+	{
+		fprintf(stderr, "hal_sim: the flash cannot be mapped at 0x%08lx\n", FLASH_BASE);
+		exit(2);
+	}
+	Flash = flash;
+	HalSim_Reset();
+}
+
+static uint64_t HalSim_Char_Ns(void)
+{
+	uint32_t baud = (Uart.handle && Uart.handle->Init.BaudRate) ? Uart.handle->Init.BaudRate : 115200;
+	return 10 * 1000000000ULL / baud;
+}
+
+static uint64_t HalSim_Bit_Ns(I2C_HandleTypeDef *hi2c)
+{
+	return 1000000000ULL / (hi2c->Init.ClockSpeed ? hi2c->Init.ClockSpeed : 100000);
+}
+
+void HalSim_Reset(void)
+{
+	memset(Flash, 0xFF, HALSIM_FLASH_SIZE);
+	FlashLocked = true;
+	FlashError = HAL_FLASH_ERROR_NONE;
+	memset(&FlashStats, 0, sizeof(FlashStats));
+	FlashFailIn = 0;
+
+	Now = 0;
+	Tick = 0;
+	NextTick = HALSIM_MS_NS;
+	Primask = 0;
+	InInterrupt = false;
+	TickHandler = NULL;
+	ExtiTime = HALSIM_NEVER;
+	ExtiHandler = NULL;
+	SystemResets = 0;
+	SysTickRegs.LOAD = HALSIM_CPU_HZ / 1000 - 1;
+	SysTickRegs.VAL = SysTickRegs.LOAD;
+	memset(&DwtRegs, 0, sizeof(DwtRegs));
+	memset(&CoreDebugRegs, 0, sizeof(CoreDebugRegs));
+	DwtTime = 0;
+
+	memset(Latch, 0, sizeof(Latch));
+	memset(Output, 0, sizeof(Output));
+
+	DeviceCount = 0;
+	memset(&I2cTransfer, 0, sizeof(I2cTransfer));
+	Stuck = NULL;
+	SclClocks = 0;
+	memset(&I2cStats, 0, sizeof(I2cStats));
+
+	memset(&Uart, 0, sizeof(Uart));
+	Uart.idle = HALSIM_NEVER;
+	memset(&UartStats, 0, sizeof(UartStats));
+}
+
+uint64_t HalSim_Now_Ns(void)
+{
+	return Now;
+}
+
+/*
+ * Interrupts
+ */
+
+typedef enum {
+	HALSIM_EVENT_NONE,
+	HALSIM_EVENT_TICK,
+	HALSIM_EVENT_I2C,
+	HALSIM_EVENT_UART_TX,
+	HALSIM_EVENT_UART_RX,
+	HALSIM_EVENT_UART_IDLE,
+	HALSIM_EVENT_EXTI,
+} HalSimEvent;
+
+/*Earliest interrupt and its time*/
+static HalSimEvent HalSim_Next(uint64_t *time)
+{
+	HalSimEvent event = HALSIM_EVENT_TICK;
+
+	*time = NextTick;
+	if (I2cTransfer.handle && I2cTransfer.end < *time)
+	{
+		*time = I2cTransfer.end;
+		event = HALSIM_EVENT_I2C;
+	}
+	if (Uart.tx_data && Uart.tx_end < *time)
+	{
+		*time = Uart.tx_end;
+		event = HALSIM_EVENT_UART_TX;
+	}
+	if (Uart.count && Uart.arrival[Uart.tail] < *time)
+	{
+		*time = Uart.arrival[Uart.tail];
+		event = HALSIM_EVENT_UART_RX;
+	}
+	if (Uart.idle < *time)
+	{
+		*time = Uart.idle;
+		event = HALSIM_EVENT_UART_IDLE;
+	}
+	if (ExtiTime < *time)
+	{
+		*time = ExtiTime;
+		event = HALSIM_EVENT_EXTI;
+	}
+	return event;
+}
+
+static void HalSim_I2c_End(void)
+{
+	I2C_HandleTypeDef *hi2c = I2cTransfer.handle;
+	HalSimI2cDevice *device = I2cTransfer.device;
+	uint16_t i;
+
+	I2cTransfer.handle = NULL;
+	hi2c->State = HAL_I2C_STATE_READY;
+	if (I2cTransfer.error)
+	{
+		hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+		HAL_I2C_ErrorCallback(hi2c);
+		return;
+	}
+	for (i = 0; i < I2cTransfer.length; i++) I2cTransfer.data[i] = device->registers[device->pointer++];
+	HAL_I2C_MemRxCpltCallback(hi2c);
+}
+
+static void HalSim_Uart_Receive(void)
+{
+	UART_HandleTypeDef *huart = Uart.handle;
+	uint8_t byte = Uart.queue[Uart.tail];
+	uint64_t arrival = Uart.arrival[Uart.tail];
+
+	Uart.tail = (Uart.tail + 1) % HALSIM_UART_QUEUE;
+	Uart.count--;
+
+	if (huart == NULL || huart->RxState != HAL_UART_STATE_BUSY_RX)
+	{
+		UartStats.lost++;		/*Overrun: nobody reads the data register*/
+		return;
+	}
+	*huart->pRxBuffPtr++ = byte;
+	huart->RxXferCount--;
+	UartStats.rx_bytes++;
+	Uart.idle = arrival + HalSim_Char_Ns();
+
+	if (huart->RxXferCount == 0)
+	{
+		huart->RxState = HAL_UART_STATE_READY;
+		Uart.idle = HALSIM_NEVER;
+		if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+		else HAL_UART_RxCpltCallback(huart);
+	}
+}
+
+static void HalSim_Uart_Idle(void)
+{
+	UART_HandleTypeDef *huart = Uart.handle;
+
+	Uart.idle = HALSIM_NEVER;
+	if (huart->RxState != HAL_UART_STATE_BUSY_RX || huart->ReceptionType != HAL_UART_RECEPTION_TOIDLE) return;
+	if (huart->RxXferCount == huart->RxXferSize) return;
+
+	huart->RxState = HAL_UART_STATE_READY;
+	HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize - huart->RxXferCount);
+}
+
+static void HalSim_Deliver(HalSimEvent event)
+{
+	const uint8_t *data;
+
+	InInterrupt = true;
+	switch (event)
+	{
+	case HALSIM_EVENT_TICK:
+		Tick++;
+		NextTick = (Now / HALSIM_MS_NS + 1) * HALSIM_MS_NS;	/*Only one SysTick can be pending*/
+		if (TickHandler) TickHandler();
+		break;
+	case HALSIM_EVENT_I2C:
+		HalSim_I2c_End();
+		break;
+	case HALSIM_EVENT_UART_TX:
+		data = Uart.tx_data;
+		Uart.tx_data = NULL;
+		Uart.handle->gState = HAL_UART_STATE_READY;
+		UartStats.tx_bytes += Uart.tx_length;
+		HAL_UART_TxCpltCallback(Uart.handle);
+		if (Uart.peer) Uart.peer(Uart.handle, data, Uart.tx_length);
+		break;
+	case HALSIM_EVENT_UART_RX:
+		HalSim_Uart_Receive();
+		break;
+	case HALSIM_EVENT_UART_IDLE:
+		HalSim_Uart_Idle();
+		break;
+	case HALSIM_EVENT_EXTI:
+		ExtiTime = HALSIM_NEVER;
+		if (ExtiHandler) ExtiHandler();
+		break;
+	default:
+		break;
+	}
+	InInterrupt = false;
+}
+
+/*Delivers the interrupts that are already due*/
+static void HalSim_Service(void)
+{
+	HalSimEvent event;
+	uint64_t time;
+
+	while (!Primask && !InInterrupt)
+	{
+		event = HalSim_Next(&time);
+		if (time > Now) break;
+		HalSim_Deliver(event);
+	}
+}
+
+void HalSim_Advance_Ns(uint64_t ns)
+{
+	uint64_t target = Now + ns, time;
+	HalSimEvent event;
+
+	while (!Primask && !InInterrupt)
+	{
+		event = HalSim_Next(&time);
+		if (time > target) break;
+		if (time > Now) Now = time;
+		HalSim_Deliver(event);
+	}
+	if (target > Now) Now = target;
+}
+
+void HalSim_Advance_Us(uint32_t us)
+{
+	HalSim_Advance_Ns((uint64_t)us * 1000);
+}
+
+void HalSim_Set_Tick_Handler(void (*handler)(void))
+{
+	TickHandler = handler;
+}
+
+void HalSim_Set_Tick(uint32_t tick)
+{
+	Tick = tick;
+}
+
+void HalSim_Exti_At(uint64_t time, void (*handler)(void))
+{
+	ExtiTime = time;
+	ExtiHandler = handler;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+	return Primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+	Primask = priMask & 1;
+	HalSim_Service();
+}
+
+void __disable_irq(void)
+{
+	Primask = 1;
+}
+
+void __enable_irq(void)
+{
+	Primask = 0;
+	HalSim_Service();
+}
+
+/*Sleeps until the next interrupt, which wakes the core even if it is masked*/
+void __WFI(void)
+{
+	uint64_t time;
+
+	HalSim_Next(&time);
+	if (time <= Now) return;
+	if (Primask || InInterrupt) Now = time;
+	else HalSim_Advance_Ns(time - Now);
+}
+
+void HAL_NVIC_SystemReset(void)
+{
+	SystemResets++;
+}
+
+uint32_t HalSim_System_Resets(void)
+{
+	return SystemResets;
+}
+
+SysTick_Type *HalSim_SysTick(void)
+{
+	HalSim_Advance_Ns(HALSIM_CYCLE_NS);
+	SysTickRegs.VAL = SysTickRegs.LOAD - (uint32_t)((Now % HALSIM_MS_NS) * (SysTickRegs.LOAD + 1) / HALSIM_MS_NS);
+	return &SysTickRegs;
+}
+
+DWT_Type *HalSim_DWT(void)
+{
+	HalSim_Advance_Ns(HALSIM_CYCLE_NS);
+	if (DwtRegs.CTRL & DWT_CTRL_CYCCNTENA_Msk)
+	{
+		DwtRegs.CYCCNT += (uint32_t)(Now * (HALSIM_CPU_HZ / 1000000) / 1000 - DwtTime * (HALSIM_CPU_HZ / 1000000) / 1000);
+	}
+	DwtTime = Now;
+	return &DwtRegs;
+}
+
+CoreDebug_Type *HalSim_CoreDebug(void)
+{
+	return &CoreDebugRegs;
+}
+
+SCB_Type *HalSim_SCB(void)
+{
+	HalSim_Advance_Ns(HALSIM_CYCLE_NS);
+	ScbRegs.ICSR = (Now >= NextTick) ? SCB_ICSR_PENDSTSET_Msk : 0;
+	return &ScbRegs;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	HalSim_Advance_Ns(HALSIM_POLL_NS);
+	return Tick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	uint32_t start = HAL_GetTick();
+	uint32_t wait = Delay + (Delay < HAL_MAX_DELAY);
+
+	if (Primask || InInterrupt)
+	{
+		fprintf(stderr, "hal_sim: HAL_Delay with the interrupts masked never ends\n");
+		abort();
+	}
+	while (HAL_GetTick() - start < wait) __WFI();
+}
+
+/*
+ * Flash
+ */
+
+/*Sector of an address and its size*/
+static int HalSim_Sector(uint32_t sector, uint32_t *start, uint32_t *size)
+{
+	if (sector < 4)
+	{
+		*start = FLASH_BASE + sector * 0x4000;
+		*size = 0x4000;
+	}
+	else if (sector == 4)
+	{
+		*start = FLASH_BASE + 0x10000;
+		*size = 0x10000;
+	}
+	else if (sector < FLASH_SECTOR_TOTAL)
+	{
+		*start = FLASH_BASE + 0x20000 * (sector - 4);
+		*size = 0x20000;
+	}
+	else return -1;
+	return 0;
+}
+
+static void HalSim_Flash_Busy(uint64_t ns)
+{
+	FlashStats.busy_ns += ns;
+	HalSim_Advance_Ns(ns);
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+	FlashLocked = false;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+	FlashLocked = true;
+	return HAL_OK;
+}
+
+uint32_t HAL_FLASH_GetError(void)
+{
+	return FlashError;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+	uint32_t size = 1U << TypeProgram, i;
+	uint8_t *cell;
+	bool conflict = false;
+
+	FlashError = HAL_FLASH_ERROR_NONE;
+	if (FlashLocked) FlashError = HAL_FLASH_ERROR_PGS;
+	else if (TypeProgram > FLASH_TYPEPROGRAM_DOUBLEWORD || Address % size != 0) FlashError = HAL_FLASH_ERROR_PGA;
+	else if (Address < FLASH_BASE || Address + size - 1 > FLASH_END) FlashError = HAL_FLASH_ERROR_WRP;
+	else if (FlashFailIn != 0 && --FlashFailIn == 0) FlashError = HAL_FLASH_ERROR_PGP;
+	if (FlashError != HAL_FLASH_ERROR_NONE)
+	{
+		FlashStats.errors++;
+		return HAL_ERROR;
+	}
+
+	cell = &Flash[Address - FLASH_BASE];
+	for (i = 0; i < size; i++)
+	{
+		uint8_t byte = (uint8_t)(Data >> (8 * i));
+		if (byte & ~cell[i]) conflict = true;
+		cell[i] &= byte;		/*Programming only clears bits*/
+	}
+	if (conflict) FlashStats.conflicts++;
+	FlashStats.programs++;
+	FlashStats.program_bytes += size;
+	HalSim_Flash_Busy(HALSIM_PROGRAM_NS);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError)
+{
+	uint32_t sector, first = pEraseInit->Sector, last, start, size;
+
+	FlashError = HAL_FLASH_ERROR_NONE;
+	*SectorError = 0xFFFFFFFFU;
+	if (pEraseInit->TypeErase == FLASH_TYPEERASE_MASSERASE)
+	{
+		first = 0;
+		last = FLASH_SECTOR_TOTAL - 1;
+	}
+	else last = first + pEraseInit->NbSectors - 1;
+
+	for (sector = first; sector <= last; sector++)
+	{
+		if (FlashLocked || pEraseInit->NbSectors == 0 || HalSim_Sector(sector, &start, &size) != 0)
+		{
+			FlashError = FlashLocked ? HAL_FLASH_ERROR_PGS : HAL_FLASH_ERROR_WRP;
+			FlashStats.errors++;
+			*SectorError = sector;
+			return HAL_ERROR;
+		}
+		memset(&Flash[start - FLASH_BASE], 0xFF, size);
+		FlashStats.erases++;
+		FlashStats.erase_bytes += size;
+		HalSim_Flash_Busy(size == 0x4000 ? HALSIM_ERASE_16K_NS :
+						  size == 0x10000 ? HALSIM_ERASE_64K_NS : HALSIM_ERASE_128K_NS);
+	}
+	return HAL_OK;
+}
+
+const HalSimFlashStats *HalSim_Flash_Get_Stats(void)
+{
+	return &FlashStats;
+}
+
+void HalSim_Flash_Clear_Stats(void)
+{
+	memset(&FlashStats, 0, sizeof(FlashStats));
+}
+
+void HalSim_Flash_Fail(uint32_t programs)
+{
+	FlashFailIn = programs;
+}
+
+void HalSim_Flash_Flip(uint32_t address, uint8_t bit)
+{
+	if (address < FLASH_BASE || address > FLASH_END) return;
+	Flash[address - FLASH_BASE] ^= (uint8_t)(1U << (bit & 7));
+}
+
+/*
+ * GPIO
+ */
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+	if (GPIO_Init->Mode == GPIO_MODE_OUTPUT_PP || GPIO_Init->Mode == GPIO_MODE_OUTPUT_OD)
+	{
+		Output[GPIOx->port] |= (uint16_t)GPIO_Init->Pin;
+	}
+	else Output[GPIOx->port] &= (uint16_t)~GPIO_Init->Pin;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+	Output[GPIOx->port] &= (uint16_t)~GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+	/*Open drain lines with pull-ups: high unless an output or a device pulls them low*/
+	bool high = !(Output[GPIOx->port] & GPIO_Pin) || (Latch[GPIOx->port] & GPIO_Pin);
+
+	HalSim_Advance_Ns(HALSIM_GPIO_NS);
+	if (GPIOx == GPIOB && GPIO_Pin == HALSIM_SDA_PIN && Stuck != NULL) high = false;
+	return high ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+	bool rising = PinState == GPIO_PIN_SET && !(Latch[GPIOx->port] & GPIO_Pin);
+
+	HalSim_Advance_Ns(HALSIM_GPIO_NS);
+	if (PinState == GPIO_PIN_SET) Latch[GPIOx->port] |= GPIO_Pin;
+	else Latch[GPIOx->port] &= (uint16_t)~GPIO_Pin;
+
+	/*A stuck device releases SDA after clocking out the rest of its byte and the ACK*/
+	if (GPIOx == GPIOB && (GPIO_Pin & HALSIM_SCL_PIN) && (Output[1] & HALSIM_SCL_PIN) && rising && Stuck != NULL)
+	{
+		if (++SclClocks >= 9)
+		{
+			Stuck->fault = HALSIM_I2C_OK;
+			Stuck = NULL;
+			I2cStats.recoveries++;
+		}
+	}
+}
+
+/*
+ * I2C
+ */
+
+static HalSimI2cDevice *HalSim_I2c_Find(uint16_t address)
+{
+	uint8_t i;
+
+	for (i = 0; i < DeviceCount; i++)
+	{
+		if (Devices[i].address == (address & 0xFE)) return &Devices[i];
+	}
+	return NULL;
+}
+
+bool HalSim_I2c_Add(uint8_t address, uint8_t *registers, uint32_t latency_us)
+{
+	if (DeviceCount == HALSIM_I2C_DEVICES) return false;
+	Devices[DeviceCount].address = address & 0xFE;
+	Devices[DeviceCount].registers = registers;
+	Devices[DeviceCount].pointer = 0;
+	Devices[DeviceCount].latency_ns = latency_us * 1000;
+	Devices[DeviceCount].fault = HALSIM_I2C_OK;
+	DeviceCount++;
+	return true;
+}
+
+void HalSim_I2c_Set_Fault(uint8_t address, HalSimI2cFault fault)
+{
+	HalSimI2cDevice *device = HalSim_I2c_Find(address);
+
+	if (device) device->fault = fault;
+}
+
+const HalSimI2cStats *HalSim_I2c_Get_Stats(void)
+{
+	return &I2cStats;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+	hi2c->State = HAL_I2C_STATE_READY;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c)
+{
+	if (I2cTransfer.handle == hi2c) I2cTransfer.handle = NULL;	/*The transfer is abandoned*/
+	hi2c->State = HAL_I2C_STATE_RESET;
+	return HAL_OK;
+}
+
+/*Checks of every transfer: peripheral ready and bus free (BUSY waited up to 25 ms)*/
+static HAL_StatusTypeDef HalSim_I2c_Ready(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c->State != HAL_I2C_STATE_READY) return HAL_BUSY;
+	if (Stuck != NULL)
+	{
+		HalSim_Advance_Ns(HALSIM_I2C_BUSY_NS);
+		return HAL_BUSY;
+	}
+	return HAL_OK;
+}
+
+/*Blocking transfer of bits on the bus, false if the address is not acknowledged*/
+static bool HalSim_I2c_Blocking(I2C_HandleTypeDef *hi2c, HalSimI2cDevice *device, uint32_t bits, uint32_t bytes)
+{
+	I2cStats.transfers++;
+	if (device == NULL || device->fault == HALSIM_I2C_NACK)
+	{
+		I2cStats.nacks++;
+		I2cStats.bytes++;
+		I2cStats.busy_ns += 11 * HalSim_Bit_Ns(hi2c);
+		HalSim_Advance_Ns(11 * HalSim_Bit_Ns(hi2c));
+		hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+		return false;
+	}
+	I2cStats.bytes += bytes;
+	I2cStats.busy_ns += bits * HalSim_Bit_Ns(hi2c) + device->latency_ns;
+	HalSim_Advance_Ns(bits * HalSim_Bit_Ns(hi2c) + device->latency_ns);
+	return true;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+										  uint16_t Size, uint32_t Timeout)
+{
+	HalSimI2cDevice *device = HalSim_I2c_Find(DevAddress);
+	HAL_StatusTypeDef status = HalSim_I2c_Ready(hi2c);
+
+	(void)Timeout;
+	if (status != HAL_OK) return status;
+	if (!HalSim_I2c_Blocking(hi2c, device, 11 + 9 * Size, 1 + Size)) return HAL_ERROR;
+	if (Size > 0) device->pointer = pData[0];	/*The first byte sets the register pointer*/
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+										 uint16_t Size, uint32_t Timeout)
+{
+	HalSimI2cDevice *device = HalSim_I2c_Find(DevAddress);
+	HAL_StatusTypeDef status = HalSim_I2c_Ready(hi2c);
+	uint16_t i;
+
+	(void)Timeout;
+	if (status != HAL_OK) return status;
+	if (!HalSim_I2c_Blocking(hi2c, device, 11 + 9 * Size, 1 + Size)) return HAL_ERROR;
+	for (i = 0; i < Size; i++) pData[i] = device->registers[device->pointer++];
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	HalSimI2cDevice *device = HalSim_I2c_Find(DevAddress);
+	HAL_StatusTypeDef status = HalSim_I2c_Ready(hi2c);
+	uint16_t i;
+
+	(void)MemAddSize;
+	if (status != HAL_OK) return status;
+	if (device != NULL && device->fault == HALSIM_I2C_STUCK)
+	{
+		I2cStats.transfers++;
+		I2cStats.stuck++;
+		Stuck = device;
+		SclClocks = 0;
+		HalSim_Advance_Ns((uint64_t)Timeout * HALSIM_MS_NS);
+		hi2c->ErrorCode = HAL_I2C_ERROR_TIMEOUT;
+		return HAL_TIMEOUT;
+	}
+	if (!HalSim_I2c_Blocking(hi2c, device, 30 + 9 * Size, 3 + Size)) return HAL_ERROR;
+	device->pointer = (uint8_t)MemAddress;
+	for (i = 0; i < Size; i++) pData[i] = device->registers[device->pointer++];
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									  uint16_t MemAddSize, uint8_t *pData, uint16_t Size)
+{
+	HalSimI2cDevice *device = HalSim_I2c_Find(DevAddress);
+	HAL_StatusTypeDef status = HalSim_I2c_Ready(hi2c);
+	uint64_t bits;
+
+	(void)MemAddSize;
+	if (status != HAL_OK) return status;
+
+	hi2c->State = HAL_I2C_STATE_BUSY_RX;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	I2cTransfer.handle = hi2c;
+	I2cTransfer.device = device;
+	I2cTransfer.data = pData;
+	I2cTransfer.length = Size;
+	I2cStats.transfers++;
+
+	if (device == NULL || device->fault == HALSIM_I2C_NACK)
+	{
+		I2cStats.nacks++;
+		I2cStats.bytes++;
+		I2cTransfer.error = true;
+		I2cTransfer.end = Now + 11 * HalSim_Bit_Ns(hi2c);
+		I2cStats.busy_ns += 11 * HalSim_Bit_Ns(hi2c);
+		return HAL_OK;
+	}
+	if (device->fault == HALSIM_I2C_STUCK)
+	{
+		I2cStats.stuck++;
+		Stuck = device;
+		SclClocks = 0;
+		I2cTransfer.error = false;
+		I2cTransfer.end = HALSIM_NEVER;
+		return HAL_OK;
+	}
+
+	bits = 30 + 9 * Size;
+	device->pointer = (uint8_t)MemAddress;
+	I2cTransfer.error = false;
+	I2cTransfer.end = Now + bits * HalSim_Bit_Ns(hi2c) + device->latency_ns;
+	I2cStats.bytes += 3 + Size;
+	I2cStats.busy_ns += bits * HalSim_Bit_Ns(hi2c) + device->latency_ns;
+	return HAL_OK;
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	(void)hi2c;
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	(void)hi2c;
+}
+
+/*
+ * UART
+ */
+
+void HalSim_Uart_Attach(UART_HandleTypeDef *huart, HalSimUartPeer peer)
+{
+	Uart.handle = huart;
+	Uart.peer = peer;
+}
+
+void HalSim_Uart_Send(const uint8_t *data, uint16_t length, uint32_t delay_us)
+{
+	uint64_t time = Now + (uint64_t)delay_us * 1000;
+	uint16_t i;
+
+	if (Uart.count && Uart.last > time) time = Uart.last;
+	for (i = 0; i < length && Uart.count < HALSIM_UART_QUEUE; i++)
+	{
+		time += HalSim_Char_Ns();
+		Uart.queue[Uart.head] = data[i];
+		Uart.arrival[Uart.head] = time;
+		Uart.head = (Uart.head + 1) % HALSIM_UART_QUEUE;
+		Uart.count++;
+	}
+	Uart.last = time;
+}
+
+const HalSimUartStats *HalSim_Uart_Get_Stats(void)
+{
+	return &UartStats;
+}
+
+void HalSim_Uart_Error(uint32_t error)
+{
+	UART_HandleTypeDef *huart = Uart.handle;
+
+	if (huart == NULL) return;
+	huart->ErrorCode |= error;
+	if ((error & HAL_UART_ERROR_ORE) && huart->RxState == HAL_UART_STATE_BUSY_RX)
+	{
+		huart->RxState = HAL_UART_STATE_READY;	/*UART_EndRxTransfer*/
+		Uart.idle = HALSIM_NEVER;
+	}
+	InInterrupt = true;
+	HAL_UART_ErrorCallback(huart);
+	InInterrupt = false;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+	huart->gState = HAL_UART_STATE_READY;
+	huart->RxState = HAL_UART_STATE_READY;
+	huart->ErrorCode = 0;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+	if (huart->gState != HAL_UART_STATE_READY || huart != Uart.handle || Size == 0) return HAL_BUSY;
+	huart->gState = HAL_UART_STATE_BUSY_TX;
+	Uart.tx_data = pData;
+	Uart.tx_length = Size;
+	Uart.tx_end = Now + Size * HalSim_Char_Ns();
+	return HAL_OK;
+}
+
+static HAL_StatusTypeDef HalSim_Uart_Start(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t type)
+{
+	if (huart->RxState != HAL_UART_STATE_READY || Size == 0) return HAL_BUSY;
+	huart->pRxBuffPtr = pData;
+	huart->RxXferSize = Size;
+	huart->RxXferCount = Size;
+	huart->ReceptionType = type;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	huart->RxState = HAL_UART_STATE_BUSY_RX;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	return HalSim_Uart_Start(huart, pData, Size, HAL_UART_RECEPTION_STANDARD);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	return HalSim_Uart_Start(huart, pData, Size, HAL_UART_RECEPTION_TOIDLE);
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+	huart->RxState = HAL_UART_STATE_READY;
+	if (huart == Uart.handle) Uart.idle = HALSIM_NEVER;
+	return HAL_OK;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	(void)huart;
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	(void)huart;
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	(void)huart;
+	(void)Size;
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	(void)huart;
+}
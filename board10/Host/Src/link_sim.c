@@ -0,0 +1,182 @@
+/*!
+ * \file      link_sim.c
+ *
+ * \brief     Downlink of a transfer over a simulated LoRa channel (see link_sim.h)
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "link_sim.h"
+#include <string.h>
+
+typedef struct {
+	uint32_t DataAddress;
+	uint32_t Length;
+	uint16_t Total;
+	uint16_t FirstMissing;
+	uint8_t Received[LINKSIM_MAX_PACKETS];
+	uint8_t Parity[LINKSIM_MAX_PACKETS / ARQ_WINDOW_SIZE + 1];	/*Parity packets received per group*/
+	LinkSimResult *Result;
+} LinkSimGround;
+
+static uint32_t Random(LinkSimChannel *channel)
+{
+	channel->Seed = channel->Seed * 1103515245 + 12345;
+	return (channel->Seed >> 8) % 1000000;
+}
+
+bool LinkSim_Lost(LinkSimChannel *channel)
+{
+	if (channel->GoodToBad) {
+		if (channel->Bad) channel->Bad = Random(channel) >= channel->BadToGood;
+		else channel->Bad = Random(channel) < channel->GoodToBad;
+	}
+	return Random(channel) < (channel->Bad ? channel->LossBad : channel->LossGood);
+}
+
+void LinkSim_Bernoulli(LinkSimChannel *channel, uint32_t lossPpm, uint32_t seed)
+{
+	memset(channel, 0, sizeof(*channel));
+	channel->LossGood = lossPpm;
+	channel->TurnaroundMs = LINKSIM_TURNAROUND_MS;
+	channel->Seed = seed;
+}
+
+void LinkSim_Gilbert(LinkSimChannel *channel, uint32_t lossGood, uint32_t lossBad,
+					 uint32_t goodToBad, uint32_t badToGood, uint32_t seed)
+{
+	memset(channel, 0, sizeof(*channel));
+	channel->LossGood = lossGood;
+	channel->LossBad = lossBad;
+	channel->GoodToBad = goodToBad;
+	channel->BadToGood = badToGood;
+	channel->TurnaroundMs = LINKSIM_TURNAROUND_MS;
+	channel->Seed = seed;
+}
+
+void LinkSim_Params(LoraToaParams *params, uint8_t SpreadingFactor)
+{
+	memset(params, 0, sizeof(*params));
+	params->SpreadingFactor = SpreadingFactor;
+	params->Bandwidth = 4;		/*LORA_BW_125*/
+	params->CodingRate = 1;		/*LORA_CR_4_5*/
+	params->PreambleLength = 8;
+	params->Crc = true;
+	params->LowDatarateOptimize = LoraToa_Symbol_Us(SpreadingFactor, 4) >= LORA_TOA_LDRO_SYMBOL_US;
+}
+
+/*A group is rebuilt when its packets received, data or parity, reach its data packets*/
+static void Ground_Rebuild(LinkSimGround *ground, uint16_t group)
+{
+	uint16_t first = group * ARQ_WINDOW_SIZE, last = first + ARQ_WINDOW_SIZE, seq, have = 0;
+
+	if (last > ground->Total) last = ground->Total;
+	for (seq = first; seq < last; seq++) have += ground->Received[seq];
+	if (have == last - first || have + ground->Parity[group] < last - first) return;
+
+	for (seq = first; seq < last; seq++) {
+		if (!ground->Received[seq]) {
+			ground->Received[seq] = 1;
+			ground->Result->Rebuilt++;
+		}
+	}
+}
+
+static void Ground_Receive(LinkSimGround *ground, const uint8_t *packet)
+{
+	uint16_t seq = (uint16_t)(packet[0] << 8 | packet[1]);
+	uint32_t offset, length;
+
+	if (seq & FEC_PARITY_FLAG) {
+		seq &= ~FEC_PARITY_FLAG;
+		ground->Parity[seq >> 4]++;
+		Ground_Rebuild(ground, seq >> 4);
+		return;
+	}
+
+	offset = (uint32_t)seq * ARQ_PAYLOAD_SIZE;
+	length = ground->Length - offset;
+	if (length > ARQ_PAYLOAD_SIZE) length = ARQ_PAYLOAD_SIZE;
+	if (seq >= ground->Total || memcmp(&packet[ARQ_HEADER_SIZE], (const uint8_t *)(ground->DataAddress + offset), length) != 0) {
+		ground->Result->Corrupted++;
+		return;
+	}
+	ground->Received[seq] = 1;
+	Ground_Rebuild(ground, seq / ARQ_WINDOW_SIZE);
+}
+
+static void Ground_Sack(LinkSimGround *ground, uint8_t *sack)
+{
+	uint64_t bitmap = 0;
+	uint16_t seq;
+	int i;
+
+	while (ground->FirstMissing < ground->Total && ground->Received[ground->FirstMissing]) ground->FirstMissing++;
+	for (i = 0; i < 64; i++) {
+		seq = ground->FirstMissing + i;
+		if (seq < ground->Total && ground->Received[seq]) bitmap |= 1ULL << i;
+	}
+	sack[0] = ground->FirstMissing >> 8;
+	sack[1] = ground->FirstMissing & 0xFF;
+	for (i = 0; i < 8; i++) sack[2 + i] = (uint8_t)(bitmap >> (56 - 8 * i));
+}
+
+LinkSimResult LinkSim_Run(uint32_t DataAddress, uint32_t Length, uint8_t Parity,
+						  const LoraToaParams *params, LinkSimChannel *channel)
+{
+	static LinkSimGround ground;
+	static ArqTx arq;
+	LinkSimResult result;
+	uint8_t packet[ARQ_PACKET_SIZE], sack[ARQ_SACK_SIZE];
+	uint32_t packetUs = LoraToa_Compute_Us(params, ARQ_PACKET_SIZE);
+	uint32_t sackUs = LoraToa_Compute_Us(params, ARQ_SACK_SIZE);
+	uint32_t rounds, sent;
+
+	memset(&result, 0, sizeof(result));
+	if (packetUs == 0 || sackUs == 0) return result;	/*Modulation not supported*/
+
+	memset(&ground, 0, sizeof(ground));
+	ground.DataAddress = DataAddress;
+	ground.Length = Length;
+	ground.Total = (Length + ARQ_PAYLOAD_SIZE - 1) / ARQ_PAYLOAD_SIZE;
+	ground.Result = &result;
+
+	Arq_Init(&arq, DataAddress, Length);
+	Arq_Reset(&arq);
+	Arq_Set_Fec(&arq, Parity);
+
+	for (rounds = 0; rounds < LINKSIM_MAX_ROUNDS && !Arq_Done(&arq); rounds++) {
+		sent = 0;
+		while (Arq_Next(&arq, packet)) {
+			result.TimeUs += packetUs;
+			sent++;
+			if (!LinkSim_Lost(channel)) Ground_Receive(&ground, packet);
+		}
+		if (sent == 0) {
+			/*The SACK did not ask for anything (the last packets were lost): the timer expires*/
+			result.TimeUs += LINKSIM_SACK_TIMEOUT_MS * 1000;
+			result.Timeouts++;
+			Arq_Timeout(&arq);
+			continue;
+		}
+
+		result.TimeUs += 2 * channel->TurnaroundMs * 1000 + sackUs;
+		Ground_Sack(&ground, sack);
+		if (LinkSim_Lost(channel)) {
+			result.TimeUs += LINKSIM_SACK_TIMEOUT_MS * 1000;
+			result.Timeouts++;
+			Arq_Timeout(&arq);
+		}
+		else {
+			Arq_Sack(&arq, sack);
+			result.Sacks++;
+		}
+	}
+
+	result.Sent = arq.Sent;
+	result.Retransmitted = arq.Retransmitted;
+	result.Parity = arq.ParitySent;
+	result.Done = Arq_Done(&arq);
+	return result;
+}
@@ -0,0 +1,158 @@
+/*!
+ * \file      trace_decode.c
+ *
+ * \brief     Decoder of the trace pieces and Chrome trace writer (see
+ * 			  trace_decode.h)
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "trace_decode.h"
+#include <string.h>
+
+static const char *const ProbeNames[] = {
+	[TRACE_SYSTEM_STATE] = "systemState",
+	[TRACE_SENSOR_READINGS] = "sensorReadings",
+	[TRACE_I2C_EPOCH] = "I2C epoch",
+	[TRACE_FLASH_WRITE] = "Write_Flash_Direct",
+	[TRACE_FLASH_ERASE] = "Flash_Erase",
+	[TRACE_FLASH_CACHE_FLUSH] = "FlashCache_Flush",
+	[TRACE_CAMERA_STEP] = "downloadStep",
+};
+
+static uint32_t Read_Le(const uint8_t *data, uint8_t bytes)
+{
+	uint32_t value = 0;
+
+	while (bytes--) value = (value << 8) | data[bytes];
+	return value;
+}
+
+void TraceDecode_Init(TraceDecoder *decoder)
+{
+	memset(decoder, 0, sizeof(*decoder));
+}
+
+bool TraceDecode_Piece(TraceDecoder *decoder, const uint8_t *piece, uint16_t length)
+{
+	uint16_t count, i, offset = TRACE_HEADER_SIZE, probe;
+	uint32_t delta, raw;
+	uint8_t shift;
+
+	if (length < TRACE_HEADER_SIZE || piece[0] != 'T' || piece[1] != 'R' || piece[2] != TRACE_VERSION) {
+		decoder->Rejected++;
+		return false;
+	}
+	count = (uint16_t)Read_Le(&piece[3], 2);
+	decoder->Lost += Read_Le(&piece[5], 2);
+	decoder->ClockHz = Read_Le(&piece[7], 4);
+
+	for (i = 0; i < count; i++) {
+		if (offset + 3 > length) break;
+		probe = (uint16_t)Read_Le(&piece[offset], 2);
+		offset += 2;
+		delta = 0;
+		for (shift = 0; offset < length && shift < 35; shift += 7) {
+			delta |= (uint32_t)(piece[offset] & 0x7F) << shift;
+			if (!(piece[offset++] & 0x80)) break;
+		}
+		if (shift >= 35) break;
+
+		/*The first record has the counter itself: unwrapped from the last record decoded*/
+		if (i == 0) {
+			raw = delta;
+			decoder->Last += (uint32_t)(raw - (uint32_t)decoder->Last);
+		}
+		else decoder->Last += delta;
+
+		if (decoder->Count < TRACE_DECODE_MAX_RECORDS) {
+			decoder->Records[decoder->Count].Cycles = decoder->Last;
+			decoder->Records[decoder->Count].Probe = probe;
+			decoder->Count++;
+		}
+		else decoder->Dropped++;
+	}
+	if (i < count) {
+		decoder->Rejected++;
+		return false;
+	}
+	return true;
+}
+
+const char *TraceDecode_Name(uint16_t probe, const char *const *tasks, uint8_t taskCount)
+{
+	probe &= ~TRACE_EXIT_FLAG;
+	if (probe >= TRACE_TASK && tasks != NULL && probe - TRACE_TASK < taskCount) return tasks[probe - TRACE_TASK];
+	if (probe < sizeof(ProbeNames) / sizeof(ProbeNames[0]) && ProbeNames[probe] != NULL) return ProbeNames[probe];
+	return NULL;
+}
+
+/**************************************************************************************
+ *                                                                                    *
+ * Function:  TraceDecode_Chrome                                                      *
+ * --------------------                                                               *
+ * Pairs every exit with the last enter of the same probe and writes the pair as a    *
+ * complete event ("ph": "X") of the Chrome trace format, in microseconds. The        *
+ * records lost on board leave exits without their enter: they are skipped            *
+ *                                                                                    *
+ *  decoder: records of TraceDecode_Piece, its Probes are filled                      *
+ *  out: the JSON file                                                                *
+ *  tasks: names of the scheduler tasks (TRACE_TASK + index), NULL if not known       *
+ *  taskCount: entries in tasks                                                       *
+ *                                                                                    *
+ *  returns: complete events written                                                  *
+ *                                                                                    *
+ **************************************************************************************/
+uint32_t TraceDecode_Chrome(TraceDecoder *decoder, FILE *out, const char *const *tasks, uint8_t taskCount)
+{
+	static uint64_t Stack[TRACE_DECODE_PROBES][TRACE_DECODE_DEPTH];
+	static uint8_t Depth[TRACE_DECODE_PROBES];
+	double usPerCycle = decoder->ClockHz ? 1e6 / decoder->ClockHz : 1.0;
+	const TraceDecodeRecord *record;
+	TraceDecodeProbe *stats;
+	const char *name;
+	uint64_t start, duration;
+	uint32_t i, events = 0;
+	uint16_t probe;
+	uint8_t slot;
+
+	memset(Depth, 0, sizeof(Depth));
+	memset(decoder->Probes, 0, sizeof(decoder->Probes));
+	decoder->Unpaired = 0;
+
+	fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	for (i = 0; i < decoder->Count; i++) {
+		record = &decoder->Records[i];
+		probe = record->Probe & ~TRACE_EXIT_FLAG;
+		slot = probe < TRACE_DECODE_PROBES ? probe : TRACE_DECODE_PROBES - 1;
+
+		if (!(record->Probe & TRACE_EXIT_FLAG)) {
+			if (Depth[slot] < TRACE_DECODE_DEPTH) Stack[slot][Depth[slot]++] = record->Cycles;
+			else decoder->Unpaired++;
+			continue;
+		}
+		if (Depth[slot] == 0) {
+			decoder->Unpaired++;
+			continue;
+		}
+		start = Stack[slot][--Depth[slot]];
+		duration = record->Cycles - start;
+
+		stats = &decoder->Probes[slot];
+		stats->Count++;
+		stats->TotalCycles += duration;
+		if (duration > stats->MaxCycles) stats->MaxCycles = duration;
+
+		name = TraceDecode_Name(probe, tasks, taskCount);
+		fprintf(out, "%s\n{\"name\":\"", events ? "," : "");
+		if (name != NULL) fprintf(out, "%s", name);
+		else fprintf(out, "probe 0x%04x", probe);
+		fprintf(out, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+				probe >= TRACE_TASK ? "task" : "probe", start * usPerCycle, duration * usPerCycle);
+		events++;
+	}
+	for (slot = 0; slot < TRACE_DECODE_PROBES; slot++) decoder->Unpaired += Depth[slot];
+	fprintf(out, "\n]}\n");
+	return events;
+}
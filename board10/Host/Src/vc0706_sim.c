@@ -0,0 +1,159 @@
+/*!
+ * \file      vc0706_sim.c
+ *
+ * \brief     VC0706 camera on the simulated USART1 (see vc0706_sim.h)
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "vc0706_sim.h"
+#include "hal_sim.h"
+#include <string.h>
+
+#define VC0706_SEND			0x56
+#define VC0706_RECEIVE		0x76
+#define VC0706_SERIAL		0x00
+
+#define VC0706_WRITE_DATA	0x31
+#define VC0706_READ_FBUF	0x32
+#define VC0706_GET_FBUF_LEN	0x34
+#define VC0706_FBUF_CTRL	0x36
+
+#define VC0706_OK			0x00
+#define VC0706_BAD_COMMAND	0x01
+#define VC0706_BAD_LENGTH	0x03
+
+static const uint8_t *Frame;
+static uint32_t FrameLength;
+static uint32_t Latency = 100;
+static uint32_t ErrorPpm = 0;
+static uint32_t Seed = 1;
+static VC0706SimStats Stats;
+static uint8_t Answer[1024];			/*Biggest READ_FBUF answered, headers included*/
+
+static uint32_t Random(void)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return Seed >> 8;
+}
+
+/*76 00 command status 00*/
+static void Send_Status(uint8_t command, uint8_t status, uint32_t delay_us)
+{
+	uint8_t header[5] = { VC0706_RECEIVE, VC0706_SERIAL, command, status, 0x00 };
+
+	HalSim_Uart_Send(header, sizeof(header), delay_us);
+}
+
+/*Header, delay, data and header again. Damaged answers still take their time on the line*/
+static void Read_Fbuf(const uint8_t *args, uint16_t length)
+{
+	uint32_t address, size, delay_us;
+	uint8_t header[5] = { VC0706_RECEIVE, VC0706_SERIAL, VC0706_READ_FBUF, VC0706_OK, 0x00 };
+	uint16_t total;
+
+	if (length < 13 || args[0] != 0x0C) {
+		Send_Status(VC0706_READ_FBUF, VC0706_BAD_LENGTH, Latency);
+		return;
+	}
+	address = (uint32_t)args[3] << 24 | (uint32_t)args[4] << 16 | (uint32_t)args[5] << 8 | args[6];
+	size = (uint32_t)args[7] << 24 | (uint32_t)args[8] << 16 | (uint32_t)args[9] << 8 | args[10];
+	delay_us = ((uint32_t)args[11] << 8 | args[12]) * 10;
+
+	if ((size % 8 != 0 && address + size < FrameLength) || size == 0 || address + size > FrameLength ||
+		size + 10 > sizeof(Answer)) {
+		Stats.refused++;
+		Send_Status(VC0706_READ_FBUF, VC0706_BAD_LENGTH, Latency);
+		return;
+	}
+
+	memcpy(Answer, header, 5);
+	memcpy(&Answer[5], &Frame[address], size);
+	memcpy(&Answer[5 + size], header, 5);
+	total = (uint16_t)(size + 10);
+	Stats.reads++;
+	Stats.read_bytes += size;
+
+	if (ErrorPpm && Random() % 1000000 < ErrorPpm) {
+		Stats.corrupted++;
+		if (Random() & 1) Answer[5 + size + (Random() % 4)] ^= 0x5A;	/*Bad trailing header*/
+		else total -= (uint16_t)(1 + Random() % size);					/*Bytes lost on the line*/
+	}
+
+	HalSim_Uart_Send(Answer, 5, Latency);
+	HalSim_Uart_Send(&Answer[5], total - 5, delay_us);
+}
+
+/*Every frame sent by the MCU*/
+static void VC0706_Peer(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t length)
+{
+	uint8_t answer[9] = { VC0706_RECEIVE, VC0706_SERIAL, VC0706_GET_FBUF_LEN, VC0706_OK, 0x04 };
+
+	(void)huart;
+	Stats.commands++;
+	if (length < 3 || data[0] != VC0706_SEND || data[1] != VC0706_SERIAL) return;	/*Ignored*/
+
+	switch (data[2]) {
+	case VC0706_FBUF_CTRL:
+	case VC0706_WRITE_DATA:
+		Send_Status(data[2], VC0706_OK, Latency);
+		break;
+	case VC0706_GET_FBUF_LEN:
+		answer[5] = (uint8_t)(FrameLength >> 24);
+		answer[6] = (uint8_t)(FrameLength >> 16);
+		answer[7] = (uint8_t)(FrameLength >> 8);
+		answer[8] = (uint8_t)FrameLength;
+		HalSim_Uart_Send(answer, sizeof(answer), Latency);
+		break;
+	case VC0706_READ_FBUF:
+		Read_Fbuf(&data[3], length - 3);
+		break;
+	default:
+		Send_Status(data[2], VC0706_BAD_COMMAND, Latency);
+		break;
+	}
+}
+
+void VC0706Sim_Init(UART_HandleTypeDef *huart, const uint8_t *frame, uint32_t length)
+{
+	Frame = frame;
+	FrameLength = length;
+	memset(&Stats, 0, sizeof(Stats));
+	HalSim_Uart_Attach(huart, VC0706_Peer);
+}
+
+void VC0706Sim_Set_Latency(uint32_t latency_us)
+{
+	Latency = latency_us;
+}
+
+void VC0706Sim_Set_Error_Rate(uint32_t ppm, uint32_t seed)
+{
+	ErrorPpm = ppm;
+	Seed = seed;
+}
+
+const VC0706SimStats *VC0706Sim_Get_Stats(void)
+{
+	return &Stats;
+}
+
+void VC0706Sim_Make_Jpeg(uint8_t *jpeg, uint32_t length, uint32_t seed)
+{
+	static const uint8_t Header[] = {
+		0xFF, 0xD8,														/*SOI*/
+		0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01,	/*APP0*/
+		0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+	};
+	uint32_t i;
+
+	memcpy(jpeg, Header, sizeof(Header));
+	for (i = sizeof(Header); i < length - 2; i++) {
+		seed = seed * 1103515245 + 12345;
+		jpeg[i] = (uint8_t)(seed >> 16);
+		if (jpeg[i] == 0xFF) jpeg[i] = 0xFE;	/*No markers inside the scan*/
+	}
+	jpeg[length - 2] = 0xFF;
+	jpeg[length - 1] = 0xD9;					/*EOI*/
+}
@@ -0,0 +1,42 @@
+/*!
+ * \file      host_test.h
+ *
+ * \brief     Checks of the host tests: a failed CHECK prints its line and the
+ * 			  test returns non-zero from HOST_TEST_END, so ctest reports it.
+ * 			  Benchmarks print their results with BENCH, one line each, to be
+ * 			  read in the output of ctest -V.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int HostTestFailures = 0;
+
+#define CHECK(condition) do { \
+		if (!(condition)) { \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			HostTestFailures++; \
+		} \
+	} while (0)
+
+#define BENCH(...)		do { printf("bench: " __VA_ARGS__); printf("\n"); } while (0)
+
+#define HOST_TEST_END()	(printf("%s\n", HostTestFailures ? "FAILED" : "OK"), HostTestFailures != 0)
+
+/*Wall clock of the host, for the cost of the code itself (ns)*/
+static inline uint64_t Host_Clock_Ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+#endif /* HOST_TEST_H_ */
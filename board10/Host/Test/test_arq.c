@@ -0,0 +1,161 @@
+/*!
+ * \file      test_arq.c
+ *
+ * \brief     Selective-repeat ARQ (arq.c) over the simulated lossy downlink
+ * 			  (link_sim.c): every packet of a 20 KB image arrives intact, the
+ * 			  window is resumed after a reset, and the goodput against the
+ * 			  loss rate at SF7 to SF12, next to a stop-and-wait per window.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "link_sim.h"
+#include "flash.h"
+#include "flash_cache.h"
+#include "flash_log.h"
+
+#define IMAGE_BYTES		20480
+#define SEEDS			4
+
+static uint8_t Image[IMAGE_BYTES];
+
+static void Setup(void)
+{
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HAL_FLASH_Unlock();
+	CHECK(Flash_Program_Data(PHOTO_ADDR, Image, IMAGE_BYTES) == HAL_OK);
+	HAL_FLASH_Lock();
+}
+
+/*
+ * The previous scheme: the missing packets of a window of ARQ_WINDOW_SIZE are sent
+ * again until it is complete, the next window waits for it. Without the SACK the
+ * satellite sends again everything it did not see acknowledged.
+ */
+static uint64_t Stop_And_Wait_Us(const LoraToaParams *params, LinkSimChannel *channel)
+{
+	uint32_t packetUs = LoraToa_Compute_Us(params, ARQ_PACKET_SIZE);
+	uint32_t sackUs = LoraToa_Compute_Us(params, ARQ_SACK_SIZE);
+	uint16_t total = (IMAGE_BYTES + ARQ_PAYLOAD_SIZE - 1) / ARQ_PAYLOAD_SIZE;
+	uint16_t first, known, missing, received, i;
+	uint64_t time = 0;
+
+	for (first = 0; first < total; first += ARQ_WINDOW_SIZE) {
+		known = missing = (total - first < ARQ_WINDOW_SIZE) ? total - first : ARQ_WINDOW_SIZE;
+		while (known > 0) {
+			for (i = 0, received = 0; i < known; i++) {
+				time += packetUs;
+				if (!LinkSim_Lost(channel) && i < missing) received++;
+			}
+			missing -= received;
+			time += 2 * channel->TurnaroundMs * 1000 + sackUs;
+			if (LinkSim_Lost(channel)) time += LINKSIM_SACK_TIMEOUT_MS * 1000;
+			else known = missing;
+		}
+	}
+	return time;
+}
+
+static void Test_Transfer(void)
+{
+	LoraToaParams params;
+	LinkSimChannel channel;
+	LinkSimResult result;
+
+	Setup();
+	LinkSim_Params(&params, 7);
+
+	LinkSim_Bernoulli(&channel, 0, 1);
+	result = LinkSim_Run(PHOTO_ADDR, IMAGE_BYTES, 0, &params, &channel);
+	CHECK(result.Done && result.Corrupted == 0);
+	CHECK(result.Sent == (IMAGE_BYTES + ARQ_PAYLOAD_SIZE - 1) / ARQ_PAYLOAD_SIZE && result.Retransmitted == 0);
+
+	/*Half of the packets and SACKs lost*/
+	LinkSim_Bernoulli(&channel, 500000, 2);
+	result = LinkSim_Run(PHOTO_ADDR, IMAGE_BYTES, 0, &params, &channel);
+	CHECK(result.Done && result.Corrupted == 0);
+	CHECK(result.Retransmitted > 0 && result.Timeouts > 0);
+}
+
+static void Test_Resume(void)
+{
+	static ArqTx arq;
+	uint8_t packet[ARQ_PACKET_SIZE], sack[ARQ_SACK_SIZE] = { 0 };
+	int i;
+
+	Setup();
+	Arq_Init(&arq, PHOTO_ADDR, IMAGE_BYTES);
+	Arq_Reset(&arq);
+	for (i = 0; i < ARQ_WINDOW_SIZE; i++) CHECK(Arq_Next(&arq, packet));
+	CHECK(!Arq_Next(&arq, packet));
+
+	/*The first window received*/
+	sack[1] = ARQ_WINDOW_SIZE;
+	Arq_Sack(&arq, sack);
+	CHECK(arq.Base == 40 && arq.Next == 40);
+
+	/*Reset: the window is taken from the flash*/
+	Arq_Init(&arq, PHOTO_ADDR, IMAGE_BYTES);
+	CHECK(arq.Base == 40 && arq.Next == 40);
+	CHECK(Arq_Next(&arq, packet) && packet[0] == 0 && packet[1] == 40);
+
+	/*A window of another, shorter transfer is not resumed*/
+	Arq_Init(&arq, PHOTO_ADDR, 100);
+	CHECK(arq.Base == 0);
+}
+
+static void Bench_Goodput(void)
+{
+	static const uint32_t Losses[] = { 0, 50000, 100000, 200000, 300000 };
+	LoraToaParams params;
+	LinkSimChannel channel;
+	LinkSimResult result;
+	uint64_t arqUs, sawUs;
+	uint32_t sf, l, seed, retransmitted;
+	double raw;
+
+	Setup();
+	for (sf = LORA_TOA_SF_MIN; sf <= LORA_TOA_SF_MAX; sf++) {
+		LinkSim_Params(&params, sf);
+		raw = (double)ARQ_PAYLOAD_SIZE * 1e6 / LoraToa_Compute_Us(&params, ARQ_PACKET_SIZE);
+		for (l = 0; l < sizeof(Losses) / sizeof(Losses[0]); l++) {
+			arqUs = sawUs = 0;
+			retransmitted = 0;
+			for (seed = 1; seed <= SEEDS; seed++) {
+				LinkSim_Bernoulli(&channel, Losses[l], seed);
+				result = LinkSim_Run(PHOTO_ADDR, IMAGE_BYTES, 0, &params, &channel);
+				CHECK(result.Done && result.Corrupted == 0);
+				arqUs += result.TimeUs;
+				retransmitted += result.Retransmitted;
+
+				LinkSim_Bernoulli(&channel, Losses[l], seed);
+				sawUs += Stop_And_Wait_Us(&params, &channel);
+			}
+			BENCH("SF%-2u loss %2u%%: goodput %6.1f B/s (%3.0f%% of %6.1f B/s), %5.0f s per image, "
+				  "%4u retransmissions, stop-and-wait %6.1f B/s",
+				  sf, Losses[l] / 10000, IMAGE_BYTES * 1e6 * SEEDS / arqUs,
+				  100.0 * IMAGE_BYTES * 1e6 * SEEDS / arqUs / raw, raw, arqUs / 1e6 / SEEDS,
+				  retransmitted / SEEDS, IMAGE_BYTES * 1e6 * SEEDS / sawUs);
+			/*Lost packets of the tail are only known after a timeout, on par below 20%*/
+			CHECK(arqUs < sawUs * 1.02);
+			if (Losses[l] >= 300000) CHECK(arqUs < sawUs);
+			if (Losses[l] == 0) CHECK(arqUs * raw < IMAGE_BYTES * 1e6 * SEEDS / 0.95);
+		}
+	}
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < IMAGE_BYTES; i++) Image[i] = (uint8_t)(i * 31 + (i >> 7));
+	Test_Transfer();
+	Test_Resume();
+	Bench_Goodput();
+	return HOST_TEST_END();
+}
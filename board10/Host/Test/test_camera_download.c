@@ -0,0 +1,97 @@
+/*!
+ * \file      test_camera_download.c
+ *
+ * \brief     Download engine of retrieveImage against the simulated VC0706 with
+ * 			  different processing latencies and rates of damaged answers:
+ * 			  download time, retries and chunk size of every frame, and the
+ * 			  photo area checked against the frame every time it succeeds.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "vc0706_sim.h"
+#include "payload_camera.h"
+#include "flash.h"
+
+#define JPEG_BYTES		8192
+#define SEEDS			3
+
+extern uint32_t frameLength;
+
+static uint8_t Jpeg[JPEG_BYTES];
+static UART_HandleTypeDef Huart = { .Instance = USART1 };
+
+/*One frame, returns true if it was downloaded and it is in the flash*/
+static bool Download(uint32_t baud, uint32_t latency_us, uint32_t ppm, uint32_t seed)
+{
+	HalSim_Reset();
+	Huart.Init.BaudRate = baud;
+	HAL_UART_Init(&Huart);
+	VC0706Sim_Init(&Huart, Jpeg, sizeof(Jpeg));
+	VC0706Sim_Set_Latency(latency_us);
+	VC0706Sim_Set_Error_Rate(ppm, seed);
+	CameraUart_Init(&Huart, NULL);
+
+	frameLength = sizeof(Jpeg);
+	if (!retrieveImage(&Huart)) return false;
+	CHECK(memcmp((uint8_t *)PHOTO_ADDR, Jpeg, sizeof(Jpeg)) == 0);
+	return true;
+}
+
+static void Bench_Download(void)
+{
+	static const uint32_t Bauds[] = { 38400, 115200 };
+	static const uint32_t Latencies[] = { 100, 2000 };
+	static const uint32_t Errors[] = { 0, 10000, 50000, 100000 };
+	const CameraDownloadStats *stats = getDownloadStats();
+	uint32_t b, l, e, seed, ok, retries, time, flash;
+
+	for (b = 0; b < sizeof(Bauds) / sizeof(Bauds[0]); b++) {
+		for (l = 0; l < sizeof(Latencies) / sizeof(Latencies[0]); l++) {
+			for (e = 0; e < sizeof(Errors) / sizeof(Errors[0]); e++) {
+				ok = retries = time = 0;
+				for (seed = 1; seed <= SEEDS; seed++) {
+					if (Download(Bauds[b], Latencies[l], Errors[e], seed)) ok++;
+					retries += stats->retries;
+					time += stats->time_ms;
+					/*Every chunk asked for, shrunk or not, is accepted by the camera*/
+					CHECK(VC0706Sim_Get_Stats()->refused == 0);
+				}
+				flash = (uint32_t)(HalSim_Flash_Get_Stats()->busy_ns / 1000000);
+				BENCH("%6u baud, latency %4u us, %4.1f%% bad answers: %u/%d frames, %5u ms per frame "
+					  "(%u ms in the flash), %4.1f retries per frame, chunk %u",
+					  Bauds[b], Latencies[l], Errors[e] / 1e4, ok, SEEDS, time / SEEDS, flash, (double)retries / SEEDS,
+					  stats->chunk_size);
+				if (Errors[e] == 0) CHECK(ok == SEEDS && retries == 0);
+				if (Errors[e] <= 10000) CHECK(ok == SEEDS);
+			}
+		}
+	}
+}
+
+/*Damaged answers right after the start: the chunk is halved twice from the tuned 176 B*/
+static void Test_Shrink(void)
+{
+	const CameraDownloadStats *stats = getDownloadStats();
+	uint32_t seed;
+	bool retried = false;
+
+	for (seed = 1; seed <= 10; seed++) {
+		if (Download(38400, 100, 300000, seed)) CHECK(stats->bytes == sizeof(Jpeg));
+		if (stats->retries >= 2) retried = true;
+		CHECK(VC0706Sim_Get_Stats()->refused == 0);
+	}
+	CHECK(retried);
+	CHECK(stats->chunk_size == 176);
+}
+
+int main(void)
+{
+	VC0706Sim_Make_Jpeg(Jpeg, sizeof(Jpeg), 11);
+	Test_Shrink();
+	Bench_Download();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,162 @@
+/*!
+ * \file      test_camera_retrieve.c
+ *
+ * \brief     Streaming download of a photo (retrieveImage) from the simulated
+ * 			  VC0706 to the simulated flash: the photo area ends with the same
+ * 			  bytes as the JPEG served by the camera, the same photo taken by
+ * 			  steps (photoStep) from a main loop that keeps running, and the
+ * 			  throughput in bytes/s at the usual baud rates. The JPEG is
+ * 			  generated, or read from the file given as the first argument.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "vc0706_sim.h"
+#include "payload_camera.h"
+#include "flash.h"
+
+#define JPEG_BYTES		20000
+#define LOOP_US			50			/*One iteration of a main loop with nothing to do*/
+#define TASK_PERIOD_MS	10			/*Period of the camera task of main.c*/
+
+static uint8_t Jpeg[VC0706SIM_MAX_FRAME];
+static uint32_t JpegLength = JPEG_BYTES;
+static UART_HandleTypeDef Huart = { .Instance = USART1 };
+static volatile int Events;
+
+static void On_Event(CameraUartEvent event)
+{
+	(void)event;
+	Events++;
+}
+
+static uint32_t Load_Jpeg(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	size_t length;
+
+	if (file == NULL) return 0;
+	length = fread(Jpeg, 1, sizeof(Jpeg), file);
+	fclose(file);
+	return (uint32_t)length;
+}
+
+/*Camera and transport on a clean board, the reception started after HAL_UART_Init*/
+static void Setup(uint32_t baud)
+{
+	HalSim_Reset();
+	Huart.Init.BaudRate = baud;
+	HAL_UART_Init(&Huart);
+	VC0706Sim_Init(&Huart, Jpeg, JpegLength);
+	VC0706Sim_Set_Latency(100);
+	VC0706Sim_Set_Error_Rate(0, 1);
+	CameraUart_Init(&Huart, NULL);
+}
+
+static void Test_Photo(void)
+{
+	const CameraDownloadStats *stats = getDownloadStats();
+
+	Setup(115200);
+	CHECK(takePhoto(&Huart));
+	CHECK(stats->ok && stats->bytes == JpegLength && stats->retries == 0);
+	CHECK(memcmp((uint8_t *)PHOTO_ADDR, Jpeg, JpegLength) == 0);
+	CHECK(*(uint8_t *)(PHOTO_ADDR + JpegLength) == 0xFF);
+	CHECK(CameraUart_Overflows() == 0);
+	CHECK(VC0706Sim_Get_Stats()->refused == 0);
+}
+
+/*The camera task of main.c: a step on every event of the UART and every TASK_PERIOD_MS*/
+static void Test_Task(void)
+{
+	CameraPhotoState state = CAMERA_PHOTO_IDLE, before;
+	uint64_t start, step, erase = 0, longest = 0;
+	uint32_t last = 0, loops = 0, steps = 0;
+
+	Setup(115200);
+	CameraUart_Init(&Huart, On_Event);
+	Events = 0;
+	CHECK(startPhoto(&Huart));
+	CHECK(!startPhoto(&Huart));
+	while (state != CAMERA_PHOTO_DONE && state != CAMERA_PHOTO_FAILED && loops < 10000000) {
+		if (Events == 0 && HAL_GetTick() - last < TASK_PERIOD_MS) {
+			HalSim_Advance_Us(LOOP_US);
+			loops++;
+			continue;
+		}
+		Events = 0;
+		last = HAL_GetTick();
+		before = state;
+		start = HalSim_Now_Ns();
+		state = photoStep();
+		step = HalSim_Now_Ns() - start;
+		steps++;
+		/*The erase of the photo area, before the first chunk, stalls the CPU anyway*/
+		if (before == CAMERA_PHOTO_LENGTH) erase = step;
+		else if (step > longest) longest = step;
+	}
+	CHECK(state == CAMERA_PHOTO_DONE);
+	CHECK(memcmp((uint8_t *)PHOTO_ADDR, Jpeg, JpegLength) == 0);
+	CHECK(getDownloadStats()->ok && getDownloadStats()->bytes == JpegLength);
+	BENCH("photo by steps: %u steps, the longest %.2f ms (erase %.0f ms), %u main loop iterations of %d us meanwhile",
+		  steps, longest / 1e6, erase / 1e6, loops, LOOP_US);
+	CHECK(longest < 5000000);
+	CHECK(loops > steps);
+}
+
+/*CameraUart_Init before HAL_UART_Init: the reception is refused, the first command starts it*/
+static void Test_Not_Armed(void)
+{
+	HalSim_Reset();
+	memset(&Huart, 0, sizeof(Huart));
+	Huart.Instance = USART1;
+	Huart.Init.BaudRate = 115200;
+	VC0706Sim_Init(&Huart, Jpeg, JpegLength);
+	CameraUart_Init(&Huart, NULL);
+	CHECK(Huart.RxState != HAL_UART_STATE_BUSY_RX);
+
+	HAL_UART_Init(&Huart);
+	CHECK(captureImage(&Huart));
+	getFrameLength(&Huart);
+	CHECK(retrieveImage(&Huart));
+	CHECK(memcmp((uint8_t *)PHOTO_ADDR, Jpeg, JpegLength) == 0);
+	CHECK(HalSim_Uart_Get_Stats()->lost == 0);
+}
+
+static void Bench_Throughput(void)
+{
+	static const uint32_t Bauds[] = { 38400, 57600, 115200 };
+	const CameraDownloadStats *stats = getDownloadStats();
+	uint32_t i;
+	double line;
+
+	for (i = 0; i < sizeof(Bauds) / sizeof(Bauds[0]); i++) {
+		Setup(Bauds[i]);
+		CHECK(takePhoto(&Huart));
+		CHECK(memcmp((uint8_t *)PHOTO_ADDR, Jpeg, JpegLength) == 0);
+		line = Bauds[i] / 10.0;
+		BENCH("%6u baud: %u B in %u ms (%.0f ms erasing and programming), %.0f B/s (%.0f%% of the line), chunk %u",
+			  Bauds[i], stats->bytes, stats->time_ms, HalSim_Flash_Get_Stats()->busy_ns / 1e6,
+			  stats->bytes * 1000.0 / stats->time_ms, 100.0 * stats->bytes * 1000.0 / stats->time_ms / line,
+			  stats->chunk_size);
+	}
+	BENCH("fixed 100 ms per 128 B chunk: at least %u ms, %u B on the stack",
+		  (JpegLength + 127) / 128 * 100, JpegLength);
+	BENCH("RAM of the pipeline: %d B chunk + %d B ring", CAMERA_CHUNK_MAX + 10, CAMERA_UART_RX_FIFO_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1) JpegLength = Load_Jpeg(argv[1]);
+	else VC0706Sim_Make_Jpeg(Jpeg, JpegLength, 7);
+	CHECK(JpegLength > 0 && JpegLength <= PHOTO_MAX_SIZE);
+
+	Test_Photo();
+	Test_Task();
+	Test_Not_Armed();
+	Bench_Throughput();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,172 @@
+/*!
+ * \file      test_camera_uart.c
+ *
+ * \brief     Asynchronous transport of the camera (camera_uart.c) against the
+ * 			  simulated VC0706: latency of every command of payload_camera.c,
+ * 			  how long CameraUart_Send keeps the CPU, how many main loop
+ * 			  iterations run while a command is answered, the ring buffer
+ * 			  when nobody reads it, and the line errors in the middle of an
+ * 			  answer.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "vc0706_sim.h"
+#include "payload_camera.h"
+
+#define BAUD			38400		/*Default of the VC0706*/
+#define LATENCY_US		200
+#define LOOP_US			50			/*One iteration of a main loop with nothing to do*/
+
+static uint8_t Jpeg[4096];
+static UART_HandleTypeDef Huart = { .Instance = USART1, .Init = { .BaudRate = BAUD } };
+static volatile int TxDone, RxIdle, Overflows;
+
+static void On_Event(CameraUartEvent event)
+{
+	if (event == CAMERA_UART_TX_DONE) TxDone++;
+	else if (event == CAMERA_UART_RX_IDLE) RxIdle++;
+	else Overflows++;
+}
+
+static void Setup(void)
+{
+	HalSim_Reset();
+	HAL_UART_Init(&Huart);
+	VC0706Sim_Init(&Huart, Jpeg, sizeof(Jpeg));
+	VC0706Sim_Set_Latency(LATENCY_US);
+	CameraUart_Init(&Huart, On_Event);
+	TxDone = RxIdle = Overflows = 0;
+}
+
+/*Time of n characters on the line*/
+static double Chars_Us(uint32_t n)
+{
+	return n * 10 * 1e6 / BAUD;
+}
+
+static void Bench_Commands(void)
+{
+	static const struct {
+		const char *name;
+		uint8_t command, length, answer;
+		uint8_t args[13];
+	} Commands[] = {
+		{ "FBUF_CTRL stop", 0x36, 2, 5, { 0x01, 0x00 } },
+		{ "GET_FBUF_LEN", 0x34, 2, 9, { 0x01, 0x00 } },
+		{ "WRITE_DATA resolution", 0x31, 6, 5, { 0x05, 0x04, 0x01, 0x00, 0x19, 0x00 } },
+		{ "READ_FBUF 8 B", 0x32, 13, 18, { 0x0C, 0x00, 0x0A, 0, 0, 0, 0, 0, 0, 0, 8, 0, 1 } },
+	};
+	uint64_t start, ns;
+	double ideal;
+	uint32_t i;
+
+	Setup();
+	for (i = 0; i < sizeof(Commands) / sizeof(Commands[0]); i++) {
+		start = HalSim_Now_Ns();
+		CHECK(runCommand(&Huart, Commands[i].command, (uint8_t *)Commands[i].args, Commands[i].length,
+						 Commands[i].answer, true));
+		ns = HalSim_Now_Ns() - start;
+		ideal = Chars_Us(3 + Commands[i].length + Commands[i].answer) + LATENCY_US;
+		BENCH("%-22s %7.0f us (line + camera %6.0f us), previously > %.0f us",
+			  Commands[i].name, ns / 1e3, ideal, 100000 + ideal);
+		CHECK(ns / 1e3 < ideal + 1000);
+	}
+}
+
+static void Test_Background(void)
+{
+	static const uint8_t Args[] = { 0x01, 0x00 };
+	uint8_t answer[9];
+	uint64_t start, send;
+	uint32_t loops = 0;
+
+	/*Sending only starts the interrupt transfer*/
+	Setup();
+	start = HalSim_Now_Ns();
+	CHECK(CameraUart_Send(0x34, Args, sizeof(Args)));
+	send = HalSim_Now_Ns() - start;
+	CHECK(CameraUart_TxBusy());
+	CHECK(!CameraUart_Send(0x34, Args, sizeof(Args)));
+
+	/*The main loop keeps running until the answer is complete*/
+	while (RxIdle == 0 && loops < 100000) {
+		HalSim_Advance_Us(LOOP_US);
+		loops++;
+	}
+	CHECK(TxDone == 1 && RxIdle == 1);
+	CHECK(CameraUart_Read(answer, sizeof(answer)) == 9);
+	CHECK(answer[0] == 0x76 && answer[2] == 0x34 && answer[8] == (uint8_t)sizeof(Jpeg));
+	BENCH("CameraUart_Send: %.1f us of CPU, %u main loop iterations of %d us while GET_FBUF_LEN is answered",
+		  send / 1e3, loops, LOOP_US);
+	CHECK(send < 10000);
+	CHECK(loops > 50);
+}
+
+static void Test_Overflow(void)
+{
+	static const uint8_t Read[] = { 0x0C, 0x00, 0x0A, 0, 0, 0, 0, 0, 0, 0x01, 0x00, 0, 1 };
+	uint8_t data[CAMERA_UART_RX_FIFO_SIZE];
+	int i;
+
+	/*Three 256 B chunks nobody reads: the ring keeps what fits and counts the rest*/
+	Setup();
+	for (i = 0; i < 3; i++) {
+		CHECK(CameraUart_Send(0x32, Read, sizeof(Read)));
+		HalSim_Advance_Us(100000);
+	}
+	CHECK(Overflows > 0);
+	CHECK(CameraUart_Overflows() + CameraUart_Read(data, sizeof(data)) == 3 * (256 + 10));
+	CHECK(HalSim_Uart_Get_Stats()->lost == 0);
+
+	/*Once read, it receives again*/
+	CameraUart_Flush();
+	CHECK(runCommand(&Huart, 0x36, (uint8_t *)"\x01\x03", 2, 5, true));
+}
+
+/*A line error after the 4th byte of the GET_FBUF_LEN answer, returns the bytes received*/
+static uint16_t Answer_With_Error(uint32_t error, uint8_t *answer)
+{
+	static const uint8_t Args[] = { 0x01, 0x00 };
+	uint16_t size;
+	uint32_t loops = 0;
+
+	CameraUart_Flush();
+	CHECK(CameraUart_Send(0x34, Args, sizeof(Args)));
+	size = Huart.RxXferSize;
+	while (Huart.RxXferCount > size - 4 && loops++ < 100000) HalSim_Advance_Us(LOOP_US);
+	HalSim_Uart_Error(error);
+	HalSim_Advance_Us(10000);
+	return CameraUart_Read(answer, 9);
+}
+
+static void Test_Errors(void)
+{
+	uint8_t answer[9];
+	int idle;
+
+	/*Noise: the reception goes on in the same block, the answer ends as usual*/
+	Setup();
+	CHECK(Answer_With_Error(HAL_UART_ERROR_NE, answer) == 9);
+	CHECK(answer[0] == 0x76 && answer[2] == 0x34 && answer[8] == (uint8_t)sizeof(Jpeg));
+
+	/*Overrun: the 4 bytes before it are kept and the reception starts again for the rest*/
+	idle = RxIdle;
+	CHECK(Answer_With_Error(HAL_UART_ERROR_ORE, answer) == 9);
+	CHECK(answer[0] == 0x76 && answer[2] == 0x34 && answer[8] == (uint8_t)sizeof(Jpeg));
+	CHECK(RxIdle == idle + 1 && Huart.RxState == HAL_UART_STATE_BUSY_RX);
+	CHECK(HalSim_Uart_Get_Stats()->lost == 0 && CameraUart_Overflows() == 0);
+}
+
+int main(void)
+{
+	VC0706Sim_Make_Jpeg(Jpeg, sizeof(Jpeg), 3);
+	Bench_Commands();
+	Test_Background();
+	Test_Overflow();
+	Test_Errors();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,256 @@
+/*!
+ * \file      test_fec.c
+ *
+ * \brief     Cauchy erasure code of the downlink (fec.c): lost packets of a
+ * 			  group rebuilt from the parity by a decoder written here with its
+ * 			  own GF(2^8) arithmetic, the encode throughput, and the time of a
+ * 			  20 KB image with ARQ only or FEC + ARQ on a channel with bursts.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "link_sim.h"
+#include "flash.h"
+#include "flash_cache.h"
+#include "flash_log.h"
+#include <string.h>
+
+#define IMAGE_BYTES		20480
+#define SEEDS			32
+#define ENCODE_GROUPS	20000
+
+static uint8_t Image[IMAGE_BYTES];
+
+/*Shift-and-add multiplication, polynomial 0x11D*/
+static uint8_t Gf_Mul(uint8_t a, uint8_t b)
+{
+	uint8_t p = 0;
+
+	while (b) {
+		if (b & 1) p ^= a;
+		a = (a << 1) ^ ((a & 0x80) ? 0x1D : 0);
+		b >>= 1;
+	}
+	return p;
+}
+
+/*a^254 = 1 / a*/
+static uint8_t Gf_Inv(uint8_t a)
+{
+	uint8_t r = 1;
+	int i;
+
+	for (i = 0; i < 254; i++) r = Gf_Mul(r, a);
+	return r;
+}
+
+static uint8_t Cauchy(uint8_t j, uint8_t i)
+{
+	return Gf_Inv((FEC_MAX_GROUP + j) ^ i);
+}
+
+/*
+ * Rebuilds the data packets of the group marked in Lost (K packets, M parity blocks).
+ * The parity minus the packets received leaves one equation per parity block in the
+ * lost packets, solved by Gauss-Jordan elimination. Returns false if there are more
+ * losses than parity blocks.
+ */
+static bool Decode(uint8_t Data[][FEC_BLOCK_SIZE], const bool *Lost, uint8_t K,
+				   uint8_t Parity[][FEC_BLOCK_SIZE], uint8_t M)
+{
+	uint8_t a[FEC_MAX_PARITY][FEC_MAX_PARITY], s[FEC_MAX_PARITY][FEC_BLOCK_SIZE];
+	uint8_t lost[FEC_MAX_PARITY], n = 0, j, i, r, c, f;
+	int b;
+
+	for (i = 0; i < K; i++) {
+		if (!Lost[i]) continue;
+		if (n == M) return false;
+		lost[n++] = i;
+	}
+	for (j = 0; j < n; j++) {
+		memcpy(s[j], Parity[j], FEC_BLOCK_SIZE);
+		for (i = 0; i < K; i++) {
+			if (Lost[i]) continue;
+			f = Cauchy(j, i);
+			for (b = 0; b < FEC_BLOCK_SIZE; b++) s[j][b] ^= Gf_Mul(f, Data[i][b]);
+		}
+		for (c = 0; c < n; c++) a[j][c] = Cauchy(j, lost[c]);
+	}
+
+	/*Every square submatrix of a Cauchy matrix is invertible: no pivot search*/
+	for (c = 0; c < n; c++) {
+		f = Gf_Inv(a[c][c]);
+		for (i = 0; i < n; i++) a[c][i] = Gf_Mul(a[c][i], f);
+		for (b = 0; b < FEC_BLOCK_SIZE; b++) s[c][b] = Gf_Mul(s[c][b], f);
+		for (r = 0; r < n; r++) {
+			if (r == c || a[r][c] == 0) continue;
+			f = a[r][c];
+			for (i = 0; i < n; i++) a[r][i] ^= Gf_Mul(a[c][i], f);
+			for (b = 0; b < FEC_BLOCK_SIZE; b++) s[r][b] ^= Gf_Mul(s[c][b], f);
+		}
+	}
+	for (c = 0; c < n; c++) memcpy(Data[lost[c]], s[c], FEC_BLOCK_SIZE);
+	return true;
+}
+
+static void Test_Rebuild(void)
+{
+	static uint8_t data[FEC_MAX_GROUP][FEC_BLOCK_SIZE], sent[FEC_MAX_GROUP][FEC_BLOCK_SIZE];
+	static uint8_t parity[FEC_MAX_PARITY][FEC_BLOCK_SIZE];
+	static const uint8_t Groups[][2] = { { 40, 1 }, { 40, 4 }, { 40, 8 }, { 17, 4 }, { 128, 16 }, { 1, 2 } };
+	FecEncoder enc;
+	bool lost[FEC_MAX_GROUP];
+	uint32_t seed = 7, g, trial, i, j, rebuilt = 0;
+	uint8_t K, M, n;
+
+	for (g = 0; g < sizeof(Groups) / sizeof(Groups[0]); g++) {
+		K = Groups[g][0];
+		M = Groups[g][1];
+		for (trial = 0; trial < 20; trial++) {
+			Fec_Init(&enc, K, M);
+			for (i = 0; i < K; i++) {
+				for (j = 0; j < FEC_BLOCK_SIZE; j++) {
+					seed = seed * 1103515245 + 12345;
+					sent[i][j] = (trial % 4 == 0 && j % 3 == 0) ? 0 : seed >> 16;	/*Zeros too*/
+				}
+				CHECK(Fec_Add(&enc, sent[i]) == (i == K - 1u));
+			}
+			for (j = 0; j < M; j++) memcpy(parity[j], Fec_Parity(&enc, j), FEC_BLOCK_SIZE);
+
+			/*Up to M packets lost anywhere in the group*/
+			memcpy(data, sent, sizeof(data));
+			memset(lost, 0, sizeof(lost));
+			n = (trial % M) + 1;
+			if (n > K) n = K;
+			for (i = 0; i < n;) {
+				seed = seed * 1103515245 + 12345;
+				j = (seed >> 16) % K;
+				if (lost[j]) continue;
+				lost[j] = true;
+				memset(data[j], 0xA5, FEC_BLOCK_SIZE);
+				i++;
+			}
+			CHECK(Decode(data, lost, K, parity, M));
+			CHECK(memcmp(data, sent, K * FEC_BLOCK_SIZE) == 0);
+			rebuilt += n;
+
+			/*One loss more than the parity cannot be rebuilt*/
+			if (M < K) {
+				for (j = 0; j < K && n <= M; j++) {
+					if (!lost[j]) lost[j] = true, n++;
+				}
+				CHECK(!Decode(data, lost, K, parity, M));
+			}
+		}
+	}
+	BENCH("%u lost packets rebuilt from the parity in groups of 1 to 128 packets", rebuilt);
+
+	/*A short last group: the packets never sent count as zeros*/
+	Fec_Init(&enc, 40, 2);
+	for (i = 0; i < 5; i++) CHECK(!Fec_Add(&enc, sent[i]));
+	for (j = 0; j < 2; j++) memcpy(parity[j], Fec_Parity(&enc, j), FEC_BLOCK_SIZE);
+	memcpy(data, sent, sizeof(data));
+	memset(data[5], 0, (40 - 5) * FEC_BLOCK_SIZE);
+	memset(lost, 0, sizeof(lost));
+	lost[1] = lost[3] = true;
+	CHECK(Decode(data, lost, 40, parity, 2));
+	CHECK(memcmp(data, sent, 5 * FEC_BLOCK_SIZE) == 0);
+
+	/*M = 0 is the FEC off*/
+	Fec_Init(&enc, 40, 0);
+	CHECK(!Fec_Add(&enc, sent[0]));
+}
+
+static void Bench_Encode(void)
+{
+	static const uint8_t Parities[] = { 2, 4, 8, 16 };
+	static uint8_t data[ARQ_WINDOW_SIZE][FEC_BLOCK_SIZE];
+	FecEncoder enc;
+	uint64_t start, ns;
+	uint32_t p, g, i, sink = 0;
+
+	for (i = 0; i < sizeof(data); i++) data[i / FEC_BLOCK_SIZE][i % FEC_BLOCK_SIZE] = (uint8_t)(i * 13 + 1);
+	for (p = 0; p < sizeof(Parities); p++) {
+		Fec_Init(&enc, ARQ_WINDOW_SIZE, Parities[p]);
+		start = Host_Clock_Ns();
+		for (g = 0; g < ENCODE_GROUPS; g++) {
+			for (i = 0; i < ARQ_WINDOW_SIZE; i++) Fec_Add(&enc, data[i]);
+			sink += Fec_Parity(&enc, 0)[g % FEC_BLOCK_SIZE];
+			Fec_Restart(&enc);
+		}
+		ns = Host_Clock_Ns() - start;
+		BENCH("Fec_Add with %2u parity packets: %6.1f ns per data packet, %6.1f MB/s of data (host)",
+			  Parities[p], (double)ns / (ENCODE_GROUPS * ARQ_WINDOW_SIZE),
+			  (double)ENCODE_GROUPS * ARQ_WINDOW_SIZE * FEC_BLOCK_SIZE * 1e3 / ns);
+	}
+	CHECK(sink != 0xFFFFFFFF);
+}
+
+/*
+ * Bursts of 3 and 8 packets on average, losses of 1% between them. Each SACK costs
+ * the radio turnaround, or the seconds of a ground station that relays it. The
+ * retransmissions go with the new packets of the next round, so the parity only
+ * pays for itself when the rounds are that long.
+ */
+static void Bench_Bursts(void)
+{
+	static const uint8_t Parities[] = { 0, 2, 4, 8 };
+	static const uint32_t BadToGood[] = { 333333, 125000 };
+	static const uint32_t Turnarounds[] = { LINKSIM_TURNAROUND_MS, 2000, 5000 };
+	LoraToaParams params;
+	LinkSimChannel channel;
+	LinkSimResult result;
+	uint64_t timeUs[sizeof(Parities)];
+	uint32_t t, b, p, seed, rebuilt, retransmitted, parity, sacks;
+
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HAL_FLASH_Unlock();
+	CHECK(Flash_Program_Data(PHOTO_ADDR, Image, IMAGE_BYTES) == HAL_OK);
+	HAL_FLASH_Lock();
+	LinkSim_Params(&params, 9);
+
+	for (t = 0; t < sizeof(Turnarounds) / sizeof(Turnarounds[0]); t++) {
+		for (b = 0; b < sizeof(BadToGood) / sizeof(BadToGood[0]); b++) {
+			for (p = 0; p < sizeof(Parities); p++) {
+				timeUs[p] = 0;
+				rebuilt = retransmitted = parity = sacks = 0;
+				for (seed = 1; seed <= SEEDS; seed++) {
+					/*Entering a burst every 50 packets*/
+					LinkSim_Gilbert(&channel, 10000, 800000, 20000, BadToGood[b], seed);
+					channel.TurnaroundMs = Turnarounds[t];
+					result = LinkSim_Run(PHOTO_ADDR, IMAGE_BYTES, Parities[p], &params, &channel);
+					CHECK(result.Done && result.Corrupted == 0);
+					timeUs[p] += result.TimeUs;
+					rebuilt += result.Rebuilt;
+					retransmitted += result.Retransmitted;
+					parity += result.Parity;
+					sacks += result.Sacks + result.Timeouts;
+				}
+				BENCH("SF9, turnaround %4u ms, bursts of %u packets, %u parity per %d: %5.1f s per image, "
+					  "%3u parity sent, %2u rebuilt, %3u retransmissions, %2u SACK rounds",
+					  Turnarounds[t], 1000000 / BadToGood[b], Parities[p], ARQ_WINDOW_SIZE,
+					  timeUs[p] / 1e6 / SEEDS, parity / SEEDS, rebuilt / SEEDS, retransmitted / SEEDS, sacks / SEEDS);
+				if (Parities[p] == 0) CHECK(rebuilt == 0 && parity == 0);
+				else CHECK(rebuilt > 0);
+			}
+			/*The parity that covers a burst saves the rounds of the retransmissions*/
+			if (Turnarounds[t] >= 5000 && BadToGood[b] > 200000) CHECK(timeUs[2] < timeUs[0] * 0.95);
+		}
+	}
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < IMAGE_BYTES; i++) Image[i] = (uint8_t)(i * 7 + (i >> 9));
+	Test_Rebuild();
+	Bench_Encode();
+	Bench_Bursts();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,169 @@
+/*!
+ * \file      test_flash_cache.c
+ *
+ * \brief     RAM copy of the address map (flash_cache.c) on the simulated flash:
+ * 			  10000 iterations of the main loop (the reads of system_state(),
+ * 			  the state flag every iteration and the telemetry every sensor
+ * 			  epoch) through Read_Flash/Write_Flash, against the same loop
+ * 			  going to the flash every time, and the reduction in flash
+ * 			  operations between the two.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+#include "flash_cache.h"
+#include "flash_log.h"
+
+#define ITERATIONS		10000
+#define LOOP_US			100000		/*One main loop iteration*/
+#define SENSOR_EPOCH	10			/*Iterations between sensor readings*/
+#define STATE_PERIOD	500			/*Iterations between state changes*/
+
+typedef struct {
+	uint32_t reads;					/*Reads of the memory-mapped flash*/
+	uint32_t programs;
+	uint32_t erases;
+	uint64_t flash_ns;				/*Simulated time spent programming and erasing*/
+} LoopCost;
+
+static uint32_t Reads;
+
+/*Read_Flash_Direct reads the flash once, or three times where there is redundancy*/
+static void Loop_Read(bool cached, uint32_t Address, uint8_t *RxBuf, uint16_t numberofbytes)
+{
+	if (cached) {
+		Read_Flash(Address, RxBuf, numberofbytes);
+	}
+	else {
+		Read_Flash_Direct(Address, RxBuf, numberofbytes);
+		Reads += Flash_Log_Owns(Address, numberofbytes) ? 1 : 3;
+	}
+}
+
+static void Loop_Write(bool cached, uint32_t Address, uint8_t *Data, uint16_t numberofbytes)
+{
+	if (cached) Write_Flash(Address, Data, numberofbytes);
+	else Write_Flash_Direct(Address, Data, numberofbytes);
+}
+
+static LoopCost Run_Loop(bool cached)
+{
+	const HalSimFlashStats *flash = HalSim_Flash_Get_Stats();
+	uint8_t state = 0, value, temp[8];
+	uint32_t i;
+	int t;
+	LoopCost cost;
+
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HalSim_Flash_Clear_Stats();
+	Reads = 0;
+
+	for (i = 0; i < ITERATIONS; i++)
+	{
+		/*system_state()*/
+		Loop_Read(cached, NOMINAL_ADDR, &value, 1);
+		Loop_Read(cached, LOW_ADDR, &value, 1);
+		Loop_Read(cached, CRITICAL_ADDR, &value, 1);
+		Loop_Read(cached, BATT_LEVEL_ADDR, &value, 1);
+		Loop_Read(cached, PAYLOAD_STATE_ADDR, &value, 1);
+		Loop_Read(cached, KP_ADDR, &value, 1);
+
+		if (i % STATE_PERIOD == 0) {
+			if (cached) Flash_Cache_Flush();
+			state = (uint8_t)((state + 1) % 6);
+		}
+		Loop_Write(cached, PREVIOUS_STATE_ADDR, &state, 1);
+
+		if (i % SENSOR_EPOCH == 0) {
+			for (t = 0; t < 8; t++) temp[t] = (uint8_t)(20 + (i / SENSOR_EPOCH + t) % 4);
+			Loop_Write(cached, TEMP_ADDR, temp, 8);
+			value = (uint8_t)(200 + (i / SENSOR_EPOCH) % 3);
+			Loop_Write(cached, VOLTAGE_ADDR, &value, 1);
+			value = (uint8_t)(90 - i / 1000);
+			Loop_Write(cached, BATT_LEVEL_ADDR, &value, 1);
+		}
+
+		if (cached) Flash_Cache_Poll();
+		HalSim_Advance_Us(LOOP_US);
+	}
+	if (cached) Flash_Cache_Flush();	/*Before the reset*/
+
+	/*Whatever the path, the flash ends with the same values*/
+	Read_Flash_Direct(PREVIOUS_STATE_ADDR, &value, 1);
+	CHECK(value == state);
+	Read_Flash_Direct(TEMP_ADDR, &value, 1);
+	CHECK(value == temp[0]);
+
+	cost.reads = Reads;
+	cost.programs = flash->programs;
+	cost.erases = flash->erases;
+	cost.flash_ns = flash->busy_ns;
+	return cost;
+}
+
+static void Test_Cache(void)
+{
+	uint8_t value = 7, read = 0;
+
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HalSim_Flash_Clear_Stats();
+
+	/*Reads and writes stay in RAM until the write-back*/
+	Write_Flash(NOMINAL_ADDR, &value, 1);
+	Read_Flash(NOMINAL_ADDR, &read, 1);
+	CHECK(read == 7);
+	CHECK(HalSim_Flash_Get_Stats()->programs == 0);
+	Flash_Log_Read(NOMINAL_ADDR, &read, 1);
+	CHECK(read != 7);
+
+	/*Periodic write-back*/
+	Flash_Cache_Poll();
+	CHECK(HalSim_Flash_Get_Stats()->programs == 0);
+	HalSim_Advance_Us(FLASH_CACHE_FLUSH_PERIOD * 1000);
+	Flash_Cache_Poll();
+	Flash_Log_Read(NOMINAL_ADDR, &read, 1);
+	CHECK(read == 7);
+
+	/*The same value again does not dirty the region*/
+	HalSim_Flash_Clear_Stats();
+	Write_Flash(NOMINAL_ADDR, &value, 1);
+	Flash_Cache_Flush();
+	CHECK(HalSim_Flash_Get_Stats()->programs == 0);
+
+	/*Outside the cached map it goes to the flash*/
+	CHECK(!Flash_Cache_Owns(BATT_LEVEL_ADDR + 6, 1));
+	CHECK(!Flash_Cache_Owns(BATT_LEVEL_ADDR + 5, 2));
+	CHECK(Flash_Cache_Owns(PAYLOAD_STATE_ADDR, FLASH_CACHE_SIZE));
+}
+
+static void Bench_Loop(void)
+{
+	LoopCost direct = Run_Loop(false);
+	LoopCost cached = Run_Loop(true);
+	double directOps = (double)direct.reads + direct.programs + direct.erases;
+	double cachedOps = (double)cached.reads + cached.programs + cached.erases;
+
+	BENCH("%d iterations without cache: %u reads, %u programs, %u erases, %.1f ms programming",
+		  ITERATIONS, direct.reads, direct.programs, direct.erases, direct.flash_ns / 1e6);
+	BENCH("%d iterations with cache: %u reads, %u programs, %u erases, %.1f ms programming",
+		  ITERATIONS, cached.reads, cached.programs, cached.erases, cached.flash_ns / 1e6);
+	BENCH("flash operations reduced %.0fx (programs %.1fx)",
+		  directOps / (cachedOps > 0 ? cachedOps : 1), (double)direct.programs / cached.programs);
+	CHECK(cachedOps * 100 < directOps);
+	CHECK(cached.programs * 5 < direct.programs);
+}
+
+int main(void)
+{
+	Test_Cache();
+	Bench_Loop();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,169 @@
+/*!
+ * \file      test_flash_log.c
+ *
+ * \brief     Flash log (flash_log.c) on the simulated flash: values survive a
+ * 			  reset and the garbage collections, ranges that are not in the
+ * 			  log are left alone, a failed format or collection loses nothing,
+ * 			  and the cost of one state-machine cycle (the state flag and the
+ * 			  telemetry of the main loop) against the erase + program of
+ * 			  Flash_Write_Data.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+#include "flash_log.h"
+
+#define CYCLES_LOG		20000
+#define CYCLES_ERASE	50
+
+/*What the main loop writes every iteration: state, temperatures, voltage, current, battery*/
+static void Cycle_Values(uint32_t cycle, uint8_t *state, uint8_t *temp, uint8_t *volt, uint8_t *curr, uint8_t *batt)
+{
+	int i;
+
+	*state = (uint8_t)(cycle & 3);
+	for (i = 0; i < 8; i++) temp[i] = (uint8_t)(20 + ((cycle + i) % 5));
+	*volt = (uint8_t)(200 + cycle % 7);
+	*curr = (uint8_t)(cycle % 11);
+	*batt = (uint8_t)(90 - (cycle / 100) % 50);
+}
+
+static void Test_Values(void)
+{
+	const FlashLogStats *stats = Flash_Log_Get_Stats();
+	uint8_t state, temp[8], volt, curr, batt;
+	uint8_t read[8];
+	uint32_t i, collections;
+
+	HalSim_Reset();
+	Flash_Log_Init();
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_A_ADDR == FLASH_LOG_SECTOR_VALID);
+
+	/*Enough cycles for several garbage collections*/
+	collections = stats->collections;
+	for (i = 0; i < CYCLES_LOG; i++)
+	{
+		Cycle_Values(i, &state, temp, &volt, &curr, &batt);
+		CHECK(Flash_Log_Write(PREVIOUS_STATE_ADDR, &state, 1) == 0);
+		CHECK(Flash_Log_Write(TEMP_ADDR, temp, 8) == 0);
+		CHECK(Flash_Log_Write(VOLTAGE_ADDR, &volt, 1) == 0);
+		CHECK(Flash_Log_Write(CURRENT_ADDR, &curr, 1) == 0);
+		CHECK(Flash_Log_Write(BATT_LEVEL_ADDR, &batt, 1) == 0);
+	}
+	CHECK(stats->collections - collections >= 2);
+
+	/*Reset: the index is rebuilt from the active sector*/
+	Flash_Log_Init();
+	Flash_Log_Read(PREVIOUS_STATE_ADDR, read, 1);
+	CHECK(read[0] == state);
+	Flash_Log_Read(TEMP_ADDR, read, 8);
+	CHECK(memcmp(read, temp, 8) == 0);
+	Flash_Log_Read(BATT_LEVEL_ADDR, read, 1);
+	CHECK(read[0] == batt);
+
+	/*Outside the log: refused on write, untouched on read*/
+	CHECK(!Flash_Log_Owns(TLE_ADDR, 1));
+	CHECK(!Flash_Log_Owns(EXIT_LOW_ADDR, 4));
+	CHECK(Flash_Log_Write(TLE_ADDR, &state, 1) == HAL_FLASH_ERROR_OPERATION);
+	memset(read, 0xA5, sizeof(read));
+	Flash_Log_Read(SF_ADDR, read, 2);
+	CHECK(read[0] == 0xA5 && read[1] == 0xA5);
+}
+
+static void Test_Failures(void)
+{
+	const FlashLogStats *stats = Flash_Log_Get_Stats();
+	uint8_t state = 0, read;
+	uint32_t collections, status = 0;
+	int i;
+
+	/*A format that fails leaves the log unusable until one succeeds*/
+	HalSim_Reset();
+	HalSim_Flash_Fail(3);
+	Flash_Log_Init();
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_A_ADDR != FLASH_LOG_SECTOR_VALID);
+	CHECK(Flash_Log_Write(PREVIOUS_STATE_ADDR, &state, 1) == 0);
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_A_ADDR == FLASH_LOG_SECTOR_VALID);
+
+	/*A collection that fails half way: an append is 3 programs, a collection many more*/
+	collections = stats->collections;
+	for (i = 0; i < 100000 && status == 0; i++)
+	{
+		state = (uint8_t)(i + 1);
+		HalSim_Flash_Fail(6);
+		status = Flash_Log_Write(PREVIOUS_STATE_ADDR, &state, 1);
+		HalSim_Flash_Fail(0);
+	}
+	CHECK(status != 0);
+	CHECK(stats->collections == collections);
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_A_ADDR == FLASH_LOG_SECTOR_VALID);
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_B_ADDR == FLASH_LOG_SECTOR_RECEIVING);
+	Flash_Log_Read(PREVIOUS_STATE_ADDR, &read, 1);
+	CHECK(read == (uint8_t)(state - 1));		/*The old sector still serves the last value*/
+
+	/*The next write collects again and the value survives a reset*/
+	CHECK(Flash_Log_Write(PREVIOUS_STATE_ADDR, &state, 1) == 0);
+	CHECK(stats->collections == collections + 1);
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_B_ADDR == FLASH_LOG_SECTOR_VALID);
+	Flash_Log_Init();
+	Flash_Log_Read(PREVIOUS_STATE_ADDR, &read, 1);
+	CHECK(read == state);
+	CHECK(*(uint32_t *)FLASH_LOG_SECTOR_A_ADDR == FLASH_LOG_SECTOR_ERASED);
+}
+
+static void Bench_Cycle(void)
+{
+	const HalSimFlashStats *flash = HalSim_Flash_Get_Stats();
+	uint8_t state, temp[8], volt, curr, batt;
+	uint64_t start;
+	double logNs, logErases, eraseNs, eraseErases;
+	uint32_t i;
+
+	HalSim_Reset();
+	Flash_Log_Init();
+	HalSim_Flash_Clear_Stats();
+	start = HalSim_Now_Ns();
+	for (i = 0; i < CYCLES_LOG; i++)
+	{
+		Cycle_Values(i, &state, temp, &volt, &curr, &batt);
+		Flash_Log_Write(PREVIOUS_STATE_ADDR, &state, 1);
+		Flash_Log_Write(TEMP_ADDR, temp, 8);
+		Flash_Log_Write(VOLTAGE_ADDR, &volt, 1);
+		Flash_Log_Write(CURRENT_ADDR, &curr, 1);
+		Flash_Log_Write(BATT_LEVEL_ADDR, &batt, 1);
+	}
+	logNs = (double)(HalSim_Now_Ns() - start) / CYCLES_LOG;
+	logErases = (double)flash->erases / CYCLES_LOG;
+
+	HalSim_Reset();
+	start = HalSim_Now_Ns();
+	for (i = 0; i < CYCLES_ERASE; i++)
+	{
+		Cycle_Values(i, &state, temp, &volt, &curr, &batt);
+		Flash_Write_Data(PREVIOUS_STATE_ADDR, &state, 1);
+		Flash_Write_Data(TEMP_ADDR, temp, 8);
+		Flash_Write_Data(VOLTAGE_ADDR, &volt, 1);
+		Flash_Write_Data(CURRENT_ADDR, &curr, 1);
+		Flash_Write_Data(BATT_LEVEL_ADDR, &batt, 1);
+	}
+	eraseNs = (double)(HalSim_Now_Ns() - start) / CYCLES_ERASE;
+	eraseErases = (double)flash->erases / CYCLES_ERASE;
+
+	BENCH("flash_log per cycle: %.4f erases, %.1f us", logErases, logNs / 1000);
+	BENCH("Flash_Write_Data per cycle: %.1f erases, %.1f us", eraseErases, eraseNs / 1000);
+	BENCH("cycles per erase of a log sector: %.0f", 1 / logErases);
+	CHECK(logErases * 100 < eraseErases);
+	CHECK(logNs * 100 < eraseNs);
+}
+
+int main(void)
+{
+	Test_Values();
+	Test_Failures();
+	Bench_Cycle();
+	return HOST_TEST_END();
+}
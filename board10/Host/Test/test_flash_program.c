@@ -0,0 +1,102 @@
+/*!
+ * \file      test_flash_program.c
+ *
+ * \brief     Bulk programming of Flash_Program_Data on the simulated flash:
+ * 			  content and operation count for aligned and unaligned ranges, and
+ * 			  the operations and time of a photo and a TLE against programming
+ * 			  them byte by byte.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+
+#define PHOTO_BYTES		20000
+#define TLE_BYTES		138
+
+static uint8_t Data[PHOTO_BYTES];
+
+/*What Flash_Write_Data did before: one FLASH_TYPEPROGRAM_BYTE per byte*/
+static HAL_StatusTypeDef Program_Bytes(uint32_t Address, uint8_t *Data, uint32_t numberofbytes)
+{
+	uint32_t i;
+
+	for (i = 0; i < numberofbytes; i++) {
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, Address + i, Data[i]) != HAL_OK) return HAL_ERROR;
+	}
+	return HAL_OK;
+}
+
+/*Programs a range on erased flash and returns the operations, checking the content*/
+static uint32_t Program(bool bulk, uint32_t Address, uint32_t numberofbytes, uint64_t *ns)
+{
+	const HalSimFlashStats *flash = HalSim_Flash_Get_Stats();
+	uint64_t start;
+
+	HalSim_Reset();
+	HAL_FLASH_Unlock();
+	start = HalSim_Now_Ns();
+	if (bulk) CHECK(Flash_Program_Data(Address, Data, numberofbytes) == HAL_OK);
+	else CHECK(Program_Bytes(Address, Data, numberofbytes) == HAL_OK);
+	*ns = HalSim_Now_Ns() - start;
+	HAL_FLASH_Lock();
+
+	CHECK(memcmp((uint8_t *)Address, Data, numberofbytes) == 0);
+	CHECK(*(uint8_t *)(Address - 1) == 0xFF && *(uint8_t *)(Address + numberofbytes) == 0xFF);
+	CHECK(flash->conflicts == 0 && flash->errors == 0);
+	return flash->programs;
+}
+
+static void Test_Alignment(void)
+{
+	uint64_t ns;
+
+	/*x32: bytes up to the alignment, then words, then the bytes left*/
+	CHECK(Program(true, PHOTO_ADDR, 16, &ns) == 4);
+	CHECK(Program(true, PHOTO_ADDR + 1, 16, &ns) == 3 + 3 + 1);
+	CHECK(Program(true, PHOTO_ADDR + 3, 2, &ns) == 2);
+	CHECK(Program(true, PHOTO_ADDR + 2, 1, &ns) == 1);
+	CHECK(Program(true, PHOTO_ADDR + 1, 7, &ns) == 3 + 1);
+
+	/*Locked flash: the error is returned*/
+	HalSim_Reset();
+	CHECK(Flash_Program_Data(PHOTO_ADDR, Data, 16) == HAL_ERROR);
+}
+
+static void Bench_Sizes(void)
+{
+	uint32_t bytes, bulk;
+	uint64_t bytesNs, bulkNs;
+
+	bytes = Program(false, PHOTO_ADDR, PHOTO_BYTES, &bytesNs);
+	bulk = Program(true, PHOTO_ADDR, PHOTO_BYTES, &bulkNs);
+	BENCH("photo %d B: %u ops %.1f ms byte by byte, %u ops %.1f ms bulk", PHOTO_BYTES,
+		  bytes, bytesNs / 1e6, bulk, bulkNs / 1e6);
+	CHECK(bulk == PHOTO_BYTES / 4);
+
+	bytes = Program(false, TLE_ADDR, TLE_BYTES, &bytesNs);
+	bulk = Program(true, TLE_ADDR, TLE_BYTES, &bulkNs);
+	BENCH("TLE %d B: %u ops %.2f ms byte by byte, %u ops %.2f ms bulk", TLE_BYTES,
+		  bytes, bytesNs / 1e6, bulk, bulkNs / 1e6);
+	CHECK(bulk == TLE_BYTES / 4 + TLE_BYTES % 4);
+
+	/*The calibration starts at an odd address*/
+	bytes = Program(false, MAGNETO_MATRIX_ADDR, 36, &bytesNs);
+	bulk = Program(true, MAGNETO_MATRIX_ADDR, 36, &bulkNs);
+	BENCH("magnetometer matrix 36 B at +0x%X: %u ops byte by byte, %u ops bulk",
+		  MAGNETO_MATRIX_ADDR & 3, bytes, bulk);
+	CHECK(bulk == 1 + 8 + 3);
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < PHOTO_BYTES; i++) Data[i] = (uint8_t)(i * 7 + (i >> 8));
+	Test_Alignment();
+	Bench_Sizes();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,164 @@
+/*!
+ * \file      test_flash_scrub.c
+ *
+ * \brief     Fault injection on the triple redundancy area (flash_scrub.c): random
+ * 			  bit flips in the three copies, the main loop calling
+ * 			  Flash_Scrub_Step, and the iterations and simulated time until the
+ * 			  three copies are identical again, with the cost of every step.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+#include "flash_scrub.h"
+
+#define LOOP_US			100000		/*One main loop iteration*/
+#define MAX_ITERATIONS	1000
+#define TRIALS			20
+
+static uint8_t Reference[FLASH_SCRUB_SIZE];
+static uint32_t Seed = 12345;
+
+static uint32_t Random(uint32_t range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return (Seed >> 8) % range;
+}
+
+static void Store_Copies(void)
+{
+	uint32_t copy;
+
+	HalSim_Reset();
+	HAL_FLASH_Unlock();
+	for (copy = 0; copy < 3; copy++) {
+		CHECK(Flash_Program_Data(FLASH_SCRUB_START + copy * REDUNDANCY_OFFSET, Reference, FLASH_SCRUB_SIZE) == HAL_OK);
+	}
+	HAL_FLASH_Lock();
+}
+
+static bool Copies_Repaired(void)
+{
+	uint32_t copy;
+
+	for (copy = 0; copy < 3; copy++) {
+		if (memcmp((uint8_t *)(FLASH_SCRUB_START + copy * REDUNDANCY_OFFSET), Reference, FLASH_SCRUB_SIZE) != 0)
+			return false;
+	}
+	return true;
+}
+
+/*Flips that never hit the same bit in two copies, so the majority is always right*/
+static void Inject(uint32_t upsets)
+{
+	static uint8_t hit[FLASH_SCRUB_SIZE];
+	uint32_t offset, copy;
+	uint8_t bit;
+
+	memset(hit, 0, sizeof(hit));
+	while (upsets > 0) {
+		offset = Random(FLASH_SCRUB_SIZE);
+		bit = (uint8_t)Random(8);
+		copy = Random(3);
+		if (hit[offset] & (1u << bit)) continue;
+		hit[offset] |= 1u << bit;
+		HalSim_Flash_Flip(FLASH_SCRUB_START + copy * REDUNDANCY_OFFSET + offset, bit);
+		upsets--;
+	}
+}
+
+/*Main loop iterations until the copies are repaired, 0 if they are not*/
+static uint32_t Scrub(uint64_t *ns, uint64_t *worstStepNs)
+{
+	uint64_t start = HalSim_Now_Ns(), step;
+	uint32_t i;
+
+	*worstStepNs = 0;
+	for (i = 1; i <= MAX_ITERATIONS; i++) {
+		step = HalSim_Now_Ns();
+		Flash_Scrub_Step();
+		step = HalSim_Now_Ns() - step;
+		if (step > *worstStepNs) *worstStepNs = step;
+		HalSim_Advance_Us(LOOP_US);
+		if (Copies_Repaired()) {
+			*ns = HalSim_Now_Ns() - start;
+			return i;
+		}
+	}
+	return 0;
+}
+
+static void Test_Convergence(void)
+{
+	static const uint32_t Upsets[] = { 1, 4, 16, 64 };
+	const FlashScrubStats *stats = Flash_Scrub_Get_Stats();
+	uint32_t u, t, iterations, worstIterations;
+	uint64_t ns = 0, totalNs, stepNs, worstStepNs;
+	FlashScrubStats before;
+
+	for (u = 0; u < sizeof(Upsets) / sizeof(Upsets[0]); u++) {
+		totalNs = 0;
+		worstIterations = 0;
+		worstStepNs = 0;
+		before = *stats;
+		for (t = 0; t < TRIALS; t++) {
+			Store_Copies();
+			Inject(Upsets[u]);
+			iterations = Scrub(&ns, &stepNs);
+			CHECK(iterations != 0);
+			totalNs += ns;
+			if (iterations > worstIterations) worstIterations = iterations;
+			if (stepNs > worstStepNs) worstStepNs = stepNs;
+		}
+		/*Two flips in the same word of different copies count as uncorrectable words*/
+		if (Upsets[u] == 1) CHECK(stats->uncorrectable == before.uncorrectable);
+		CHECK(stats->corrected - before.corrected >= TRIALS);
+		BENCH("%2u upsets: converged in %.1f s on average, %u iterations at worst, longest step %.0f ms, "
+			  "%u in-place and %u erase repairs",
+			  Upsets[u], totalNs / 1e9 / TRIALS, worstIterations, worstStepNs / 1e6,
+			  stats->repairs_inplace - before.repairs_inplace, stats->repairs_erase - before.repairs_erase);
+	}
+}
+
+static void Test_Uncorrectable(void)
+{
+	const FlashScrubStats *stats = Flash_Scrub_Get_Stats();
+	uint32_t before = stats->uncorrectable, i;
+
+	/*Three different values of the same word*/
+	Store_Copies();
+	HalSim_Flash_Flip(FLASH_SCRUB_START + 8, 0);
+	HalSim_Flash_Flip(FLASH_SCRUB_START + REDUNDANCY_OFFSET + 8, 1);
+	for (i = 0; i < 2 * FLASH_SCRUB_SIZE / 4 / FLASH_SCRUB_WORDS_PER_STEP + 4; i++) Flash_Scrub_Step();
+	CHECK(stats->uncorrectable > before);
+
+	/*Every bit still has a majority, so the repair restores the word*/
+	CHECK(Copies_Repaired());
+}
+
+static void Bench_Step(void)
+{
+	uint64_t start;
+	uint32_t i, passes = Flash_Scrub_Get_Stats()->passes;
+
+	Store_Copies();
+	start = Host_Clock_Ns();
+	for (i = 0; i < 100000; i++) Flash_Scrub_Step();
+	BENCH("clean step (%d words voted): %.0f ns host, %u passes",
+		  FLASH_SCRUB_WORDS_PER_STEP, (double)(Host_Clock_Ns() - start) / 100000,
+		  Flash_Scrub_Get_Stats()->passes - passes);
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(Reference); i++) Reference[i] = (uint8_t)(i * 13 + 5);
+	Test_Convergence();
+	Test_Uncorrectable();
+	Bench_Step();
+	return HOST_TEST_END();
+}
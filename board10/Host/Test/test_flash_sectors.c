@@ -0,0 +1,94 @@
+/*!
+ * \file      test_flash_sectors.c
+ *
+ * \brief     Sector table of flash.c: every sector boundary address (the first
+ * 			  and last byte of each sector and the bytes around them), the
+ * 			  addresses outside the flash and the erase plans over several
+ * 			  sectors. Built once per FLASH_SECTOR_TOTAL (8, 12, 16 and 24) so
+ * 			  the rows of the larger F4 parts are checked too.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+
+/*Layout of the reference manuals, computed instead of listed*/
+static uint32_t Sector_Size(uint32_t index)
+{
+	uint32_t inBank = (FLASH_SECTOR_TOTAL == 24U) ? index % 12 : index;
+
+	if (inBank < 4) return 0x4000;
+	if (inBank == 4) return 0x10000;
+	return 0x20000;
+}
+
+static uint32_t Sector_Start(uint32_t index)
+{
+	uint32_t start = FLASH_BASE, i;
+
+	for (i = 0; i < index; i++) start += Sector_Size(i);
+	return start;
+}
+
+static void Test_Boundaries(void)
+{
+	const FlashSector *sector;
+	uint32_t i, start, size, end;
+
+	for (i = 0; i < FLASH_SECTOR_TOTAL; i++) {
+		start = Sector_Start(i);
+		size = Sector_Size(i);
+
+		sector = Flash_Get_Sector(start);
+		CHECK(sector != NULL && sector->index == i && sector->start == start && sector->size == size);
+		CHECK(Flash_Get_Sector(start + 1) == sector);
+		CHECK(Flash_Get_Sector(start + size / 2) == sector);
+		CHECK(Flash_Get_Sector(start + size - 1) == sector);
+		if (i > 0) {
+			sector = Flash_Get_Sector(start - 1);
+			CHECK(sector != NULL && sector->index == i - 1);
+		}
+	}
+
+	end = Sector_Start(FLASH_SECTOR_TOTAL);
+	CHECK(Flash_Get_Sector(FLASH_BASE - 1) == NULL);
+	CHECK(Flash_Get_Sector(0) == NULL);
+	CHECK(Flash_Get_Sector(end) == NULL);
+	CHECK(Flash_Get_Sector(0xFFFFFFFF) == NULL);
+	CHECK(Flash_Get_Sector(end - 1) != NULL);
+	BENCH("%u sectors, %u KB", FLASH_SECTOR_TOTAL, (uint32_t)((end - FLASH_BASE) / 1024));
+}
+
+static void Test_Plans(void)
+{
+	uint32_t first, count, i, end = Sector_Start(FLASH_SECTOR_TOTAL);
+
+	/*One byte and one whole sector*/
+	CHECK(Flash_Plan_Erase(PREVIOUS_STATE_ADDR, 1, &first, &count) && first == 2 && count == 1);
+	CHECK(Flash_Plan_Erase(Sector_Start(4), Sector_Size(4), &first, &count) && first == 4 && count == 1);
+
+	/*Ranges that end on the first byte of the next sector*/
+	for (i = 0; i + 1 < FLASH_SECTOR_TOTAL; i++) {
+		CHECK(Flash_Plan_Erase(Sector_Start(i), Sector_Size(i) + 1, &first, &count) && first == i && count == 2);
+		CHECK(Flash_Plan_Erase(Sector_Start(i + 1) - 1, 2, &first, &count) && first == i && count == 2);
+	}
+
+	/*A 20KB photo at PHOTO_ADDR, and the whole flash*/
+	CHECK(Flash_Plan_Erase(PHOTO_ADDR, 20000, &first, &count) && first == 5 && count == 1);
+	CHECK(Flash_Plan_Erase(FLASH_BASE, end - FLASH_BASE, &first, &count) && first == 0 && count == FLASH_SECTOR_TOTAL);
+
+	/*Empty or outside the flash*/
+	CHECK(!Flash_Plan_Erase(PHOTO_ADDR, 0, &first, &count));
+	CHECK(!Flash_Plan_Erase(end - 1, 2, &first, &count));
+	CHECK(!Flash_Plan_Erase(FLASH_BASE - 1, 2, &first, &count));
+}
+
+int main(void)
+{
+	Test_Boundaries();
+	Test_Plans();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,124 @@
+/*!
+ * \file      test_fuel_gauge.c
+ *
+ * \brief     Fuel gauge block read (fuel_gauge.c) on a simulated DS2782 register
+ * 			  map: random register contents decoded from one block read the same
+ * 			  as from the four register reads of the previous checkbatteries,
+ * 			  acquireVoltage, acquireCurrents and acquireTemp, and the bytes and
+ * 			  the bus time of both per housekeeping epoch.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "fuel_gauge.h"
+
+#define FUEL_GAUGE_ADDR		(0x34 << 1)
+#define MAPS				1000
+#define TIMEOUT				1000		/*ms, as the previous code*/
+
+static I2C_HandleTypeDef Hi2c;
+static uint8_t Registers[256];
+static uint32_t Seed = 11;
+
+static uint8_t Random(void)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return (uint8_t)(Seed >> 16);
+}
+
+/*The register read of the previous code: the register pointer, then the data*/
+static HAL_StatusTypeDef Old_Read(uint8_t reg, uint8_t *data, uint16_t length)
+{
+	HAL_StatusTypeDef ret = HAL_I2C_Master_Transmit(&Hi2c, FUEL_GAUGE_ADDR, &reg, 1, TIMEOUT);
+
+	if (ret != HAL_OK) return ret;
+	return HAL_I2C_Master_Receive(&Hi2c, FUEL_GAUGE_ADDR, data, length, TIMEOUT);
+}
+
+/*The four round trips, decoded register by register*/
+static void Old_Epoch(FuelGaugeRegisters *registers)
+{
+	uint8_t buf[2];
+
+	Old_Read(FUEL_GAUGE_REG_LEVEL, buf, 1);
+	registers->level = buf[0];
+	Old_Read(FUEL_GAUGE_REG_VOLTAGE, buf, 2);
+	registers->voltage = (int16_t)((buf[0] << 8) | buf[1]) >> 5;
+	Old_Read(FUEL_GAUGE_REG_CURRENT, buf, 2);
+	registers->current = (int16_t)((buf[0] << 8) | buf[1]);
+	Old_Read(FUEL_GAUGE_REG_TEMPERATURE, buf, 2);
+	registers->temperature = (int16_t)((buf[0] << 8) | buf[1]) >> 5;
+}
+
+static void Block_Epoch(FuelGaugeRegisters *registers)
+{
+	uint8_t block[FUEL_GAUGE_BLOCK_SIZE];
+
+	CHECK(HAL_I2C_Mem_Read(&Hi2c, FUEL_GAUGE_ADDR, FUEL_GAUGE_BLOCK_START, I2C_MEMADD_SIZE_8BIT,
+						   block, sizeof(block), TIMEOUT) == HAL_OK);
+	FuelGauge_Decode(block, registers);
+}
+
+static void Test_Decode(void)
+{
+	FuelGaugeRegisters old, block;
+	uint32_t i, reg, wrong = 0;
+
+	for (i = 0; i < MAPS; i++) {
+		for (reg = 0; reg < sizeof(Registers); reg++) Registers[reg] = Random();
+		Old_Epoch(&old);
+		Block_Epoch(&block);
+		wrong += old.level != block.level || old.current != block.current ||
+				 old.temperature != block.temperature || old.voltage != block.voltage;
+	}
+	CHECK(wrong == 0);
+
+	/*Signs and alignment: -2 A of 1.5625 uV, -10 degC, 3.7 V*/
+	Registers[FUEL_GAUGE_REG_CURRENT] = 0xFF;
+	Registers[FUEL_GAUGE_REG_CURRENT + 1] = 0x38;
+	Registers[FUEL_GAUGE_REG_TEMPERATURE] = 0xF6;
+	Registers[FUEL_GAUGE_REG_TEMPERATURE + 1] = 0x00;
+	Registers[FUEL_GAUGE_REG_VOLTAGE] = 0x5E;
+	Registers[FUEL_GAUGE_REG_VOLTAGE + 1] = 0xC0;
+	Block_Epoch(&block);
+	CHECK(block.current == -200 && block.temperature == -80 && block.voltage == 758);
+}
+
+static void Bench_Bus(void)
+{
+	const HalSimI2cStats *stats = HalSim_I2c_Get_Stats();
+	FuelGaugeRegisters registers;
+	uint32_t bytes, transfers, oldBytes, oldTransfers, blockBytes, blockTransfers;
+	uint64_t busy, oldNs, blockNs;
+
+	bytes = stats->bytes, transfers = stats->transfers, busy = stats->busy_ns;
+	Old_Epoch(&registers);
+	oldBytes = stats->bytes - bytes, oldTransfers = stats->transfers - transfers, oldNs = stats->busy_ns - busy;
+
+	bytes = stats->bytes, transfers = stats->transfers, busy = stats->busy_ns;
+	Block_Epoch(&registers);
+	blockBytes = stats->bytes - bytes, blockTransfers = stats->transfers - transfers, blockNs = stats->busy_ns - busy;
+
+	BENCH("fuel gauge per epoch at 100 kHz: %u transfers, %u bytes, %.0f us register by register; "
+		  "%u transfer, %u bytes, %.0f us in one block read (x%.2f)",
+		  oldTransfers, oldBytes, oldNs / 1e3, blockTransfers, blockBytes, blockNs / 1e3, (double)oldNs / blockNs);
+	/*The block carries the 2 registers in between too: 8 transfers to 1, but not 4 times less time on the bus*/
+	CHECK(oldTransfers == 8 && blockTransfers == 1);
+	CHECK(blockBytes < oldBytes && blockNs * 5 < oldNs * 3);
+}
+
+int main(void)
+{
+	HalSim_Reset();
+	Hi2c.Instance = I2C1;
+	Hi2c.Init.ClockSpeed = 100000;
+	HAL_I2C_Init(&Hi2c);
+	HalSim_I2c_Add(FUEL_GAUGE_ADDR, Registers, 0);
+
+	Test_Decode();
+	Bench_Bus();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,212 @@
+/*!
+ * \file      test_hal_sim.c
+ *
+ * \brief     Checks of the HAL simulation itself: flash erase / program rules
+ * 			  and times, SysTick and PRIMASK, I2C transfers and faults, UART
+ * 			  frames in both directions.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+
+static int Ticks;
+static int I2cDone, I2cErrors;
+static uint8_t Echo[8];
+static uint8_t Received[16];
+static int RxEvents;
+static uint16_t RxSize;
+
+static void On_Tick(void)
+{
+	Ticks++;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	(void)hi2c;
+	I2cDone++;
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	(void)hi2c;
+	I2cErrors++;
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	(void)huart;
+	RxEvents++;
+	RxSize = Size;
+}
+
+/*Answers every frame with the frame itself, 1 ms later*/
+static void Echo_Peer(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t length)
+{
+	(void)huart;
+	memcpy(Echo, data, length);
+	HalSim_Uart_Send(data, length, 1000);
+}
+
+static void Test_Flash(void)
+{
+	FLASH_EraseInitTypeDef erase = { FLASH_TYPEERASE_SECTORS, FLASH_BANK_1, FLASH_SECTOR_2, 1, FLASH_VOLTAGE_RANGE_3 };
+	const HalSimFlashStats *stats = HalSim_Flash_Get_Stats();
+	uint32_t error;
+	uint64_t start;
+
+	HalSim_Reset();
+	CHECK(*(uint32_t *)0x08008000 == 0xFFFFFFFF);
+
+	CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, 0x08008000, 0x12345678) == HAL_ERROR);	/*Locked*/
+	CHECK(HAL_FLASH_GetError() == HAL_FLASH_ERROR_PGS);
+
+	HAL_FLASH_Unlock();
+	start = HalSim_Now_Ns();
+	CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, 0x08008000, 0x12345678) == HAL_OK);
+	CHECK(HalSim_Now_Ns() - start == HALSIM_PROGRAM_NS);
+	CHECK(*(uint32_t *)0x08008000 == 0x12345678);
+	CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, 0x08008002, 0) == HAL_ERROR);			/*Misaligned*/
+	CHECK(HAL_FLASH_GetError() == HAL_FLASH_ERROR_PGA);
+
+	/*Programming only clears bits*/
+	CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, 0x08008000, 0xFF) == HAL_OK);
+	CHECK(*(uint8_t *)0x08008000 == 0x78);
+	CHECK(stats->conflicts == 1);
+
+	start = HalSim_Now_Ns();
+	CHECK(HAL_FLASHEx_Erase(&erase, &error) == HAL_OK);
+	CHECK(error == 0xFFFFFFFF);
+	CHECK(HalSim_Now_Ns() - start == HALSIM_ERASE_16K_NS);
+	CHECK(*(uint32_t *)0x08008000 == 0xFFFFFFFF);
+	CHECK(stats->erases == 1 && stats->erase_bytes == 0x4000);
+
+	erase.Sector = FLASH_SECTOR_7;
+	erase.NbSectors = 2;
+	CHECK(HAL_FLASHEx_Erase(&erase, &error) == HAL_ERROR);
+	CHECK(error == 8);
+	HAL_FLASH_Lock();
+
+	HalSim_Flash_Flip(0x08008010, 3);
+	CHECK(*(uint8_t *)0x08008010 == 0xF7);
+}
+
+static void Test_Clock(void)
+{
+	uint32_t tick;
+
+	HalSim_Reset();
+	HalSim_Set_Tick_Handler(On_Tick);
+	Ticks = 0;
+	HalSim_Advance_Us(10500);
+	CHECK(HAL_GetTick() == 10 && Ticks == 10);
+
+	/*Masked for 5 ms: one SysTick is pending, four are lost*/
+	__disable_irq();
+	HalSim_Advance_Us(5000);
+	CHECK(Ticks == 10);
+	__enable_irq();
+	CHECK(Ticks == 11);
+	CHECK(HAL_GetTick() == 11);
+
+	tick = HAL_GetTick();
+	HAL_Delay(20);
+	CHECK(HAL_GetTick() - tick == 21);
+
+	CHECK(SysTick->LOAD == HALSIM_CPU_HZ / 1000 - 1);
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	DWT->CYCCNT = 0;
+	HalSim_Advance_Us(1000);
+	CHECK(DWT->CYCCNT >= HALSIM_CPU_HZ / 1000 && DWT->CYCCNT < HALSIM_CPU_HZ / 1000 + 10);
+}
+
+static void Test_I2c(void)
+{
+	I2C_HandleTypeDef hi2c = { .Instance = I2C1, .Init = { .ClockSpeed = 100000 } };
+	GPIO_InitTypeDef gpio = { GPIO_PIN_6 | GPIO_PIN_7, GPIO_MODE_OUTPUT_OD, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0 };
+	static uint8_t registers[256];
+	const HalSimI2cStats *stats = HalSim_I2c_Get_Stats();
+	uint8_t data[4];
+	uint64_t start;
+	int i;
+
+	HalSim_Reset();
+	for (i = 0; i < 256; i++) registers[i] = (uint8_t)i;
+	HalSim_I2c_Add(0x90, registers, 100);
+	HAL_I2C_Init(&hi2c);
+
+	start = HalSim_Now_Ns();
+	CHECK(HAL_I2C_Mem_Read(&hi2c, 0x90, 0x10, I2C_MEMADD_SIZE_8BIT, data, 4, 10) == HAL_OK);
+	CHECK(data[0] == 0x10 && data[3] == 0x13);
+	CHECK(HalSim_Now_Ns() - start == (30 + 36) * 10000 + 100000);
+	CHECK(HAL_I2C_Mem_Read(&hi2c, 0x92, 0x10, I2C_MEMADD_SIZE_8BIT, data, 4, 10) == HAL_ERROR);
+
+	I2cDone = I2cErrors = 0;
+	CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x90, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_OK);
+	CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x90, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_BUSY);
+	HalSim_Advance_Us(1000);
+	CHECK(I2cDone == 1 && data[0] == 0x20 && data[1] == 0x21);
+
+	/*A device stuck in a transfer keeps the bus busy until SCL is clocked 9 times*/
+	HalSim_I2c_Set_Fault(0x90, HALSIM_I2C_STUCK);
+	CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x90, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_OK);
+	HalSim_Advance_Us(10000);
+	CHECK(I2cDone == 1 && I2cErrors == 0);
+	HAL_I2C_DeInit(&hi2c);
+	HAL_I2C_Init(&hi2c);
+	start = HalSim_Now_Ns();
+	CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x90, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_BUSY);
+	CHECK(HalSim_Now_Ns() - start >= 25000000);
+
+	HAL_I2C_DeInit(&hi2c);
+	HAL_GPIO_Init(GPIOB, &gpio);
+	CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_7) == GPIO_PIN_RESET);
+	for (i = 0; i < 9; i++)
+	{
+		HAL_GPIO_WritePin(GPIOB, GPIO_PIN_6, GPIO_PIN_RESET);
+		HAL_GPIO_WritePin(GPIOB, GPIO_PIN_6, GPIO_PIN_SET);
+	}
+	HAL_GPIO_WritePin(GPIOB, GPIO_PIN_7, GPIO_PIN_SET);
+	CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_7) == GPIO_PIN_SET);
+	CHECK(stats->recoveries == 1);
+	HAL_I2C_Init(&hi2c);
+	CHECK(HAL_I2C_Mem_Read(&hi2c, 0x90, 0x30, I2C_MEMADD_SIZE_8BIT, data, 1, 10) == HAL_OK && data[0] == 0x30);
+}
+
+static void Test_Uart(void)
+{
+	UART_HandleTypeDef huart = { .Instance = USART1, .Init = { .BaudRate = 115200 } };
+	const HalSimUartStats *stats = HalSim_Uart_Get_Stats();
+	uint8_t frame[5] = { 0x56, 0x00, 0x11, 0x00, 0x42 };
+
+	HalSim_Reset();
+	HAL_UART_Init(&huart);
+	HalSim_Uart_Attach(&huart, Echo_Peer);
+
+	/*Nobody receives: the echo is lost*/
+	CHECK(HAL_UART_Transmit_IT(&huart, frame, sizeof(frame)) == HAL_OK);
+	CHECK(HAL_UART_Transmit_IT(&huart, frame, sizeof(frame)) == HAL_BUSY);
+	HalSim_Advance_Us(5000);
+	CHECK(memcmp(Echo, frame, sizeof(frame)) == 0);
+	CHECK(stats->tx_bytes == 5 && stats->lost == 5);
+
+	/*Armed before sending: the reception ends when the line goes idle*/
+	RxEvents = 0;
+	CHECK(HAL_UARTEx_ReceiveToIdle_IT(&huart, Received, sizeof(Received)) == HAL_OK);
+	CHECK(HAL_UART_Transmit_IT(&huart, frame, sizeof(frame)) == HAL_OK);
+	HalSim_Advance_Us(5000);
+	CHECK(RxEvents == 1 && RxSize == 5 && memcmp(Received, frame, 5) == 0);
+	CHECK(stats->rx_bytes == 5 && stats->lost == 5);
+}
+
+int main(void)
+{
+	Test_Flash();
+	Test_Clock();
+	Test_I2c();
+	Test_Uart();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,240 @@
+/*!
+ * \file      test_hk_log.c
+ *
+ * \brief     Housekeeping time series (hk_log.c) on the simulated flash, with
+ * 			  one orbit of synthetic sensor profiles sampled every second:
+ * 			  every block read back (HkLog_Read_Block) decodes to the samples
+ * 			  that were appended, the packets of HkLog_Read_Fragment join back
+ * 			  to each block, HkLog_Find gives the block of any time, the time
+ * 			  goes on after a reset and across the wrap of the HAL tick, and
+ * 			  the bytes stored against the 2 bytes per channel of the raw
+ * 			  samples.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash_log.h"
+#include "hk_log.h"
+#include <math.h>
+#include <string.h>
+
+#define ORBIT_S			5700		/*HK_STATS_ORBIT_PERIOD*/
+#define ECLIPSE_S		2100		/*Shadow part of the orbit*/
+#define PI				3.14159265358979
+#define PACKET_SIZE		38			/*TELEMETRY_MAX_SIZE*/
+
+typedef enum {
+	PROFILE_QUIET,				/*Steady sun pointing, the sensors only follow the orbit*/
+	PROFILE_NOISY,				/*Same, with the last bit of the current and the temperatures toggling*/
+	PROFILE_TUMBLING,			/*Panels in and out of the sun every 40 s*/
+	PROFILES,
+} Profile;
+
+static const char *const ProfileNames[PROFILES] = { "quiet", "noisy", "tumbling" };
+
+static int16_t Samples[ORBIT_S][HK_LOG_CHANNELS];
+static uint32_t Seed;
+
+static int32_t Noise(void)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return (Seed >> 16) % 3 - 1;
+}
+
+/*Channels of hk_log.h at second t of the orbit, in their units (0.1 A, 0.1 V, %, degC)*/
+static void Orbit_Sample(Profile profile, uint32_t t, int16_t *values)
+{
+	bool sun = t >= ECLIPSE_S;
+	double phase = 2 * PI * t / ORBIT_S, spin = 0;
+	int c;
+
+	if (profile == PROFILE_TUMBLING) spin = sin(2 * PI * t / 40);
+	values[HK_LOG_CURRENT] = (int16_t)(sun ? 8 + lround(3 * spin) : -5);
+	values[HK_LOG_VOLTAGE] = (int16_t)(sun ? 82 : 78 - t * 4 / ECLIPSE_S);
+	values[HK_LOG_BATT_LEVEL] = (int16_t)(sun ? 70 + (t - ECLIPSE_S) * 20 / (ORBIT_S - ECLIPSE_S) : 90 - t * 20 / ECLIPSE_S);
+	values[HK_LOG_TEMP_BATT] = (int16_t)lround(12 + 4 * sin(phase));
+	for (c = 0; c < 6; c++) {
+		values[HK_LOG_TEMP1 + c] = (int16_t)lround(10 + 25 * sin(phase + c * PI / 3) + 8 * spin * (c & 1));
+	}
+	if (profile == PROFILE_NOISY) {
+		values[HK_LOG_CURRENT] += Noise();
+		for (c = 0; c < 6; c++) values[HK_LOG_TEMP1 + c] += Noise();
+	}
+}
+
+static uint32_t Varint(const uint8_t **p)
+{
+	uint32_t value = 0;
+	uint8_t shift = 0;
+
+	do value |= (uint32_t)(**p & 0x7F) << shift, shift += 7;
+	while (*(*p)++ & 0x80);
+	return value;
+}
+
+static int32_t Zigzag(const uint8_t **p)
+{
+	uint32_t value = Varint(p);
+
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static uint32_t Get32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/*Joins the fragments of a block, returns its length or 0 if a fragment is wrong*/
+static uint16_t Join_Fragments(uint16_t b, uint8_t *block)
+{
+	uint8_t packet[PACKET_SIZE];
+	uint16_t offset = 0, length, header;
+	uint32_t first = 0;
+
+	while ((length = HkLog_Read_Fragment(b, offset, packet, sizeof(packet))) != 0) {
+		header = packet[4] | packet[5] << 8;
+		if ((header & ~HK_LOG_FRAGMENT_LAST) != offset || length <= HK_LOG_FRAGMENT_HEADER) return 0;
+		if (offset == 0) first = Get32(packet);
+		else if (Get32(packet) != first) return 0;
+		memcpy(&block[offset], &packet[HK_LOG_FRAGMENT_HEADER], length - HK_LOG_FRAGMENT_HEADER);
+		offset += length - HK_LOG_FRAGMENT_HEADER;
+		if (header & HK_LOG_FRAGMENT_LAST) return Get32(&block[6]) == first ? offset : 0;
+	}
+	return 0;
+}
+
+/*Decodes a block to Samples from index first on, returns the samples or -1 if they differ*/
+static int32_t Decode_Block(const uint8_t *block, uint16_t length, uint32_t first, uint32_t *time)
+{
+	const uint8_t *p = &block[HK_LOG_HEADER_SIZE];
+	int16_t values[HK_LOG_CHANNELS];
+	uint16_t count = block[4] | block[5] << 8, i;
+	uint32_t mask, step = 0, last;
+	int c;
+
+	if (block[0] != 'H' || block[1] != 'K' || block[3] != HK_LOG_CHANNELS) return -1;
+	*time = Get32(&block[6]);
+	last = Get32(&block[10]);
+	for (c = 0; c < HK_LOG_CHANNELS; c++) values[c] = (int16_t)(block[14 + 2 * c] | block[15 + 2 * c] << 8);
+
+	for (i = 0; i < count; i++) {
+		if (i > 0) {
+			mask = Varint(&p);
+			if (mask & 1) step += Zigzag(&p);
+			*time += step;
+			for (c = 0; c < HK_LOG_CHANNELS; c++) {
+				if (mask & (2u << c)) values[c] += Zigzag(&p);
+			}
+		}
+		if (memcmp(values, Samples[first + i], sizeof(values)) != 0) return -1;
+	}
+	if (p != block + length || *time != last) return -1;
+	return count;
+}
+
+static void Test_Profiles(void)
+{
+	static uint8_t block[HK_LOG_BLOCK_SIZE], joined[HK_LOG_BLOCK_SIZE];
+	const HkLogStats *stats = HkLog_Get_Stats();
+	uint32_t t, sample, time, wrong, found, start, blocksBefore, bytesBefore, bytes;
+	uint16_t blocks, b, length, first;
+	int32_t count;
+	uint8_t profile;
+	uint64_t ns;
+
+	for (profile = 0; profile < PROFILES; profile++) {
+		HalSim_Reset();
+		Flash_Log_Init();
+		HkLog_Init();
+		start = HkLog_Time();
+		blocksBefore = stats->blocks;
+		bytesBefore = stats->bytes;
+		Seed = 7;
+
+		ns = 0;
+		for (t = 0; t < ORBIT_S; t++) {
+			Orbit_Sample(profile, t, Samples[t]);
+			ns -= Host_Clock_Ns();
+			HkLog_Append(Samples[t]);
+			ns += Host_Clock_Ns();
+			HalSim_Advance_Ns(1000000000ULL);
+		}
+
+		/*Every block, the open one included, back to the samples*/
+		blocks = HkLog_Blocks();
+		for (b = 0, sample = 0, wrong = 0; b < blocks; b++) {
+			length = HkLog_Read_Block(b, block, sizeof(block));
+			count = Decode_Block(block, length, sample, &time);
+			if (count < 0 || Join_Fragments(b, joined) != length || memcmp(joined, block, length) != 0) {
+				wrong++;
+				break;
+			}
+			sample += count;
+		}
+		CHECK(wrong == 0 && sample == ORBIT_S);
+
+		/*The block of a time holds it*/
+		for (t = 0, found = 0; t < ORBIT_S; t += 97) {
+			first = HkLog_Find(start + t);
+			length = HkLog_Read_Block(first, block, sizeof(block));
+			time = Get32(&block[6]);
+			length = HkLog_Read_Block(first + 1, block, sizeof(block));
+			found += time <= start + t && (length == 0 || Get32(&block[6]) > start + t);
+		}
+		CHECK(found == (ORBIT_S + 96) / 97);
+
+		HkLog_Flush();
+		bytes = stats->bytes - bytesBefore;
+		BENCH("%-8s orbit, %u samples of %u channels: %u blocks, %u bytes for %u raw (x%.1f), %.0f ns per sample (host)",
+			  ProfileNames[profile], ORBIT_S, HK_LOG_CHANNELS, stats->blocks - blocksBefore, bytes,
+			  ORBIT_S * HK_LOG_CHANNELS * 2, (double)ORBIT_S * HK_LOG_CHANNELS * 2 / bytes, (double)ns / ORBIT_S);
+		/*Over 5 times while the channels follow the orbit; the noise of the last bit of 7 channels and the
+		  tumbling change most of them every second, a delta of each then costs a byte*/
+		if (profile == PROFILE_QUIET) CHECK(bytes * 5 < ORBIT_S * HK_LOG_CHANNELS * 2);
+		else CHECK(bytes * 2 < ORBIT_S * HK_LOG_CHANNELS * 2);
+		CHECK(stats->errors == 0);
+	}
+
+	/*Reset: the index is read from the flash log and the time goes on from the last sample*/
+	HkLog_Init();
+	CHECK(HkLog_Blocks() == blocks && HkLog_Time() == start + ORBIT_S);
+	CHECK(HkLog_Find(0) == 0 && HkLog_Read_Block(blocks, block, sizeof(block)) == 0);
+	CHECK(HkLog_Read_Fragment(blocks, 0, block, PACKET_SIZE) == 0);
+}
+
+/*The time counts on across the wraps of the 32-bit ms tick: read every 1.5 s, and
+  every 11.6 days (the tick set forward) for 58 days*/
+static void Test_Wrap(void)
+{
+	uint32_t start, i, wrong = 0;
+	uint64_t ms = 0;
+
+	HalSim_Reset();
+	HalSim_Set_Tick(0xFFFFFFFF - 10000);
+	Flash_Log_Init();
+	HkLog_Init();
+	start = HkLog_Time();
+	for (i = 1; i <= 20; i++) {
+		HalSim_Advance_Ns(1500000000ULL);
+		wrong += HkLog_Time() != start + i * 3 / 2;
+	}
+	CHECK(wrong == 0 && HAL_GetTick() < 30000);
+
+	start = HkLog_Time();
+	for (i = 0; i < 5; i++) {
+		ms += 1000000001;
+		HalSim_Set_Tick(HAL_GetTick() + 1000000001);
+		wrong += HkLog_Time() != start + ms / 1000;
+	}
+	CHECK(wrong == 0 && ms > 0xFFFFFFFFULL);
+}
+
+int main(void)
+{
+	Test_Profiles();
+	Test_Wrap();
+	return HOST_TEST_END();
+}
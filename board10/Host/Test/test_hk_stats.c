@@ -0,0 +1,171 @@
+/*!
+ * \file      test_hk_stats.c
+ *
+ * \brief     Window summaries of hk_stats.c over two days of samples, with gaps
+ * 			  and channels of every kind (an offset near the limit of the mean,
+ * 			  a range wider than the deviation can hold): every summary against
+ * 			  a two-pass computation in double precision, the frames of
+ * 			  HkStats_Frame, the error of the one-pass float formula it avoids,
+ * 			  and the cost of a sample.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "host_test.h"
+#include "hk_stats.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUN_S			(2 * 86400)
+#define MAX_SAMPLES		RUN_S
+#define ONE				(1 << HK_STATS_FRACTION)
+
+static int16_t Values[MAX_SAMPLES][HK_LOG_CHANNELS];
+static uint32_t Times[MAX_SAMPLES];
+static uint32_t Seed = 1;
+
+static int32_t Random(int32_t range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return (int32_t)((Seed >> 8) % (2 * range + 1)) - range;
+}
+
+static void Sample(uint32_t t, int16_t *values)
+{
+	int c;
+
+	values[0] = (int16_t)Random(50);									/*Current, white noise*/
+	values[1] = (int16_t)(2040 + Random(3));							/*Offset near the +-2047 of the mean*/
+	values[2] = (int16_t)(t / 1000 % 101);								/*Slow ramp*/
+	values[3] = (int16_t)(-2000 + (t & 1));								/*Toggling last bit*/
+	values[4] = (int16_t)Random(30000);									/*Deviation past 4095 units: saturated*/
+	for (c = 5; c < HK_LOG_CHANNELS; c++) {
+		values[c] = (int16_t)lround(20 * sin(2 * 3.14159265358979 * t / 5700 + c) + Random(1));
+	}
+}
+
+static int32_t Saturate(double value, double low, double high)
+{
+	return (int32_t)(value < low ? low : value > high ? high : value);
+}
+
+/*Two passes in double over the samples first .. end - 1, compared with the summary*/
+static uint32_t Check_Summary(const HkStatsSummary *summary, uint32_t first, uint32_t end, uint32_t period,
+							  double *floatError)
+{
+	double mean, variance, sum;
+	float fsum, fsquares, fstddev;
+	int32_t min, max, c, wrong = 0;
+	uint32_t i, n = end - first;
+
+	if (summary->count != n || summary->start != Times[first] - Times[first] % period) return 1;
+	for (c = 0; c < HK_LOG_CHANNELS; c++) {
+		min = INT16_MAX, max = INT16_MIN, sum = 0, fsum = 0, fsquares = 0;
+		for (i = first; i < end; i++) {
+			if (Values[i][c] < min) min = Values[i][c];
+			if (Values[i][c] > max) max = Values[i][c];
+			sum += Values[i][c];
+			fsum += Values[i][c];
+			fsquares += (float)Values[i][c] * Values[i][c];
+		}
+		mean = sum / n;
+		for (i = first, variance = 0; i < end; i++) variance += (Values[i][c] - mean) * (Values[i][c] - mean);
+		variance /= n;
+
+		/*mean rounded to 1/16, stddev truncated to 1/16: the integers can be one step off only on a tie*/
+		wrong += summary->channels[c].min != min || summary->channels[c].max != max;
+		wrong += abs(summary->channels[c].mean - Saturate(floor(mean * ONE + 0.5), INT16_MIN, INT16_MAX)) > 1;
+		wrong += abs(summary->channels[c].stddev - Saturate(floor(sqrt(variance) * ONE), 0, UINT16_MAX)) > 1;
+
+		/*The textbook formula in float, on the channel with the offset*/
+		if (c == 1) {
+			fstddev = sqrtf(fmaxf(fsquares / n - (fsum / n) * (fsum / n), 0));
+			if (fabs(fstddev - sqrt(variance)) > *floatError) *floatError = fabs(fstddev - sqrt(variance));
+		}
+	}
+	return wrong;
+}
+
+static void Test_Reference(void)
+{
+	static const uint32_t periods[HK_STATS_WINDOWS] = {
+		HK_STATS_MINUTE_PERIOD, HK_STATS_ORBIT_PERIOD, HK_STATS_DAY_PERIOD,
+	};
+	uint32_t first[HK_STATS_WINDOWS] = { 0 }, checked[HK_STATS_WINDOWS] = { 0 }, wrong = 0, n = 0, t;
+	uint8_t frame[HK_STATS_FRAME_SIZE];
+	const HkStatsSummary *summary;
+	double floatError = 0;
+	uint8_t w, part, channels = 0;
+
+	HkStats_Init();
+	CHECK(HkStats_Frame(HK_STATS_MINUTE, 0, frame, sizeof(frame)) == 0);
+
+	for (t = 0; t < RUN_S; t++) {
+		if (Random(25) == 0 && t + 11 < RUN_S) t += 1 + Seed % 10;		/*Epochs lost*/
+		Times[n] = t;
+		Sample(t, Values[n]);
+		HkStats_Add(Values[n], t);
+
+		/*A sample in a new window ends the previous one*/
+		for (w = 0; w < HK_STATS_WINDOWS; w++) {
+			if (n > 0 && t / periods[w] != Times[first[w]] / periods[w]) {
+				wrong += Check_Summary(HkStats_Get_Summary(w), first[w], n, periods[w], &floatError);
+				checked[w]++;
+				first[w] = n;
+			}
+		}
+		n++;
+	}
+	CHECK(wrong == 0);
+	CHECK(checked[HK_STATS_MINUTE] > RUN_S / 60 - 2 && checked[HK_STATS_ORBIT] == RUN_S / HK_STATS_ORBIT_PERIOD &&
+		  checked[HK_STATS_DAY] == 1);
+	BENCH("%u windows checked against double, 0 off by more than 1/16; one-pass float stddev off by up to %.2f units",
+		  checked[0] + checked[1] + checked[2], floatError);
+
+	/*The frames: the summary of the last day, little-endian, each in a packet*/
+	summary = HkStats_Get_Summary(HK_STATS_DAY);
+	CHECK(HkStats_Frame(HK_STATS_DAY, 0, frame, sizeof(frame) - 1) == 0);
+	for (part = 0; part < HK_STATS_FRAMES; part++) {
+		wrong += HkStats_Frame(HK_STATS_DAY, part, frame, sizeof(frame)) != 14 + 8 * frame[5] ||
+				 frame[0] != 'H' || frame[1] != 'S' || frame[3] != HK_STATS_DAY || frame[4] != channels ||
+				 (frame[10] | frame[11] << 8 | frame[12] << 16 | (uint32_t)frame[13] << 24) != summary->count ||
+				 (int16_t)(frame[14 + 4] | frame[14 + 5] << 8) != summary->channels[channels].mean;
+		channels += frame[5];
+	}
+	CHECK(wrong == 0 && channels == HK_LOG_CHANNELS && HK_STATS_FRAME_SIZE <= 38);
+	CHECK(HkStats_Frame(HK_STATS_DAY, HK_STATS_FRAMES, frame, sizeof(frame)) == 0);
+	CHECK(summary->channels[4].stddev == UINT16_MAX);
+	CHECK(HkStats_Frame(HK_STATS_WINDOWS, 0, frame, sizeof(frame)) == 0);
+
+	/*A new period starts the window again*/
+	HkStats_Set_Period(HK_STATS_ORBIT, 5400);
+	HkStats_Add(Values[0], RUN_S);
+	HkStats_Add(Values[0], RUN_S + 5400);
+	CHECK(HkStats_Get_Summary(HK_STATS_ORBIT)->count == 1);
+}
+
+static void Bench_Add(void)
+{
+	volatile uint32_t sink = 0;
+	uint64_t start, ns;
+	uint32_t i;
+
+	HkStats_Init();
+	start = Host_Clock_Ns();
+	for (i = 0; i < MAX_SAMPLES; i++) HkStats_Add(Values[i], i);
+	ns = Host_Clock_Ns() - start;
+	sink += HkStats_Get_Summary(HK_STATS_MINUTE)->count;
+
+	BENCH("HkStats_Add (host): %.1f ns per sample of %u channels in %u windows",
+		  (double)ns / MAX_SAMPLES, HK_LOG_CHANNELS, HK_STATS_WINDOWS);
+	CHECK(sink == 60);
+}
+
+int main(void)
+{
+	Test_Reference();
+	Bench_Add();
+	return HOST_TEST_END();
+}
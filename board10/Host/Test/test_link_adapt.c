@@ -0,0 +1,217 @@
+/*!
+ * \file      test_link_adapt.c
+ *
+ * \brief     SF / CR adaptation (link_adapt.c) over passes of a 500 km orbit:
+ * 			  the SNR follows the slant range to the ground station, with a
+ * 			  fading of every packet, and the bytes delivered in each pass are
+ * 			  compared with the fixed SF9 of comms.h. Also the setting kept in
+ * 			  the flash log across a reset and the one of a telecommand.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "link_adapt.h"
+#include "lora_toa.h"
+#include "arq.h"
+#include "flash.h"
+#include "flash_cache.h"
+#include "flash_log.h"
+#include <math.h>
+
+#define EARTH_KM		6371.0
+#define ALTITUDE_KM		500.0
+#define PERIOD_S		5677.0		/*Orbit of 500 km*/
+#define EIRP_DBM		22.0		/*TX_OUTPUT_POWER, 0 dBi on the satellite*/
+#define GAIN_DB			10.0		/*12 dBi Yagi of the ground station minus cable and polarisation losses*/
+#define NOISE_DBM		(-117.0)	/*-174 dBm/Hz + 51 dB (125 kHz) + 6 dB of noise figure*/
+#define FADING_DB		2.0			/*Standard deviation of the fading of every packet*/
+#define CR_GAIN_DB		0.7			/*Demodulation gain of every step of coding rate*/
+#define SACK_GAP_MS		40			/*Turnaround before and after the SACK*/
+
+typedef struct {
+	uint32_t Bytes;				/*Payload bytes received by the ground station*/
+	uint32_t Sent;
+	uint32_t Changes;
+	uint8_t MinSF, MaxSF;
+} PassResult;
+
+static uint32_t Seed;
+static uint8_t Applied[2];		/*Last SF and CR given to the radio*/
+
+static void Apply(uint8_t SpreadingFactor, uint8_t CodingRate)
+{
+	Applied[0] = SpreadingFactor;
+	Applied[1] = CodingRate;
+}
+
+static double Uniform(void)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return ((Seed >> 8) + 0.5) / (1 << 24);
+}
+
+static double Gaussian(void)
+{
+	return sqrt(-2 * log(Uniform())) * cos(2 * M_PI * Uniform());
+}
+
+/*SNR (dB) t seconds into a pass whose closest approach is offset rad away from the ground track*/
+static double Pass_Snr(double t, double duration, double offset)
+{
+	double along = 2 * M_PI * (t - duration / 2) / PERIOD_S;
+	double central = acos(cos(along) * cos(offset));
+	double r = EARTH_KM + ALTITUDE_KM;
+	double range = sqrt(EARTH_KM * EARTH_KM + r * r - 2 * EARTH_KM * r * cos(central));
+	double fspl = 20 * log10(range) + 20 * log10(868.0) + 32.44;
+
+	return EIRP_DBM + GAIN_DB - fspl - NOISE_DBM;
+}
+
+/*From horizon to horizon, maxElevation in degrees*/
+static double Pass_Duration(double maxElevation, double *offset)
+{
+	double r = EARTH_KM + ALTITUDE_KM, el = maxElevation * M_PI / 180;
+	double horizon = acos(EARTH_KM / r);
+
+	*offset = acos(EARTH_KM * cos(el) / r) - el;
+	return 2 * acos(cos(horizon) / cos(*offset)) * PERIOD_S / (2 * M_PI);
+}
+
+/*One pass of windows of ARQ_WINDOW_SIZE packets, adapted or always at SF9 CR 4/5*/
+static PassResult Run_Pass(double maxElevation, bool adapt, uint32_t seed)
+{
+	LoraToaParams params = { .Bandwidth = 4, .PreambleLength = 8, .Crc = true };
+	const LinkAdaptStats *stats = LinkAdapt_Get_Stats();
+	PassResult result = { 0, 0, 0, LORA_TOA_SF_MAX, LORA_TOA_SF_MIN };
+	double offset, duration = Pass_Duration(maxElevation, &offset), t = 0, snr;
+	uint16_t lost;
+	int i;
+
+	Seed = seed;
+	Applied[0] = 9;
+	Applied[1] = 1;
+	if (adapt) LinkAdapt_Init(Apply);
+
+	while (t < duration) {
+		params.SpreadingFactor = Applied[0];
+		params.CodingRate = Applied[1];
+		params.LowDatarateOptimize = LoraToa_Symbol_Us(Applied[0], 4) >= LORA_TOA_LDRO_SYMBOL_US;
+		if (Applied[0] < result.MinSF) result.MinSF = Applied[0];
+		if (Applied[0] > result.MaxSF) result.MaxSF = Applied[0];
+
+		for (i = 0, lost = 0; i < ARQ_WINDOW_SIZE && t < duration; i++) {
+			snr = Pass_Snr(t, duration, offset) + FADING_DB * Gaussian();
+			if (snr >= LoraToa_Snr_Limit(Applied[0]) / 10.0 - CR_GAIN_DB * (Applied[1] - 1)) result.Bytes += ARQ_PAYLOAD_SIZE;
+			else lost++;
+			result.Sent++;
+			t += LoraToa_Compute_Us(&params, ARQ_PACKET_SIZE) / 1e6;
+		}
+
+		/*The SACK of the window: its SNR is measured by the satellite*/
+		t += (LoraToa_Compute_Us(&params, ARQ_SACK_SIZE) + 2 * SACK_GAP_MS * 1000) / 1e6;
+		snr = Pass_Snr(t, duration, offset) + FADING_DB * Gaussian();
+		if (!adapt) continue;
+		if (snr >= LoraToa_Snr_Limit(Applied[0]) / 10.0)
+			LinkAdapt_Rx((int16_t)lround(snr + NOISE_DBM), (int8_t)lround(snr));
+		LinkAdapt_Window(i, lost);
+	}
+	if (adapt) result.Changes = stats->Changes;
+	return result;
+}
+
+static void Setup(uint8_t sf, uint8_t cr)
+{
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	Write_Flash(SF_ADDR, &sf, 1);
+	Write_Flash(CRC_ADDR, &cr, 1);
+	Flash_Cache_Flush();
+}
+
+static void Bench_Passes(void)
+{
+	static const double Elevations[] = { 10, 30, 60, 90 };
+	PassResult fixed, adapted;
+	uint32_t e, seed, fixedBytes, adaptedBytes, changes, erases;
+	uint8_t minSF, maxSF;
+	double offset, duration;
+
+	for (e = 0; e < sizeof(Elevations) / sizeof(Elevations[0]); e++) {
+		duration = Pass_Duration(Elevations[e], &offset);
+		fixedBytes = adaptedBytes = changes = erases = 0;
+		minSF = LORA_TOA_SF_MAX;
+		maxSF = LORA_TOA_SF_MIN;
+		for (seed = 1; seed <= 4; seed++) {
+			Setup(9, 0);
+			fixed = Run_Pass(Elevations[e], false, seed);
+			HalSim_Flash_Clear_Stats();
+			adapted = Run_Pass(Elevations[e], true, seed);
+			Flash_Cache_Flush();
+			erases += HalSim_Flash_Get_Stats()->erases;
+			fixedBytes += fixed.Bytes;
+			adaptedBytes += adapted.Bytes;
+			changes += adapted.Changes;
+			if (adapted.MinSF < minSF) minSF = adapted.MinSF;
+			if (adapted.MaxSF > maxSF) maxSF = adapted.MaxSF;
+		}
+		BENCH("pass of %2.0f deg (%3.0f s, SNR %5.1f dB at the top): SF9 %6u B, adapted %6u B (x%.2f), "
+			  "SF%u..%u, %u changes, %u erases",
+			  Elevations[e], duration, Pass_Snr(duration / 2, duration, offset),
+			  fixedBytes / 4, adaptedBytes / 4, (double)adaptedBytes / fixedBytes, minSF, maxSF,
+			  changes / 4, erases);
+		CHECK(adaptedBytes > fixedBytes);
+		/*The setting goes to the flash log, no sector is erased for it*/
+		CHECK(erases == 0);
+	}
+}
+
+static void Test_Persistence(void)
+{
+	const LinkAdaptStats *stats = LinkAdapt_Get_Stats();
+	uint8_t sf, cr;
+	int i;
+
+	/*Nothing chosen yet: the setting of the ground*/
+	Setup(10, 2);
+	LinkAdapt_Init(Apply);
+	CHECK(stats->SpreadingFactor == 10 && stats->CodingRate == 3 && Applied[0] == 10 && Applied[1] == 3);
+
+	/*Strong signal and no losses: faster after the hold*/
+	for (i = 0; i < 10; i++) {
+		LinkAdapt_Rx(-100, 10);
+		LinkAdapt_Window(ARQ_WINDOW_SIZE, 0);
+	}
+	CHECK(stats->SpreadingFactor == LORA_TOA_SF_MIN && stats->CodingRate == 1 && Applied[0] == LORA_TOA_SF_MIN);
+	Read_Flash(LINK_SF_ADDR, &sf, 1);
+	Read_Flash(LINK_CR_ADDR, &cr, 1);
+	CHECK(sf == LORA_TOA_SF_MIN && cr == 0);
+
+	/*Reset: the last choice, from the log*/
+	Flash_Cache_Flush();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	Applied[0] = 0;
+	LinkAdapt_Init(Apply);
+	CHECK(stats->SpreadingFactor == LORA_TOA_SF_MIN && Applied[0] == LORA_TOA_SF_MIN);
+	Read_Flash(SF_ADDR, &sf, 1);
+	CHECK(sf == 10);
+
+	/*SET_SF: starts again from the telecommand*/
+	sf = 12;
+	Write_Flash(SF_ADDR, &sf, 1);
+	LinkAdapt_Load();
+	CHECK(stats->SpreadingFactor == 12 && Applied[0] == 12);
+	Read_Flash(LINK_SF_ADDR, &sf, 1);
+	CHECK(sf == 12);
+}
+
+int main(void)
+{
+	Test_Persistence();
+	Bench_Passes();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,160 @@
+/*!
+ * \file      test_lora_toa.c
+ *
+ * \brief     Integer time on air (lora_toa.c) against the double formula of
+ * 			  RadioTimeOnAir (radio.c) for every SF, bandwidth, coding rate,
+ * 			  header, CRC, preamble and payload length, the configurations that
+ * 			  are not supported, and the cost of each way of getting the time.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "host_test.h"
+#include "lora_toa.h"
+#include <math.h>
+
+#define BENCH_CALLS		2000000
+
+/*RadioLoRaSymbTime of radio.c, ms*/
+static const double SymbolTime[3][6] = {
+	{ 32.768, 16.384, 8.192, 4.096, 2.048, 1.024 },
+	{ 16.384, 8.192, 4.096, 2.048, 1.024, 0.512 },
+	{ 8.192, 4.096, 2.048, 1.024, 0.512, 0.256 },
+};
+
+/*
+ * The LoRa case of RadioTimeOnAir. The driver takes (CodingRate % 4) + 4, which is 4
+ * for LORA_CR_4_8 instead of 8: the coding rate is taken as CodingRate + 4 here, as
+ * the SX126x datasheet and lora_toa.c do.
+ */
+static uint32_t Reference_Ms(const LoraToaParams *p, uint8_t pktLen)
+{
+	double ts = SymbolTime[p->Bandwidth - 4][12 - p->SpreadingFactor];
+	double tPreamble = (p->PreambleLength + 4.25) * ts;
+	double tmp = ceil((8 * pktLen - 4 * p->SpreadingFactor + 28 + 16 * p->Crc - (p->FixedLength ? 20 : 0)) /
+					  (double)(4 * (p->SpreadingFactor - (p->LowDatarateOptimize > 0 ? 2 : 0)))) *
+				 (p->CodingRate + 4);
+	double nPayload = 8 + (tmp > 0 ? tmp : 0);
+
+	return floor(tPreamble + nPayload * ts + 0.999);
+}
+
+/*Same formula in microseconds, without the rounding to ms*/
+static double Reference_Us(const LoraToaParams *p, uint8_t pktLen)
+{
+	double ts = SymbolTime[p->Bandwidth - 4][12 - p->SpreadingFactor] * 1000;
+	double tmp = ceil((8 * pktLen - 4 * p->SpreadingFactor + 28 + 16 * p->Crc - (p->FixedLength ? 20 : 0)) /
+					  (double)(4 * (p->SpreadingFactor - (p->LowDatarateOptimize > 0 ? 2 : 0)))) *
+				 (p->CodingRate + 4);
+
+	return (p->PreambleLength + 4.25) * ts + (8 + (tmp > 0 ? tmp : 0)) * ts;
+}
+
+static void Test_Reference(void)
+{
+	static const uint16_t Preambles[] = { 6, 8, 12, 1000, 65535 };
+	static LoraToa toa;
+	LoraToaParams p = { 0 };
+	uint32_t checked = 0, mismatches = 0, us;
+	int pre, crc, header, len;
+
+	for (p.SpreadingFactor = LORA_TOA_SF_MIN; p.SpreadingFactor <= LORA_TOA_SF_MAX; p.SpreadingFactor++) {
+		for (p.Bandwidth = LORA_TOA_BW_MIN; p.Bandwidth <= LORA_TOA_BW_MAX; p.Bandwidth++) {
+			for (p.CodingRate = 1; p.CodingRate <= 4; p.CodingRate++) {
+				for (p.LowDatarateOptimize = 0; p.LowDatarateOptimize <= 1; p.LowDatarateOptimize++) {
+					for (pre = 0; pre < (int)(sizeof(Preambles) / sizeof(Preambles[0])); pre++) {
+						p.PreambleLength = Preambles[pre];
+						for (crc = 0; crc <= 1; crc++) {
+							for (header = 0; header <= 1; header++) {
+								p.Crc = crc;
+								p.FixedLength = header;
+								LoraToa_Init(&toa, &p);
+								for (len = 0; len <= LORA_TOA_MAX_LENGTH; len++) {
+									us = LoraToa_Compute_Us(&p, len);
+									if (us != Reference_Us(&p, len) || LoraToa_Compute(&p, len) != Reference_Ms(&p, len))
+										mismatches++;
+									if (LoraToa_Get(&toa, len) != (uint16_t)Reference_Ms(&p, len))
+										mismatches += Reference_Ms(&p, len) <= 0xFFFF;
+									checked++;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	BENCH("%u configurations and lengths against the double formula, %u different", checked, mismatches);
+	CHECK(checked == 6 * 3 * 4 * 2 * 5 * 2 * 2 * 256 && mismatches == 0);
+
+	/*Datasheet example: SF7, 125 kHz, CR 4/5, 8 symbols, CRC, 10 bytes = 41.216 ms*/
+	p = (LoraToaParams){ .SpreadingFactor = 7, .Bandwidth = 4, .CodingRate = 1, .PreambleLength = 8, .Crc = true };
+	CHECK(LoraToa_Compute_Us(&p, 10) == 41216 && LoraToa_Compute(&p, 10) == 42);
+}
+
+static void Test_Unsupported(void)
+{
+	static LoraToa toa;
+	LoraToaParams p = { .SpreadingFactor = 9, .Bandwidth = 4, .CodingRate = 1, .PreambleLength = 8, .Crc = true };
+	LoraToaParams bad;
+
+	CHECK(LoraToa_Symbol_Us(6, 4) == 0 && LoraToa_Symbol_Us(13, 4) == 0 && LoraToa_Symbol_Us(0, 4) == 0);
+	CHECK(LoraToa_Symbol_Us(9, 3) == 0 && LoraToa_Symbol_Us(9, 7) == 0 && LoraToa_Symbol_Us(9, 10) == 0);
+	CHECK(LoraToa_Symbol_Us(12, 4) == 32768 && LoraToa_Symbol_Us(7, 6) == 256);
+
+	bad = p;
+	bad.Bandwidth = 0;		/*LORA_BW_007*/
+	CHECK(LoraToa_Compute_Us(&bad, 38) == 0 && LoraToa_Compute(&bad, 38) == 0);
+	CHECK(LoraToa_Throughput(&bad, 38, 36) == 0 && LoraToa_Pass_Capacity(&bad, 38, 36, 600000, 20) == 0);
+	CHECK(LoraToa_Best_SF(&bad, 38, 36, 600000, 20, 0, 30) == 0 && bad.SpreadingFactor == 9);
+	LoraToa_Init(&toa, &bad);
+	CHECK(LoraToa_Get(&toa, 38) == 0 && LoraToa_Get(&toa, 255) == 0);
+
+	bad = p;
+	bad.SpreadingFactor = 5;
+	CHECK(LoraToa_Compute_Us(&bad, 38) == 0 && LoraToa_Throughput(&bad, 38, 36) == 0);
+	bad = p;
+	bad.CodingRate = 0;
+	CHECK(LoraToa_Compute_Us(&bad, 38) == 0);
+	bad.CodingRate = 5;
+	CHECK(LoraToa_Compute_Us(&bad, 38) == 0);
+
+	/*The supported configuration still works after them*/
+	CHECK(LoraToa_Throughput(&p, 38, 36) > 0 && LoraToa_Best_SF(&p, 38, 36, 600000, 20, 0, 30) != 0);
+}
+
+static void Bench_Calls(void)
+{
+	static LoraToa toa;
+	LoraToaParams p = { .SpreadingFactor = 10, .Bandwidth = 4, .CodingRate = 1, .PreambleLength = 8, .Crc = true,
+						.LowDatarateOptimize = 0 };
+	volatile uint32_t sink = 0;
+	uint64_t start, reference, integer, table;
+	uint32_t i;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_CALLS; i++) sink += Reference_Ms(&p, i & 0xFF);
+	reference = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_CALLS; i++) sink += LoraToa_Compute(&p, i & 0xFF);
+	integer = Host_Clock_Ns() - start;
+
+	LoraToa_Init(&toa, &p);
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_CALLS; i++) sink += LoraToa_Get(&toa, i & 0xFF);
+	table = Host_Clock_Ns() - start;
+
+	BENCH("time on air per call: double %.1f ns, integer %.1f ns, table %.1f ns (host with a double FPU)",
+		  (double)reference / BENCH_CALLS, (double)integer / BENCH_CALLS, (double)table / BENCH_CALLS);
+	CHECK(sink != 0);
+}
+
+int main(void)
+{
+	Test_Reference();
+	Test_Unsupported();
+	Bench_Calls();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,349 @@
+/*!
+ * \file      test_radio_irq.c
+ *
+ * \brief     Dispatch of the SX126x interrupts (radio_irq.c) with a fake radio
+ * 			  behind RadioIrqOps: the order of the handlers, the timeouts, a full
+ * 			  queue, and the time from the DIO1 edge to the handler under the
+ * 			  load of the other tasks. The previous main loop (system_state and
+ * 			  the state machine, then RadioIrqProcess if IrqFired) is compared
+ * 			  with the radio task of the scheduler.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "radio_irq.h"
+#include "scheduler.h"
+#include <sx126x.h>
+#include <math.h>
+#include <string.h>
+
+#define SPI_COMMAND_US		4			/*GetIrqStatus, ClearIrqStatus: 4 bytes at 8 MHz plus BUSY*/
+#define SPI_BYTE_NS			1000		/*ReadBuffer of the payload*/
+#define HANDLER_US			20
+#define EVENTS				3000
+#define MEAN_GAP_US			25000		/*Between two DIO1 edges*/
+
+/*Work of each task, in microseconds of CPU*/
+#define HEALTH_US			4500		/*system_state: blocking I2C reads of the batteries and temperatures*/
+#define SENSORS_OLD_US		3000		/*sensorReadings with blocking reads*/
+#define SENSORS_US			300			/*Start of an interrupt-driven epoch (sensor_bus)*/
+#define STATE_US			400
+#define FLASH_US			100
+
+static struct {
+	uint16_t Irq;				/*IRQ status register*/
+	uint64_t Raised[16];		/*Time each IRQ bit was set*/
+	bool Transmitting;
+	uint8_t Payload[RADIO_IRQ_PAYLOAD_SIZE];
+	uint8_t Size;
+} Sx126x;
+
+static struct {
+	uint64_t Sum;
+	uint64_t Max;
+	uint32_t Count;
+	uint32_t Histogram[64];		/*Buckets of 250 us*/
+} Latency;
+
+static char Calls[16];
+static uint8_t CallCount;
+static bool IrqFired;
+static void (*Dio1)(void);			/*Handler of the DIO1 interrupt*/
+static uint32_t Seed;
+static uint32_t LoadUs;
+
+static uint16_t Fake_Get_Irq_Status(void)
+{
+	HalSim_Advance_Us(SPI_COMMAND_US);
+	return Sx126x.Irq;
+}
+
+static void Fake_Clear_Irq_Status(uint16_t irq)
+{
+	HalSim_Advance_Us(SPI_COMMAND_US);
+	Sx126x.Irq &= ~irq;
+}
+
+static void Fake_Get_Payload(uint8_t *buffer, uint8_t *size, int16_t *rssi, int8_t *snr)
+{
+	HalSim_Advance_Ns(2 * SPI_COMMAND_US * 1000 + Sx126x.Size * SPI_BYTE_NS);
+	memcpy(buffer, Sx126x.Payload, Sx126x.Size);
+	*size = Sx126x.Size;
+	*rssi = -110;
+	*snr = -5;
+}
+
+static bool Fake_Is_Transmitting(void)
+{
+	return Sx126x.Transmitting;
+}
+
+static const RadioIrqOps FakeOps = {
+	Fake_Get_Irq_Status, Fake_Clear_Irq_Status, Fake_Get_Payload, Fake_Is_Transmitting
+};
+
+/*Time from the IRQ bit to its handler*/
+static void Record(uint16_t irq)
+{
+	uint64_t ns = HalSim_Now_Ns() - Sx126x.Raised[__builtin_ctz(irq)];
+	uint32_t bucket = ns / 250000;
+
+	Latency.Sum += ns;
+	Latency.Count++;
+	if (ns > Latency.Max) Latency.Max = ns;
+	Latency.Histogram[bucket < 63 ? bucket : 63]++;
+	HalSim_Advance_Us(HANDLER_US);
+}
+
+static void On_Tx_Done(void)
+{
+	Calls[CallCount++ & 15] = 'T';
+	Record(IRQ_TX_DONE);
+}
+
+static void On_Rx_Done(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
+{
+	Calls[CallCount++ & 15] = 'R';
+	CHECK(size == Sx126x.Size && memcmp(payload, Sx126x.Payload, size) == 0 && rssi == -110 && snr == -5);
+	Record(IRQ_RX_DONE);
+}
+
+static void On_Cad_Done(bool activity)
+{
+	Calls[CallCount++ & 15] = activity ? 'A' : 'C';
+	Record(IRQ_CAD_DONE);
+}
+
+static void On_Tx_Timeout(void)
+{
+	Calls[CallCount++ & 15] = 't';
+}
+
+static void On_Rx_Timeout(void)
+{
+	Calls[CallCount++ & 15] = 'r';
+}
+
+static void On_Rx_Error(void)
+{
+	Calls[CallCount++ & 15] = 'e';
+}
+
+static RadioEvents_t Events = {
+	.TxDone = On_Tx_Done,
+	.RxDone = On_Rx_Done,
+	.RxTimeout = On_Rx_Timeout,
+	.RxError = On_Rx_Error,
+	.TxTimeout = On_Tx_Timeout,
+	.CadDone = On_Cad_Done,
+};
+
+/*The radio sets IRQ bits and DIO1 goes high*/
+static void Fake_Raise(uint16_t irq)
+{
+	uint8_t i;
+
+	for (i = 0; i < 16; i++) {
+		if (irq & (1 << i)) Sx126x.Raised[i] = HalSim_Now_Ns();
+	}
+	Sx126x.Irq |= irq;
+	Dio1();
+}
+
+static void Setup(void)
+{
+	HalSim_Reset();
+	Scheduler_Init();
+	memset(&Sx126x, 0, sizeof(Sx126x));
+	memset(&Latency, 0, sizeof(Latency));
+	CallCount = 0;
+	Dio1 = RadioIrq_On_Dio1;
+	RadioIrq_Init(&FakeOps, &Events);
+}
+
+static void Test_Order(void)
+{
+	Setup();
+	Sx126x.Size = 12;
+	memcpy(Sx126x.Payload, "telecommand", 12);
+
+	/*Every event of one DIO1, dispatched in priority order and cleared*/
+	Fake_Raise(IRQ_CRC_ERROR | IRQ_CAD_DONE | IRQ_RX_DONE | IRQ_TX_DONE | IRQ_CAD_ACTIVITY_DETECTED);
+	CHECK(RadioIrq_Dispatch() == 4);
+	CHECK(CallCount == 4 && memcmp(Calls, "TRAe", 4) == 0 && Sx126x.Irq == 0);
+	CHECK(RadioIrq_Dispatch() == 0);
+
+	/*The timeout of the transmission or of the reception*/
+	CallCount = 0;
+	Sx126x.Transmitting = true;
+	Fake_Raise(IRQ_RX_TX_TIMEOUT);
+	CHECK(RadioIrq_Dispatch() == 1);
+	Sx126x.Transmitting = false;
+	Fake_Raise(IRQ_RX_TX_TIMEOUT);
+	CHECK(RadioIrq_Dispatch() == 1);
+	Fake_Raise(IRQ_HEADER_ERROR);
+	CHECK(RadioIrq_Dispatch() == 1);
+	CHECK(CallCount == 3 && memcmp(Calls, "trr", 3) == 0);
+
+	/*Posted by a timer without reading the radio*/
+	CallCount = 0;
+	RadioIrq_Post(RADIO_EVENT_RX_TIMEOUT);
+	CHECK(RadioIrq_Dispatch() == 1 && Calls[0] == 'r');
+}
+
+static void Test_Full(void)
+{
+	const RadioIrqStats *stats = RadioIrq_Get_Stats();
+	uint32_t posted = stats->posted, dropped = stats->dropped;
+	int i;
+
+	Setup();
+	for (i = 0; i < RADIO_IRQ_QUEUE_SIZE + 4; i++) RadioIrq_Post(RADIO_EVENT_TX_TIMEOUT);
+	CHECK(stats->posted - posted == RADIO_IRQ_QUEUE_SIZE && stats->dropped - dropped == 4);
+
+	/*The same events merged in one call*/
+	CHECK(RadioIrq_Dispatch() == 1 && Calls[0] == 't');
+	CHECK(RadioIrq_Post(RADIO_EVENT_TX_TIMEOUT) && RadioIrq_Dispatch() == 1);
+}
+
+/*Next DIO1 edge of the fake radio: a transmission, a reception or a CAD ended*/
+static void Schedule_Edge(void);
+
+static void Edge(void)
+{
+	uint32_t kind;
+
+	Seed = Seed * 1103515245 + 12345;
+	kind = (Seed >> 16) % 10;
+	Sx126x.Size = 38;
+	Fake_Raise(kind < 5 ? IRQ_TX_DONE : kind < 9 ? IRQ_RX_DONE : IRQ_CAD_DONE);
+	Schedule_Edge();
+}
+
+static void Schedule_Edge(void)
+{
+	double u;
+
+	Seed = Seed * 1103515245 + 12345;
+	u = ((Seed >> 8) + 0.5) / (1 << 24);
+	HalSim_Exti_At(HalSim_Now_Ns() + (uint64_t)(-log(u) * MEAN_GAP_US * 1000), Edge);
+}
+
+/*The previous DIO1 handler (RadioOnDioIrq) only sets a flag*/
+static void Old_Dio1(void)
+{
+	IrqFired = true;
+}
+
+/*RadioIrqProcess of radio.c: one status read, one if per IRQ bit*/
+static void Old_Irq_Process(void)
+{
+	uint16_t irq;
+	uint8_t size;
+	int16_t rssi;
+	int8_t snr;
+	static uint8_t payload[RADIO_IRQ_PAYLOAD_SIZE];
+
+	if (!IrqFired) return;
+	IrqFired = false;
+	irq = Fake_Get_Irq_Status();
+	Fake_Clear_Irq_Status(IRQ_RADIO_ALL);
+	if (irq & IRQ_TX_DONE) On_Tx_Done();
+	if (irq & IRQ_RX_DONE) {
+		Fake_Get_Payload(payload, &size, &rssi, &snr);
+		On_Rx_Done(payload, size, rssi, snr);
+	}
+	if (irq & IRQ_CAD_DONE) On_Cad_Done((irq & IRQ_CAD_ACTIVITY_DETECTED) != 0);
+}
+
+static void Health_Task(void) { HalSim_Advance_Us(HEALTH_US); }
+static void Sensors_Task(void) { HalSim_Advance_Us(SENSORS_US); }
+static void State_Task(void) { HalSim_Advance_Us(STATE_US); }
+static void Flash_Task(void) { HalSim_Advance_Us(FLASH_US); }
+static void Payload_Task(void) { HalSim_Advance_Us(LoadUs); }
+
+static void Radio_Task(void)
+{
+	RadioIrq_Dispatch();
+}
+
+/*The tasks of main.c, and a payload task every 10 ms that takes LoadUs*/
+static const SchedulerTask Tasks[] = {
+	{ "radio",	Radio_Task,		0,		5,	SCHEDULER_EVENT_RADIO,	0 },
+	{ "health",	Health_Task,	1000,	0,	0,						1 },
+	{ "sensors",Sensors_Task,	1000,	0,	0,						2 },
+	{ "state",	State_Task,		1000,	0,	0,						3 },
+	{ "flash",	Flash_Task,		10,		0,	0,						4 },
+	{ "payload",Payload_Task,	10,		0,	0,						5 },
+};
+
+static double Percentile(double p)
+{
+	uint32_t i, n = 0;
+
+	for (i = 0; i < 64; i++) {
+		n += Latency.Histogram[i];
+		if (n >= p * Latency.Count) return (i + 1) * 0.25;
+	}
+	return 16;
+}
+
+static void Bench_Latency(void)
+{
+	static const uint32_t Loads[] = { 0, 1000, 3000, 6000 };
+	double oldMean, oldMax;
+	uint32_t l, dropped;
+	uint8_t i;
+
+	for (l = 0; l < sizeof(Loads) / sizeof(Loads[0]); l++) {
+		LoadUs = Loads[l];
+
+		/*Previous main loop: every step runs in turn, the flag is looked at once per turn*/
+		Setup();
+		Seed = 11;
+		IrqFired = false;
+		Dio1 = Old_Dio1;
+		Schedule_Edge();
+		while (Latency.Count < EVENTS) {
+			Health_Task();
+			HalSim_Advance_Us(SENSORS_OLD_US);
+			State_Task();
+			Flash_Task();
+			Payload_Task();
+			Old_Irq_Process();
+		}
+		oldMean = Latency.Sum / 1e3 / Latency.Count;
+		oldMax = Latency.Max / 1e3;
+		BENCH("load %u us per 10 ms, main loop + IrqFired: latency mean %7.1f us, p99 %5.2f ms, max %5.2f ms",
+			  LoadUs, oldMean, Percentile(0.99), oldMax / 1e3);
+
+		/*Scheduler: the radio task runs as soon as the running task returns*/
+		Setup();
+		Seed = 11;
+		for (i = 0; i < sizeof(Tasks) / sizeof(Tasks[0]); i++) Scheduler_Add(&Tasks[i]);
+		dropped = RadioIrq_Get_Stats()->dropped;
+		Schedule_Edge();
+		while (Latency.Count < EVENTS) {
+			if (!Scheduler_Run_Once()) __WFI();
+		}
+		BENCH("load %u us per 10 ms, radio task:         latency mean %7.1f us, p99 %5.2f ms, max %5.2f ms "
+			  "(%u dropped)", LoadUs, Latency.Sum / 1e3 / Latency.Count, Percentile(0.99), Latency.Max / 1e6,
+			  RadioIrq_Get_Stats()->dropped - dropped);
+
+		/*Bounded by the longest task, not by the whole loop*/
+		CHECK(Latency.Max / 1e3 < (LoadUs > HEALTH_US ? LoadUs : HEALTH_US) + 500);
+		CHECK(Latency.Sum / 1e3 / Latency.Count < oldMean / 2);
+		CHECK(Latency.Max / 1e3 < oldMax && RadioIrq_Get_Stats()->dropped == dropped);
+	}
+}
+
+int main(void)
+{
+	Test_Order();
+	Test_Full();
+	Bench_Latency();
+	return HOST_TEST_END();
+}
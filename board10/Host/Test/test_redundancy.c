@@ -0,0 +1,143 @@
+/*!
+ * \file      test_redundancy.c
+ *
+ * \brief     Majority vote of Check_Redundancy on the simulated flash: results
+ * 			  and corrected word counts with upsets in one, two and three copies
+ * 			  of the TLE and the calibration, and its cost against the previous
+ * 			  implementation (three buffers, byte compare and a fourth read).
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "flash.h"
+
+#define TLE_BYTES			138
+#define CALIBRATION_BYTES	(TELEMETRY_ADDR - CALIBRATION_ADDR)
+#define ROUNDS				100000
+
+static uint8_t Reference[TELEMETRY_ADDR - CONFIG_ADDR];
+
+/*Check_Redundancy before the single-pass vote, without the pointer assignment of the fallback*/
+static void Naive_Check_Redundancy(uint32_t Address, uint8_t *RxDef, uint16_t numberofbytes)
+{
+	uint8_t lect1[numberofbytes], lect2[numberofbytes], lect3[numberofbytes];
+	Flash_Read_Data(Address, lect1, numberofbytes);
+	Flash_Read_Data(Address + 0x4000, lect2, numberofbytes);
+	Flash_Read_Data(Address + 0x8000, lect3, numberofbytes);
+
+	bool coincidence12 = true, coincidence13 = true, coincidence23 = true;
+	for (int i = 0; i < numberofbytes; i++) {
+		if (lect1[i] != lect2[i]) coincidence12 = false;
+		if (lect1[i] != lect3[i]) coincidence13 = false;
+		if (lect2[i] != lect3[i]) coincidence23 = false;
+	}
+	if (coincidence12 || coincidence13) {
+		Flash_Read_Data(Address, RxDef, numberofbytes);
+	}
+	else if (coincidence23) {
+		Flash_Read_Data(Address + 0x4000, RxDef, numberofbytes);
+	}
+}
+
+/*The three copies of the configuration, TLE and calibration*/
+static void Store_Copies(void)
+{
+	uint32_t copy;
+
+	HalSim_Reset();
+	HAL_FLASH_Unlock();
+	for (copy = 0; copy < 3; copy++) {
+		CHECK(Flash_Program_Data(CONFIG_ADDR + copy * REDUNDANCY_OFFSET, Reference, sizeof(Reference)) == HAL_OK);
+	}
+	HAL_FLASH_Lock();
+}
+
+static void Test_Vote(void)
+{
+	uint8_t read[sizeof(Reference)];
+
+	Store_Copies();
+	CHECK(Check_Redundancy(TLE_ADDR, read, TLE_BYTES) == 0);
+	CHECK(memcmp(read, &Reference[TLE_ADDR - CONFIG_ADDR], TLE_BYTES) == 0);
+
+	/*One upset in each copy, in different words: every bit still has a majority*/
+	HalSim_Flash_Flip(TLE_ADDR + 5, 0);
+	HalSim_Flash_Flip(TLE_ADDR + REDUNDANCY_OFFSET + 40, 7);
+	HalSim_Flash_Flip(TLE_ADDR + 2 * REDUNDANCY_OFFSET + 137, 3);
+	CHECK(Check_Redundancy(TLE_ADDR, read, TLE_BYTES) == 3);
+	CHECK(memcmp(read, &Reference[TLE_ADDR - CONFIG_ADDR], TLE_BYTES) == 0);
+
+	/*Same byte, different bits of two copies: the vote is still right*/
+	HalSim_Flash_Flip(MAGNETO_MATRIX_ADDR + 2, 1);
+	HalSim_Flash_Flip(MAGNETO_MATRIX_ADDR + REDUNDANCY_OFFSET + 2, 6);
+	CHECK(Check_Redundancy(CALIBRATION_ADDR, read, CALIBRATION_BYTES) == 1);
+	CHECK(memcmp(read, &Reference[CALIBRATION_ADDR - CONFIG_ADDR], CALIBRATION_BYTES) == 0);
+
+	/*Same bit of two copies: the majority is wrong, but only in that bit*/
+	HalSim_Flash_Flip(GYRO_POLYN_ADDR, 4);
+	HalSim_Flash_Flip(GYRO_POLYN_ADDR + 2 * REDUNDANCY_OFFSET, 4);
+	Check_Redundancy(GYRO_POLYN_ADDR, read, 4);
+	CHECK(read[0] == (Reference[GYRO_POLYN_ADDR - CONFIG_ADDR] ^ 0x10));
+	CHECK(memcmp(&read[1], &Reference[GYRO_POLYN_ADDR - CONFIG_ADDR + 1], 3) == 0);
+}
+
+static void Bench_Vote(void)
+{
+	uint8_t read[sizeof(Reference)];
+	uint64_t start, naiveNs, voteNs;
+	volatile uint16_t sink = 0;
+	int i;
+
+	Store_Copies();
+	HalSim_Flash_Flip(TLE_ADDR + REDUNDANCY_OFFSET + 17, 2);
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < ROUNDS; i++) {
+		Naive_Check_Redundancy(TLE_ADDR, read, TLE_BYTES);
+		sink += read[i % TLE_BYTES];
+	}
+	naiveNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < ROUNDS; i++) {
+		sink += Check_Redundancy(TLE_ADDR, read, TLE_BYTES);
+		sink += read[i % TLE_BYTES];
+	}
+	voteNs = Host_Clock_Ns() - start;
+	CHECK(memcmp(read, &Reference[TLE_ADDR - CONFIG_ADDR], TLE_BYTES) == 0);
+
+	BENCH("TLE %d B with one upset: %.0f ns previous vote, %.0f ns single pass (%.1fx), stack %d B -> 0 B",
+		  TLE_BYTES, (double)naiveNs / ROUNDS, (double)voteNs / ROUNDS,
+		  (double)naiveNs / voteNs, 3 * TLE_BYTES);
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < ROUNDS; i++) {
+		Naive_Check_Redundancy(CALIBRATION_ADDR, read, CALIBRATION_BYTES);
+		sink += read[i % CALIBRATION_BYTES];
+	}
+	naiveNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < ROUNDS; i++) {
+		sink += Check_Redundancy(CALIBRATION_ADDR, read, CALIBRATION_BYTES);
+		sink += read[i % CALIBRATION_BYTES];
+	}
+	voteNs = Host_Clock_Ns() - start;
+
+	BENCH("calibration %d B (odd address): %.0f ns previous vote, %.0f ns single pass (%.1fx)",
+		  (int)CALIBRATION_BYTES, (double)naiveNs / ROUNDS, (double)voteNs / ROUNDS, (double)naiveNs / voteNs);
+	(void)sink;
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(Reference); i++) Reference[i] = (uint8_t)(i * 29 + 3);
+	Test_Vote();
+	Bench_Vote();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,253 @@
+/*!
+ * \file      test_ring.c
+ *
+ * \brief     Lock-free SPSC ring (ring.c) and its FIFO shim (fifo.c): the
+ * 			  full / empty limits and the spans, a producer and a consumer
+ * 			  thread mixing every push and pop function over a small ring, and
+ * 			  the throughput next to the Semtech FIFO it replaces.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "host_test.h"
+#include "ring.h"
+#include "fifo.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define STRESS_BYTES	(32u * 1024 * 1024)
+#define BENCH_BYTES		(64u * 1024 * 1024)
+#define BENCH_SIZE		1024
+#define BENCH_BLOCK		64
+
+/*Byte i of the stream, not periodic in any power of 2 below 2^16*/
+#define STREAM(i)		((uint8_t)((i) * 131 + ((i) >> 9)))
+
+/*The Semtech FIFO of the previous fifo.c: one byte at a time, % Size on every index, a call each as from fifo.c*/
+typedef struct {
+	uint16_t Begin;
+	uint16_t End;
+	uint8_t *Data;
+	uint16_t Size;
+} OldFifo_t;
+
+static uint16_t Old_Fifo_Next(OldFifo_t *fifo, uint16_t index)
+{
+	return (index + 1) % fifo->Size;
+}
+
+__attribute__((noinline)) static void Old_Fifo_Push(OldFifo_t *fifo, uint8_t data)
+{
+	fifo->End = Old_Fifo_Next(fifo, fifo->End);
+	fifo->Data[fifo->End] = data;
+}
+
+__attribute__((noinline)) static uint8_t Old_Fifo_Pop(OldFifo_t *fifo)
+{
+	uint8_t data = fifo->Data[Old_Fifo_Next(fifo, fifo->Begin)];
+
+	fifo->Begin = Old_Fifo_Next(fifo, fifo->Begin);
+	return data;
+}
+
+__attribute__((noinline)) static bool Old_Fifo_Full(OldFifo_t *fifo)
+{
+	return Old_Fifo_Next(fifo, fifo->End) == fifo->Begin;
+}
+
+static void Test_Limits(void)
+{
+	static uint8_t buffer[100], out[64];
+	Ring_t ring;
+	Fifo_t fifo;
+	const uint8_t *read;
+	uint8_t *write, byte, in[64];
+	int i;
+
+	for (i = 0; i < 64; i++) in[i] = STREAM(i);
+
+	/*Too small for a power of 2 ring: refused, the ring is not touched*/
+	ring.Mask = 0x55;
+	CHECK(!RingInit(&ring, buffer, 0) && !RingInit(&ring, buffer, 1) && ring.Mask == 0x55);
+	CHECK(RingInit(&ring, buffer, 2) && ring.Mask == 1 && RingSpace(&ring) == 2);
+
+	/*100 is rounded down to 64, all of it usable*/
+	CHECK(RingInit(&ring, buffer, sizeof(buffer)));
+	CHECK(ring.Mask == 63 && RingSpace(&ring) == 64 && RingCount(&ring) == 0);
+	CHECK(RingPushN(&ring, in, 40) == 40 && RingPopN(&ring, out, 30) == 30 && memcmp(out, in, 30) == 0);
+
+	/*Across the end of the buffer: 24 bytes to the end, then the beginning*/
+	CHECK(RingPushN(&ring, in, 60) == 54 && ring.Overflows == 6 && RingSpace(&ring) == 0);
+	CHECK(!RingPush(&ring, 1) && ring.Overflows == 7);
+	CHECK(RingPopN(&ring, out, 64) == 64 && memcmp(out, &in[30], 10) == 0 && memcmp(&out[10], in, 54) == 0);
+	CHECK(!RingPop(&ring, &byte) && RingPopN(&ring, out, 1) == 0);
+
+	/*Spans stop at the end of the buffer*/
+	CHECK(RingWriteSpan(&ring, &write) == 34 && write == &buffer[30]);
+	RingCommitWrite(&ring, 34);
+	CHECK(RingReadSpan(&ring, &read) == 34 && read == write);
+	RingCommitRead(&ring, 34);
+	CHECK(RingWriteSpan(&ring, &write) == 64 && write == buffer);
+
+	RingPushN(&ring, in, 10);
+	RingFlush(&ring);
+	CHECK(RingCount(&ring) == 0);
+
+	/*The shim drops instead of overwriting*/
+	FifoInit(&fifo, buffer, 16);
+	for (i = 0; i < 20; i++) FifoPush(&fifo, in[i]);
+	CHECK(IsFifoFull(&fifo) && fifo.Overflows == 4);
+	for (i = 0; i < 16; i++) CHECK(FifoPop(&fifo) == in[i]);
+	CHECK(IsFifoEmpty(&fifo) && FifoPop(&fifo) == 0);
+}
+
+/*
+ * Stress: the producer and the consumer use a different function every time
+ * (byte, block of a random length, span), the consumer checks every byte.
+ */
+typedef struct {
+	Ring_t Ring;
+	uint8_t Buffer[256];
+	uint32_t Errors;
+	uint32_t Retries;			/*Pushes that did not fit, sent again*/
+} Stress;
+
+static uint32_t Next(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+static void *Producer(void *arg)
+{
+	Stress *s = arg;
+	uint8_t block[200], *span;
+	uint32_t seed = 1, sent = 0, length, pushed, i;
+
+	while (sent < STRESS_BYTES) {
+		length = Next(&seed) % 200 + 1;
+		if (length > STRESS_BYTES - sent) length = STRESS_BYTES - sent;
+		switch (Next(&seed) % 3) {
+		case 0:
+			if (RingPush(&s->Ring, STREAM(sent))) sent++;
+			else s->Retries++, sched_yield();
+			break;
+		case 1:
+			for (i = 0; i < length; i++) block[i] = STREAM(sent + i);
+			pushed = RingPushN(&s->Ring, block, length);
+			if (pushed < length) s->Retries++, sched_yield();
+			sent += pushed;
+			break;
+		default:
+			length = RingWriteSpan(&s->Ring, &span) < length ? RingWriteSpan(&s->Ring, &span) : length;
+			for (i = 0; i < length; i++) span[i] = STREAM(sent + i);
+			RingCommitWrite(&s->Ring, length);
+			sent += length;
+			break;
+		}
+	}
+	return NULL;
+}
+
+static void *Consumer(void *arg)
+{
+	Stress *s = arg;
+	uint8_t block[200];
+	const uint8_t *span;
+	uint32_t seed = 2, received = 0, length, i;
+
+	while (received < STRESS_BYTES) {
+		switch (Next(&seed) % 3) {
+		case 0:
+			length = RingPop(&s->Ring, block);
+			break;
+		case 1:
+			length = RingPopN(&s->Ring, block, Next(&seed) % 200 + 1);
+			break;
+		default:
+			length = RingReadSpan(&s->Ring, &span);
+			if (length > 200) length = 200;
+			memcpy(block, span, length);
+			RingCommitRead(&s->Ring, length);
+			break;
+		}
+		if (length == 0) sched_yield();	/*The producer may share the core*/
+		for (i = 0; i < length; i++) s->Errors += block[i] != STREAM(received + i);
+		received += length;
+	}
+	return NULL;
+}
+
+static void Test_Threads(void)
+{
+	static Stress s;
+	pthread_t producer, consumer;
+	uint64_t start, ns;
+
+	RingInit(&s.Ring, s.Buffer, sizeof(s.Buffer));
+	start = Host_Clock_Ns();
+	CHECK(pthread_create(&consumer, NULL, Consumer, &s) == 0);
+	CHECK(pthread_create(&producer, NULL, Producer, &s) == 0);
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+	ns = Host_Clock_Ns() - start;
+
+	BENCH("two threads, ring of 256: %u MB checked at %.1f MB/s, %u pushes did not fit, %u bytes wrong",
+		  STRESS_BYTES >> 20, (double)STRESS_BYTES * 1e3 / ns, s.Retries, s.Errors);
+	CHECK(s.Errors == 0 && RingCount(&s.Ring) == 0);
+	/*Every failed push was sent again, none counted as lost in the stream*/
+	CHECK(s.Ring.Overflows >= s.Retries);
+}
+
+static void Bench_Throughput(void)
+{
+	static uint8_t buffer[BENCH_SIZE], block[BENCH_BLOCK];
+	volatile uint32_t sink = 0;
+	OldFifo_t old = { 0, 0, buffer, BENCH_SIZE };
+	Ring_t ring;
+	uint64_t start, oldNs, byteNs, blockNs;
+	uint32_t i, j;
+	uint8_t byte;
+
+	/*Half a buffer pushed, then popped, as a UART reception read by the main loop*/
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_BYTES; i += BENCH_SIZE / 2) {
+		for (j = 0; j < BENCH_SIZE / 2 && !Old_Fifo_Full(&old); j++) Old_Fifo_Push(&old, (uint8_t)j);
+		for (j = 0; j < BENCH_SIZE / 2; j++) sink += Old_Fifo_Pop(&old);
+	}
+	oldNs = Host_Clock_Ns() - start;
+
+	RingInit(&ring, buffer, BENCH_SIZE);
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_BYTES; i += BENCH_SIZE / 2) {
+		for (j = 0; j < BENCH_SIZE / 2; j++) RingPush(&ring, (uint8_t)j);
+		for (j = 0; j < BENCH_SIZE / 2; j++) {
+			RingPop(&ring, &byte);
+			sink += byte;
+		}
+	}
+	byteNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_BYTES; i += BENCH_SIZE / 2) {
+		for (j = 0; j < BENCH_SIZE / 2; j += BENCH_BLOCK) RingPushN(&ring, block, BENCH_BLOCK);
+		for (j = 0; j < BENCH_SIZE / 2; j += BENCH_BLOCK) sink += RingPopN(&ring, block, BENCH_BLOCK);
+	}
+	blockNs = Host_Clock_Ns() - start;
+
+	BENCH("push + pop per byte (host): Semtech FIFO %.2f ns, ring %.2f ns, ring by %u-byte blocks %.2f ns",
+		  (double)oldNs / BENCH_BYTES, (double)byteNs / BENCH_BYTES, BENCH_BLOCK, (double)blockNs / BENCH_BYTES);
+	/*Fits in the buffer every time*/
+	CHECK(ring.Overflows == 0);
+	CHECK(byteNs < oldNs && blockNs < byteNs);
+}
+
+int main(void)
+{
+	Test_Limits();
+	Test_Threads();
+	Bench_Throughput();
+	return HOST_TEST_END();
+}
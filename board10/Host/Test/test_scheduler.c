@@ -0,0 +1,232 @@
+/*!
+ * \file      test_scheduler.c
+ *
+ * \brief     Run-to-completion scheduler (scheduler.c) with the tasks of main.c
+ * 			  simulated by their execution times: a minute of the radio posted
+ * 			  by DIO1, the end of the I2C epochs posted by the SysTick, the state
+ * 			  transitions posted by the state task, and the report of the runs,
+ * 			  jitter, execution and CPU of every task. Then a task that blocks
+ * 			  for too long, caught by the deadline of the radio. Before them,
+ * 			  the clock with the SysTick masked and a two-hour load window.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "scheduler.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define RUN_S				60
+#define RADIO_GAP_US		70000		/*Mean time between two DIO1 edges (a packet at SF7)*/
+#define EPOCH_MS			12			/*I2C epoch of sensor_bus, from its start to the event*/
+
+/*Execution time of every task, microseconds*/
+#define RADIO_US			150
+#define HEALTH_US			4500
+#define SENSORS_US			300
+#define STATE_US			400
+#define FLASH_US			100
+#define FLASH_WRITE_US		2000		/*Write-back of the flash cache, every 500 runs*/
+#define TELEMETRY_US		1200
+#define PAYLOAD_US			30000		/*A blocking camera step, second run only*/
+#define SLOW_US				1000000		/*Test_Clock: 1 s every 10 s*/
+#define SLOW_PERIOD_MS		10000
+#define LONG_WINDOW_S		7200
+
+static uint32_t Seed;
+static uint32_t EpochLeft;				/*ms to the end of the I2C epoch*/
+static bool Epoch;						/*An epoch was started and not published yet*/
+static uint32_t Transitions;
+static uint32_t FlashRuns;
+static uint32_t SensorEvents;
+
+static void Radio_Edge(void)
+{
+	double u;
+
+	Scheduler_Post(SCHEDULER_EVENT_RADIO);
+	Seed = Seed * 1103515245 + 12345;
+	u = ((Seed >> 8) + 0.5) / (1 << 24);
+	HalSim_Exti_At(HalSim_Now_Ns() + (uint64_t)(-log(u) * RADIO_GAP_US * 1000), Radio_Edge);
+}
+
+/*SysTick: the I2C transfers of the epoch end by interrupt*/
+static void Tick(void)
+{
+	if (EpochLeft && --EpochLeft == 0) Scheduler_Post(SCHEDULER_EVENT_SENSORS);
+}
+
+static void Radio_Task(void) { HalSim_Advance_Us(RADIO_US); }
+static void Health_Task(void) { HalSim_Advance_Us(HEALTH_US); }
+static void Telemetry_Task(void) { HalSim_Advance_Us(TELEMETRY_US); }
+static void Payload_Task(void) { HalSim_Advance_Us(PAYLOAD_US); }
+
+static void Sensors_Task(void)
+{
+	HalSim_Advance_Us(SENSORS_US);
+	if (!Epoch) {
+		Epoch = true;
+		EpochLeft = EPOCH_MS;
+	}
+	else if (EpochLeft == 0) {
+		Epoch = false;		/*Published*/
+		SensorEvents++;
+	}
+}
+
+/*One step in four changes the state, the new one runs right away*/
+static void State_Task(void)
+{
+	HalSim_Advance_Us(STATE_US);
+	Seed = Seed * 1103515245 + 12345;
+	if ((Seed >> 16) % 4 == 0) {
+		Transitions++;
+		Scheduler_Post(SCHEDULER_EVENT_STATE);
+	}
+}
+
+static void Flash_Task(void)
+{
+	HalSim_Advance_Us(++FlashRuns % 500 == 0 ? FLASH_WRITE_US : FLASH_US);
+}
+
+/*main.c, and the telemetry every 5 s*/
+static const SchedulerTask Tasks[] = {
+	{ "radio",		Radio_Task,		0,		5,	SCHEDULER_EVENT_RADIO,		0 },
+	{ "health",		Health_Task,	1000,	0,	0,							1 },
+	{ "sensors",	Sensors_Task,	1000,	0,	SCHEDULER_EVENT_SENSORS,	2 },
+	{ "state",		State_Task,		1000,	0,	SCHEDULER_EVENT_STATE,		3 },
+	{ "flash",		Flash_Task,		10,		0,	0,							4 },
+	{ "telemetry",	Telemetry_Task,	5000,	0,	0,							5 },
+};
+static const SchedulerTask Payload = { "payload", Payload_Task, 2000, 0, 0, 6 };
+
+/*Scheduler_Run for RUN_S seconds*/
+static uint16_t Run(bool payload)
+{
+	uint8_t i;
+
+	HalSim_Reset();
+	HalSim_Set_Tick_Handler(Tick);
+	Seed = 3;
+	EpochLeft = Transitions = FlashRuns = SensorEvents = 0;
+	Epoch = false;
+	Scheduler_Init();
+	for (i = 0; i < sizeof(Tasks) / sizeof(Tasks[0]); i++) CHECK(Scheduler_Add(&Tasks[i]));
+	if (payload) CHECK(Scheduler_Add(&Payload));
+	Radio_Edge();
+
+	while (HalSim_Now_Ns() < RUN_S * 1000000000ULL) {
+		if (Scheduler_Run_Once()) continue;
+		__disable_irq();
+		__WFI();
+		__enable_irq();
+	}
+	return Scheduler_Get_Load();
+}
+
+static void Test_Report(void)
+{
+	const SchedulerTaskStats *stats;
+	const char *name;
+	uint64_t busy = 0;
+	uint16_t load = Run(false);
+	uint32_t seconds;
+	uint8_t i;
+
+	for (i = 0; (stats = Scheduler_Get_Stats(i, &name)) != NULL; i++) {
+		BENCH("%-9s %5u runs, jitter max %5u us, exec mean %5.0f us max %5u us, CPU %5.2f%%, %u misses, %u overruns",
+			  name, stats->runs, stats->max_jitter, (double)stats->total_exec / stats->runs, stats->max_exec,
+			  stats->total_exec / (RUN_S * 1e4), stats->deadline_misses, stats->overruns);
+		busy += stats->total_exec;
+		CHECK(stats->deadline_misses == 0 && stats->overruns == 0);
+	}
+	BENCH("load %u per mille over %u s, %u state transitions, %u I2C epochs published", load, RUN_S,
+		  Transitions, SensorEvents);
+
+	/*The periodic tasks keep their rate, the released events all run*/
+	stats = Scheduler_Get_Stats(4, &name);
+	CHECK(stats->runs >= RUN_S * 100 - 1 && stats->runs <= RUN_S * 100);
+	seconds = Scheduler_Get_Stats(1, &name)->runs;
+	CHECK(seconds >= RUN_S - 1 && seconds <= RUN_S);
+	stats = Scheduler_Get_Stats(2, &name);
+	CHECK(stats->runs == seconds + SensorEvents && SensorEvents >= seconds - 1);
+	stats = Scheduler_Get_Stats(3, &name);
+	CHECK(stats->runs == seconds + Transitions);
+
+	/*Non-preemptive: the radio waits at most for the longest task*/
+	stats = Scheduler_Get_Stats(0, &name);
+	CHECK(stats->runs > RUN_S * 1000000 / RADIO_GAP_US / 2 && stats->max_jitter < HEALTH_US + 300);
+
+	/*The load is the sum of the executions*/
+	CHECK(fabs(load - busy / (RUN_S * 1e3)) <= 2);
+}
+
+static void Test_Deadline(void)
+{
+	const SchedulerTaskStats *stats;
+	const char *name;
+
+	Run(true);
+	stats = Scheduler_Get_Stats(0, &name);
+	BENCH("with a payload step of %u ms every 2 s: radio jitter max %u us, %u deadline misses of %u runs",
+		  PAYLOAD_US / 1000, stats->max_jitter, stats->deadline_misses, stats->runs);
+	CHECK(stats->deadline_misses > 0 && stats->max_jitter >= 5000);
+	/*The flash task starts again from the end of the step: the periods skipped are late*/
+	stats = Scheduler_Get_Stats(4, &name);
+	CHECK(stats->deadline_misses >= RUN_S / 2 - 1);
+}
+
+static void Slow_Task(void) { HalSim_Advance_Us(SLOW_US); }
+static void Event_Task(void) { }
+
+/*The clock inside a critical section, and a load window longer than 71 minutes*/
+static void Test_Clock(void)
+{
+	static const SchedulerTask event = { "event", Event_Task, 0, 0, SCHEDULER_EVENT_RADIO, 0 };
+	static const SchedulerTask slow = { "slow", Slow_Task, SLOW_PERIOD_MS, 0, 0, 1 };
+	const SchedulerTaskStats *stats;
+	const char *name;
+	uint16_t load;
+
+	/*Posted with the SysTick of the new ms pending: stamped in the new ms, no jitter*/
+	HalSim_Reset();
+	HalSim_Set_Tick_Handler(NULL);
+	Scheduler_Init();
+	CHECK(Scheduler_Add(&event));
+	HalSim_Advance_Us(900);
+	__disable_irq();
+	HalSim_Advance_Us(200);
+	Scheduler_Post(SCHEDULER_EVENT_RADIO);
+	__enable_irq();
+	CHECK(Scheduler_Run_Once());
+	stats = Scheduler_Get_Stats(0, &name);
+	CHECK(stats->runs == 1 && stats->max_jitter < 50);
+
+	/*Reading the load does not restart its window*/
+	Scheduler_Init();
+	CHECK(Scheduler_Add(&slow));
+	while (HalSim_Now_Ns() < LONG_WINDOW_S * 1000000000ULL) {
+		if (Scheduler_Run_Once()) continue;
+		__disable_irq();
+		__WFI();
+		__enable_irq();
+	}
+	load = Scheduler_Get_Load();
+	BENCH("load over %u min: %u per mille", LONG_WINDOW_S / 60, load);
+	CHECK(load == Scheduler_Get_Load());
+	CHECK(abs(load - SLOW_US / SLOW_PERIOD_MS) <= 1);
+	Scheduler_Reset_Load();
+	CHECK(Scheduler_Get_Load() == 0);
+}
+
+int main(void)
+{
+	Test_Clock();
+	Test_Report();
+	Test_Deadline();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,164 @@
+/*!
+ * \file      test_sensor_bus.c
+ *
+ * \brief     I2C epoch of sensorReadings (sensor_bus.c) on the simulated bus:
+ * 			  six TMP102 and the block read of the fuel gauge, with every
+ * 			  sensor present, one that does not answer and one that holds SDA
+ * 			  low. Each reading keeps its own status, the stuck sensor is
+ * 			  released by the bus recovery, and the epoch duration and the
+ * 			  longest main loop call are compared with the blocking reads of
+ * 			  the previous sensorReadings.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "sensor_bus.h"
+#include "fuel_gauge.h"
+#include "timer.h"
+
+#define TEMP_SENSORS		6
+#define FUEL_GAUGE_ADDR		(0x34 << 1)
+#define FUEL_GAUGE_US		100			/*Conversion wait of the gauge*/
+#define OLD_TIMEOUT			1000		/*ms of the blocking reads of the previous code*/
+
+static const uint8_t TempAddr[TEMP_SENSORS] = { 0x90, 0x92, 0x94, 0x96, 0x98, 0x9A };
+
+static I2C_HandleTypeDef Hi2c;
+static uint8_t Registers[TEMP_SENSORS + 1][256];
+static uint8_t TempRaw[TEMP_SENSORS][2];
+static uint8_t GaugeRaw[FUEL_GAUGE_BLOCK_SIZE];
+static SensorBusTransfer Epoch[TEMP_SENSORS + 1];
+static volatile bool Woken;
+
+static void On_Done(void)
+{
+	Woken = true;
+}
+
+/*Sensors on the bus, the temperature of sensor i is 20 + i degC*/
+static void Setup(void)
+{
+	uint8_t i;
+
+	HalSim_Reset();
+	HalSim_Set_Tick_Handler(TimerIrqHandler);
+	Hi2c.Instance = I2C1;
+	Hi2c.Init.ClockSpeed = 100000;
+	HAL_I2C_Init(&Hi2c);
+	for (i = 0; i < TEMP_SENSORS; i++) {
+		Registers[i][0] = 20 + i;		/*0.0625 degC << 4, MSB first*/
+		Registers[i][1] = 0;
+		HalSim_I2c_Add(TempAddr[i], Registers[i], 0);
+		Epoch[i] = (SensorBusTransfer){ TempAddr[i], 0x00, 2, TempRaw[i], SENSOR_BUS_ABSENT };
+	}
+	Registers[TEMP_SENSORS][FUEL_GAUGE_REG_LEVEL] = 87;
+	HalSim_I2c_Add(FUEL_GAUGE_ADDR, Registers[TEMP_SENSORS], FUEL_GAUGE_US);
+	Epoch[TEMP_SENSORS] = (SensorBusTransfer){ FUEL_GAUGE_ADDR, FUEL_GAUGE_BLOCK_START, FUEL_GAUGE_BLOCK_SIZE,
+											   GaugeRaw, SENSOR_BUS_ABSENT };
+	SensorBus_Init(&Hi2c, On_Done);
+}
+
+/*An epoch run as the sensors task: woken by the done callback, returns its duration (ns)*/
+static uint64_t Run_Epoch(uint64_t *maxCall)
+{
+	uint64_t start = HalSim_Now_Ns(), call;
+	bool done = false;
+
+	*maxCall = 0;
+	Woken = false;
+	CHECK(SensorBus_Start(Epoch, TEMP_SENSORS + 1));
+	CHECK(!SensorBus_Start(Epoch, TEMP_SENSORS + 1));
+	while (!done) {
+		__disable_irq();
+		if (!Woken) __WFI();
+		Woken = false;
+		__enable_irq();
+
+		call = HalSim_Now_Ns();
+		done = SensorBus_Process();
+		call = HalSim_Now_Ns() - call;
+		if (call > *maxCall) *maxCall = call;
+	}
+	return HalSim_Now_Ns() - start;
+}
+
+/*The previous sensorReadings: one blocking read after the other*/
+static uint64_t Run_Blocking(void)
+{
+	uint64_t start = HalSim_Now_Ns();
+	uint8_t i;
+
+	for (i = 0; i < TEMP_SENSORS + 1; i++) {
+		HAL_I2C_Mem_Read(&Hi2c, Epoch[i].device, Epoch[i].reg, I2C_MEMADD_SIZE_8BIT, Epoch[i].data,
+						 Epoch[i].length, OLD_TIMEOUT);
+	}
+	return HalSim_Now_Ns() - start;
+}
+
+static uint8_t Count_Status(uint8_t status)
+{
+	uint8_t i, n = 0;
+
+	for (i = 0; i < TEMP_SENSORS + 1; i++) n += Epoch[i].status == status;
+	return n;
+}
+
+static void Test_Epochs(void)
+{
+	const SensorBusStats *stats = SensorBus_Get_Stats();
+	uint64_t good, nack, stuck, after, blocking, goodCall, nackCall, stuckCall, afterCall;
+	uint32_t timeouts;
+	uint8_t i;
+
+	/*Every sensor answers*/
+	Setup();
+	good = Run_Epoch(&goodCall);
+	CHECK(Count_Status(SENSOR_BUS_OK) == TEMP_SENSORS + 1);
+	for (i = 0; i < TEMP_SENSORS; i++) CHECK(TempRaw[i][0] == 20 + i);
+	CHECK(GaugeRaw[0] == 87);
+	CHECK(stats->last_duration <= 5);
+
+	/*Sensor 3 does not acknowledge: only its reading fails, at once*/
+	HalSim_I2c_Set_Fault(TempAddr[3], HALSIM_I2C_NACK);
+	nack = Run_Epoch(&nackCall);
+	CHECK(Epoch[3].status == SENSOR_BUS_ERROR && Count_Status(SENSOR_BUS_OK) == TEMP_SENSORS);
+	CHECK(nack < good);
+	HalSim_I2c_Set_Fault(TempAddr[3], HALSIM_I2C_OK);
+
+	/*Sensor 2 holds SDA low: aborted after its timeout, released, the others read*/
+	timeouts = stats->timeouts;
+	HalSim_I2c_Set_Fault(TempAddr[2], HALSIM_I2C_STUCK);
+	stuck = Run_Epoch(&stuckCall);
+	CHECK(Epoch[2].status == SENSOR_BUS_TIMEOUT_ERROR && Count_Status(SENSOR_BUS_OK) == TEMP_SENSORS);
+	CHECK(stats->timeouts == timeouts + 1 && stats->recoveries == 1 && HalSim_I2c_Get_Stats()->recoveries == 1);
+	CHECK(stuck < good + (SENSOR_BUS_TIMEOUT + 2) * 1000000ULL);
+	/*The recovery is the longest call: 10 clocks of 10 us*/
+	CHECK(stuckCall < 200000);
+
+	/*And the bus is free for the next epoch*/
+	after = Run_Epoch(&afterCall);
+	CHECK(Count_Status(SENSOR_BUS_OK) == TEMP_SENSORS + 1 && stats->timeouts == timeouts + 1);
+
+	BENCH("epoch of %u reads (sensor_bus): %.2f ms all present, %.2f ms with a NACK, %.2f ms with a stuck sensor, %.2f ms after it",
+		  TEMP_SENSORS + 1, good / 1e6, nack / 1e6, stuck / 1e6, after / 1e6);
+	BENCH("longest SensorBus_Process call: %.1f us, %.1f us with the recovery of the stuck sensor",
+		  goodCall / 1e3, stuckCall / 1e3);
+
+	/*The blocking reads of the previous code, the whole epoch in one call*/
+	Setup();
+	good = Run_Blocking();
+	HalSim_I2c_Set_Fault(TempAddr[2], HALSIM_I2C_STUCK);
+	blocking = Run_Blocking();
+	BENCH("blocking reads: %.2f ms all present, %.0f ms with the stuck sensor (main loop stalled as long)",
+		  good / 1e6, blocking / 1e6);
+	CHECK(blocking > OLD_TIMEOUT * 1000000ULL && blocking > 100 * stuck);
+}
+
+int main(void)
+{
+	Test_Epochs();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,155 @@
+/*!
+ * \file      test_sensor_conv.c
+ *
+ * \brief     Fixed-point conversions of sensor_conv.c: every 16-bit count of
+ * 			  every channel against the conversion in double precision (and
+ * 			  against the float code of the previous sensorReadings, truncated
+ * 			  into its storage), a checksum of all of them to compare with the
+ * 			  target, the calibrations, and the cost of a batch next to the
+ * 			  float and libm conversion.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "host_test.h"
+#include "sensor_conv.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define BENCH_BATCHES	2000000
+
+/*Scales of sensor_conv.c, units per count*/
+static const double Scale[SENSOR_CONV_CHANNELS] = {
+	0.0625, 0.0625, 0.0625, 0.0625, 0.0625, 0.0625, 0.125, 4.88 / 100, 1.5625e-6 / 0.015 * 10,
+};
+
+static double Saturate(double value, SensorConvChannel channel)
+{
+	const SensorCalibration *calibration = SensorConv_Get_Calibration(channel);
+
+	if (value < calibration->min) return calibration->min;
+	if (value > calibration->max) return calibration->max;
+	return value;
+}
+
+/*The previous code: a float product truncated by the assignment, the current scale with pow as it was*/
+__attribute__((noinline)) static int16_t Old_Convert(SensorConvChannel channel, int16_t count)
+{
+	float value;
+
+	if (channel == SENSOR_CONV_CURRENT) value = count * (Scale[channel] / 1e-4) * pow(10, -4);
+	else value = count * (float)Scale[channel];
+	return (int16_t)Saturate(value, channel);
+}
+
+static void Test_Accuracy(void)
+{
+	uint32_t fixedWrong, oldWrong, checksum = 0;
+	int32_t count, fixedMax, oldMax, error;
+	int16_t value;
+	double reference;
+	uint8_t channel;
+
+	for (channel = 0; channel < SENSOR_CONV_CHANNELS; channel++) {
+		fixedWrong = oldWrong = 0;
+		fixedMax = oldMax = 0;
+		for (count = INT16_MIN; count <= INT16_MAX; count++) {
+			reference = Saturate(floor(count * Scale[channel] + 0.5), channel);
+			value = SensorConv_Convert(channel, (int16_t)count);
+			checksum = checksum * 31 + (uint16_t)value;
+
+			error = abs(value - (int32_t)reference);
+			fixedWrong += error != 0;
+			if (error > fixedMax) fixedMax = error;
+			error = abs(Old_Convert(channel, (int16_t)count) - (int32_t)reference);
+			oldWrong += error != 0;
+			if (error > oldMax) oldMax = error;
+		}
+		if (channel == SENSOR_CONV_TEMP1 || channel >= SENSOR_CONV_TEMP_BATT) {
+			BENCH("channel %u, 65536 counts: fixed point %5u off by at most %d, float truncated %5u off by at most %d",
+				  channel, fixedWrong, fixedMax, oldWrong, oldMax);
+		}
+		/*The Q24 gain is off by 2^-25 at most: only the counts next to a tie can round the other way*/
+		CHECK(fixedMax <= 1 && fixedWrong < 65536 / 1000);
+		CHECK(fixedWrong < oldWrong);
+	}
+	/*The same on the target: integer arithmetic only*/
+	BENCH("checksum of every conversion: 0x%08x", checksum);
+	CHECK(checksum == 0x4e7f5aa0U);
+
+	/*TMP102: 12 bits left aligned, negative temperatures*/
+	CHECK(SensorConv_Tmp102_Count((const uint8_t[]){ 0x19, 0x00 }) == 400);		/*25 degC*/
+	CHECK(SensorConv_Tmp102_Count((const uint8_t[]){ 0xE7, 0x00 }) == -400);	/*-25 degC*/
+	CHECK(SensorConv_Convert(SENSOR_CONV_TEMP1, -400) == -25);
+}
+
+static void Test_Calibration(void)
+{
+	SensorCalibration calibration = *SensorConv_Get_Calibration(SENSOR_CONV_TEMP3);
+	int16_t counts[SENSOR_CONV_CHANNELS], values[SENSOR_CONV_CHANNELS];
+	uint8_t i;
+
+	/*Sensor 3 reads 1.5 degC high*/
+	calibration.offset = -(int32_t)(1.5 * SENSOR_CONV_ONE);
+	CHECK(SensorConv_Set_Calibration(SENSOR_CONV_TEMP3, &calibration));
+	for (i = 0; i < SENSOR_CONV_CHANNELS; i++) counts[i] = 400;
+	SensorConv_Convert_Batch(SENSOR_CONV_TEMP1, counts, values, SENSOR_CONV_CHANNELS);
+	CHECK(values[SENSOR_CONV_TEMP2] == 25 && values[SENSOR_CONV_TEMP3] == 24 && values[SENSOR_CONV_TEMP_BATT] == 50);
+
+	/*Past the end of the channels: only the ones that exist*/
+	values[2] = 0x7777;
+	SensorConv_Convert_Batch(SENSOR_CONV_CURRENT - 1, counts, values, 3);
+	CHECK(values[2] == 0x7777);
+	values[0] = 0x7777;
+	SensorConv_Convert_Batch(SENSOR_CONV_CHANNELS, counts, values, 1);
+	SensorConv_Convert_Batch((SensorConvChannel)0xFF, counts, values, 1);
+	CHECK(values[0] == 0x7777);
+
+	calibration.min = 10;
+	calibration.max = 0;
+	CHECK(!SensorConv_Set_Calibration(SENSOR_CONV_TEMP3, &calibration));
+	CHECK(!SensorConv_Set_Calibration(SENSOR_CONV_CHANNELS, &calibration));
+	SensorConv_Reset_Calibration();
+	CHECK(SensorConv_Convert(SENSOR_CONV_TEMP3, 400) == 25);
+}
+
+static void Bench_Speed(void)
+{
+	int16_t counts[SENSOR_CONV_CHANNELS], values[SENSOR_CONV_CHANNELS];
+	volatile int32_t sink = 0;
+	uint64_t start, fixedNs, oldNs;
+	uint32_t i;
+	uint8_t channel;
+
+	for (channel = 0; channel < SENSOR_CONV_CHANNELS; channel++) counts[channel] = 300 + channel;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_BATCHES; i++) {
+		counts[0] = (int16_t)i;
+		SensorConv_Convert_Batch(SENSOR_CONV_TEMP1, counts, values, SENSOR_CONV_CHANNELS);
+		sink += values[0] + values[SENSOR_CONV_CURRENT];
+	}
+	fixedNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_BATCHES; i++) {
+		counts[0] = (int16_t)i;
+		for (channel = 0; channel < SENSOR_CONV_CHANNELS; channel++) values[channel] = Old_Convert(channel, counts[channel]);
+		sink += values[0] + values[SENSOR_CONV_CURRENT];
+	}
+	oldNs = Host_Clock_Ns() - start;
+
+	/*On the Cortex-M4 the doubles and pow are soft-float calls, the gap is wider there*/
+	BENCH("%u channels (host): fixed-point batch %.1f ns, float and pow %.1f ns",
+		  SENSOR_CONV_CHANNELS, (double)fixedNs / BENCH_BATCHES, (double)oldNs / BENCH_BATCHES);
+	CHECK(fixedNs < oldNs);
+}
+
+int main(void)
+{
+	Test_Accuracy();
+	Test_Calibration();
+	Bench_Speed();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,177 @@
+/*!
+ * \file      test_sensor_readings.c
+ *
+ * \brief     sensorReadings (sensorReadings.c) run as the sensors task of
+ * 			  main.c on the simulated bus with the fuel gauge present and the
+ * 			  TMP102 not defined yet: the snapshot and the memory after an epoch,
+ * 			  a gauge that stops answering; then the checks of the health task
+ * 			  (system_state, checkbatteries, checktemperature of
+ * 			  configuration.c) against the thresholds in memory.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "configuration.h"
+#include "sensorReadings.h"
+#include "fuel_gauge.h"
+#include "flash_cache.h"
+#include "flash_log.h"
+#include "hk_log.h"
+#include "hk_stats.h"
+#include "scheduler.h"
+#include "timer.h"
+
+#define FUEL_GAUGE_US		100			/*Conversion wait of the gauge*/
+#define EPOCH_MAX_MS		50
+
+static I2C_HandleTypeDef Hi2c;
+static uint8_t Gauge[256];
+
+static void Sensors_Task(void)
+{
+	sensorReadings(&Hi2c);
+}
+
+static const SchedulerTask SensorsTask = { "sensors", Sensors_Task, 1000, 0, SCHEDULER_EVENT_SENSORS, 2 };
+
+/*Registers of the gauge, left aligned and MSB first as the DS2782*/
+static void Set_Gauge(uint8_t level, int16_t current, int16_t temperature, int16_t voltage)
+{
+	Gauge[FUEL_GAUGE_REG_LEVEL] = level;
+	Gauge[FUEL_GAUGE_REG_CURRENT] = (uint16_t)current >> 8;
+	Gauge[FUEL_GAUGE_REG_CURRENT + 1] = (uint8_t)current;
+	Gauge[FUEL_GAUGE_REG_TEMPERATURE] = (uint16_t)(temperature << 5) >> 8;
+	Gauge[FUEL_GAUGE_REG_TEMPERATURE + 1] = (uint8_t)(temperature << 5);
+	Gauge[FUEL_GAUGE_REG_VOLTAGE] = (uint16_t)(voltage << 5) >> 8;
+	Gauge[FUEL_GAUGE_REG_VOLTAGE + 1] = (uint8_t)(voltage << 5);
+}
+
+/*The start of main(): memory, housekeeping, sensors and the sensors task*/
+static void Setup(void)
+{
+	HalSim_Reset();
+	HalSim_Set_Tick_Handler(TimerIrqHandler);
+	Hi2c.Instance = I2C1;
+	Hi2c.Init.ClockSpeed = 100000;
+	HAL_I2C_Init(&Hi2c);
+	memset(Gauge, 0, sizeof(Gauge));
+	Set_Gauge(87, 4800, 200, 758);	/*87 %, 0.5 A, 25 degC, 3.7 V*/
+	HalSim_I2c_Add(BATTSENSOR_ADDR, Gauge, FUEL_GAUGE_US);
+
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HkLog_Init();
+	HkStats_Init();
+	sensorReadingsInit(&Hi2c);
+	Scheduler_Init();
+	Scheduler_Add(&SensorsTask);
+}
+
+/*Main loop until the next epoch is published, false if it did not end in EPOCH_MAX_MS*/
+static bool Run_Epoch(void)
+{
+	const SensorSnapshot *snapshot = getSensorSnapshot();
+	uint32_t epoch = snapshot->epoch;
+	uint64_t start;
+
+	Scheduler_Post(SCHEDULER_EVENT_SENSORS);
+	start = HalSim_Now_Ns();
+	while (snapshot->epoch == epoch) {
+		if (HalSim_Now_Ns() - start > EPOCH_MAX_MS * 1000000ULL) return false;
+		if (!Scheduler_Run_Once()) __WFI();
+	}
+	return true;
+}
+
+static uint8_t Read_Byte(uint32_t address)
+{
+	uint8_t value;
+
+	Read_Flash(address, &value, 1);
+	return value;
+}
+
+static void Test_Epoch(void)
+{
+	const SensorSnapshot *snapshot = getSensorSnapshot();
+	uint16_t gaugeValid = SENSOR_VALID_TEMP_BATT | SENSOR_VALID_VOLTAGE | SENSOR_VALID_CURRENT |
+						  SENSOR_VALID_BATT_LEVEL;
+
+	Setup();
+	CHECK(Run_Epoch());
+	/*The TMP102 have no address yet: only the readings of the gauge are valid*/
+	CHECK(snapshot->valid == gaugeValid);
+	CHECK(snapshot->battery_level == 87);
+	CHECK(snapshot->voltage == 37);
+	CHECK(snapshot->current == 5);
+	CHECK(snapshot->temperatures.fields.tempbatt == 25);
+	CHECK(snapshot->tick == HAL_GetTick() || snapshot->tick + 1 == HAL_GetTick());
+	CHECK(Read_Byte(VOLTAGE_ADDR) == 37);
+	CHECK((int8_t)Read_Byte(CURRENT_ADDR) == 5);
+	CHECK(Read_Byte(TEMP_ADDR) == 25);		/*tempbatt, before temp1..temp6*/
+
+	/*The gauge stops answering: its readings lose their valid bit and keep their value*/
+	HalSim_I2c_Set_Fault(BATTSENSOR_ADDR, HALSIM_I2C_NACK);
+	CHECK(Run_Epoch());
+	CHECK(snapshot->valid == 0);
+	CHECK(snapshot->battery_level == 87 && snapshot->voltage == 37 && snapshot->current == 5);
+	CHECK(snapshot->epoch == 2);
+}
+
+static void Test_System_State(void)
+{
+	uint8_t nominal = 80;
+
+	Setup();
+	Write_Flash(NOMINAL_ADDR, &nominal, 1);
+	CHECK(Run_Epoch());
+	CHECK(system_state(&Hi2c));
+	CHECK(Read_Byte(BATT_LEVEL_ADDR) == 87);
+
+	/*Below the threshold*/
+	Set_Gauge(70, 4800, 200, 758);
+	CHECK(Run_Epoch());
+	CHECK(!system_state(&Hi2c));
+	CHECK(Read_Byte(BATT_LEVEL_ADDR) == 70);
+
+	/*A failed reading does not change the level in memory*/
+	HalSim_I2c_Set_Fault(BATTSENSOR_ADDR, HALSIM_I2C_NACK);
+	Set_Gauge(95, 4800, 200, 758);
+	CHECK(Run_Epoch());
+	CHECK(!system_state(&Hi2c));
+	CHECK(Read_Byte(BATT_LEVEL_ADDR) == 70);
+	nominal = 60;
+	Write_Flash(NOMINAL_ADDR, &nominal, 1);
+	CHECK(system_state(&Hi2c));
+}
+
+/*More than 3 of the 6 panels above TEMP_MAX*/
+static void Test_Temperature(void)
+{
+	Temperatures temp;
+
+	Setup();
+	memset(&temp, 0, sizeof(temp));
+	temp.fields.temp1 = TEMP_MAX + 1;
+	temp.fields.temp3 = TEMP_MAX + 1;
+	temp.fields.temp6 = TEMP_MAX + 1;
+	Write_Flash(TEMP_ADDR, (uint8_t *)temp.raw, sizeof(temp));
+	CHECK(checktemperature(&Hi2c));
+	temp.fields.temp4 = TEMP_MAX + 1;
+	Write_Flash(TEMP_ADDR, (uint8_t *)temp.raw, sizeof(temp));
+	CHECK(!checktemperature(&Hi2c));
+	temp.fields.temp4 = TEMP_MAX;
+	Write_Flash(TEMP_ADDR, (uint8_t *)temp.raw, sizeof(temp));
+	CHECK(checktemperature(&Hi2c));
+}
+
+int main(void)
+{
+	Test_Epoch();
+	Test_System_State();
+	Test_Temperature();
+	return HOST_TEST_END();
+}
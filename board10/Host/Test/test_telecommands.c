@@ -0,0 +1,134 @@
+/*!
+ * \file      test_telecommands.c
+ *
+ * \brief     process_telecommand (telecommands.c) on the simulated memory: the
+ * 			  thresholds and flags it stores, the SF and CR given to the link
+ * 			  adaptation, the reset after the write-back of the RAM copy, the
+ * 			  sends that only read; then the beacon of buildTelemetry unpacked
+ * 			  as the ground station does.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "telecommands.h"
+#include "flash_log.h"
+
+static void Setup(void)
+{
+	HalSim_Reset();
+	Flash_Log_Init();
+	Flash_Cache_Init();
+	HkLog_Init();
+	HkStats_Init();
+	LinkAdapt_Init(NULL);
+	Scheduler_Init();
+	currentState = INIT;
+}
+
+static uint8_t Read_Byte(uint32_t address)
+{
+	uint8_t value;
+
+	Read_Flash(address, &value, 1);
+	return value;
+}
+
+static void Test_Stored(void)
+{
+	Setup();
+	process_telecommand(NOMINAL, 75);
+	process_telecommand(LOW, 60);
+	process_telecommand(CRITICAL, 50);
+	process_telecommand(SET_CONSTANT_KP, 12);
+	CHECK(Read_Byte(NOMINAL_ADDR) == 75);
+	CHECK(Read_Byte(LOW_ADDR) == 60);
+	CHECK(Read_Byte(CRITICAL_ADDR) == 50);
+	CHECK(Read_Byte(KP_ADDR) == 12);
+
+	/*The payload flag is a byte set to TRUE, not the contents of address TRUE*/
+	process_telecommand(TAKEPHOTO, 0);
+	CHECK(Read_Byte(PAYLOAD_STATE_ADDR) == TRUE);
+}
+
+/*The values kept in RAM reach the flash before the reset*/
+static void Test_Reset(void)
+{
+	uint8_t value;
+
+	Setup();
+	process_telecommand(NOMINAL, 75);
+	Read_Flash_Direct(NOMINAL_ADDR, &value, 1);
+	CHECK(value != 75);
+	process_telecommand(RESET2, 1);
+	CHECK(HalSim_System_Resets() == 1);
+	Read_Flash_Direct(NOMINAL_ADDR, &value, 1);
+	CHECK(value == 75);
+}
+
+static void Test_Link(void)
+{
+	const LinkAdaptStats *link = LinkAdapt_Get_Stats();
+
+	Setup();
+	process_telecommand(SET_CRC, 1);
+	process_telecommand(SET_SF, 2);
+	CHECK(Read_Byte(SF_ADDR) == 9 && Read_Byte(CRC_ADDR) == 1);
+	CHECK(link->SpreadingFactor == 9);
+
+	/*Out of range: ignored*/
+	process_telecommand(SET_SF, 6);
+	process_telecommand(SET_CRC, 4);
+	CHECK(Read_Byte(SF_ADDR) == 9 && Read_Byte(CRC_ADDR) == 1);
+	CHECK(link->SpreadingFactor == 9);
+}
+
+/*Nothing logged yet: the sends build nothing and write nothing*/
+static void Test_Sends(void)
+{
+	uint32_t programs;
+
+	Setup();
+	Flash_Cache_Flush();
+	programs = HalSim_Flash_Get_Stats()->programs;
+	process_telecommand(SEND_HK_LOG, 1);
+	process_telecommand(SEND_HK_STATS, HK_STATS_ORBIT);
+	process_telecommand(SEND_TRACE, 0);
+	process_telecommand(SEND_CONFIG, 0);
+	process_telecommand(SENDTELEMETRY, 0);
+	CHECK(HalSim_Flash_Get_Stats()->programs == programs);
+}
+
+static void Test_Telemetry(void)
+{
+	uint8_t frame[TELEMETRY_MAX_SIZE], deployed = TRUE, stowed = FALSE, size;
+	int32_t values[TELEMETRY_FIELD_COUNT];
+
+	Setup();
+	process_telecommand(SET_SF, 3);
+	Write_Flash(DEPLOYMENT_STATE_ADDR, &deployed, 1);
+	Write_Flash(DEPLOYMENTRF_STATE_ADDR, &stowed, 1);
+	currentState = PAYLOAD;
+	HalSim_Advance_Ns(5 * 1000000000ULL);
+
+	size = buildTelemetry(frame);
+	CHECK(size == TELEMETRY_FRAME_SIZE);
+	CHECK(Telemetry_Unpack(frame, size, values));
+	CHECK(values[TELEMETRY_TIME] == (int32_t)HkLog_Time());
+	CHECK(values[TELEMETRY_STATE] == PAYLOAD);
+	CHECK(values[TELEMETRY_DEPLOYMENT] == 1 && values[TELEMETRY_DEPLOYMENT_RF] == 0);
+	CHECK(values[TELEMETRY_SENSORS_VALID] == 0);	/*No epoch yet*/
+	CHECK(values[TELEMETRY_SF] == 10);
+}
+
+int main(void)
+{
+	Test_Stored();
+	Test_Reset();
+	Test_Link();
+	Test_Sends();
+	Test_Telemetry();
+	return HOST_TEST_END();
+}
@@ -0,0 +1,148 @@
+/*!
+ * \file      test_telemetry.c
+ *
+ * \brief     Bit-packed telemetry frame (telemetry.c): random frames packed and
+ * 			  unpacked back, the saturation at the limits of every field and the
+ * 			  frames that are not of this schema; then the bytes and the time on
+ * 			  air of a beacon at every SF against the same fields in whole bytes,
+ * 			  and the cost of packing and unpacking a frame.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "host_test.h"
+#include "telemetry.h"
+#include "lora_toa.h"
+#include "link_sim.h"
+#include <string.h>
+
+#define FRAMES			100000
+#define BENCH_FRAMES	2000000
+
+#define FIELD_BITS(name, bits, min)		bits,
+#define FIELD_MIN(name, bits, min)		min,
+
+static const uint8_t Bits[TELEMETRY_FIELD_COUNT] = { TELEMETRY_FIELDS(FIELD_BITS) };
+static const int32_t Min[TELEMETRY_FIELD_COUNT] = { TELEMETRY_FIELDS(FIELD_MIN) };
+
+static uint32_t Seed = 3;
+
+static int32_t Max(uint8_t f)
+{
+	return (int32_t)(Min[f] + (int64_t)((1ULL << Bits[f]) - 1));
+}
+
+static int32_t Random(uint8_t f)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return (int32_t)(Min[f] + (int64_t)((Seed >> 4) & ((1ULL << Bits[f]) - 1)));
+}
+
+/*The same fields in whole bytes, little-endian, as the unions of definitions.h*/
+__attribute__((noinline)) static uint8_t Aligned_Pack(const int32_t *values, uint8_t *frame)
+{
+	uint8_t *p = frame, f, b;
+
+	*p++ = TELEMETRY_FRAME_ID;
+	for (f = 0; f < TELEMETRY_FIELD_COUNT; f++) {
+		for (b = 0; b < Bits[f]; b += 8) *p++ = (uint8_t)((uint32_t)values[f] >> b);
+	}
+	return (uint8_t)(p - frame);
+}
+
+static void Test_Frames(void)
+{
+	int32_t values[TELEMETRY_FIELD_COUNT], read[TELEMETRY_FIELD_COUNT];
+	uint8_t frame[TELEMETRY_MAX_SIZE];
+	uint32_t i, wrong = 0;
+	uint8_t f;
+
+	for (i = 0; i < FRAMES; i++) {
+		for (f = 0; f < TELEMETRY_FIELD_COUNT; f++) values[f] = Random(f);
+		CHECK(Telemetry_Pack(values, frame) == TELEMETRY_FRAME_SIZE);
+		wrong += !Telemetry_Unpack(frame, TELEMETRY_FRAME_SIZE, read) || memcmp(values, read, sizeof(values)) != 0;
+	}
+	CHECK(wrong == 0);
+
+	/*Out of range: the nearest limit of the field*/
+	for (f = 0; f < TELEMETRY_FIELD_COUNT; f++) values[f] = (f & 1) ? INT32_MIN : INT32_MAX;
+	Telemetry_Pack(values, frame);
+	CHECK(Telemetry_Unpack(frame, TELEMETRY_FRAME_SIZE, read));
+	for (f = 0, wrong = 0; f < TELEMETRY_FIELD_COUNT; f++) wrong += read[f] != ((f & 1) ? Min[f] : Max(f));
+	CHECK(wrong == 0);
+
+	/*The padding of the last byte is 0*/
+	if (TELEMETRY_BITS % 8) CHECK((frame[TELEMETRY_FRAME_SIZE - 1] >> (TELEMETRY_BITS % 8)) == 0);
+
+	/*Another schema or a short frame*/
+	CHECK(!Telemetry_Unpack(frame, TELEMETRY_FRAME_SIZE - 1, read));
+	frame[0] ^= 1;
+	CHECK(!Telemetry_Unpack(frame, TELEMETRY_FRAME_SIZE, read));
+}
+
+static void Bench_Airtime(void)
+{
+	LoraToaParams params;
+	uint32_t packedUs, alignedUs;
+	uint8_t sf;
+
+	BENCH("beacon of %u fields: %u bits, %u bytes packed, %u bytes in whole bytes",
+		  TELEMETRY_FIELD_COUNT, TELEMETRY_BITS, TELEMETRY_FRAME_SIZE, TELEMETRY_ALIGNED_SIZE);
+	for (sf = 7; sf <= 12; sf++) {
+		LinkSim_Params(&params, sf);
+		packedUs = LoraToa_Compute_Us(&params, TELEMETRY_FRAME_SIZE);
+		alignedUs = LoraToa_Compute_Us(&params, TELEMETRY_ALIGNED_SIZE);
+		/*The preamble and the header do not shrink: the saving is less than the bytes*/
+		BENCH("SF%-2u BW125 CR4/5: %7.1f ms packed, %7.1f ms in whole bytes (-%.0f%%)",
+			  sf, packedUs / 1e3, alignedUs / 1e3, 100.0 * (alignedUs - packedUs) / alignedUs);
+		CHECK(packedUs < alignedUs);
+	}
+	CHECK(TELEMETRY_FRAME_SIZE * 4 < TELEMETRY_ALIGNED_SIZE * 3);
+}
+
+static void Bench_Cost(void)
+{
+	int32_t values[TELEMETRY_FIELD_COUNT], read[TELEMETRY_FIELD_COUNT];
+	uint8_t frame[TELEMETRY_MAX_SIZE];
+	volatile uint32_t sink = 0;
+	uint64_t start, packNs, unpackNs, alignedNs;
+	uint32_t i;
+	uint8_t f;
+
+	for (f = 0; f < TELEMETRY_FIELD_COUNT; f++) values[f] = Random(f);
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_FRAMES; i++) {
+		values[0] = (int32_t)i;
+		sink += Telemetry_Pack(values, frame) + frame[1];
+	}
+	packNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_FRAMES; i++) {
+		frame[1] = (uint8_t)i;
+		sink += Telemetry_Unpack(frame, TELEMETRY_FRAME_SIZE, read) + read[0];
+	}
+	unpackNs = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_FRAMES; i++) {
+		values[0] = (int32_t)i;
+		sink += Aligned_Pack(values, frame) + frame[1];
+	}
+	alignedNs = Host_Clock_Ns() - start;
+
+	/*A beacon every few seconds: far below the airtime either way*/
+	BENCH("per frame (host): pack %.1f ns, unpack %.1f ns, whole bytes %.1f ns",
+		  (double)packNs / BENCH_FRAMES, (double)unpackNs / BENCH_FRAMES, (double)alignedNs / BENCH_FRAMES);
+	CHECK(packNs / BENCH_FRAMES < 1000 && sink != 0);
+}
+
+int main(void)
+{
+	Test_Frames();
+	Bench_Airtime();
+	Bench_Cost();
+	return HOST_TEST_END();
+}
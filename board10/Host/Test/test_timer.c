@@ -0,0 +1,263 @@
+/*!
+ * \file      test_timer.c
+ *
+ * \brief     Timing wheel of timer.c against the sorted delta list of the
+ * 			  Semtech driver it replaces, with 1000 timers of 1 ms to 60 s:
+ * 			  every timer expires on its tick, the time to the next event for
+ * 			  the tickless idle, the catch-up after an hour asleep, and the
+ * 			  cost of a start, of a restart (as the CAD and RX timeouts of
+ * 			  comms.c) and of the ticks and expiries.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "timer.h"
+#include <string.h>
+
+#define TIMERS			1000
+#define MAX_DELAY_MS	60000
+#define RESTARTS		200000
+#define SLEEP_MS		3600000
+
+/*
+ * The delta list of the previous timer.c: every timer keeps the time after the
+ * one before it. A start looks for the timer in the whole list (TimerExists) and
+ * walks it to the insertion point, a stop walks it to the timer.
+ */
+typedef struct ListTimer_s {
+	uint32_t Delta;
+	uint32_t Reload;
+	bool Running;
+	struct ListTimer_s *Next;
+} ListTimer;
+
+static ListTimer *ListHead;
+static uint32_t ListTime;		/*Time the delta of the head counts from*/
+
+static bool List_Exists(ListTimer *obj)
+{
+	ListTimer *cur;
+
+	for (cur = ListHead; cur != NULL; cur = cur->Next) {
+		if (cur == obj) return true;
+	}
+	return false;
+}
+
+static void List_Start(ListTimer *obj, uint32_t now)
+{
+	ListTimer **link = &ListHead;
+	uint32_t delta = now - ListTime + obj->Reload;
+
+	if (List_Exists(obj)) return;
+	while (*link != NULL && (*link)->Delta <= delta) {
+		delta -= (*link)->Delta;
+		link = &(*link)->Next;
+	}
+	if (*link != NULL) (*link)->Delta -= delta;
+	obj->Delta = delta;
+	obj->Next = *link;
+	obj->Running = true;
+	*link = obj;
+}
+
+static void List_Stop(ListTimer *obj)
+{
+	ListTimer **link = &ListHead;
+
+	while (*link != NULL && *link != obj) link = &(*link)->Next;
+	if (*link == NULL) return;
+	if (obj->Next != NULL) obj->Next->Delta += obj->Delta;
+	*link = obj->Next;
+	obj->Running = false;
+}
+
+static uint32_t List_Tick(uint32_t now)
+{
+	uint32_t expired = 0;
+	ListTimer *head;
+
+	while ((head = ListHead) != NULL && now - ListTime >= head->Delta) {
+		ListTime += head->Delta;
+		ListHead = head->Next;
+		head->Running = false;
+		expired++;
+	}
+	return expired;
+}
+
+static TimerEvent_t Timers[TIMERS];
+static ListTimer ListTimers[TIMERS];
+static uint32_t Delays[TIMERS];
+static uint16_t Due[MAX_DELAY_MS + 2];		/*Timers expiring at each ms*/
+static uint32_t Expired;
+static uint32_t Seed;
+
+static uint32_t Random(void)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return Seed >> 8;
+}
+
+/*Middle of the ms of the tick, whatever the HAL_GetTick calls cost*/
+static void To_Tick(uint32_t tick)
+{
+	HalSim_Advance_Ns((uint64_t)tick * 1000000 + 500000 - HalSim_Now_Ns());
+}
+
+static void On_Expiry(void)
+{
+	Expired++;
+}
+
+/*1000 timers started at tick 0: every tick expires the ones due, the next event is never late*/
+static void Test_Expiry(void)
+{
+	TimerTime_t next;
+	uint32_t i, t, first = 1, late = 0, wakeups = 0, wrong = 0, now;
+
+	memset(Due, 0, sizeof(Due));
+	Seed = 5;
+	for (i = 0; i < TIMERS; i++) {
+		Delays[i] = (i < 64) ? i + 1 : Random() % MAX_DELAY_MS + 1;	/*Every level of the wheel*/
+		TimerInit(&Timers[i], On_Expiry);
+		TimerSetValue(&Timers[i], Delays[i]);
+	}
+	now = HAL_GetTick();
+	for (i = 0; i < TIMERS; i++) {
+		TimerStart(&Timers[i]);
+		Due[Delays[i]]++;
+	}
+	/*Stopped and started again: the same expiry*/
+	for (i = 0; i < TIMERS; i += 7) TimerReset(&Timers[i]);
+
+	Expired = 0;
+	for (t = 1; t <= MAX_DELAY_MS + 1; t++) {
+		while (first <= MAX_DELAY_MS && Due[first] == 0) first++;
+		next = TimerGetTimeToNextEvent();
+		/*Never after the first expiry, before it only for a cascade*/
+		if (first <= MAX_DELAY_MS && next > first - (t - 1)) late++;
+		if (next == 1 && Due[t] == 0) wakeups++;
+		To_Tick(now + t);
+		TimerIrqHandler();
+		if (Expired != Due[t]) wrong++;
+		if (t == first) first++;
+		Expired = 0;
+	}
+	CHECK(HAL_GetTick() == now + MAX_DELAY_MS + 1);
+	CHECK(wrong == 0 && late == 0);
+	CHECK(TimerGetTimeToNextEvent() == TIMER_NO_EVENT);
+	BENCH("%u timers of 1 ms to %u s, every one on its tick, %u ticks woken only for a cascade",
+		  TIMERS, MAX_DELAY_MS / 1000, wakeups);
+
+	/*Tickless: the ticks missed are caught up in one call*/
+	TimerSetValue(&Timers[0], 50);
+	TimerStart(&Timers[0]);
+	CHECK(TimerGetTimeToNextEvent() <= 50);
+	To_Tick(HAL_GetTick() + 80);
+	TimerIrqHandler();
+	CHECK(Expired == 1 && !Timers[0].IsRunning);
+}
+
+/*An hour asleep with 1000 timers: one call expires them all, it jumps from event to event*/
+static void Test_Sleep(void)
+{
+	uint64_t start, elapsed;
+	uint32_t i;
+
+	Seed = 11;
+	for (i = 0; i < TIMERS; i++) {
+		TimerSetValue(&Timers[i], Random() % SLEEP_MS + 1);
+		TimerStart(&Timers[i]);
+	}
+	Expired = 0;
+	To_Tick(HAL_GetTick() + SLEEP_MS + 1);
+	start = Host_Clock_Ns();
+	TimerIrqHandler();
+	elapsed = Host_Clock_Ns() - start;
+
+	BENCH("catch-up of %u s asleep with %u timers: %.1f us", SLEEP_MS / 1000, TIMERS, elapsed / 1000.0);
+	CHECK(Expired == TIMERS && TimerGetTimeToNextEvent() == TIMER_NO_EVENT);
+	/*A step per tick is 3.6 million steps, tens of ms*/
+	CHECK(elapsed < 5000000);
+
+	for (i = 0; i < TIMERS; i++) TimerSetValue(&Timers[i], Delays[i]);
+}
+
+static void Bench_Cost(void)
+{
+	uint64_t start, wheelStart, listStart, wheelRestart, listRestart, wheelRun, listRun, baseRun;
+	uint32_t i, t, now, expired = 0;
+
+	/*Start*/
+	TimerSetValue(&Timers[0], Delays[0]);
+	start = Host_Clock_Ns();
+	for (i = 0; i < TIMERS; i++) TimerStart(&Timers[i]);
+	wheelStart = Host_Clock_Ns() - start;
+
+	ListHead = NULL;
+	now = ListTime = HAL_GetTick();
+	for (i = 0; i < TIMERS; i++) ListTimers[i].Reload = Delays[i];
+	start = Host_Clock_Ns();
+	for (i = 0; i < TIMERS; i++) List_Start(&ListTimers[i], now);
+	listStart = Host_Clock_Ns() - start;
+
+	/*Restart of a running timer (TimerReset), the list needs the stop first*/
+	Seed = 9;
+	start = Host_Clock_Ns();
+	for (i = 0; i < RESTARTS; i++) TimerReset(&Timers[Random() % TIMERS]);
+	wheelRestart = Host_Clock_Ns() - start;
+
+	Seed = 9;
+	start = Host_Clock_Ns();
+	for (i = 0; i < RESTARTS; i++) {
+		t = Random() % TIMERS;
+		List_Stop(&ListTimers[t]);
+		List_Start(&ListTimers[t], now);
+	}
+	listRestart = Host_Clock_Ns() - start;
+
+	/*Every tick until all of them expired; the simulated clock alone is taken off*/
+	Expired = 0;
+	start = Host_Clock_Ns();
+	for (t = 1; t <= MAX_DELAY_MS + 1; t++) {
+		To_Tick(now + t);
+		TimerIrqHandler();
+	}
+	wheelRun = Host_Clock_Ns() - start;
+
+	start = Host_Clock_Ns();
+	for (t = 1; t <= MAX_DELAY_MS + 1; t++) {
+		To_Tick(now + MAX_DELAY_MS + 1 + t);
+		HAL_GetTick();
+	}
+	baseRun = Host_Clock_Ns() - start;
+	wheelRun = wheelRun > baseRun ? wheelRun - baseRun : 0;
+
+	/*The list has its own time, no simulated clock*/
+	start = Host_Clock_Ns();
+	for (t = 1; t <= MAX_DELAY_MS + 1; t++) expired += List_Tick(now + t);
+	listRun = Host_Clock_Ns() - start;
+
+	BENCH("%u timers (host): start wheel %6.1f ns, list %7.1f ns; restart wheel %6.1f ns, list %7.1f ns",
+		  TIMERS, (double)wheelStart / TIMERS, (double)listStart / TIMERS,
+		  (double)wheelRestart / RESTARTS, (double)listRestart / RESTARTS);
+	/*The list only wakes for its head (an RTC alarm on the target), the wheel on every tick it has timers*/
+	BENCH("%u s with %u expiries: wheel %5.1f ns per tick, %6.1f ns per expiry with its ticks; list %5.1f ns per expiry",
+		  MAX_DELAY_MS / 1000, Expired, (double)wheelRun / MAX_DELAY_MS, (double)wheelRun / TIMERS,
+		  (double)listRun / TIMERS);
+	CHECK(Expired == TIMERS && expired == TIMERS && ListHead == NULL);
+	CHECK(wheelStart < listStart && wheelRestart * 10 < listRestart);
+}
+
+int main(void)
+{
+	HalSim_Reset();
+	Test_Expiry();
+	Test_Sleep();
+	Bench_Cost();
+	return HOST_TEST_END();
+}
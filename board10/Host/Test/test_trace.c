@@ -0,0 +1,229 @@
+/*!
+ * \file      test_trace.c
+ *
+ * \brief     Probes of trace.c read back through trace_decode.c: the pieces of
+ * 			  one telemetry packet (SEND_TRACE), the records lost by a full
+ * 			  ring and the counter wrapping, a piece sent again until it is
+ * 			  committed; a scheduler run whose Chrome trace
+ * 			  (trace.json, next to the test) matches the statistics of every
+ * 			  task; and the cost of a probe and the bytes of a record.
+ *
+ *
+ * \created on: 16/10/2026
+ */
+
+#include "hal_sim.h"
+#include "host_test.h"
+#include "trace.h"
+#include "trace_decode.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include <math.h>
+
+#define PAIRS			150			/*300 records in a ring of 256*/
+#define GAP_US			7			/*Between two pairs*/
+#define RUN_S			10
+#define BENCH_RECORDS	1000000
+
+static TraceDecoder Decoder;
+
+/*Dumps the ring in packets, returns the bytes*/
+static uint32_t Dump_All(uint32_t *pieces)
+{
+	uint8_t piece[TELEMETRY_MAX_SIZE];
+	uint32_t bytes = 0;
+	uint16_t length;
+
+	while ((length = Trace_Dump(piece, sizeof(piece))) != 0) {
+		CHECK(TraceDecode_Piece(&Decoder, piece, length));
+		bytes += length;
+		if (pieces != NULL) (*pieces)++;
+	}
+	return bytes;
+}
+
+static uint32_t Pair_Us(uint32_t pair)
+{
+	return pair % 50 * 10 + 10;
+}
+
+static void Test_Pieces(void)
+{
+	uint8_t piece[TELEMETRY_MAX_SIZE];
+	const TraceDecodeProbe *probe;
+	uint32_t i, pieces = 0, wrong = 0, expected;
+	FILE *out;
+
+	HalSim_Reset();
+	Trace_Init();
+	TraceDecode_Init(&Decoder);
+	CHECK(Trace_Dump(piece, sizeof(piece)) == 0);
+
+	/*The counter wraps 20 ms later, after the records that will be lost*/
+	DWT->CYCCNT = 0xFFFFFFFF - 20 * (SystemCoreClock / 1000);
+	for (i = 0; i < PAIRS; i++) {
+		TRACE_ENTER(TRACE_FLASH_WRITE);
+		HalSim_Advance_Us(Pair_Us(i));
+		TRACE_EXIT(TRACE_FLASH_WRITE);
+		HalSim_Advance_Us(GAP_US);
+	}
+	/*Paused: not recorded*/
+	Trace_Enable(false);
+	TRACE_ENTER(TRACE_FLASH_ERASE);
+	Trace_Enable(true);
+
+	CHECK(Trace_Dump(piece, TRACE_HEADER_SIZE - 1) == 0);
+	Dump_All(&pieces);
+	CHECK(Decoder.Count == TRACE_SIZE && Decoder.Lost == 2 * PAIRS - TRACE_SIZE && Decoder.Rejected == 0);
+	CHECK(Decoder.ClockHz == SystemCoreClock);
+	for (i = 1; i < Decoder.Count; i++) wrong += Decoder.Records[i].Cycles <= Decoder.Records[i - 1].Cycles;
+	CHECK(wrong == 0 && Decoder.Records[Decoder.Count - 1].Cycles > 0xFFFFFFFFULL);
+
+	/*The oldest pairs were overwritten, the others keep their length to a cycle or two*/
+	out = fopen("/dev/null", "w");
+	CHECK(TraceDecode_Chrome(&Decoder, out, NULL, 0) == TRACE_SIZE / 2 && Decoder.Unpaired == 0);
+	fclose(out);
+	probe = &Decoder.Probes[TRACE_FLASH_WRITE];
+	CHECK(probe->Count == TRACE_SIZE / 2);
+	for (i = PAIRS - TRACE_SIZE / 2, expected = 0; i < PAIRS; i++) expected += Pair_Us(i) * (SystemCoreClock / 1000000);
+	CHECK(probe->TotalCycles >= expected && probe->TotalCycles <= expected + 2 * TRACE_SIZE);
+	BENCH("%u records in a ring of %u: %u lost, the others in %u packets of %u bytes, %s",
+		  2 * PAIRS, TRACE_SIZE, Decoder.Lost, pieces, TELEMETRY_MAX_SIZE, wrong ? "out of order" : "in order");
+
+	/*Not a trace*/
+	piece[0] = 'X';
+	CHECK(!TraceDecode_Piece(&Decoder, piece, sizeof(piece)) && Decoder.Rejected == 1);
+}
+
+/*A piece that is not committed is sent again, one overwritten after the peek is not lost*/
+static void Test_Commit(void)
+{
+	uint8_t piece[TELEMETRY_MAX_SIZE], again[TELEMETRY_MAX_SIZE];
+	uint16_t length, count, i;
+
+	HalSim_Reset();
+	Trace_Init();
+	TraceDecode_Init(&Decoder);
+	for (i = 0; i < TRACE_SIZE; i++) {
+		TRACE_ENTER(TRACE_FLASH_WRITE);
+		HalSim_Advance_Us(3);
+	}
+
+	/*Packet lost: the same piece next time*/
+	length = Trace_Peek(piece, sizeof(piece));
+	CHECK(length > TRACE_HEADER_SIZE && Trace_Peek(again, sizeof(again)) == length);
+	CHECK(memcmp(piece, again, length) == 0);
+
+	/*The ring overwrites some of the peeked records before the acknowledgement*/
+	count = piece[3] | (piece[4] << 8);
+	for (i = 0; i < count / 2; i++) TRACE_ENTER(TRACE_FLASH_ERASE);
+	Trace_Commit();
+	CHECK(TraceDecode_Piece(&Decoder, piece, length));
+	while ((length = Trace_Dump(piece, sizeof(piece))) != 0) CHECK(TraceDecode_Piece(&Decoder, piece, length));
+	CHECK(Decoder.Count == (uint32_t)(TRACE_SIZE + count / 2) && Decoder.Lost == 0);
+}
+
+/*
+ * The tasks of test_scheduler.c, shorter: the trace is dumped whenever the
+ * scheduler is idle, as the telecommand would, and both views have to agree.
+ */
+static void Radio_Edge(void)
+{
+	Scheduler_Post(SCHEDULER_EVENT_RADIO);
+	HalSim_Exti_At(HalSim_Now_Ns() + 73000000, Radio_Edge);
+}
+
+static void Radio_Task(void) { HalSim_Advance_Us(150); }
+static void Health_Task(void) { HalSim_Advance_Us(4500); }
+static void Flash_Task(void) { HalSim_Advance_Us(100); }
+static void Telemetry_Task(void) { HalSim_Advance_Us(1200); }
+
+static const SchedulerTask Tasks[] = {
+	{ "radio",		Radio_Task,		0,		5,	SCHEDULER_EVENT_RADIO,	0 },
+	{ "health",		Health_Task,	1000,	0,	0,						1 },
+	{ "flash",		Flash_Task,		10,		0,	0,						2 },
+	{ "telemetry",	Telemetry_Task,	5000,	0,	0,						3 },
+};
+#define TASKS		(sizeof(Tasks) / sizeof(Tasks[0]))
+
+static void Test_Scheduler(void)
+{
+	const char *names[TASKS], *name;
+	const SchedulerTaskStats *stats;
+	const TraceDecodeProbe *probe;
+	double traceUs;
+	uint32_t events, bytes = 0, pieces = 0;
+	uint8_t i;
+	FILE *out;
+
+	HalSim_Reset();
+	Trace_Init();
+	TraceDecode_Init(&Decoder);
+	Scheduler_Init();
+	for (i = 0; i < TASKS; i++) CHECK(Scheduler_Add(&Tasks[i]));
+	Radio_Edge();
+
+	while (HalSim_Now_Ns() < RUN_S * 1000000000ULL) {
+		if (Scheduler_Run_Once()) continue;
+		bytes += Dump_All(&pieces);
+		__disable_irq();
+		__WFI();
+		__enable_irq();
+	}
+	bytes += Dump_All(&pieces);
+
+	for (i = 0; i < TASKS; i++) Scheduler_Get_Stats(i, &names[i]);
+	out = fopen("trace.json", "w");
+	CHECK(out != NULL);
+	if (out == NULL) return;
+	events = TraceDecode_Chrome(&Decoder, out, names, TASKS);
+	fclose(out);
+	CHECK(Decoder.Lost == 0 && Decoder.Dropped == 0 && Decoder.Unpaired == 0 && events == Decoder.Count / 2);
+
+	for (i = 0; (stats = Scheduler_Get_Stats(i, &name)) != NULL; i++) {
+		probe = &Decoder.Probes[TRACE_TASK + i];
+		traceUs = probe->TotalCycles * 1e6 / Decoder.ClockHz;
+		BENCH("%-9s %5u runs, %9.0f us (scheduler) %9.0f us (trace), max %5u / %5.0f us",
+			  name, stats->runs, (double)stats->total_exec, traceUs, stats->max_exec,
+			  probe->MaxCycles * 1e6 / Decoder.ClockHz);
+		CHECK(probe->Count == stats->runs);
+		CHECK(fabs(traceUs - stats->total_exec) <= stats->total_exec / 100.0 + stats->runs);
+	}
+	/*Dumped at every idle, so a few records a packet: the headers weigh more than on a full ring*/
+	bytes -= pieces * TRACE_HEADER_SIZE;
+	BENCH("%u s: %u events in trace.json, %u packets, %.2f bytes per record without the headers",
+		  RUN_S, events, pieces, (double)bytes / Decoder.Count);
+	/*Varint deltas: smaller than the 6 bytes of a record in RAM*/
+	CHECK(bytes < 6 * Decoder.Count);
+}
+
+static void Bench_Probe(void)
+{
+	uint64_t start, enabledNs, pausedNs;
+	uint32_t i;
+
+	HalSim_Reset();
+	Trace_Init();
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_RECORDS; i++) Trace_Record(TRACE_TASK);
+	enabledNs = Host_Clock_Ns() - start;
+
+	Trace_Enable(false);
+	start = Host_Clock_Ns();
+	for (i = 0; i < BENCH_RECORDS; i++) Trace_Record(TRACE_TASK);
+	pausedNs = Host_Clock_Ns() - start;
+
+	/*The simulated DWT read is most of the enabled cost on the host, a load on the target*/
+	BENCH("probe (host): %.1f ns recording, %.1f ns paused",
+		  (double)enabledNs / BENCH_RECORDS, (double)pausedNs / BENCH_RECORDS);
+	CHECK(pausedNs < enabledNs);
+}
+
+int main(void)
+{
+	Test_Pieces();
+	Test_Commit();
+	Test_Scheduler();
+	Bench_Probe();
+	return HOST_TEST_END();
+}